@@ -0,0 +1,127 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include "openglframework.h"
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Number of builds used to measure the build time
+const int NB_BUILDS = 5;
+
+// Number of rays of each raycasting measure
+const int NB_RAYS = 1000000;
+
+// Return the elapsed time in seconds since a time point
+double getElapsedSeconds(const chrono::high_resolution_clock::time_point& start) {
+    return chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+}
+
+// Generate rays from a sphere around the mesh toward random points of its bounding box
+void generateRays(const AABB& aabb, vector<Ray>& rays) {
+    Vector3 center = aabb.getCenter();
+    Vector3 extent = aabb.getExtent();
+    float radius = 2.0f * extent.length();
+    srand(0);
+    rays.resize(NB_RAYS);
+    for (int i=0; i<NB_RAYS; i++) {
+        float theta = 2.0f * float(M_PI) * rand() / float(RAND_MAX);
+        float z = 2.0f * rand() / float(RAND_MAX) - 1.0f;
+        float r = sqrt(1.0f - z * z);
+        Vector3 origin = center + Vector3(r * cos(theta), r * sin(theta), z) * radius;
+        Vector3 target(center.x + extent.x * (2.0f * rand() / float(RAND_MAX) - 1.0f),
+                       center.y + extent.y * (2.0f * rand() / float(RAND_MAX) - 1.0f),
+                       center.z + extent.z * (2.0f * rand() / float(RAND_MAX) - 1.0f));
+        rays[i] = Ray(origin, (target - origin).normalize());
+    }
+}
+
+// Cast all the rays and return the number of millions of rays per second
+double measureRaycasts(const MeshBVH& bvh, const vector<Ray>& rays, bool isAnyHit, int& nbHits) {
+    int hits = 0;
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(+:hits)
+    for (int i=0; i<int(rays.size()); i++) {
+        RaycastHit hit;
+        bool isHit = isAnyHit ? bvh.testRayHit(rays[i]) : bvh.raycast(rays[i], hit);
+        if (isHit) hits++;
+    }
+    double seconds = getElapsedSeconds(start);
+    nbHits = hits;
+    return rays.size() / seconds * 1e-6;
+}
+
+// Main function
+int main(int argc, char** argv) {
+
+    // Number of Loop subdivision levels applied to the torus
+    uint nbLevels = (argc > 1) ? uint(atoi(argv[1])) : 3;
+
+    // Create the mesh
+    Mesh controlMesh;
+    MeshReaderWriter::loadMeshFromFile("torus.obj", controlMesh);
+    Mesh mesh;
+    LoopSubdivision subdivision;
+    subdivision.subdivide(controlMesh, mesh, nbLevels);
+
+    // Measure the build time
+    MeshBVH bvh;
+    double buildSeconds = 0.0;
+    for (int i=0; i<NB_BUILDS; i++) {
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        bvh.build(mesh);
+        buildSeconds += getElapsedSeconds(start);
+    }
+    buildSeconds /= NB_BUILDS;
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    MeshBVH wideBVH(mesh, true);
+    double wideBuildSeconds = getElapsedSeconds(start);
+
+    cout << "Triangles            : " << bvh.getNbTriangles() << endl;
+    cout << "Nodes                : " << bvh.getNbNodes() << endl;
+    cout << "Build time (binary)  : " << buildSeconds * 1000.0 << " ms" << endl;
+    cout << "Build time (4-ary)   : " << wideBuildSeconds * 1000.0 << " ms" << endl;
+
+    // Measure the raycasting throughput
+    vector<Ray> rays;
+    generateRays(bvh.getAABB(), rays);
+    int nbHits;
+    double mrays = measureRaycasts(bvh, rays, false, nbHits);
+    cout << "Closest hit (binary) : " << mrays << " Mrays/s (" << nbHits << " hits)" << endl;
+    mrays = measureRaycasts(wideBVH, rays, false, nbHits);
+    cout << "Closest hit (4-ary)  : " << mrays << " Mrays/s (" << nbHits << " hits)" << endl;
+    mrays = measureRaycasts(bvh, rays, true, nbHits);
+    cout << "Any hit (binary)     : " << mrays << " Mrays/s (" << nbHits << " hits)" << endl;
+    mrays = measureRaycasts(wideBVH, rays, true, nbHits);
+    cout << "Any hit (4-ary)      : " << mrays << " Mrays/s (" << nbHits << " hits)" << endl;
+
+    return 0;
+}
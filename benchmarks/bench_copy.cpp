@@ -0,0 +1,161 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <chrono>
+#include <type_traits>
+#include "openglframework.h"
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Number of vectors
+const uint NB_VECTORS = 1 << 20;
+
+// Number of repetitions of each test
+const int NB_REPETITIONS = 50;
+
+// The maths types must be trivially copyable (the trait is not available before GCC 5)
+#if !defined(__GNUC__) || defined(__clang__) || __GNUC__ >= 5
+static_assert(is_trivially_copyable<Vector3>::value, "Vector3 is not trivially copyable");
+static_assert(is_trivially_copyable<Vector4>::value, "Vector4 is not trivially copyable");
+static_assert(is_trivially_copyable<Matrix4>::value, "Matrix4 is not trivially copyable");
+static_assert(is_trivially_copyable<Color>::value, "Color is not trivially copyable");
+#endif
+
+// Constant transforms are folded at compile time
+constexpr Matrix4 CONSTANT_TRANSFORM = Matrix4::translationMatrix(Vector3(1, 2, 3));
+static_assert(CONSTANT_TRANSFORM.m[2][3] == 3.0f, "The translation matrix is not constexpr");
+
+// Class LegacyVector3
+// 3D vector with user-provided copy operations (as the maths types had before),
+// used as a reference for the copy throughput
+class LegacyVector3 {
+
+    public:
+
+        // Components of the vector
+        float x, y, z;
+
+        // Constructor
+        LegacyVector3(float x=0, float y=0, float z=0) : x(x), y(y), z(z) {}
+
+        // Constructor
+        LegacyVector3(const LegacyVector3& vector) : x(vector.x), y(vector.y), z(vector.z) {}
+
+        // Destructor
+        ~LegacyVector3() {}
+
+        // = operator
+        LegacyVector3& operator=(const LegacyVector3& vector) {
+            if (&vector != this) {
+                x = vector.x;
+                y = vector.y;
+                z = vector.z;
+            }
+            return *this;
+        }
+};
+
+// Return a random number between -1 and 1
+float getRandomNumber() {
+    return rand() / float(RAND_MAX) * 2.0f - 1.0f;
+}
+
+// Measure the copy construction, copy assignment and resize of vectors of a given type
+// and return the times in seconds
+template<typename VectorType>
+void measureCopies(const vector<VectorType>& source, double times[3]) {
+
+    vector<VectorType> destination(source.size());
+    times[0] = times[1] = times[2] = 0.0;
+    float checksum = 0.0f;
+
+    for (int r=0; r<NB_REPETITIONS; r++) {
+
+        // Copy construction
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        vector<VectorType> copy(source);
+        times[0] += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        checksum += copy[r].x;
+
+        // Copy assignment into an allocated vector
+        start = chrono::high_resolution_clock::now();
+        destination = source;
+        times[1] += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        checksum += destination[r].y;
+
+        // Growth of a vector by doubling its size (the elements are moved at each reallocation)
+        start = chrono::high_resolution_clock::now();
+        vector<VectorType> growing(1);
+        while (growing.size() < source.size()) {
+            growing.resize(growing.size() * 2);
+        }
+        times[2] += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        checksum += growing[r].z;
+    }
+
+    if (checksum == 1234.5f) cout << endl;
+}
+
+// Main function
+int main(int argc, char** argv) {
+
+    srand(0);
+    vector<Vector3> vectors(NB_VECTORS);
+    vector<LegacyVector3> legacyVectors(NB_VECTORS);
+    for (uint i=0; i<NB_VECTORS; i++) {
+        vectors[i] = Vector3(getRandomNumber(), getRandomNumber(), getRandomNumber());
+        legacyVectors[i] = LegacyVector3(vectors[i].x, vectors[i].y, vectors[i].z);
+    }
+
+    // Reference copy with memcpy
+    vector<Vector3> destination(NB_VECTORS);
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    for (int r=0; r<NB_REPETITIONS; r++) {
+        memcpy(&destination[0], &vectors[0], NB_VECTORS * sizeof(Vector3));
+    }
+    double memcpyTime = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+
+    double times[3], legacyTimes[3];
+    measureCopies(vectors, times);
+    measureCopies(legacyVectors, legacyTimes);
+
+    const char* names[3] = {"copy construction", "copy assignment  ", "resize growth    "};
+    const double nbBytes = double(NB_VECTORS) * sizeof(Vector3) * NB_REPETITIONS;
+    cout << "memcpy                           : " << nbBytes / memcpyTime * 1e-9 << " GB/s" << endl;
+    for (int i=0; i<3; i++) {
+        cout << names[i] << " (Vector3)       : " << nbBytes / times[i] * 1e-9 << " GB/s" << endl;
+        cout << names[i] << " (LegacyVector3) : " << nbBytes / legacyTimes[i] * 1e-9
+             << " GB/s (speedup " << legacyTimes[i] / times[i] << "x)" << endl;
+    }
+
+    return 0;
+}
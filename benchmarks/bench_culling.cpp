@@ -0,0 +1,123 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <chrono>
+#include "openglframework.h"
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Number of objects
+const uint NB_OBJECTS = 100000;
+
+// Number of rendered frames
+const int NB_FRAMES = 200;
+
+// Return a random number between 0 and 1
+float getRandomNumber() {
+    return rand() / float(RAND_MAX);
+}
+
+// Main function
+int main(int argc, char** argv) {
+
+    // Create random objects in a cube around the origin
+    srand(0);
+    vector<BoundingSphere> spheres(NB_OBJECTS);
+    vector<AABB> aabbs(NB_OBJECTS);
+    SphereBatch sphereBatch;
+    AABBBatch aabbBatch;
+    for (uint i=0; i<NB_OBJECTS; i++) {
+        Vector3 center(getRandomNumber() * 200.0f - 100.0f, getRandomNumber() * 200.0f - 100.0f,
+                       getRandomNumber() * 200.0f - 100.0f);
+        float radius = 0.1f + getRandomNumber();
+        spheres[i] = BoundingSphere(center, radius);
+        aabbs[i] = AABB(center - Vector3(radius, radius, radius),
+                        center + Vector3(radius, radius, radius));
+        sphereBatch.add(spheres[i]);
+        aabbBatch.add(aabbs[i]);
+    }
+
+    // The camera turns around at the origin
+    Camera camera;
+    camera.setDimensions(1280, 720);
+    camera.setSceneRadius(20.0f);
+
+    vector<uint> visibleIndices;
+    visibleIndices.reserve(NB_OBJECTS);
+    double times[4] = {0.0, 0.0, 0.0, 0.0};
+    uint nbVisibles[4] = {0, 0, 0, 0};
+
+    for (int frame=0; frame<NB_FRAMES; frame++) {
+
+        camera.rotateLocal(Vector3(0, 1, 0), 2.0f * PI / NB_FRAMES);
+        Frustum frustum = camera.getWorldFrustum();
+
+        // Scalar spheres
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        visibleIndices.clear();
+        for (uint i=0; i<NB_OBJECTS; i++) {
+            if (frustum.testSphere(spheres[i]) != Frustum::OUTSIDE) visibleIndices.push_back(i);
+        }
+        times[0] += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        nbVisibles[0] += visibleIndices.size();
+
+        // Batched spheres
+        start = chrono::high_resolution_clock::now();
+        FrustumCulling::cullSpheres(frustum, sphereBatch, visibleIndices);
+        times[1] += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        nbVisibles[1] += visibleIndices.size();
+
+        // Scalar boxes
+        start = chrono::high_resolution_clock::now();
+        visibleIndices.clear();
+        for (uint i=0; i<NB_OBJECTS; i++) {
+            if (frustum.testAABB(aabbs[i]) != Frustum::OUTSIDE) visibleIndices.push_back(i);
+        }
+        times[2] += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        nbVisibles[2] += visibleIndices.size();
+
+        // Batched boxes
+        start = chrono::high_resolution_clock::now();
+        FrustumCulling::cullAABBs(frustum, aabbBatch, visibleIndices);
+        times[3] += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        nbVisibles[3] += visibleIndices.size();
+    }
+
+    const char* names[4] = {"Spheres (scalar)  ", "Spheres (batched) ",
+                            "AABBs (scalar)    ", "AABBs (batched)   "};
+    cout << "Objects : " << NB_OBJECTS << endl;
+    for (int i=0; i<4; i++) {
+        cout << names[i] << ": " << times[i] / NB_FRAMES * 1000.0 << " ms/frame, "
+             << nbVisibles[i] / NB_FRAMES << " visible" << endl;
+    }
+
+    return 0;
+}
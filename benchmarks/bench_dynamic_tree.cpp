@@ -0,0 +1,160 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <chrono>
+#include "openglframework.h"
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Number of objects (they all move at each frame)
+const uint NB_OBJECTS = 10000;
+
+// Number of simulated frames
+const int NB_FRAMES = 200;
+
+// Half size of the cube that contains the objects
+const float WORLD_HALF_SIZE = 100.0f;
+
+// Number of objects inserted again at each frame by the refit strategy
+const uint NB_REBALANCED_OBJECTS = NB_OBJECTS / 100;
+
+// Return a random number between 0 and 1
+float getRandomNumber() {
+    return rand() / float(RAND_MAX);
+}
+
+// Return the box of a sphere
+AABB computeAABB(const Vector3& center, float radius) {
+    return AABB(center - Vector3(radius, radius, radius), center + Vector3(radius, radius, radius));
+}
+
+// Main function
+int main(int argc, char** argv) {
+
+    // Create random objects in a cube around the origin with random velocities
+    srand(0);
+    vector<Object3D> objects(NB_OBJECTS);
+    vector<Vector3> centers(NB_OBJECTS), velocities(NB_OBJECTS);
+    vector<float> radii(NB_OBJECTS);
+    for (uint i=0; i<NB_OBJECTS; i++) {
+        centers[i] = Vector3(getRandomNumber(), getRandomNumber(), getRandomNumber()) *
+                     (2.0f * WORLD_HALF_SIZE) - Vector3(WORLD_HALF_SIZE, WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+        velocities[i] = Vector3(getRandomNumber() - 0.5f, getRandomNumber() - 0.5f,
+                                getRandomNumber() - 0.5f) * 0.4f;
+        radii[i] = 0.1f + getRandomNumber();
+    }
+
+    // One tree updated object by object and one tree refitted at each frame
+    DynamicAABBTree updatedTree, refittedTree;
+    vector<int> updatedProxies(NB_OBJECTS), refittedProxies(NB_OBJECTS);
+    for (uint i=0; i<NB_OBJECTS; i++) {
+        AABB aabb = computeAABB(centers[i], radii[i]);
+        updatedProxies[i] = updatedTree.addObject(&objects[i], aabb);
+        refittedProxies[i] = refittedTree.addObject(&objects[i], aabb);
+    }
+
+    // The camera turns around at the origin
+    Camera camera;
+    camera.setDimensions(1280, 720);
+    camera.setSceneRadius(20.0f);
+
+    vector<int> proxies;
+    double updateTimes[2] = {0.0, 0.0}, queryTimes[2] = {0.0, 0.0};
+    double maxUpdateTimes[2] = {0.0, 0.0};
+    uint nbReinsertedObjects = 0;
+    uint nbVisibles[2] = {0, 0};
+    DynamicAABBTree* trees[2] = {&updatedTree, &refittedTree};
+
+    for (int frame=0; frame<NB_FRAMES; frame++) {
+
+        // Move the objects (they bounce on the sides of the cube)
+        for (uint i=0; i<NB_OBJECTS; i++) {
+            centers[i] += velocities[i];
+            for (int axis=0; axis<3; axis++) {
+                if (centers[i][axis] < -WORLD_HALF_SIZE || centers[i][axis] > WORLD_HALF_SIZE) {
+                    velocities[i][axis] = -velocities[i][axis];
+                }
+            }
+        }
+
+        // Update the objects one by one (the leaves that leave their fat box are
+        // inserted again)
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        for (uint i=0; i<NB_OBJECTS; i++) {
+            if (updatedTree.updateObject(updatedProxies[i], computeAABB(centers[i], radii[i]),
+                                         velocities[i])) {
+                nbReinsertedObjects++;
+            }
+        }
+        double time = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        updateTimes[0] += time;
+        maxUpdateTimes[0] = max(maxUpdateTimes[0], time);
+
+        // Set the boxes, refit the tree and insert again a few objects (per-frame path
+        // of the tree when many objects move)
+        start = chrono::high_resolution_clock::now();
+        for (uint i=0; i<NB_OBJECTS; i++) {
+            refittedTree.setObjectAABB(refittedProxies[i], computeAABB(centers[i], radii[i]));
+        }
+        refittedTree.refit();
+        refittedTree.rebalance(NB_REBALANCED_OBJECTS);
+        time = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        updateTimes[1] += time;
+        maxUpdateTimes[1] = max(maxUpdateTimes[1], time);
+
+        // Query the visible objects to compare the quality of the trees
+        camera.rotateLocal(Vector3(0, 1, 0), 2.0f * PI / NB_FRAMES);
+        Frustum frustum = camera.getWorldFrustum();
+        for (int t=0; t<2; t++) {
+            start = chrono::high_resolution_clock::now();
+            proxies.clear();
+            trees[t]->queryFrustum(frustum, proxies);
+            queryTimes[t] += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+            nbVisibles[t] += proxies.size();
+        }
+    }
+
+    const char* names[2] = {"updateObject       ", "refit + rebalance  "};
+    cout << "Moving objects : " << NB_OBJECTS << endl;
+    for (int t=0; t<2; t++) {
+        cout << names[t] << ": update " << updateTimes[t] / NB_FRAMES * 1000.0 << " ms/frame (max "
+             << maxUpdateTimes[t] * 1000.0 << " ms), frustum query "
+             << queryTimes[t] / NB_FRAMES * 1000.0 << " ms/frame, height "
+             << trees[t]->getHeight() << ", " << nbVisibles[t] / NB_FRAMES << " visible" << endl;
+    }
+    cout << "Reinserted objects (updateObject) : " << nbReinsertedObjects / NB_FRAMES
+         << " per frame" << endl;
+
+    bool isValid = updatedTree.validate() && refittedTree.validate();
+    cout << "Trees valid : " << (isValid ? "yes" : "no") << endl;
+
+    return isValid ? 0 : 1;
+}
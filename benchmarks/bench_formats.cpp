@@ -0,0 +1,201 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include "openglframework.h"
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Number of elements converted by each test
+const uint NB_ELEMENTS = 1 << 20;
+
+// Number of repetitions of each test
+const int NB_REPETITIONS = 50;
+
+// Return a random number between a minimum and a maximum
+float getRandomNumber(float minValue, float maxValue) {
+    return minValue + rand() / float(RAND_MAX) * (maxValue - minValue);
+}
+
+// Return the float with given bits
+float getFloatFromBits(uint bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(float));
+    return value;
+}
+
+// Return true if a half float is a NaN
+bool isHalfNaN(unsigned short half) {
+    return (half & 0x7fff) > 0x7c00;
+}
+
+// Print the throughput of a conversion (in GB/s of floats)
+void printThroughput(const char* name, double time, double nbFloatBytes) {
+    cout << name << " : " << nbFloatBytes * NB_REPETITIONS / time * 1e-9 << " GB/s" << endl;
+}
+
+// Check the half float conversions and return the number of errors
+int checkHalfs() {
+
+    int nbErrors = 0;
+
+    // Every half float must be converted into a float and back without change
+    vector<unsigned short> halfs(65536), results(65536);
+    vector<float> values(65536);
+    for (uint i=0; i<65536; i++) halfs[i] = (unsigned short)i;
+    FormatConversion::convertHalfsToFloats(&halfs[0], &values[0], 65536);
+    FormatConversion::convertFloatsToHalfs(&values[0], &results[0], 65536);
+    for (uint i=0; i<65536; i++) {
+        bool isSame = isHalfNaN(halfs[i]) ? isHalfNaN(results[i]) : results[i] == halfs[i];
+        if (!isSame) nbErrors++;
+    }
+
+    // The array conversion must match the scalar one on a sample of all the floats
+    vector<float> floats;
+    for (uint bits=0; bits<0xfffff000u; bits+=4093) floats.push_back(getFloatFromBits(bits));
+    vector<unsigned short> floatHalfs(floats.size());
+    FormatConversion::convertFloatsToHalfs(&floats[0], &floatHalfs[0], uint(floats.size()));
+    for (size_t i=0; i<floats.size(); i++) {
+        unsigned short half = FormatConversion::convertFloatToHalf(floats[i]);
+        bool isSame = isHalfNaN(half) ? isHalfNaN(floatHalfs[i]) : half == floatHalfs[i];
+        if (!isSame) nbErrors++;
+    }
+
+    return nbErrors;
+}
+
+// Check the sRGB encoding against the exact rounding and return the number of errors
+int checkSRGB() {
+
+    int nbErrors = 0;
+    vector<Color> colors;
+    for (uint bits=0; bits<=0x3f800000u; bits+=97) {
+        float value = getFloatFromBits(bits);
+        colors.push_back(Color(value, value, value, value));
+    }
+    vector<unsigned char> pixels(4 * colors.size());
+    FormatConversion::convertColorsToSRGBA8(&colors[0], &pixels[0], uint(colors.size()));
+    for (size_t i=0; i<colors.size(); i++) {
+        double value = colors[i].r;
+        double srgb = (value <= 0.0031308) ? 12.92 * value : 1.055 * pow(value, 1.0 / 2.4) - 0.055;
+        if (pixels[4 * i] != int(floor(srgb * 255.0 + 0.5))) nbErrors++;
+    }
+
+    // Every sRGB8 and RGBA8 pixel must be decoded and encoded back without change
+    unsigned char codes[1024], results[1024];
+    Color decodedColors[256];
+    for (int i=0; i<1024; i++) codes[i] = (unsigned char)(i & 255);
+    FormatConversion::convertSRGBA8ToColors(codes, decodedColors, 256);
+    FormatConversion::convertColorsToSRGBA8(decodedColors, results, 256);
+    if (memcmp(codes, results, 1024) != 0) nbErrors++;
+    FormatConversion::convertRGBA8ToColors(codes, decodedColors, 256);
+    FormatConversion::convertColorsToRGBA8(decodedColors, results, 256);
+    if (memcmp(codes, results, 1024) != 0) nbErrors++;
+
+    return nbErrors;
+}
+
+// Return the largest error of the 10-10-10-2 conversion of given vectors
+float compute1010102Error(const vector<Vector3>& vectors) {
+
+    vector<uint> packedVectors(vectors.size());
+    vector<Vector3> results(vectors.size());
+    FormatConversion::convertVectorsTo1010102(&vectors[0], &packedVectors[0], uint(vectors.size()));
+    FormatConversion::convert1010102ToVectors(&packedVectors[0], &results[0], uint(vectors.size()));
+    float maxError = 0.0f;
+    for (size_t i=0; i<vectors.size(); i++) {
+        for (int k=0; k<3; k++) {
+            float value = std::max(-1.0f, std::min(1.0f, (&vectors[i].x)[k]));
+            maxError = std::max(maxError, std::fabs(value - (&results[i].x)[k]));
+        }
+    }
+    return maxError;
+}
+
+// Main function
+int main(int argc, char** argv) {
+
+    srand(0);
+    vector<float> values(NB_ELEMENTS);
+    vector<unsigned short> halfs(NB_ELEMENTS);
+    vector<Color> colors(NB_ELEMENTS);
+    vector<unsigned char> pixels(4 * NB_ELEMENTS);
+    vector<Vector3> vectors(NB_ELEMENTS);
+    vector<uint> packedVectors(NB_ELEMENTS);
+    for (uint i=0; i<NB_ELEMENTS; i++) {
+        values[i] = getRandomNumber(-100.0f, 100.0f);
+        colors[i] = Color(getRandomNumber(0, 1), getRandomNumber(0, 1), getRandomNumber(0, 1), 1);
+        vectors[i] = Vector3(getRandomNumber(-1, 1), getRandomNumber(-1, 1), getRandomNumber(-1, 1));
+    }
+
+    // Measure the throughput of each conversion
+    const char* names[8] = {"float -> half     ", "half -> float     ", "Color -> RGBA8    ",
+                            "RGBA8 -> Color    ", "Color -> sRGBA8   ", "sRGBA8 -> Color   ",
+                            "Vector3 -> 1010102", "1010102 -> Vector3"};
+    const double nbFloatBytes[8] = {4.0 * NB_ELEMENTS, 4.0 * NB_ELEMENTS, 16.0 * NB_ELEMENTS,
+                                    16.0 * NB_ELEMENTS, 16.0 * NB_ELEMENTS, 16.0 * NB_ELEMENTS,
+                                    12.0 * NB_ELEMENTS, 12.0 * NB_ELEMENTS};
+    for (int test=0; test<8; test++) {
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        for (int r=0; r<NB_REPETITIONS; r++) {
+            switch (test) {
+                case 0: FormatConversion::convertFloatsToHalfs(&values[0], &halfs[0], NB_ELEMENTS); break;
+                case 1: FormatConversion::convertHalfsToFloats(&halfs[0], &values[0], NB_ELEMENTS); break;
+                case 2: FormatConversion::convertColorsToRGBA8(&colors[0], &pixels[0], NB_ELEMENTS); break;
+                case 3: FormatConversion::convertRGBA8ToColors(&pixels[0], &colors[0], NB_ELEMENTS); break;
+                case 4: FormatConversion::convertColorsToSRGBA8(&colors[0], &pixels[0], NB_ELEMENTS); break;
+                case 5: FormatConversion::convertSRGBA8ToColors(&pixels[0], &colors[0], NB_ELEMENTS); break;
+                case 6: FormatConversion::convertVectorsTo1010102(&vectors[0], &packedVectors[0], NB_ELEMENTS); break;
+                case 7: FormatConversion::convert1010102ToVectors(&packedVectors[0], &vectors[0], NB_ELEMENTS); break;
+            }
+        }
+        double time = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        printThroughput(names[test], time, nbFloatBytes[test]);
+    }
+
+    // Check the accuracy of the conversions
+    int nbHalfErrors = checkHalfs();
+    int nbSRGBErrors = checkSRGB();
+    vector<Vector3> testVectors(NB_ELEMENTS);
+    for (uint i=0; i<NB_ELEMENTS; i++) {
+        testVectors[i] = Vector3(getRandomNumber(-1.5f, 1.5f), getRandomNumber(-1.5f, 1.5f),
+                                 getRandomNumber(-1.5f, 1.5f));
+    }
+    float error1010102 = compute1010102Error(testVectors);
+    cout << "half float errors        : " << nbHalfErrors << endl;
+    cout << "sRGB errors              : " << nbSRGBErrors << endl;
+    cout << "10-10-10-2 maximum error : " << error1010102 << " (bound " << 0.5f / 511.0f << ")" << endl;
+
+    bool isValid = nbHalfErrors == 0 && nbSRGBErrors == 0 && error1010102 <= 0.5f / 511.0f + 1e-6f;
+    return isValid ? 0 : 1;
+}
@@ -0,0 +1,393 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#if defined(__linux__)
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+#include "openglframework.h"
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Number of input elements (power of two, the operations cycle through them)
+const uint NB_ELEMENTS = 1024;
+
+// Number of samples run before the measures
+const int NB_WARMUP_SAMPLES = 20;
+
+// Number of measured samples of each benchmark
+const int NB_SAMPLES = 200;
+
+// Number of operations of each sample
+const uint NB_OPERATIONS_PER_SAMPLE = 4096;
+
+// Structure BenchmarkResult
+// Statistics of the time of an operation over the samples (in nanoseconds)
+struct BenchmarkResult {
+    string name;
+    double median;
+    double p99;
+    double min;
+    double mean;
+};
+
+// Structure BenchmarkData
+// Inputs and outputs of the benchmarked operations
+struct BenchmarkData {
+    vector<Matrix4> matrices;
+    vector<Matrix4> rigidMatrices;
+    vector<Matrix3> matrices3;
+    vector<Vector3> vectors;
+    vector<Vector3> axes;
+    vector<float> angles;
+    vector<Matrix4> resultMatrices;
+    vector<Matrix3> resultMatrices3;
+    vector<Vector3> resultVectors;
+    vector<float> resultFloats;
+    Object3D object;
+    Object3D trsObject;
+};
+
+// Return a random number between -1 and 1
+float getRandomNumber() {
+    return rand() / float(RAND_MAX) * 2.0f - 1.0f;
+}
+
+// Pin the current thread on the processor it is running on so that the measures
+// are not disturbed by migrations. Return true if the thread has been pinned.
+bool pinCurrentThread() {
+#if defined(__linux__)
+    int cpu = sched_getcpu();
+    if (cpu < 0) return false;
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+    return sched_setaffinity(0, sizeof(cpuSet), &cpuSet) == 0;
+#elif defined(_WIN32)
+    DWORD_PTR mask = DWORD_PTR(1) << GetCurrentProcessorNumber();
+    return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+    return false;
+#endif
+}
+
+// Return the name of the SIMD instructions used by the maths library
+const char* getSimdName() {
+#if defined(MATRIX4_USE_AVX)
+    return "AVX";
+#elif defined(MATRIX4_USE_SSE)
+    return "SSE";
+#elif defined(MATRIX4_USE_NEON)
+    return "NEON";
+#else
+    return "none";
+#endif
+}
+
+// ---------- Benchmarked operations ---------- //
+
+struct Matrix4Multiply {
+    BenchmarkData& d;
+    void operator()(uint i) {
+        d.resultMatrices[i] = d.matrices[i] * d.matrices[(i + 1) & (NB_ELEMENTS - 1)];
+    }
+};
+
+struct Matrix4Transform {
+    BenchmarkData& d;
+    void operator()(uint i) { d.resultVectors[i] = d.matrices[i] * d.vectors[i]; }
+};
+
+struct Matrix4Transpose {
+    BenchmarkData& d;
+    void operator()(uint i) { d.resultMatrices[i] = d.matrices[i].getTranspose(); }
+};
+
+struct Matrix4Inverse {
+    BenchmarkData& d;
+    void operator()(uint i) { d.resultMatrices[i] = d.matrices[i].getInverse(); }
+};
+
+struct Matrix4AffineInverse {
+    BenchmarkData& d;
+    void operator()(uint i) { d.resultMatrices[i] = d.rigidMatrices[i].getAffineInverse(); }
+};
+
+struct Matrix4RigidInverse {
+    BenchmarkData& d;
+    void operator()(uint i) { d.resultMatrices[i] = d.rigidMatrices[i].getRigidInverse(); }
+};
+
+struct Matrix4RotationMatrix {
+    BenchmarkData& d;
+    void operator()(uint i) {
+        d.resultMatrices[i] = Matrix4::rotationMatrix(d.axes[i], d.angles[i]);
+    }
+};
+
+struct Matrix3Inverse {
+    BenchmarkData& d;
+    void operator()(uint i) { d.resultMatrices3[i] = d.matrices3[i].getInverse(); }
+};
+
+struct Vector3Normalize {
+    BenchmarkData& d;
+    void operator()(uint i) {
+        Vector3 v = d.vectors[i];
+        d.resultVectors[i] = v.normalize();
+    }
+};
+
+// Normalize the vectors by batches of 16 (the time is given per vector)
+struct Vector3NormalizeBatch {
+    BenchmarkData& d;
+    void operator()(uint i) {
+        if ((i & 15) == 0) Vector3::normalize(&d.resultVectors[i], 16);
+    }
+};
+
+struct Vector3Cross {
+    BenchmarkData& d;
+    void operator()(uint i) {
+        d.resultVectors[i] = d.vectors[i].cross(d.vectors[(i + 1) & (NB_ELEMENTS - 1)]);
+    }
+};
+
+struct Vector3Dot {
+    BenchmarkData& d;
+    void operator()(uint i) {
+        d.resultFloats[i] = d.vectors[i].dot(d.vectors[(i + 1) & (NB_ELEMENTS - 1)]);
+    }
+};
+
+struct Object3DTranslateWorld {
+    Object3D& object;
+    BenchmarkData& d;
+    void operator()(uint i) { object.translateWorld(d.vectors[i] * 0.001f); }
+};
+
+struct Object3DRotateWorld {
+    Object3D& object;
+    BenchmarkData& d;
+    void operator()(uint i) { object.rotateWorld(d.axes[i], d.angles[i]); }
+};
+
+struct Object3DRotateLocal {
+    Object3D& object;
+    BenchmarkData& d;
+    void operator()(uint i) { object.rotateLocal(d.axes[i], d.angles[i]); }
+};
+
+struct Object3DRotateAroundWorldPoint {
+    Object3D& object;
+    BenchmarkData& d;
+    void operator()(uint i) {
+        object.rotateAroundWorldPoint(d.axes[i], d.angles[i], d.vectors[i]);
+    }
+};
+
+struct Object3DRotateAndInverse {
+    Object3D& object;
+    BenchmarkData& d;
+    void operator()(uint i) {
+        object.rotateWorld(d.axes[i], d.angles[i]);
+        d.resultMatrices[i] = object.getInverseTransformMatrix();
+    }
+};
+
+struct Object3DRotateAndMatrix {
+    Object3D& object;
+    BenchmarkData& d;
+    void operator()(uint i) {
+        object.rotateWorld(d.axes[i], d.angles[i]);
+        d.resultMatrices[i] = object.getTransformMatrix();
+    }
+};
+
+// Run the samples of an operation and return the statistics of its time
+template<typename Operation>
+BenchmarkResult runBenchmark(const string& name, Operation operation) {
+
+    vector<double> samples(NB_SAMPLES);
+    for (int s=-NB_WARMUP_SAMPLES; s<NB_SAMPLES; s++) {
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        for (uint k=0; k<NB_OPERATIONS_PER_SAMPLE; k++) {
+            operation(k & (NB_ELEMENTS - 1));
+        }
+        double time = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        if (s >= 0) samples[s] = time / NB_OPERATIONS_PER_SAMPLE * 1e9;
+    }
+
+    sort(samples.begin(), samples.end());
+    BenchmarkResult result;
+    result.name = name;
+    result.median = (NB_SAMPLES % 2 == 1) ? samples[NB_SAMPLES / 2] :
+                    0.5 * (samples[NB_SAMPLES / 2 - 1] + samples[NB_SAMPLES / 2]);
+    result.p99 = samples[min(NB_SAMPLES - 1, int(ceil(0.99 * NB_SAMPLES)) - 1)];
+    result.min = samples[0];
+    result.mean = 0.0;
+    for (int s=0; s<NB_SAMPLES; s++) {
+        result.mean += samples[s];
+    }
+    result.mean /= NB_SAMPLES;
+    return result;
+}
+
+// Main function
+int main(int argc, char** argv) {
+
+    bool isPinned = pinCurrentThread();
+
+    // Create the inputs (the rigid matrices and the axes are exact rotations)
+    srand(0);
+    BenchmarkData d;
+    d.matrices.resize(NB_ELEMENTS);
+    d.rigidMatrices.resize(NB_ELEMENTS);
+    d.matrices3.resize(NB_ELEMENTS);
+    d.vectors.resize(NB_ELEMENTS);
+    d.axes.resize(NB_ELEMENTS);
+    d.angles.resize(NB_ELEMENTS);
+    d.resultMatrices.resize(NB_ELEMENTS);
+    d.resultMatrices3.resize(NB_ELEMENTS);
+    d.resultVectors.resize(NB_ELEMENTS);
+    d.resultFloats.resize(NB_ELEMENTS);
+    for (uint i=0; i<NB_ELEMENTS; i++) {
+        for (int j=0; j<4; j++) {
+            for (int k=0; k<4; k++) {
+                d.matrices[i].m[j][k] = getRandomNumber() + (j == k ? 4.0f : 0.0f);
+            }
+        }
+        d.matrices3[i] = Matrix3(4 + getRandomNumber(), getRandomNumber(), getRandomNumber(),
+                                 getRandomNumber(), 4 + getRandomNumber(), getRandomNumber(),
+                                 getRandomNumber(), getRandomNumber(), 4 + getRandomNumber());
+        d.vectors[i] = Vector3(getRandomNumber(), getRandomNumber(), getRandomNumber() + 2.0f);
+        d.axes[i] = Vector3(getRandomNumber(), getRandomNumber(), getRandomNumber() + 2.0f);
+        d.axes[i].normalize();
+        d.angles[i] = getRandomNumber() * PI;
+        d.rigidMatrices[i] = Matrix4::translationMatrix(d.vectors[i]) *
+                             Matrix4::rotationMatrix(d.axes[i], d.angles[i]);
+    }
+    d.trsObject.setTRS(Vector3(1, 2, 3), Quaternion::identity(), Vector3(1, 1, 1));
+
+    vector<BenchmarkResult> results;
+    Matrix4Multiply matrix4Multiply = {d};
+    results.push_back(runBenchmark("Matrix4::operator*(Matrix4)", matrix4Multiply));
+    Matrix4Transform matrix4Transform = {d};
+    results.push_back(runBenchmark("Matrix4::operator*(Vector3)", matrix4Transform));
+    Matrix4Transpose matrix4Transpose = {d};
+    results.push_back(runBenchmark("Matrix4::getTranspose", matrix4Transpose));
+    Matrix4Inverse matrix4Inverse = {d};
+    results.push_back(runBenchmark("Matrix4::getInverse", matrix4Inverse));
+    Matrix4AffineInverse matrix4AffineInverse = {d};
+    results.push_back(runBenchmark("Matrix4::getAffineInverse", matrix4AffineInverse));
+    Matrix4RigidInverse matrix4RigidInverse = {d};
+    results.push_back(runBenchmark("Matrix4::getRigidInverse", matrix4RigidInverse));
+    Matrix4RotationMatrix matrix4RotationMatrix = {d};
+    results.push_back(runBenchmark("Matrix4::rotationMatrix", matrix4RotationMatrix));
+    Matrix3Inverse matrix3Inverse = {d};
+    results.push_back(runBenchmark("Matrix3::getInverse", matrix3Inverse));
+    Vector3Normalize vector3Normalize = {d};
+    results.push_back(runBenchmark("Vector3::normalize", vector3Normalize));
+    d.resultVectors = d.vectors;
+    Vector3NormalizeBatch vector3NormalizeBatch = {d};
+    results.push_back(runBenchmark("Vector3::normalize (batch)", vector3NormalizeBatch));
+    Vector3Cross vector3Cross = {d};
+    results.push_back(runBenchmark("Vector3::cross", vector3Cross));
+    Vector3Dot vector3Dot = {d};
+    results.push_back(runBenchmark("Vector3::dot", vector3Dot));
+
+    // Object3D transform methods with the matrix and the TRS representations
+    Object3D* objects[2] = {&d.object, &d.trsObject};
+    const char* modes[2] = {"matrix", "TRS"};
+    for (int m=0; m<2; m++) {
+        string suffix = string(" (") + modes[m] + ")";
+        Object3DTranslateWorld translateWorld = {*objects[m], d};
+        results.push_back(runBenchmark("Object3D::translateWorld" + suffix, translateWorld));
+        Object3DRotateWorld rotateWorld = {*objects[m], d};
+        results.push_back(runBenchmark("Object3D::rotateWorld" + suffix, rotateWorld));
+        Object3DRotateLocal rotateLocal = {*objects[m], d};
+        results.push_back(runBenchmark("Object3D::rotateLocal" + suffix, rotateLocal));
+        Object3DRotateAroundWorldPoint rotateAroundWorldPoint = {*objects[m], d};
+        results.push_back(runBenchmark("Object3D::rotateAroundWorldPoint" + suffix,
+                                       rotateAroundWorldPoint));
+        Object3DRotateAndMatrix rotateAndMatrix = {*objects[m], d};
+        results.push_back(runBenchmark("Object3D::rotateWorld+getTransformMatrix" + suffix,
+                                       rotateAndMatrix));
+        Object3DRotateAndInverse rotateAndInverse = {*objects[m], d};
+        results.push_back(runBenchmark("Object3D::rotateWorld+getInverseTransformMatrix" + suffix,
+                                       rotateAndInverse));
+    }
+
+    // Checksum of the outputs so that the operations are not optimized away
+    float checksum = 0.0f;
+    for (uint i=0; i<NB_ELEMENTS; i++) {
+        checksum += d.resultMatrices[i].m[0][0] + d.resultMatrices3[i].getValue(0, 0) +
+                    d.resultVectors[i].x + d.resultFloats[i];
+    }
+
+    // Write the results in JSON
+    ostringstream json;
+    json << "{\n";
+    json << "  \"benchmark\": \"bench_maths\",\n";
+    json << "  \"simd\": \"" << getSimdName() << "\",\n";
+    json << "  \"pinned\": " << (isPinned ? "true" : "false") << ",\n";
+    json << "  \"warmup_samples\": " << NB_WARMUP_SAMPLES << ",\n";
+    json << "  \"samples\": " << NB_SAMPLES << ",\n";
+    json << "  \"operations_per_sample\": " << NB_OPERATIONS_PER_SAMPLE << ",\n";
+    json << "  \"checksum\": " << checksum << ",\n";
+    json << "  \"results\": [\n";
+    for (size_t i=0; i<results.size(); i++) {
+        json << "    {\"name\": \"" << results[i].name << "\", \"median_ns\": " << results[i].median
+             << ", \"p99_ns\": " << results[i].p99 << ", \"min_ns\": " << results[i].min
+             << ", \"mean_ns\": " << results[i].mean << "}"
+             << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n";
+    json << "}\n";
+
+    // The JSON is written in the file given as argument or on the standard output
+    if (argc > 1) {
+        ofstream file(argv[1]);
+        file << json.str();
+    }
+    else {
+        cout << json.str();
+    }
+
+    return 0;
+}
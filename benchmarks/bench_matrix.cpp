@@ -0,0 +1,239 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include "openglframework.h"
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Number of matrices
+const uint NB_MATRICES = 4096;
+
+// Number of repetitions of each test
+const int NB_REPETITIONS = 500;
+
+// Number of points of the batch transform tests
+const uint NB_POINTS = 1 << 20;
+
+// Number of repetitions of the batch transform tests
+const int NB_BATCH_REPETITIONS = 20;
+
+// Return a random number between -1 and 1
+float getRandomNumber() {
+    return rand() / float(RAND_MAX) * 2.0f - 1.0f;
+}
+
+// Scalar product of two matrices (reference implementation)
+Matrix4 multiplyScalar(const Matrix4& a, const Matrix4& b) {
+    Matrix4 o;
+    for (int i=0; i<4; i++) {
+        for (int j=0; j<4; j++) {
+            float v = 0;
+            for (int k=0; k<4; k++) {
+                v += a.m[i][k] * b.m[k][j];
+            }
+            o.m[i][j] = v;
+        }
+    }
+    return o;
+}
+
+// Scalar product of a matrix and a vector (reference implementation)
+Vector4 transformScalar(const Matrix4& a, const Vector4& v) {
+    return Vector4(a.m[0][0]*v.x + a.m[0][1]*v.y + a.m[0][2]*v.z + v.w*a.m[0][3],
+                   a.m[1][0]*v.x + a.m[1][1]*v.y + a.m[1][2]*v.z + v.w*a.m[1][3],
+                   a.m[2][0]*v.x + a.m[2][1]*v.y + a.m[2][2]*v.z + v.w*a.m[2][3],
+                   a.m[3][0]*v.x + a.m[3][1]*v.y + a.m[3][2]*v.z + v.w*a.m[3][3]);
+}
+
+// Return the distance in units in the last place between two floats (computed with
+// 64-bit integers because the distance between floats of opposite signs overflows an int)
+int64_t computeUlpDistance(float a, float b) {
+    if (a == b) return 0;
+    int32_t ia, ib;
+    memcpy(&ia, &a, sizeof(float));
+    memcpy(&ib, &b, sizeof(float));
+    int64_t orderedA = (ia < 0) ? int64_t(INT32_MIN) - ia : int64_t(ia);
+    int64_t orderedB = (ib < 0) ? int64_t(INT32_MIN) - ib : int64_t(ib);
+    return (orderedA > orderedB) ? orderedA - orderedB : orderedB - orderedA;
+}
+
+// Main function
+int main(int argc, char** argv) {
+
+    // SIMD path of the Matrix4 products (the speedups depend on the build flags, with
+    // -O3 the compiler also vectorizes the scalar reference loops)
+#if defined(MATRIX4_USE_AVX)
+    cout << "Matrix4 SIMD path : AVX" << endl;
+#elif defined(MATRIX4_USE_SSE)
+    cout << "Matrix4 SIMD path : SSE" << endl;
+#elif defined(MATRIX4_USE_NEON)
+    cout << "Matrix4 SIMD path : NEON" << endl;
+#else
+    cout << "Matrix4 SIMD path : none" << endl;
+#endif
+#if defined(NDEBUG)
+    cout << "Assertions        : disabled" << endl;
+#else
+    cout << "Assertions        : enabled" << endl;
+#endif
+
+    srand(0);
+    vector<Matrix4> matrices(NB_MATRICES);
+    vector<Vector4> vectors(NB_MATRICES);
+    for (uint i=0; i<NB_MATRICES; i++) {
+        for (int j=0; j<4; j++) {
+            for (int k=0; k<4; k++) {
+                matrices[i].m[j][k] = getRandomNumber();
+            }
+        }
+        vectors[i] = Vector4(getRandomNumber(), getRandomNumber(), getRandomNumber(),
+                             getRandomNumber());
+    }
+
+    vector<Matrix4> scalarMatrices(NB_MATRICES), simdMatrices(NB_MATRICES);
+    vector<Vector4> scalarVectors(NB_MATRICES), simdVectors(NB_MATRICES);
+    double times[4] = {0.0, 0.0, 0.0, 0.0};
+
+    for (int r=0; r<NB_REPETITIONS; r++) {
+
+        // Matrix-matrix products (each matrix is multiplied by the next one)
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        for (uint i=0; i<NB_MATRICES; i++) {
+            scalarMatrices[i] = multiplyScalar(matrices[i], matrices[(i + 1) % NB_MATRICES]);
+        }
+        times[0] += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+
+        start = chrono::high_resolution_clock::now();
+        for (uint i=0; i<NB_MATRICES; i++) {
+            simdMatrices[i] = matrices[i] * matrices[(i + 1) % NB_MATRICES];
+        }
+        times[1] += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+
+        // Matrix-vector products
+        start = chrono::high_resolution_clock::now();
+        for (uint i=0; i<NB_MATRICES; i++) {
+            scalarVectors[i] = transformScalar(matrices[i], vectors[i]);
+        }
+        times[2] += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+
+        start = chrono::high_resolution_clock::now();
+        for (uint i=0; i<NB_MATRICES; i++) {
+            simdVectors[i] = matrices[i].transform(vectors[i]);
+        }
+        times[3] += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    }
+
+    // Compare the results
+    int64_t maxUlpMatrix = 0, maxUlpVector = 0;
+    for (uint i=0; i<NB_MATRICES; i++) {
+        for (int j=0; j<4; j++) {
+            for (int k=0; k<4; k++) {
+                maxUlpMatrix = max(maxUlpMatrix, computeUlpDistance(scalarMatrices[i].m[j][k],
+                                                                    simdMatrices[i].m[j][k]));
+            }
+        }
+        maxUlpVector = max(maxUlpVector, computeUlpDistance(scalarVectors[i].x, simdVectors[i].x));
+        maxUlpVector = max(maxUlpVector, computeUlpDistance(scalarVectors[i].y, simdVectors[i].y));
+        maxUlpVector = max(maxUlpVector, computeUlpDistance(scalarVectors[i].z, simdVectors[i].z));
+        maxUlpVector = max(maxUlpVector, computeUlpDistance(scalarVectors[i].w, simdVectors[i].w));
+    }
+
+    const double nbProducts = double(NB_MATRICES) * NB_REPETITIONS;
+    cout << "Matrix * Matrix (scalar) : " << times[0] / nbProducts * 1e9 << " ns" << endl;
+    cout << "Matrix * Matrix (SIMD)   : " << times[1] / nbProducts * 1e9 << " ns (speedup "
+         << times[0] / times[1] << "x, max error " << maxUlpMatrix << " ulp)" << endl;
+    cout << "Matrix * Vector (scalar) : " << times[2] / nbProducts * 1e9 << " ns" << endl;
+    cout << "Matrix * Vector (SIMD)   : " << times[3] / nbProducts * 1e9 << " ns (speedup "
+         << times[2] / times[3] << "x, max error " << maxUlpVector << " ulp)" << endl;
+
+    // Batch transform of points with a projective and an affine matrix
+    vector<Vector3> points(NB_POINTS), loopPoints(NB_POINTS), batchPoints(NB_POINTS);
+    vector<float> x(NB_POINTS), y(NB_POINTS), z(NB_POINTS);
+    vector<float> resultsX(NB_POINTS), resultsY(NB_POINTS), resultsZ(NB_POINTS);
+    for (uint i=0; i<NB_POINTS; i++) {
+        points[i] = Vector3(getRandomNumber(), getRandomNumber(), getRandomNumber());
+        x[i] = points[i].x;
+        y[i] = points[i].y;
+        z[i] = points[i].z;
+    }
+    Matrix4 projectiveMatrix = Matrix4(1.0f, 0.2f, 0.3f, 0.1f,  0.5f, 1.0f, 0.2f, 0.3f,
+                                       0.1f, 0.4f, 1.0f, 0.2f,  0.1f, 0.2f, 0.05f, 3.0f);
+    Matrix4 affineMatrix = Matrix4::translationMatrix(Vector3(1, 2, 3)) *
+                           Matrix4::rotationMatrix(Vector3(0, 0.6f, 0.8f), 0.7f);
+    const Matrix4* batchMatrices[2] = {&projectiveMatrix, &affineMatrix};
+    const char* batchNames[2] = {"projective", "affine"};
+
+    for (int m=0; m<2; m++) {
+        const Matrix4& matrix = *batchMatrices[m];
+        double batchTimes[3] = {0.0, 0.0, 0.0};
+        for (int r=0; r<NB_BATCH_REPETITIONS; r++) {
+            chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+            for (uint i=0; i<NB_POINTS; i++) {
+                loopPoints[i] = matrix * points[i];
+            }
+            batchTimes[0] += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+
+            start = chrono::high_resolution_clock::now();
+            BatchTransform::transformPoints(matrix, &points[0], &batchPoints[0], NB_POINTS);
+            batchTimes[1] += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+
+            start = chrono::high_resolution_clock::now();
+            BatchTransform::transformPoints(matrix, &x[0], &y[0], &z[0], &resultsX[0],
+                                            &resultsY[0], &resultsZ[0], NB_POINTS);
+            batchTimes[2] += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        }
+
+        int64_t maxUlpBatch = 0;
+        for (uint i=0; i<NB_POINTS; i++) {
+            maxUlpBatch = max(maxUlpBatch, computeUlpDistance(loopPoints[i].x, batchPoints[i].x));
+            maxUlpBatch = max(maxUlpBatch, computeUlpDistance(loopPoints[i].y, batchPoints[i].y));
+            maxUlpBatch = max(maxUlpBatch, computeUlpDistance(loopPoints[i].z, batchPoints[i].z));
+            maxUlpBatch = max(maxUlpBatch, computeUlpDistance(loopPoints[i].x, resultsX[i]));
+            maxUlpBatch = max(maxUlpBatch, computeUlpDistance(loopPoints[i].y, resultsY[i]));
+            maxUlpBatch = max(maxUlpBatch, computeUlpDistance(loopPoints[i].z, resultsZ[i]));
+        }
+
+        const double nbTransforms = double(NB_POINTS) * NB_BATCH_REPETITIONS;
+        cout << "Batch " << batchNames[m] << " points (loop) : "
+             << batchTimes[0] / nbTransforms * 1e9 << " ns/point" << endl;
+        cout << "Batch " << batchNames[m] << " points (AoS)  : "
+             << batchTimes[1] / nbTransforms * 1e9 << " ns/point (speedup "
+             << batchTimes[0] / batchTimes[1] << "x)" << endl;
+        cout << "Batch " << batchNames[m] << " points (SoA)  : "
+             << batchTimes[2] / nbTransforms * 1e9 << " ns/point (speedup "
+             << batchTimes[0] / batchTimes[2] << "x, max error " << maxUlpBatch << " ulp)" << endl;
+    }
+
+    return 0;
+}
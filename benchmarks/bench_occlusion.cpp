@@ -0,0 +1,198 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include "openglframework.h"
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Number of objects tested against the occluders
+const uint NB_OBJECTS = 100000;
+
+// Number of walls used as occluders
+const uint NB_WALLS = 200;
+
+// Number of frames
+const int NB_FRAMES = 100;
+
+// Return a random number between 0 and 1
+float getRandomNumber() {
+    return rand() / float(RAND_MAX);
+}
+
+// Return true if a world-space box is not hidden in a depth buffer by testing every
+// pixel of its screen-space rectangle (reference for the hierarchical test)
+bool isVisibleBruteForce(const OcclusionCuller& occlusionCuller,
+                         const Matrix4& viewProjectionMatrix, const AABB& aabb) {
+
+    const int width = int(occlusionCuller.getWidth());
+    const int height = int(occlusionCuller.getHeight());
+    const vector<float>& depthBuffer = occlusionCuller.getDepthBuffer();
+    const float (*m)[4] = viewProjectionMatrix.m;
+
+    // Project the corners of the box
+    float minX = numeric_limits<float>::max(), maxX = -numeric_limits<float>::max();
+    float minY = numeric_limits<float>::max(), maxY = -numeric_limits<float>::max();
+    float minDepth = numeric_limits<float>::max();
+    for (int i=0; i<8; i++) {
+        Vector3 p((i & 1) ? aabb.max.x : aabb.min.x, (i & 2) ? aabb.max.y : aabb.min.y,
+                  (i & 4) ? aabb.max.z : aabb.min.z);
+        float x = m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3];
+        float y = m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3];
+        float z = m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3];
+        float w = m[3][0] * p.x + m[3][1] * p.y + m[3][2] * p.z + m[3][3];
+        if (w < 1e-5f || z < -w) return true;
+        float invW = 1.0f / w;
+        float screenX = (x * invW * 0.5f + 0.5f) * width;
+        float screenY = (y * invW * 0.5f + 0.5f) * height;
+        minX = min(minX, screenX); maxX = max(maxX, screenX);
+        minY = min(minY, screenY); maxY = max(maxY, screenY);
+        minDepth = min(minDepth, z * invW * 0.5f + 0.5f);
+    }
+    if (maxX < 0.0f || maxY < 0.0f || minX >= width || minY >= height || minDepth > 1.0f) {
+        return false;
+    }
+
+    // Test every pixel covered by the box
+    for (int y=max(int(floor(minY)), 0); y<=min(int(floor(maxY)), height - 1); y++) {
+        for (int x=max(int(floor(minX)), 0); x<=min(int(floor(maxX)), width - 1); x++) {
+            if (depthBuffer[y * width + x] >= minDepth) return true;
+        }
+    }
+
+    return false;
+}
+
+// Main function
+int main(int argc, char** argv) {
+
+    srand(0);
+
+    // Create the walls (two triangles each) of an interior scene
+    vector<Vector3> wallVertices;
+    vector<uint> wallIndices;
+    for (uint i=0; i<NB_WALLS; i++) {
+        Vector3 center(getRandomNumber() * 200.0f - 100.0f, 0.0f,
+                       getRandomNumber() * 200.0f - 100.0f);
+        bool isAlongX = (i % 2 == 0);
+        Vector3 halfLength = isAlongX ? Vector3(10.0f, 0.0f, 0.0f) : Vector3(0.0f, 0.0f, 10.0f);
+        uint first = wallVertices.size();
+        wallVertices.push_back(center - halfLength + Vector3(0, -5, 0));
+        wallVertices.push_back(center + halfLength + Vector3(0, -5, 0));
+        wallVertices.push_back(center + halfLength + Vector3(0, 5, 0));
+        wallVertices.push_back(center - halfLength + Vector3(0, 5, 0));
+        uint indices[6] = {first, first + 1, first + 2, first, first + 2, first + 3};
+        wallIndices.insert(wallIndices.end(), indices, indices + 6);
+    }
+    Matrix4 identity;
+    identity.setToIdentity();
+
+    // Create the objects
+    AABBBatch aabbs;
+    for (uint i=0; i<NB_OBJECTS; i++) {
+        Vector3 center(getRandomNumber() * 200.0f - 100.0f, getRandomNumber() * 8.0f - 4.0f,
+                       getRandomNumber() * 200.0f - 100.0f);
+        aabbs.add(AABB(center - Vector3(0.5f, 0.5f, 0.5f), center + Vector3(0.5f, 0.5f, 0.5f)));
+    }
+
+    Camera camera;
+    camera.setDimensions(1280, 720);
+    camera.setSceneRadius(20.0f);
+
+    OcclusionCuller occlusionCuller(320, 176);
+    vector<uint> frustumVisibleIndices;
+    vector<uint> visibleIndices;
+    AABBBatch frustumVisibleAABBs;
+    double rasterizationTime = 0.0, cullingTime = 0.0;
+    uint nbFrustumVisible = 0, nbVisible = 0;
+    uint nbWronglyHidden = 0, nbWronglyVisible = 0;
+
+    for (int frame=0; frame<NB_FRAMES; frame++) {
+
+        camera.rotateLocal(Vector3(0, 1, 0), 2.0f * PI / NB_FRAMES);
+
+        // Frustum culling
+        FrustumCulling::cullAABBs(camera.getWorldFrustum(), aabbs, frustumVisibleIndices);
+        frustumVisibleAABBs.clear();
+        for (uint i=0; i<frustumVisibleIndices.size(); i++) {
+            uint j = frustumVisibleIndices[i];
+            frustumVisibleAABBs.add(AABB(Vector3(aabbs.minX[j], aabbs.minY[j], aabbs.minZ[j]),
+                                         Vector3(aabbs.maxX[j], aabbs.maxY[j], aabbs.maxZ[j])));
+        }
+
+        // Rasterize the occluders
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        occlusionCuller.beginFrame(camera);
+        occlusionCuller.addOccluder(wallVertices, wallIndices, identity);
+        occlusionCuller.rasterizeOccluders();
+        rasterizationTime += chrono::duration<double>(chrono::high_resolution_clock::now() -
+                                                      start).count();
+
+        // Occlusion culling
+        start = chrono::high_resolution_clock::now();
+        occlusionCuller.cullAABBs(frustumVisibleAABBs, visibleIndices);
+        cullingTime += chrono::duration<double>(chrono::high_resolution_clock::now() -
+                                                start).count();
+
+        nbFrustumVisible += frustumVisibleIndices.size();
+        nbVisible += visibleIndices.size();
+
+        // Compare with the per-pixel reference
+        vector<char> isVisibleAABB(frustumVisibleAABBs.size(), 0);
+        for (uint i=0; i<visibleIndices.size(); i++) {
+            isVisibleAABB[visibleIndices[i]] = 1;
+        }
+        for (uint i=0; i<frustumVisibleAABBs.size(); i++) {
+            AABB aabb(Vector3(frustumVisibleAABBs.minX[i], frustumVisibleAABBs.minY[i],
+                              frustumVisibleAABBs.minZ[i]),
+                      Vector3(frustumVisibleAABBs.maxX[i], frustumVisibleAABBs.maxY[i],
+                              frustumVisibleAABBs.maxZ[i]));
+            bool isVisibleReference = isVisibleBruteForce(occlusionCuller,
+                                                          camera.getViewProjectionMatrix(), aabb);
+            if (isVisibleReference && !isVisibleAABB[i]) nbWronglyHidden++;
+            if (!isVisibleReference && isVisibleAABB[i]) nbWronglyVisible++;
+        }
+    }
+
+    cout << "Objects                : " << NB_OBJECTS << endl;
+    cout << "Inside the frustum     : " << nbFrustumVisible / NB_FRAMES << endl;
+    cout << "Not occluded           : " << nbVisible / NB_FRAMES << endl;
+    cout << "Occluder rasterization : " << rasterizationTime / NB_FRAMES * 1000.0 << " ms/frame" << endl;
+    cout << "Occlusion tests        : " << cullingTime / NB_FRAMES * 1000.0 << " ms/frame" << endl;
+    cout << "Hierarchical levels    : " << occlusionCuller.getNbDepthLevels() << endl;
+    cout << "Wrongly hidden         : " << nbWronglyHidden << endl;
+    cout << "Wrongly visible        : " << nbWronglyVisible << endl;
+
+    return (nbWronglyHidden == 0 && nbWronglyVisible == 0) ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include "openglframework.h"
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Main function
+int main(int argc, char** argv) {
+
+    // Dimensions of the rendered picture
+    uint width = (argc > 1) ? uint(atoi(argv[1])) : 1024;
+    uint height = (argc > 2) ? uint(atoi(argv[2])) : 768;
+
+    // Number of Loop subdivision levels applied to the torus
+    uint nbLevels = (argc > 3) ? uint(atoi(argv[3])) : 0;
+
+    // Create the scene of the demo
+    Mesh controlMesh;
+    MeshReaderWriter::loadMeshFromFile("torus.obj", controlMesh);
+    Mesh mesh;
+    LoopSubdivision subdivision;
+    subdivision.subdivide(controlMesh, mesh, nbLevels);
+    mesh.calculateNormals();
+
+    Light light(0);
+    light.translateWorld(Vector3(15, 15, 15));
+
+    // Place the camera as the viewer of the demo does
+    BoundingSphere boundingSphere = mesh.getWorldBoundingSphere();
+    Camera camera;
+    camera.setDimensions(width, height);
+    camera.setSceneRadius(boundingSphere.radius);
+    camera.translateWorld(boundingSphere.center);
+    camera.setZoom(1.0f);
+
+    // Render the scene
+    RayTracer rayTracer;
+    rayTracer.addMesh(&mesh);
+    rayTracer.setLight(light);
+    rayTracer.setAmbientColor(Color(0.3f, 0.3f, 0.3f, 1.0f));
+    rayTracer.setShininess(60.0f);
+
+    vector<unsigned char> pixels;
+    rayTracer.render(camera, pixels);   // Warm up
+    rayTracer.render(camera, pixels);
+
+    cout << "Triangles  : " << mesh.getNbFaces() << endl;
+    cout << "Resolution : " << width << "x" << height << endl;
+    cout << "Time       : " << rayTracer.getLastRenderingTime() * 1000.0 << " ms" << endl;
+    cout << "Throughput : " << rayTracer.getLastMraysPerSecond() << " Mrays/s" << endl;
+
+    // Write the pictures (the rows of the rendering start at the bottom as in a TGA
+    // file, so they are flipped for the JPEG file that starts at the top)
+    TextureReaderWriter::writePixelsToFile("raytracer.tga", width, height, &pixels[0]);
+    TextureReaderWriter::writePixelsToFile("raytracer.jpg", width, height, &pixels[0], true);
+
+    return 0;
+}
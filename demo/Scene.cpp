@@ -43,16 +43,11 @@ Scene::Scene(GlutViewer* viewer) : mViewer(viewer), mLight0(0),
     // Calculate the normals of the mesh
     mMesh.calculateNormals();
 
-    // Calculate the bounding box of the mesh
-    Vector3 min, max;
-    mMesh.calculateBoundingBox(min, max);
-
-    // Compute the radius and the center of the scene
-    float radius = 0.5f * (min - max).length();
-    Vector3 center = 0.5f * (min + max);
+    // Get the world-space bounding sphere of the mesh (cached by the mesh)
+    BoundingSphere boundingSphere = mMesh.getWorldBoundingSphere();
 
     // Set the center of the scene
-    mViewer->setScenePosition(center, radius);
+    mViewer->setScenePosition(boundingSphere.center, boundingSphere.radius);
 }
 
 // Destructor
@@ -87,7 +82,7 @@ void Scene::renderMesh() {
     matrixIdentity.setToIdentity();
     mPhongShader.setVector3Uniform("cameraWorldPosition", mViewer->getCamera().getOrigin());
     mPhongShader.setMatrix4x4Uniform("modelToWorldMatrix", mMesh.getTransformMatrix());
-    mPhongShader.setMatrix4x4Uniform("worldToCameraMatrix", camera.getTransformMatrix().getInverse());
+    mPhongShader.setMatrix4x4Uniform("worldToCameraMatrix", camera.getInverseTransformMatrix());
     mPhongShader.setMatrix4x4Uniform("projectionMatrix", camera.getProjectionMatrix());
     mPhongShader.setVector3Uniform("lightWorldPosition", mLight0.getOrigin());
     mPhongShader.setVector3Uniform("lightAmbientColor", Vector3(0.3f, 0.3f, 0.3f));
@@ -0,0 +1,427 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "BatchTransform.h"
+#include <algorithm>
+#if defined(__AVX__)
+#include <immintrin.h>
+#define BATCH_TRANSFORM_USE_AVX
+#define BATCH_TRANSFORM_USE_SSE
+#elif defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define BATCH_TRANSFORM_USE_SSE
+#endif
+
+// Namespaces
+using namespace openglframework;
+
+// Number of elements of the blocks that are distributed to the threads
+static const int BLOCK_SIZE = 1024;
+
+// Minimum number of elements to process the blocks in parallel
+static const int PARALLEL_TRANSFORM_THRESHOLD = 32768;
+
+// Type of the transformed elements
+enum TransformType {TRANSFORM_PROJECTIVE_POINT, TRANSFORM_AFFINE_POINT, TRANSFORM_DIRECTION};
+
+#if defined(BATCH_TRANSFORM_USE_SSE)
+// SSE operations used by the transform kernels. The AoS points are loaded
+// four at a time into three registers.
+struct SimdSSE {
+    typedef __m128 Register;
+    static const int WIDTH = 4;
+    static Register set1(float f) { return _mm_set1_ps(f); }
+    static Register load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, Register r) { _mm_storeu_ps(p, r); }
+    static Register add(Register a, Register b) { return _mm_add_ps(a, b); }
+    static Register mul(Register a, Register b) { return _mm_mul_ps(a, b); }
+    static Register div(Register a, Register b) { return _mm_div_ps(a, b); }
+    template<int imm> static Register shuffle(Register a, Register b) {
+        return _mm_shuffle_ps(a, b, imm);
+    }
+    static void loadPoints(const float* p, Register& a, Register& b, Register& c) {
+        a = _mm_loadu_ps(p);
+        b = _mm_loadu_ps(p + 4);
+        c = _mm_loadu_ps(p + 8);
+    }
+    static void storePoints(float* p, Register a, Register b, Register c) {
+        _mm_storeu_ps(p, a);
+        _mm_storeu_ps(p + 4, b);
+        _mm_storeu_ps(p + 8, c);
+    }
+};
+#endif
+
+#if defined(BATCH_TRANSFORM_USE_AVX)
+// AVX operations used by the transform kernels. The AoS points are loaded
+// eight at a time (four points in each 128-bit lane).
+struct SimdAVX {
+    typedef __m256 Register;
+    static const int WIDTH = 8;
+    static Register set1(float f) { return _mm256_set1_ps(f); }
+    static Register load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, Register r) { _mm256_storeu_ps(p, r); }
+    static Register add(Register a, Register b) { return _mm256_add_ps(a, b); }
+    static Register mul(Register a, Register b) { return _mm256_mul_ps(a, b); }
+    static Register div(Register a, Register b) { return _mm256_div_ps(a, b); }
+    template<int imm> static Register shuffle(Register a, Register b) {
+        return _mm256_shuffle_ps(a, b, imm);
+    }
+    static Register loadLanes(const float* p) {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)),
+                                    _mm_loadu_ps(p + 12), 1);
+    }
+    static void storeLanes(float* p, Register r) {
+        _mm_storeu_ps(p, _mm256_castps256_ps128(r));
+        _mm_storeu_ps(p + 12, _mm256_extractf128_ps(r, 1));
+    }
+    static void loadPoints(const float* p, Register& a, Register& b, Register& c) {
+        a = loadLanes(p);
+        b = loadLanes(p + 4);
+        c = loadLanes(p + 8);
+    }
+    static void storePoints(float* p, Register a, Register b, Register c) {
+        storeLanes(p, a);
+        storeLanes(p + 4, b);
+        storeLanes(p + 8, c);
+    }
+};
+#endif
+
+#if defined(BATCH_TRANSFORM_USE_SSE)
+
+// Class TransformKernel
+// Transform the points or directions stored in SIMD registers (one register per
+// coordinate). The terms are accumulated in the same order as in the Matrix4 operators.
+template<typename Simd, TransformType type>
+class TransformKernel {
+
+    private:
+
+        typedef typename Simd::Register Register;
+
+        // Elements of the matrix
+        Register m00, m01, m02, m03, m10, m11, m12, m13, m20, m21, m22, m23;
+        Register m30, m31, m32, m33;
+
+    public:
+
+        // Constructor
+        TransformKernel(const Matrix4& m) {
+            m00 = Simd::set1(m.m[0][0]); m01 = Simd::set1(m.m[0][1]);
+            m02 = Simd::set1(m.m[0][2]); m03 = Simd::set1(m.m[0][3]);
+            m10 = Simd::set1(m.m[1][0]); m11 = Simd::set1(m.m[1][1]);
+            m12 = Simd::set1(m.m[1][2]); m13 = Simd::set1(m.m[1][3]);
+            m20 = Simd::set1(m.m[2][0]); m21 = Simd::set1(m.m[2][1]);
+            m22 = Simd::set1(m.m[2][2]); m23 = Simd::set1(m.m[2][3]);
+            m30 = Simd::set1(m.m[3][0]); m31 = Simd::set1(m.m[3][1]);
+            m32 = Simd::set1(m.m[3][2]); m33 = Simd::set1(m.m[3][3]);
+        }
+
+        // Transform the coordinates
+        void transform(Register x, Register y, Register z,
+                       Register& rx, Register& ry, Register& rz) const {
+            rx = Simd::add(Simd::add(Simd::mul(m00, x), Simd::mul(m01, y)), Simd::mul(m02, z));
+            ry = Simd::add(Simd::add(Simd::mul(m10, x), Simd::mul(m11, y)), Simd::mul(m12, z));
+            rz = Simd::add(Simd::add(Simd::mul(m20, x), Simd::mul(m21, y)), Simd::mul(m22, z));
+            if (type != TRANSFORM_DIRECTION) {
+                rx = Simd::add(rx, m03);
+                ry = Simd::add(ry, m13);
+                rz = Simd::add(rz, m23);
+            }
+            if (type == TRANSFORM_PROJECTIVE_POINT) {
+                Register w = Simd::add(Simd::add(Simd::add(Simd::mul(m30, x), Simd::mul(m31, y)),
+                                                 Simd::mul(m32, z)), m33);
+                Register inverseW = Simd::div(Simd::set1(1.f), w);
+                rx = Simd::mul(rx, inverseW);
+                ry = Simd::mul(ry, inverseW);
+                rz = Simd::mul(rz, inverseW);
+            }
+        }
+};
+
+// Transform the SoA elements [begin, end) with SIMD registers and return the
+// index of the first element that has not been transformed
+template<typename Simd, TransformType type>
+static int transformSoASimd(const Matrix4& matrix, const float* x, const float* y,
+                            const float* z, float* resultsX, float* resultsY,
+                            float* resultsZ, int begin, int end) {
+
+    typedef typename Simd::Register Register;
+    const TransformKernel<Simd, type> kernel(matrix);
+
+    int i = begin;
+    for (; i + Simd::WIDTH <= end; i += Simd::WIDTH) {
+        Register rx, ry, rz;
+        kernel.transform(Simd::load(x + i), Simd::load(y + i), Simd::load(z + i), rx, ry, rz);
+        Simd::store(resultsX + i, rx);
+        Simd::store(resultsY + i, ry);
+        Simd::store(resultsZ + i, rz);
+    }
+
+    return i;
+}
+
+// Transform the AoS elements [begin, end) with SIMD registers and return the
+// index of the first element that has not been transformed. Each group of four
+// points (x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3) is shuffled into one register
+// per coordinate and back.
+template<typename Simd, TransformType type>
+static int transformAoSSimd(const Matrix4& matrix, const Vector3* elements,
+                            Vector3* results, int begin, int end) {
+
+    typedef typename Simd::Register Register;
+    const TransformKernel<Simd, type> kernel(matrix);
+
+    int i = begin;
+    for (; i + Simd::WIDTH <= end; i += Simd::WIDTH) {
+        Register a, b, c;
+        Simd::loadPoints(&elements[i].x, a, b, c);
+
+        Register x = Simd::template shuffle<_MM_SHUFFLE(2, 0, 3, 0)>(
+                         a, Simd::template shuffle<_MM_SHUFFLE(1, 1, 2, 2)>(b, c));
+        Register y = Simd::template shuffle<_MM_SHUFFLE(2, 0, 2, 0)>(
+                         Simd::template shuffle<_MM_SHUFFLE(0, 0, 1, 1)>(a, b),
+                         Simd::template shuffle<_MM_SHUFFLE(2, 2, 3, 3)>(b, c));
+        Register z = Simd::template shuffle<_MM_SHUFFLE(3, 0, 2, 0)>(
+                         Simd::template shuffle<_MM_SHUFFLE(1, 1, 2, 2)>(a, b), c);
+
+        Register rx, ry, rz;
+        kernel.transform(x, y, z, rx, ry, rz);
+
+        a = Simd::template shuffle<_MM_SHUFFLE(2, 0, 2, 0)>(
+                Simd::template shuffle<_MM_SHUFFLE(0, 0, 0, 0)>(rx, ry),
+                Simd::template shuffle<_MM_SHUFFLE(1, 1, 0, 0)>(rz, rx));
+        b = Simd::template shuffle<_MM_SHUFFLE(2, 0, 2, 0)>(
+                Simd::template shuffle<_MM_SHUFFLE(1, 1, 1, 1)>(ry, rz),
+                Simd::template shuffle<_MM_SHUFFLE(2, 2, 2, 2)>(rx, ry));
+        c = Simd::template shuffle<_MM_SHUFFLE(2, 0, 2, 0)>(
+                Simd::template shuffle<_MM_SHUFFLE(3, 3, 2, 2)>(rz, rx),
+                Simd::template shuffle<_MM_SHUFFLE(3, 3, 3, 3)>(ry, rz));
+        Simd::storePoints(&results[i].x, a, b, c);
+    }
+
+    return i;
+}
+
+#endif
+
+// Transform a single element
+template<TransformType type>
+static void transformScalar(const Matrix4& matrix, float x, float y, float z,
+                            float& rx, float& ry, float& rz) {
+    const float (*m)[4] = matrix.m;
+    rx = m[0][0]*x + m[0][1]*y + m[0][2]*z;
+    ry = m[1][0]*x + m[1][1]*y + m[1][2]*z;
+    rz = m[2][0]*x + m[2][1]*y + m[2][2]*z;
+    if (type != TRANSFORM_DIRECTION) {
+        rx += m[0][3];
+        ry += m[1][3];
+        rz += m[2][3];
+    }
+    if (type == TRANSFORM_PROJECTIVE_POINT) {
+        float inverseW = 1.f / (m[3][0]*x + m[3][1]*y + m[3][2]*z + m[3][3]);
+        rx *= inverseW;
+        ry *= inverseW;
+        rz *= inverseW;
+    }
+}
+
+// Transform the SoA elements [begin, end)
+template<TransformType type>
+static void transformSoA(const Matrix4& matrix, const float* x, const float* y,
+                         const float* z, float* resultsX, float* resultsY, float* resultsZ,
+                         int begin, int end) {
+
+    int i = begin;
+#if defined(BATCH_TRANSFORM_USE_AVX)
+    i = transformSoASimd<SimdAVX, type>(matrix, x, y, z, resultsX, resultsY, resultsZ, i, end);
+#endif
+#if defined(BATCH_TRANSFORM_USE_SSE)
+    i = transformSoASimd<SimdSSE, type>(matrix, x, y, z, resultsX, resultsY, resultsZ, i, end);
+#endif
+    for (; i < end; i++) {
+        transformScalar<type>(matrix, x[i], y[i], z[i], resultsX[i], resultsY[i], resultsZ[i]);
+    }
+}
+
+// Transform the AoS elements [begin, end)
+template<TransformType type>
+static void transformAoS(const Matrix4& matrix, const Vector3* elements, Vector3* results,
+                         int begin, int end) {
+
+    int i = begin;
+#if defined(BATCH_TRANSFORM_USE_AVX)
+    i = transformAoSSimd<SimdAVX, type>(matrix, elements, results, i, end);
+#endif
+#if defined(BATCH_TRANSFORM_USE_SSE)
+    i = transformAoSSimd<SimdSSE, type>(matrix, elements, results, i, end);
+#endif
+    for (; i < end; i++) {
+        float rx, ry, rz;
+        transformScalar<type>(matrix, elements[i].x, elements[i].y, elements[i].z, rx, ry, rz);
+        results[i] = Vector3(rx, ry, rz);
+    }
+}
+
+// Transform an array of SoA elements by blocks
+template<TransformType type>
+static void transformSoABlocks(const Matrix4& matrix, const float* x, const float* y,
+                               const float* z, float* resultsX, float* resultsY,
+                               float* resultsZ, int nbElements) {
+
+    const int nbBlocks = (nbElements + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    #pragma omp parallel for schedule(static) if(nbElements >= PARALLEL_TRANSFORM_THRESHOLD)
+    for (int b=0; b<nbBlocks; b++) {
+        int begin = b * BLOCK_SIZE;
+        int end = std::min(begin + BLOCK_SIZE, nbElements);
+        transformSoA<type>(matrix, x, y, z, resultsX, resultsY, resultsZ, begin, end);
+    }
+}
+
+// Transform an array of AoS elements by blocks
+template<TransformType type>
+static void transformAoSBlocks(const Matrix4& matrix, const Vector3* elements,
+                               Vector3* results, int nbElements) {
+
+    const int nbBlocks = (nbElements + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    #pragma omp parallel for schedule(static) if(nbElements >= PARALLEL_TRANSFORM_THRESHOLD)
+    for (int b=0; b<nbBlocks; b++) {
+        int begin = b * BLOCK_SIZE;
+        transformAoS<type>(matrix, elements, results, begin,
+                           std::min(begin + BLOCK_SIZE, nbElements));
+    }
+}
+
+// Transform the 4D vectors [begin, end) without the division by w
+static void transformVectorRange(const Matrix4& matrix, const Vector4* vectors,
+                                 Vector4* results, int begin, int end) {
+
+    int i = begin;
+
+#if defined(BATCH_TRANSFORM_USE_SSE)
+    // Columns of the matrix
+    __m128 c0 = _mm_loadu_ps(matrix.m[0]);
+    __m128 c1 = _mm_loadu_ps(matrix.m[1]);
+    __m128 c2 = _mm_loadu_ps(matrix.m[2]);
+    __m128 c3 = _mm_loadu_ps(matrix.m[3]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+#endif
+
+#if defined(BATCH_TRANSFORM_USE_AVX)
+    // Two vectors at a time
+    const __m256 c0x2 = _mm256_broadcast_ps(&c0);
+    const __m256 c1x2 = _mm256_broadcast_ps(&c1);
+    const __m256 c2x2 = _mm256_broadcast_ps(&c2);
+    const __m256 c3x2 = _mm256_broadcast_ps(&c3);
+    for (; i + 2 <= end; i += 2) {
+        __m256 v = _mm256_loadu_ps(&vectors[i].x);
+        __m256 r = _mm256_mul_ps(c0x2, _mm256_permute_ps(v, 0x00));
+        r = _mm256_add_ps(r, _mm256_mul_ps(c1x2, _mm256_permute_ps(v, 0x55)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(c2x2, _mm256_permute_ps(v, 0xAA)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(c3x2, _mm256_permute_ps(v, 0xFF)));
+        _mm256_storeu_ps(&results[i].x, r);
+    }
+#endif
+#if defined(BATCH_TRANSFORM_USE_SSE)
+    for (; i < end; i++) {
+        const Vector4& v = vectors[i];
+        __m128 r = _mm_mul_ps(c0, _mm_set1_ps(v.x));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(v.y)));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(v.z)));
+        r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_set1_ps(v.w)));
+        _mm_storeu_ps(&results[i].x, r);
+    }
+#else
+    for (; i < end; i++) {
+        results[i] = matrix.transform(vectors[i]);
+    }
+#endif
+}
+
+// Return true if the last row of the matrix is (0, 0, 0, 1)
+bool BatchTransform::isAffine(const Matrix4& matrix) {
+    return matrix.m[3][0] == 0.f && matrix.m[3][1] == 0.f && matrix.m[3][2] == 0.f &&
+           matrix.m[3][3] == 1.f;
+}
+
+// Transform an array of points (same as matrix * point)
+void BatchTransform::transformPoints(const Matrix4& matrix, const Vector3* points,
+                                     Vector3* results, uint nbPoints) {
+    if (isAffine(matrix)) {
+        transformAoSBlocks<TRANSFORM_AFFINE_POINT>(matrix, points, results, int(nbPoints));
+    }
+    else {
+        transformAoSBlocks<TRANSFORM_PROJECTIVE_POINT>(matrix, points, results, int(nbPoints));
+    }
+}
+
+// Transform an array of points stored as one array per coordinate
+void BatchTransform::transformPoints(const Matrix4& matrix,
+                                     const float* x, const float* y, const float* z,
+                                     float* resultsX, float* resultsY, float* resultsZ,
+                                     uint nbPoints) {
+    if (isAffine(matrix)) {
+        transformSoABlocks<TRANSFORM_AFFINE_POINT>(matrix, x, y, z, resultsX, resultsY,
+                                                   resultsZ, int(nbPoints));
+    }
+    else {
+        transformSoABlocks<TRANSFORM_PROJECTIVE_POINT>(matrix, x, y, z, resultsX, resultsY,
+                                                       resultsZ, int(nbPoints));
+    }
+}
+
+// Transform an array of directions with the upper-left 3x3 part of the matrix
+void BatchTransform::transformDirections(const Matrix4& matrix, const Vector3* directions,
+                                         Vector3* results, uint nbDirections) {
+    transformAoSBlocks<TRANSFORM_DIRECTION>(matrix, directions, results, int(nbDirections));
+}
+
+// Transform an array of directions stored as one array per coordinate
+void BatchTransform::transformDirections(const Matrix4& matrix,
+                                         const float* x, const float* y, const float* z,
+                                         float* resultsX, float* resultsY, float* resultsZ,
+                                         uint nbDirections) {
+    transformSoABlocks<TRANSFORM_DIRECTION>(matrix, x, y, z, resultsX, resultsY, resultsZ,
+                                            int(nbDirections));
+}
+
+// Transform an array of 4D vectors without the division by w
+// (same as matrix.transform(vector))
+void BatchTransform::transformVectors(const Matrix4& matrix, const Vector4* vectors,
+                                      Vector4* results, uint nbVectors) {
+
+    const int n = int(nbVectors);
+    const int nbBlocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    #pragma omp parallel for schedule(static) if(n >= PARALLEL_TRANSFORM_THRESHOLD)
+    for (int b=0; b<nbBlocks; b++) {
+        int begin = b * BLOCK_SIZE;
+        transformVectorRange(matrix, vectors, results, begin, std::min(begin + BLOCK_SIZE, n));
+    }
+}
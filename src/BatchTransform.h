@@ -0,0 +1,90 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef BATCH_TRANSFORM_H
+#define BATCH_TRANSFORM_H
+
+// Libraries
+#include "definitions.h"
+#include "maths/Vector3.h"
+#include "maths/Vector4.h"
+#include "maths/Matrix4.h"
+
+namespace openglframework {
+
+// Class BatchTransform
+// This class contains methods to transform arrays of points, directions and 4D vectors
+// by a single matrix. The arrays can be stored as arrays of structures (AoS) or as one
+// array per coordinate (SoA). The computations use SIMD instructions (SSE or AVX if
+// available) on blocks of points and the blocks are processed in parallel
+// for large arrays. If the last row of the matrix is (0, 0, 0, 1), the division by the
+// homogeneous coordinate is skipped. The terms are accumulated in the same order as in
+// the Matrix4 operators, so the results are the same unless the compiler contracts the
+// products into FMA instructions. The output arrays can be the same as the input arrays.
+class BatchTransform {
+
+    private:
+
+        // -------------------- Methods -------------------- //
+
+        // Private constructor (static class)
+        BatchTransform() {}
+
+    public:
+
+        // -------------------- Methods -------------------- //
+
+        // Return true if the last row of the matrix is (0, 0, 0, 1)
+        static bool isAffine(const Matrix4& matrix);
+
+        // Transform an array of points (same as matrix * point)
+        static void transformPoints(const Matrix4& matrix, const Vector3* points,
+                                    Vector3* results, uint nbPoints);
+
+        // Transform an array of points stored as one array per coordinate
+        static void transformPoints(const Matrix4& matrix,
+                                    const float* x, const float* y, const float* z,
+                                    float* resultsX, float* resultsY, float* resultsZ,
+                                    uint nbPoints);
+
+        // Transform an array of directions with the upper-left 3x3 part of the matrix
+        static void transformDirections(const Matrix4& matrix, const Vector3* directions,
+                                        Vector3* results, uint nbDirections);
+
+        // Transform an array of directions stored as one array per coordinate
+        static void transformDirections(const Matrix4& matrix,
+                                        const float* x, const float* y, const float* z,
+                                        float* resultsX, float* resultsY, float* resultsZ,
+                                        uint nbDirections);
+
+        // Transform an array of 4D vectors without the division by w
+        // (same as matrix.transform(vector))
+        static void transformVectors(const Matrix4& matrix, const Vector4* vectors,
+                                     Vector4* results, uint nbVectors);
+};
+
+}
+
+#endif
@@ -73,13 +73,19 @@ void Camera::updateProjectionMatrix() {
                                 0, fy, 0, 0,
                                 0, 0, fz, fw,
                                 0, 0, -1, 0);
+
+    // Recompute its inverse (in closed form)
+    mInverseProjectionMatrix = Matrix4(1.0f / fx, 0, 0, 0,
+                                       0, 1.0f / fy, 0, 0,
+                                       0, 0, 0, -1,
+                                       0, 0, 1.0f / fw, fz / fw);
 }
 
 // Translate the camera go a given point using the dx, dy fraction
 void Camera::translateCamera(float dx, float dy, const Vector3& worldPoint) {
 
     // Transform the world point into camera coordinates
-    Vector3 pointCamera = mTransformMatrix.getInverse() * worldPoint;
+    Vector3 pointCamera = getInverseTransformMatrix() * worldPoint;
 
     // Get the depth
     float z = -pointCamera.z;
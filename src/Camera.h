@@ -29,6 +29,7 @@
 // Libraries
 #include "Object3D.h"
 #include "definitions.h"
+#include "maths/Frustum.h"
 
 namespace openglframework {
 
@@ -60,6 +61,9 @@ class Camera : public Object3D {
         // Projection matrix
         Matrix4 mProjectionMatrix;
 
+        // Inverse of the projection matrix (updated with the projection matrix)
+        Matrix4 mInverseProjectionMatrix;
+
         // ------------------- Methods ------------------- //
 
         // Update the projection matrix
@@ -78,6 +82,21 @@ class Camera : public Object3D {
         // Get the projection matrix
         const Matrix4& getProjectionMatrix() const;
 
+        // Get the view matrix (world-space to camera-space)
+        const Matrix4& getViewMatrix() const;
+
+        // Get the view-projection matrix (world-space to clip-space)
+        Matrix4 getViewProjectionMatrix() const;
+
+        // Get the inverse of the projection matrix (clip-space to camera-space)
+        const Matrix4& getInverseProjectionMatrix() const;
+
+        // Get the inverse of the view-projection matrix (clip-space to world-space)
+        Matrix4 getInverseViewProjectionMatrix() const;
+
+        // Get the world-space view frustum
+        Frustum getWorldFrustum() const;
+
         // Set the dimensions of the camera
         void setDimensions(uint width, uint height);
 
@@ -118,6 +137,32 @@ inline const Matrix4& Camera::getProjectionMatrix() const {
     return mProjectionMatrix;
 }
 
+// Get the view matrix (world-space to camera-space)
+inline const Matrix4& Camera::getViewMatrix() const {
+    return getInverseTransformMatrix();
+}
+
+// Get the view-projection matrix (world-space to clip-space)
+inline Matrix4 Camera::getViewProjectionMatrix() const {
+    return mProjectionMatrix * getViewMatrix();
+}
+
+// Get the inverse of the projection matrix (clip-space to camera-space)
+inline const Matrix4& Camera::getInverseProjectionMatrix() const {
+    return mInverseProjectionMatrix;
+}
+
+// Get the inverse of the view-projection matrix (clip-space to world-space). The
+// inverse view matrix is the camera transform, so nothing is inverted here.
+inline Matrix4 Camera::getInverseViewProjectionMatrix() const {
+    return getTransformMatrix() * mInverseProjectionMatrix;
+}
+
+// Get the world-space view frustum
+inline Frustum Camera::getWorldFrustum() const {
+    return Frustum(getViewProjectionMatrix());
+}
+
 // Set the dimensions of the camera
 inline void Camera::setDimensions(uint width, uint height) {
     mWidth = width;
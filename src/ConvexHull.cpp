@@ -0,0 +1,722 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "ConvexHull.h"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+using namespace openglframework;
+using namespace std;
+
+// Minimum number of points to partition in parallel
+static const int PARALLEL_PARTITION_THRESHOLD = 8192;
+
+// Index of a missing face or point
+static const uint INVALID_INDEX = 0xffffffff;
+
+// Face of the hull during its construction
+struct HullFace {
+
+    // Vertices of the face (counter clockwise when seen from outside)
+    uint vertices[3];
+
+    // Neighbour face across each edge (the edge i goes from the vertex i to the vertex i+1)
+    uint neighbors[3];
+
+    // Plane of the face (the distance of a point is normal.point - offset)
+    double normal[3];
+    double offset;
+
+    // Points outside the face and the farthest one from its plane
+    vector<uint> outsidePoints;
+    uint farthestPoint;
+    double farthestDistance;
+
+    // True if the face is visible from the current eye point or has been removed
+    bool isVisible;
+
+    HullFace(uint v1, uint v2, uint v3, const vector<Vector3>& points)
+        : offset(0), farthestPoint(INVALID_INDEX), farthestDistance(0), isVisible(false) {
+        vertices[0] = v1; vertices[1] = v2; vertices[2] = v3;
+        neighbors[0] = neighbors[1] = neighbors[2] = INVALID_INDEX;
+        computePlane(points);
+    }
+
+    // Compute the plane of the face
+    void computePlane(const vector<Vector3>& points) {
+        const Vector3& a = points[vertices[0]];
+        const Vector3& b = points[vertices[1]];
+        const Vector3& c = points[vertices[2]];
+        double ab[3] = {double(b.x) - a.x, double(b.y) - a.y, double(b.z) - a.z};
+        double ac[3] = {double(c.x) - a.x, double(c.y) - a.y, double(c.z) - a.z};
+        normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+        normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+        normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+        double length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] +
+                             normal[2] * normal[2]);
+        if (length > 0.0) {
+            normal[0] /= length; normal[1] /= length; normal[2] /= length;
+        }
+        offset = normal[0] * a.x + normal[1] * a.y + normal[2] * a.z;
+    }
+
+    // Return the signed distance between a point and the plane of the face
+    double computeDistance(const Vector3& point) const {
+        return normal[0] * point.x + normal[1] * point.y + normal[2] * point.z - offset;
+    }
+
+    // Add a point outside the face
+    void addOutsidePoint(uint point, double distance) {
+        outsidePoints.push_back(point);
+        if (distance > farthestDistance) {
+            farthestDistance = distance;
+            farthestPoint = point;
+        }
+    }
+};
+
+// Horizon edge of the visible faces
+struct HorizonEdge {
+
+    // Vertices of the edge (in the order of the visible face)
+    uint vertex1, vertex2;
+
+    // Face of the hull across the edge (not visible)
+    uint face;
+
+    HorizonEdge(uint vertex1, uint vertex2, uint face)
+        : vertex1(vertex1), vertex2(vertex2), face(face) {}
+};
+
+// Distance between a point and a line
+struct LineDistance {
+
+    Vector3 origin, direction;
+
+    LineDistance(const Vector3& point1, const Vector3& point2)
+        : origin(point1), direction(point2 - point1) {
+        direction.normalize();
+    }
+
+    double operator()(const Vector3& point) const {
+        return (point - origin).cross(direction).length();
+    }
+};
+
+// Absolute distance between a point and a plane
+struct PlaneDistance {
+
+    Vector3 origin, normal;
+
+    PlaneDistance(const Vector3& point1, const Vector3& point2, const Vector3& point3)
+        : origin(point1), normal((point2 - point1).cross(point3 - point1)) {
+        normal.normalize();
+    }
+
+    double operator()(const Vector3& point) const {
+        return fabs(normal.dot(point - origin));
+    }
+};
+
+// Return the point the farthest from a line or a plane (in parallel)
+template<typename Distance>
+static uint findFarthestPoint(const vector<Vector3>& points, const Distance& distance,
+                              double& maxDistance) {
+
+    const int nbPoints = int(points.size());
+    uint farthestPoint = 0;
+    maxDistance = -1.0;
+
+    #pragma omp parallel
+    {
+        uint localFarthestPoint = 0;
+        double localMaxDistance = -1.0;
+
+        #pragma omp for nowait
+        for (int i=0; i<nbPoints; i++) {
+            double d = distance(points[i]);
+            if (d > localMaxDistance) {
+                localMaxDistance = d;
+                localFarthestPoint = i;
+            }
+        }
+
+        #pragma omp critical
+        {
+            if (localMaxDistance > maxDistance) {
+                maxDistance = localMaxDistance;
+                farthestPoint = localFarthestPoint;
+            }
+        }
+    }
+
+    return farthestPoint;
+}
+
+// Find the points with the minimum and maximum coordinates along each axis (in parallel)
+// and the maximum absolute value of the coordinates
+static void findExtremePoints(const vector<Vector3>& points, uint extremePoints[6],
+                              Vector3& maxAbsoluteCoordinates) {
+
+    const int nbPoints = int(points.size());
+    for (int i=0; i<6; i++) extremePoints[i] = 0;
+    maxAbsoluteCoordinates = Vector3(0, 0, 0);
+
+    #pragma omp parallel
+    {
+        uint localExtremePoints[6] = {0, 0, 0, 0, 0, 0};
+        Vector3 localMaxAbsoluteCoordinates(0, 0, 0);
+
+        #pragma omp for nowait
+        for (int i=0; i<nbPoints; i++) {
+            const Vector3& point = points[i];
+            for (int axis=0; axis<3; axis++) {
+                if (point[axis] < points[localExtremePoints[2 * axis]][axis]) {
+                    localExtremePoints[2 * axis] = i;
+                }
+                if (point[axis] > points[localExtremePoints[2 * axis + 1]][axis]) {
+                    localExtremePoints[2 * axis + 1] = i;
+                }
+                localMaxAbsoluteCoordinates[axis] = std::max(localMaxAbsoluteCoordinates[axis],
+                                                             fabs(point[axis]));
+            }
+        }
+
+        #pragma omp critical
+        {
+            for (int axis=0; axis<3; axis++) {
+                if (points[localExtremePoints[2 * axis]][axis] <
+                    points[extremePoints[2 * axis]][axis]) {
+                    extremePoints[2 * axis] = localExtremePoints[2 * axis];
+                }
+                if (points[localExtremePoints[2 * axis + 1]][axis] >
+                    points[extremePoints[2 * axis + 1]][axis]) {
+                    extremePoints[2 * axis + 1] = localExtremePoints[2 * axis + 1];
+                }
+                maxAbsoluteCoordinates[axis] = std::max(maxAbsoluteCoordinates[axis],
+                                                        localMaxAbsoluteCoordinates[axis]);
+            }
+        }
+    }
+}
+
+// Assign each point to the new face that it is the farthest outside of (in parallel if
+// there are many points). The points that are not outside any face are discarded.
+static void partitionPoints(const vector<uint>& candidatePoints, const vector<Vector3>& points,
+                            const vector<uint>& newFaces, vector<HullFace>& faces,
+                            double epsilon) {
+
+    const int nbCandidatePoints = int(candidatePoints.size());
+    vector<uint> assignedFaces(nbCandidatePoints);
+    vector<double> distances(nbCandidatePoints);
+
+    #pragma omp parallel for if(nbCandidatePoints >= PARALLEL_PARTITION_THRESHOLD)
+    for (int i=0; i<nbCandidatePoints; i++) {
+        const Vector3& point = points[candidatePoints[i]];
+        uint bestFace = INVALID_INDEX;
+        double maxDistance = epsilon;
+        for (uint f=0; f<newFaces.size(); f++) {
+            double distance = faces[newFaces[f]].computeDistance(point);
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                bestFace = newFaces[f];
+            }
+        }
+        assignedFaces[i] = bestFace;
+        distances[i] = maxDistance;
+    }
+
+    for (int i=0; i<nbCandidatePoints; i++) {
+        if (assignedFaces[i] != INVALID_INDEX) {
+            faces[assignedFaces[i]].addOutsidePoint(candidatePoints[i], distances[i]);
+        }
+    }
+}
+
+// Return the edge of a face whose neighbour is another face
+static int findEdgeToNeighbor(const HullFace& face, uint neighbor) {
+    for (int i=0; i<3; i++) {
+        if (face.neighbors[i] == neighbor) return i;
+    }
+    assert(false);
+    return 0;
+}
+
+// Find the faces visible from an eye point (starting from a visible face) and the
+// horizon edges around them in counter clockwise order. The faces are visited in
+// depth-first order and the edges of each face are visited starting after the edge
+// shared with its parent so that consecutive horizon edges are connected. The
+// visibility does not use the tolerance: a face is visible only if the eye point is
+// above it. Keeping a face that the eye point is slightly above would fold it against
+// the new face of its horizon edge, and removing a face that the eye point is slightly
+// below would move the horizon off the silhouette of the hull (folding the new faces).
+static void computeHorizon(const Vector3& eye, uint startFace, vector<HullFace>& faces,
+                           vector<uint>& visibleFaces,
+                           vector<HorizonEdge>& horizon) {
+
+    visibleFaces.clear();
+    horizon.clear();
+
+    // Each element of the stack is a face, its first edge and the number of visited edges
+    vector<uint> stackFaces, stackFirstEdges, stackNbVisitedEdges;
+    faces[startFace].isVisible = true;
+    visibleFaces.push_back(startFace);
+    stackFaces.push_back(startFace);
+    stackFirstEdges.push_back(0);
+    stackNbVisitedEdges.push_back(0);
+
+    while (!stackFaces.empty()) {
+
+        uint top = stackFaces.size() - 1;
+        if (stackNbVisitedEdges[top] == 3) {
+            stackFaces.pop_back();
+            stackFirstEdges.pop_back();
+            stackNbVisitedEdges.pop_back();
+            continue;
+        }
+
+        uint faceIndex = stackFaces[top];
+        uint edge = (stackFirstEdges[top] + stackNbVisitedEdges[top]) % 3;
+        stackNbVisitedEdges[top]++;
+
+        const HullFace& face = faces[faceIndex];
+        uint neighbor = face.neighbors[edge];
+        if (faces[neighbor].isVisible) continue;
+
+        if (faces[neighbor].computeDistance(eye) > 0.0) {
+
+            // Visit the neighbour starting after its edge shared with the current face
+            faces[neighbor].isVisible = true;
+            visibleFaces.push_back(neighbor);
+            stackFaces.push_back(neighbor);
+            stackFirstEdges.push_back((findEdgeToNeighbor(faces[neighbor], faceIndex) + 1) % 3);
+            stackNbVisitedEdges.push_back(0);
+        }
+        else {
+            horizon.push_back(HorizonEdge(face.vertices[edge], face.vertices[(edge + 1) % 3],
+                                          neighbor));
+        }
+    }
+}
+
+#ifndef NDEBUG
+
+// Return true if the faces of the hull are convex up to the tolerance (no vertex of a
+// neighbour of a face is above it). Since the hull is closed, it is then convex and
+// contains all the points that have been discarded as being inside it.
+static bool isConvex(const vector<HullFace>& faces, const vector<Vector3>& points,
+                     double epsilon) {
+    for (uint f=0; f<faces.size(); f++) {
+        if (faces[f].isVisible) continue;
+        for (uint e=0; e<3; e++) {
+            const HullFace& neighbor = faces[faces[f].neighbors[e]];
+            for (uint i=0; i<3; i++) {
+                if (faces[f].computeDistance(points[neighbor.vertices[i]]) > epsilon) return false;
+            }
+        }
+    }
+    return true;
+}
+
+#endif
+
+// Lexicographic comparison of the projections of the points on a plane
+struct LexicographicComparison {
+
+    const vector<double>& x;
+    const vector<double>& y;
+
+    LexicographicComparison(const vector<double>& x, const vector<double>& y) : x(x), y(y) {}
+
+    bool operator()(uint i, uint j) const {
+        return x[i] < x[j] || (x[i] == x[j] && y[i] < y[j]);
+    }
+};
+
+// Return true if the path a-b-c turns left (by more than the tolerance) on the plane
+static bool isLeftTurn(uint a, uint b, uint c, const vector<double>& x,
+                       const vector<double>& y, double epsilon) {
+    double cross = (x[b] - x[a]) * (y[c] - y[a]) - (y[b] - y[a]) * (x[c] - x[a]);
+    double length = sqrt((x[c] - x[a]) * (x[c] - x[a]) + (y[c] - y[a]) * (y[c] - y[a]));
+    return cross > epsilon * length;
+}
+
+// Compute the convex hull of coplanar points as a flat two-sided polygon
+static void computePlanarHull(const vector<Vector3>& points, const Vector3& origin,
+                              const Vector3& axis1, const Vector3& axis2, double epsilon,
+                              uint maxNbFaces, vector<Vector3>& hullVertices,
+                              vector<uint>& hullIndices) {
+
+    // Project the points on the plane and sort them lexicographically
+    const uint nbPoints = points.size();
+    vector<double> coordinatesX(nbPoints), coordinatesY(nbPoints);
+    #pragma omp parallel for
+    for (int i=0; i<int(nbPoints); i++) {
+        Vector3 d = points[i] - origin;
+        coordinatesX[i] = d.dot(axis1);
+        coordinatesY[i] = d.dot(axis2);
+    }
+    vector<uint> sortedPoints(nbPoints);
+    for (uint i=0; i<nbPoints; i++) sortedPoints[i] = i;
+    sort(sortedPoints.begin(), sortedPoints.end(),
+         LexicographicComparison(coordinatesX, coordinatesY));
+
+    // Compute the lower and the upper chains of the hull (Andrew's monotone chain).
+    // The points that are almost on an edge of the polygon are removed.
+    vector<uint> polygon(2 * nbPoints);
+    int k = 0;
+    for (uint n=0; n<nbPoints; n++) {
+        uint i = sortedPoints[n];
+        while (k >= 2 && !isLeftTurn(polygon[k - 2], polygon[k - 1], i,
+                                     coordinatesX, coordinatesY, epsilon)) k--;
+        polygon[k++] = i;
+    }
+    const int lowerChainSize = k + 1;
+    for (int n=int(nbPoints) - 2; n>=0; n--) {
+        uint i = sortedPoints[n];
+        while (k >= lowerChainSize && !isLeftTurn(polygon[k - 2], polygon[k - 1], i,
+                                                  coordinatesX, coordinatesY, epsilon)) k--;
+        polygon[k++] = i;
+    }
+    polygon.resize(k - 1);
+
+    // Remove the vertices that span the smallest triangles until the
+    // polygon has few enough faces (two triangles per vertex minus four)
+    const vector<uint> fullPolygon(polygon);
+    while (maxNbFaces > 0 && polygon.size() > 3 && 2 * (polygon.size() - 2) > maxNbFaces) {
+        uint smallestVertex = 0;
+        double smallestArea = DBL_MAX;
+        for (uint v=0; v<polygon.size(); v++) {
+            uint a = polygon[(v + polygon.size() - 1) % polygon.size()];
+            uint b = polygon[v];
+            uint c = polygon[(v + 1) % polygon.size()];
+            double area = fabs((coordinatesX[b] - coordinatesX[a]) * (coordinatesY[c] - coordinatesY[a]) -
+                               (coordinatesY[b] - coordinatesY[a]) * (coordinatesX[c] - coordinatesX[a]));
+            if (area < smallestArea) {
+                smallestArea = area;
+                smallestVertex = v;
+            }
+        }
+        polygon.erase(polygon.begin() + smallestVertex);
+    }
+
+    // If vertices have been removed, scale the polygon about its centroid so that it
+    // still contains them (an edge at distance h from the centroid moves to the distance
+    // s*h, so a vertex at distance d outside the edge is contained if s >= 1 + d/h)
+    double scale = 1.0;
+    double centroidX = 0.0, centroidY = 0.0;
+    if (polygon.size() < fullPolygon.size()) {
+        for (uint v=0; v<polygon.size(); v++) {
+            centroidX += coordinatesX[polygon[v]];
+            centroidY += coordinatesY[polygon[v]];
+        }
+        centroidX /= polygon.size();
+        centroidY /= polygon.size();
+        for (uint v=0; v<polygon.size(); v++) {
+            uint a = polygon[v];
+            uint b = polygon[(v + 1) % polygon.size()];
+            double edgeX = coordinatesX[b] - coordinatesX[a];
+            double edgeY = coordinatesY[b] - coordinatesY[a];
+            double length = sqrt(edgeX * edgeX + edgeY * edgeY);
+            double height = (edgeX * (centroidY - coordinatesY[a]) -
+                             edgeY * (centroidX - coordinatesX[a])) / length;
+            height = std::max(height, epsilon);
+            for (uint w=0; w<fullPolygon.size(); w++) {
+                uint p = fullPolygon[w];
+                double distance = (edgeY * (coordinatesX[p] - coordinatesX[a]) -
+                                   edgeX * (coordinatesY[p] - coordinatesY[a])) / length;
+                if (distance > 0.0) scale = std::max(scale, 1.0 + distance / height);
+            }
+        }
+    }
+
+    // Triangulate both sides of the polygon
+    const Vector3 centroid = origin + axis1 * float(centroidX) + axis2 * float(centroidY);
+    hullVertices.resize(polygon.size());
+    for (uint v=0; v<polygon.size(); v++) {
+        hullVertices[v] = centroid + (points[polygon[v]] - centroid) * float(scale);
+    }
+    for (uint v=1; v+1<polygon.size(); v++) {
+        hullIndices.push_back(0); hullIndices.push_back(v); hullIndices.push_back(v + 1);
+        hullIndices.push_back(0); hullIndices.push_back(v + 1); hullIndices.push_back(v);
+    }
+}
+
+// Compute the convex hull of points that are not coplanar starting from a tetrahedron
+static void computePolyhedralHull(const vector<Vector3>& points, uint vertex1, uint vertex2,
+                                  uint vertex3, uint vertex4, double epsilon,
+                                  uint maxNbFaces, vector<Vector3>& hullVertices,
+                                  vector<uint>& hullIndices) {
+
+    const uint nbPoints = points.size();
+    vector<HullFace> faces;
+
+    // Create the initial tetrahedron with its faces oriented outward
+    if (HullFace(vertex1, vertex2, vertex3, points).computeDistance(points[vertex4]) > 0.0) {
+        swap(vertex2, vertex3);
+    }
+    faces.push_back(HullFace(vertex1, vertex2, vertex3, points));
+    faces.push_back(HullFace(vertex1, vertex4, vertex2, points));
+    faces.push_back(HullFace(vertex2, vertex4, vertex3, points));
+    faces.push_back(HullFace(vertex3, vertex4, vertex1, points));
+    for (uint f=0; f<4; f++) {
+        for (uint e=0; e<3; e++) {
+            uint a = faces[f].vertices[e], b = faces[f].vertices[(e + 1) % 3];
+            for (uint g=0; g<4; g++) {
+                for (uint h=0; h<3; h++) {
+                    if (faces[g].vertices[h] == b && faces[g].vertices[(h + 1) % 3] == a) {
+                        faces[f].neighbors[e] = g;
+                    }
+                }
+            }
+        }
+    }
+
+    // Partition all the points between the faces of the tetrahedron
+    vector<uint> candidatePoints(nbPoints);
+    for (uint i=0; i<nbPoints; i++) candidatePoints[i] = i;
+    vector<uint> newFaces;
+    for (uint f=0; f<4; f++) newFaces.push_back(f);
+    partitionPoints(candidatePoints, points, newFaces, faces, epsilon);
+
+    // If the hull is simplified, limit its number of vertices so that
+    // it cannot have more faces than the maximum
+    const bool isSimplified = (maxNbFaces > 0);
+    const uint maxNbVertices = isSimplified ? std::max(maxNbFaces, 4u) / 2 + 2 : nbPoints;
+    uint nbVertices = 4;
+
+    vector<uint> pendingFaces(newFaces);
+    vector<uint> visibleFaces;
+    vector<HorizonEdge> horizon;
+    while (nbVertices < maxNbVertices) {
+
+        // Select a face with outside points (the one with the farthest point if the
+        // hull is simplified)
+        uint faceIndex = INVALID_INDEX;
+        if (isSimplified) {
+            double maxDistance = 0.0;
+            for (uint f=0; f<faces.size(); f++) {
+                if (!faces[f].isVisible && !faces[f].outsidePoints.empty() &&
+                    faces[f].farthestDistance > maxDistance) {
+                    maxDistance = faces[f].farthestDistance;
+                    faceIndex = f;
+                }
+            }
+        }
+        else {
+            while (!pendingFaces.empty() && faceIndex == INVALID_INDEX) {
+                uint f = pendingFaces.back();
+                pendingFaces.pop_back();
+                if (!faces[f].isVisible && !faces[f].outsidePoints.empty()) faceIndex = f;
+            }
+        }
+        if (faceIndex == INVALID_INDEX) break;
+
+        // Find the faces visible from the farthest point of the face and their horizon
+        const uint eye = faces[faceIndex].farthestPoint;
+        computeHorizon(points[eye], faceIndex, faces, visibleFaces, horizon);
+
+        // Collect the outside points of the visible faces (they are removed)
+        candidatePoints.clear();
+        for (uint f=0; f<visibleFaces.size(); f++) {
+            HullFace& face = faces[visibleFaces[f]];
+            for (uint i=0; i<face.outsidePoints.size(); i++) {
+                if (face.outsidePoints[i] != eye) candidatePoints.push_back(face.outsidePoints[i]);
+            }
+            vector<uint>().swap(face.outsidePoints);
+        }
+
+        // Create a new face between each horizon edge and the eye point
+        const uint firstNewFace = faces.size();
+        const uint nbHorizonEdges = horizon.size();
+        newFaces.clear();
+        for (uint e=0; e<nbHorizonEdges; e++) {
+            const HorizonEdge& edge = horizon[e];
+            uint newFace = firstNewFace + e;
+            faces.push_back(HullFace(edge.vertex1, edge.vertex2, eye, points));
+            faces[newFace].neighbors[0] = edge.face;
+            faces[newFace].neighbors[1] = firstNewFace + (e + 1) % nbHorizonEdges;
+            faces[newFace].neighbors[2] = firstNewFace + (e + nbHorizonEdges - 1) % nbHorizonEdges;
+            HullFace& neighbor = faces[edge.face];
+            for (uint i=0; i<3; i++) {
+                if (neighbor.vertices[i] == edge.vertex2 &&
+                    neighbor.vertices[(i + 1) % 3] == edge.vertex1) {
+                    neighbor.neighbors[i] = newFace;
+                }
+            }
+            newFaces.push_back(newFace);
+        }
+
+        // Assign the collected points to the new faces or to the faces across the
+        // horizon (a point outside a visible face can also be outside one of them)
+        for (uint e=0; e<nbHorizonEdges; e++) {
+            if (find(newFaces.begin(), newFaces.end(), horizon[e].face) == newFaces.end()) {
+                newFaces.push_back(horizon[e].face);
+            }
+        }
+        partitionPoints(candidatePoints, points, newFaces, faces, epsilon);
+        for (uint f=0; f<newFaces.size(); f++) {
+            if (!faces[newFaces[f]].outsidePoints.empty()) pendingFaces.push_back(newFaces[f]);
+        }
+
+        nbVertices++;
+    }
+
+    assert(isConvex(faces, points, epsilon));
+
+    // Collect the faces of the hull and number their vertices
+    vector<uint> hullFaces;
+    vector<uint> vertexIndices(nbPoints, INVALID_INDEX);
+    for (uint f=0; f<faces.size(); f++) {
+        if (faces[f].isVisible) continue;
+        hullFaces.push_back(f);
+        for (uint i=0; i<3; i++) {
+            uint vertex = faces[f].vertices[i];
+            if (vertexIndices[vertex] == INVALID_INDEX) {
+                vertexIndices[vertex] = hullVertices.size();
+                hullVertices.push_back(points[vertex]);
+            }
+            hullIndices.push_back(vertexIndices[vertex]);
+        }
+    }
+
+    // If some points are still outside the hull (simplified hull), scale the hull
+    // about its centroid so that it contains them. The plane of a face at distance
+    // h from the centroid moves to the distance s*h, so a point at distance d outside
+    // the face is contained if s >= 1 + d/h.
+    vector<uint> remainingPoints;
+    for (uint f=0; f<hullFaces.size(); f++) {
+        const vector<uint>& outsidePoints = faces[hullFaces[f]].outsidePoints;
+        remainingPoints.insert(remainingPoints.end(), outsidePoints.begin(), outsidePoints.end());
+    }
+    if (!remainingPoints.empty()) {
+
+        Vector3 centroid(0, 0, 0);
+        for (uint v=0; v<hullVertices.size(); v++) centroid += hullVertices[v];
+        centroid /= float(hullVertices.size());
+
+        vector<double> heights(hullFaces.size());
+        for (uint f=0; f<hullFaces.size(); f++) {
+            heights[f] = std::max(-faces[hullFaces[f]].computeDistance(centroid), epsilon);
+        }
+
+        const int nbRemainingPoints = int(remainingPoints.size());
+        double scale = 1.0;
+        #pragma omp parallel
+        {
+            double localScale = 1.0;
+
+            #pragma omp for nowait
+            for (int i=0; i<nbRemainingPoints; i++) {
+                const Vector3& point = points[remainingPoints[i]];
+                for (uint f=0; f<hullFaces.size(); f++) {
+                    double distance = faces[hullFaces[f]].computeDistance(point);
+                    if (distance > 0.0) {
+                        localScale = std::max(localScale, 1.0 + distance / heights[f]);
+                    }
+                }
+            }
+
+            #pragma omp critical
+            scale = std::max(scale, localScale);
+        }
+
+        for (uint v=0; v<hullVertices.size(); v++) {
+            hullVertices[v] = centroid + (hullVertices[v] - centroid) * float(scale);
+        }
+    }
+}
+
+// Compute the convex hull of a set of points (a maximum number of faces of
+// zero means that the hull is not simplified)
+void ConvexHull::computeConvexHull(const vector<Vector3>& points, Mesh& hull, uint maxNbFaces) {
+
+    vector<Vector3> hullVertices;
+    vector<uint> hullIndices;
+    const uint nbPoints = points.size();
+
+    if (nbPoints >= 3) {
+
+        // Find the extreme points and the tolerance of the distance computations
+        uint extremePoints[6];
+        Vector3 maxAbsoluteCoordinates;
+        findExtremePoints(points, extremePoints, maxAbsoluteCoordinates);
+        const double epsilon = 3.0 * FLT_EPSILON * (double(maxAbsoluteCoordinates.x) +
+                                                    maxAbsoluteCoordinates.y +
+                                                    maxAbsoluteCoordinates.z);
+
+        // The first two vertices of the initial tetrahedron are the most distant
+        // pair of extreme points
+        uint vertex1 = 0, vertex2 = 0;
+        double maxDistance = -1.0;
+        for (int i=0; i<6; i++) {
+            for (int j=i+1; j<6; j++) {
+                double distance = (points[extremePoints[i]] - points[extremePoints[j]]).length();
+                if (distance > maxDistance) {
+                    maxDistance = distance;
+                    vertex1 = extremePoints[i];
+                    vertex2 = extremePoints[j];
+                }
+            }
+        }
+
+        // The third vertex is the farthest point from the line and the fourth one is
+        // the farthest point from the plane of the three first vertices
+        uint vertex3 = 0, vertex4 = 0;
+        double distanceToLine = 0.0, distanceToPlane = 0.0;
+        if (maxDistance > epsilon) {
+            vertex3 = findFarthestPoint(points, LineDistance(points[vertex1], points[vertex2]),
+                                        distanceToLine);
+        }
+        if (distanceToLine > epsilon) {
+            vertex4 = findFarthestPoint(points, PlaneDistance(points[vertex1], points[vertex2],
+                                                              points[vertex3]),
+                                        distanceToPlane);
+        }
+
+        if (distanceToLine > epsilon && distanceToPlane <= epsilon) {
+
+            // All the points are coplanar
+            Vector3 axis1 = points[vertex2] - points[vertex1];
+            Vector3 normal = axis1.cross(points[vertex3] - points[vertex1]);
+            axis1.normalize();
+            normal.normalize();
+            computePlanarHull(points, points[vertex1], axis1, normal.cross(axis1), epsilon,
+                              maxNbFaces, hullVertices, hullIndices);
+        }
+        else if (distanceToPlane > epsilon) {
+            computePolyhedralHull(points, vertex1, vertex2, vertex3, vertex4, epsilon,
+                                  maxNbFaces, hullVertices, hullIndices);
+        }
+    }
+
+    vector<vector<uint> > indices(1);
+    indices[0].swap(hullIndices);
+    hull.setVertices(std::move(hullVertices));
+    hull.setIndices(std::move(indices));
+}
@@ -0,0 +1,81 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef CONVEX_HULL_H
+#define CONVEX_HULL_H
+
+// Libraries
+#include <vector>
+#include "definitions.h"
+#include "maths/Vector3.h"
+#include "Mesh.h"
+
+namespace openglframework {
+
+// Class ConvexHull
+// This class contains static methods to compute the 3D convex hull of a set of points
+// with the quickhull algorithm. The search of the extreme points and the partition
+// of the points between the faces of the hull run in parallel with OpenMP. The
+// points closer than a tolerance (relative to the extent of the points) to a face
+// are considered to be inside the hull so that coplanar input does not create
+// degenerate faces. If all the points are coplanar, the hull is a flat two-sided
+// polygon. If they are collinear or coincident, the hull is empty.
+//
+// The hull can be simplified to a maximum number of faces. In this case, the
+// algorithm stops when the number of vertices reaches the number for which the
+// number of faces cannot exceed the maximum (a triangulated convex polyhedron with
+// V vertices has at most 2V-4 faces) and the point the farthest from the current
+// hull is added first at each iteration. The simplified hull is then scaled about
+// its centroid so that it still contains all the points (conservative proxy).
+class ConvexHull {
+
+    private :
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor (private because we do not want instances of this class)
+        ConvexHull();
+
+    public :
+
+        // -------------------- Methods -------------------- //
+
+        // Compute the convex hull of a set of points (a maximum number of faces of
+        // zero means that the hull is not simplified)
+        static void computeConvexHull(const std::vector<Vector3>& points, Mesh& hull,
+                                      uint maxNbFaces = 0);
+
+        // Compute the convex hull of the vertices of a mesh
+        static void computeConvexHull(const Mesh& mesh, Mesh& hull, uint maxNbFaces = 0);
+};
+
+// Compute the convex hull of the vertices of a mesh
+inline void ConvexHull::computeConvexHull(const Mesh& mesh, Mesh& hull, uint maxNbFaces) {
+    computeConvexHull(mesh.getVertices(), hull, maxNbFaces);
+}
+
+}
+
+#endif
@@ -0,0 +1,593 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "DynamicAABBTree.h"
+#include <algorithm>
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Constants
+const int DynamicAABBTree::NULL_NODE;
+
+// Return the union of two boxes
+static inline AABB getMergedAABB(const AABB& aabb1, const AABB& aabb2) {
+    AABB aabb = aabb1;
+    aabb.merge(aabb2);
+    return aabb;
+}
+
+// Constructor
+DynamicAABBTree::DynamicAABBTree(float fatMargin, float displacementMultiplier)
+                : mRootNode(NULL_NODE), mFreeNode(NULL_NODE), mNbObjects(0),
+                  mFatMargin(fatMargin), mDisplacementMultiplier(displacementMultiplier),
+                  mRebalancingCursor(0) {
+
+}
+
+// Destructor
+DynamicAABBTree::~DynamicAABBTree() {
+
+}
+
+// Allocate a node
+int DynamicAABBTree::allocateNode() {
+
+    int node;
+    if (mFreeNode != NULL_NODE) {
+        node = mFreeNode;
+        mFreeNode = mNodes[node].parent;
+    }
+    else {
+        node = int(mNodes.size());
+        mNodes.push_back(DynamicAABBTreeNode());
+    }
+
+    mNodes[node].object = NULL;
+    mNodes[node].parent = NULL_NODE;
+    mNodes[node].children[0] = NULL_NODE;
+    mNodes[node].children[1] = NULL_NODE;
+    mNodes[node].height = 0;
+
+    return node;
+}
+
+// Release a node
+void DynamicAABBTree::releaseNode(int node) {
+    mNodes[node].parent = mFreeNode;
+    mNodes[node].height = -1;
+    mFreeNode = node;
+}
+
+// Add an object with its world-space box and return its proxy
+int DynamicAABBTree::addObject(const Object3D* object, const AABB& aabb) {
+
+    int proxy = allocateNode();
+    const Vector3 margin(mFatMargin, mFatMargin, mFatMargin);
+    mNodes[proxy].aabb = AABB(aabb.min - margin, aabb.max + margin);
+    mNodes[proxy].object = object;
+
+    insertLeaf(proxy);
+    mNbObjects++;
+
+    return proxy;
+}
+
+// Remove an object from the tree
+void DynamicAABBTree::removeObject(int proxy) {
+    assert(proxy >= 0 && proxy < int(mNodes.size()) && mNodes[proxy].isLeaf());
+    removeLeaf(proxy);
+    releaseNode(proxy);
+    mNbObjects--;
+}
+
+// Update the world-space box of an object. The displacement of the object since
+// the last update is used to enlarge the fat box in the direction of motion.
+// Return true if the tree has been modified.
+bool DynamicAABBTree::updateObject(int proxy, const AABB& aabb, const Vector3& displacement) {
+
+    assert(proxy >= 0 && proxy < int(mNodes.size()) && mNodes[proxy].isLeaf());
+
+    // Compute the new fat box, enlarged in the direction of the motion
+    const Vector3 margin(mFatMargin, mFatMargin, mFatMargin);
+    AABB fatAABB(aabb.min - margin, aabb.max + margin);
+    Vector3 d = displacement * mDisplacementMultiplier;
+    if (d.x < 0.0f) fatAABB.min.x += d.x; else fatAABB.max.x += d.x;
+    if (d.y < 0.0f) fatAABB.min.y += d.y; else fatAABB.max.y += d.y;
+    if (d.z < 0.0f) fatAABB.min.z += d.z; else fatAABB.max.z += d.z;
+
+    // Nothing to do if the current fat box still contains the object and is not
+    // too large (the object might have been moving fast and has slowed down)
+    const AABB& treeAABB = mNodes[proxy].aabb;
+    if (treeAABB.contains(aabb)) {
+        const Vector3 hugeMargin = margin * 4.0f;
+        AABB hugeAABB(fatAABB.min - hugeMargin, fatAABB.max + hugeMargin);
+        if (hugeAABB.contains(treeAABB)) return false;
+    }
+
+    // Insert the leaf again at the best place
+    removeLeaf(proxy);
+    mNodes[proxy].aabb = fatAABB;
+    insertLeaf(proxy);
+
+    return true;
+}
+
+// Set the world-space box of an object without modifying the structure of the
+// tree. The boxes of the internal nodes are valid again after a call to refit().
+void DynamicAABBTree::setObjectAABB(int proxy, const AABB& aabb) {
+    assert(proxy >= 0 && proxy < int(mNodes.size()) && mNodes[proxy].isLeaf());
+    mNodes[proxy].aabb = aabb;
+}
+
+// Recompute the boxes of all the internal nodes from the boxes of the leaves
+void DynamicAABBTree::refit() {
+    if (mRootNode != NULL_NODE) {
+        refitSubtree(mRootNode);
+    }
+}
+
+// Recompute the boxes of the internal nodes of a subtree
+void DynamicAABBTree::refitSubtree(int node) {
+    if (mNodes[node].isLeaf()) return;
+    int child1 = mNodes[node].children[0];
+    int child2 = mNodes[node].children[1];
+    refitSubtree(child1);
+    refitSubtree(child2);
+    mNodes[node].aabb = getMergedAABB(mNodes[child1].aabb, mNodes[child2].aabb);
+}
+
+// Insert again a given number of objects (visited in turn) at the best place in
+// the tree to restore the quality of a tree that has been refitted many times
+void DynamicAABBTree::rebalance(uint nbObjects) {
+
+    nbObjects = min(nbObjects, mNbObjects);
+    uint nbNodes = mNodes.size();
+    while (nbObjects > 0) {
+
+        if (mRebalancingCursor >= nbNodes) mRebalancingCursor = 0;
+        int node = int(mRebalancingCursor++);
+
+        // Skip the internal nodes and the free nodes
+        if (mNodes[node].height != 0) continue;
+
+        removeLeaf(node);
+        insertLeaf(node);
+        nbObjects--;
+    }
+}
+
+// Remove all the objects
+void DynamicAABBTree::clear() {
+    mNodes.clear();
+    mRootNode = NULL_NODE;
+    mFreeNode = NULL_NODE;
+    mNbObjects = 0;
+    mRebalancingCursor = 0;
+}
+
+// Insert a leaf into the tree
+void DynamicAABBTree::insertLeaf(int leaf) {
+
+    if (mRootNode == NULL_NODE) {
+        mRootNode = leaf;
+        mNodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // Find the best sibling for the leaf with the surface area heuristic
+    const AABB leafAABB = mNodes[leaf].aabb;
+    int node = mRootNode;
+    while (!mNodes[node].isLeaf()) {
+
+        int child1 = mNodes[node].children[0];
+        int child2 = mNodes[node].children[1];
+
+        float area = mNodes[node].aabb.getSurfaceArea();
+        float combinedArea = getMergedAABB(mNodes[node].aabb, leafAABB).getSurfaceArea();
+
+        // Cost of creating a new parent for this node and the new leaf
+        float cost = 2.0f * combinedArea;
+
+        // Minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        // Cost of descending into each child
+        float cost1 = getMergedAABB(leafAABB, mNodes[child1].aabb).getSurfaceArea() +
+                      inheritanceCost;
+        if (!mNodes[child1].isLeaf()) cost1 -= mNodes[child1].aabb.getSurfaceArea();
+        float cost2 = getMergedAABB(leafAABB, mNodes[child2].aabb).getSurfaceArea() +
+                      inheritanceCost;
+        if (!mNodes[child2].isLeaf()) cost2 -= mNodes[child2].aabb.getSurfaceArea();
+
+        if (cost < cost1 && cost < cost2) break;
+
+        node = (cost1 < cost2) ? child1 : child2;
+    }
+    int sibling = node;
+
+    // Create a new parent for the sibling and the leaf
+    int oldParent = mNodes[sibling].parent;
+    int newParent = allocateNode();
+    mNodes[newParent].parent = oldParent;
+    mNodes[newParent].aabb = getMergedAABB(leafAABB, mNodes[sibling].aabb);
+    mNodes[newParent].height = mNodes[sibling].height + 1;
+    mNodes[newParent].children[0] = sibling;
+    mNodes[newParent].children[1] = leaf;
+    mNodes[sibling].parent = newParent;
+    mNodes[leaf].parent = newParent;
+
+    if (oldParent != NULL_NODE) {
+        int childIndex = (mNodes[oldParent].children[0] == sibling) ? 0 : 1;
+        mNodes[oldParent].children[childIndex] = newParent;
+    }
+    else {
+        mRootNode = newParent;
+    }
+
+    refitAncestors(mNodes[leaf].parent);
+}
+
+// Remove a leaf from the tree
+void DynamicAABBTree::removeLeaf(int leaf) {
+
+    if (leaf == mRootNode) {
+        mRootNode = NULL_NODE;
+        return;
+    }
+
+    int parent = mNodes[leaf].parent;
+    int grandParent = mNodes[parent].parent;
+    int sibling = (mNodes[parent].children[0] == leaf) ? mNodes[parent].children[1] :
+                                                         mNodes[parent].children[0];
+
+    // Replace the parent by the sibling
+    if (grandParent != NULL_NODE) {
+        int childIndex = (mNodes[grandParent].children[0] == parent) ? 0 : 1;
+        mNodes[grandParent].children[childIndex] = sibling;
+        mNodes[sibling].parent = grandParent;
+        releaseNode(parent);
+        refitAncestors(grandParent);
+    }
+    else {
+        mRootNode = sibling;
+        mNodes[sibling].parent = NULL_NODE;
+        releaseNode(parent);
+    }
+}
+
+// Refit the boxes and heights of the ancestors of a node and balance them
+void DynamicAABBTree::refitAncestors(int node) {
+
+    bool isFirstNode = true;
+    while (node != NULL_NODE) {
+
+        int balancedNode = balance(node);
+
+        int child1 = mNodes[balancedNode].children[0];
+        int child2 = mNodes[balancedNode].children[1];
+        int height = 1 + max(mNodes[child1].height, mNodes[child2].height);
+        AABB aabb = getMergedAABB(mNodes[child1].aabb, mNodes[child2].aabb);
+
+        // Stop if the node has not changed (its ancestors do not change either). The
+        // first node is always refitted because it can be a new node.
+        DynamicAABBTreeNode& balanced = mNodes[balancedNode];
+        if (!isFirstNode && balancedNode == node && balanced.height == height &&
+            balanced.aabb.min == aabb.min && balanced.aabb.max == aabb.max) {
+            return;
+        }
+
+        balanced.height = height;
+        balanced.aabb = aabb;
+
+        node = balanced.parent;
+        isFirstNode = false;
+    }
+}
+
+// Balance a subtree with a rotation and return the new root of the subtree. If
+// one child is higher than the other by more than one level, it is rotated up.
+int DynamicAABBTree::balance(int nodeA) {
+
+    DynamicAABBTreeNode& A = mNodes[nodeA];
+    if (A.isLeaf() || A.height < 2) return nodeA;
+
+    int nodeB = A.children[0];
+    int nodeC = A.children[1];
+    DynamicAABBTreeNode& B = mNodes[nodeB];
+    DynamicAABBTreeNode& C = mNodes[nodeC];
+
+    int balanceFactor = C.height - B.height;
+
+    // Rotate C up
+    if (balanceFactor > 1) {
+
+        int nodeF = C.children[0];
+        int nodeG = C.children[1];
+        DynamicAABBTreeNode& F = mNodes[nodeF];
+        DynamicAABBTreeNode& G = mNodes[nodeG];
+
+        // Swap A and C
+        C.children[0] = nodeA;
+        C.parent = A.parent;
+        A.parent = nodeC;
+
+        // A's old parent points to C
+        if (C.parent != NULL_NODE) {
+            int childIndex = (mNodes[C.parent].children[0] == nodeA) ? 0 : 1;
+            mNodes[C.parent].children[childIndex] = nodeC;
+        }
+        else {
+            mRootNode = nodeC;
+        }
+
+        // Keep the highest child of C under C
+        if (F.height > G.height) {
+            C.children[1] = nodeF;
+            A.children[1] = nodeG;
+            G.parent = nodeA;
+            A.aabb = getMergedAABB(B.aabb, G.aabb);
+            C.aabb = getMergedAABB(A.aabb, F.aabb);
+            A.height = 1 + max(B.height, G.height);
+            C.height = 1 + max(A.height, F.height);
+        }
+        else {
+            C.children[1] = nodeG;
+            A.children[1] = nodeF;
+            F.parent = nodeA;
+            A.aabb = getMergedAABB(B.aabb, F.aabb);
+            C.aabb = getMergedAABB(A.aabb, G.aabb);
+            A.height = 1 + max(B.height, F.height);
+            C.height = 1 + max(A.height, G.height);
+        }
+
+        return nodeC;
+    }
+
+    // Rotate B up
+    if (balanceFactor < -1) {
+
+        int nodeD = B.children[0];
+        int nodeE = B.children[1];
+        DynamicAABBTreeNode& D = mNodes[nodeD];
+        DynamicAABBTreeNode& E = mNodes[nodeE];
+
+        // Swap A and B
+        B.children[0] = nodeA;
+        B.parent = A.parent;
+        A.parent = nodeB;
+
+        // A's old parent points to B
+        if (B.parent != NULL_NODE) {
+            int childIndex = (mNodes[B.parent].children[0] == nodeA) ? 0 : 1;
+            mNodes[B.parent].children[childIndex] = nodeB;
+        }
+        else {
+            mRootNode = nodeB;
+        }
+
+        // Keep the highest child of B under B
+        if (D.height > E.height) {
+            B.children[1] = nodeD;
+            A.children[0] = nodeE;
+            E.parent = nodeA;
+            A.aabb = getMergedAABB(C.aabb, E.aabb);
+            B.aabb = getMergedAABB(A.aabb, D.aabb);
+            A.height = 1 + max(C.height, E.height);
+            B.height = 1 + max(A.height, D.height);
+        }
+        else {
+            B.children[1] = nodeE;
+            A.children[0] = nodeD;
+            D.parent = nodeA;
+            A.aabb = getMergedAABB(C.aabb, D.aabb);
+            B.aabb = getMergedAABB(A.aabb, E.aabb);
+            A.height = 1 + max(C.height, D.height);
+            B.height = 1 + max(A.height, E.height);
+        }
+
+        return nodeB;
+    }
+
+    return nodeA;
+}
+
+// Find the objects whose box overlaps a box
+void DynamicAABBTree::queryAABB(const AABB& aabb, vector<int>& proxies) const {
+
+    if (mRootNode == NULL_NODE) return;
+
+    vector<int> stack;
+    stack.reserve(64);
+    stack.push_back(mRootNode);
+
+    while (!stack.empty()) {
+
+        int node = stack.back();
+        stack.pop_back();
+
+        if (!mNodes[node].aabb.overlaps(aabb)) continue;
+
+        if (mNodes[node].isLeaf()) {
+            proxies.push_back(node);
+        }
+        else {
+            stack.push_back(mNodes[node].children[0]);
+            stack.push_back(mNodes[node].children[1]);
+        }
+    }
+}
+
+// Find the objects whose box overlaps a sphere
+void DynamicAABBTree::querySphere(const BoundingSphere& sphere, vector<int>& proxies) const {
+
+    if (mRootNode == NULL_NODE || sphere.isEmpty()) return;
+
+    const float radiusSquare = sphere.radius * sphere.radius;
+
+    vector<int> stack;
+    stack.reserve(64);
+    stack.push_back(mRootNode);
+
+    while (!stack.empty()) {
+
+        int node = stack.back();
+        stack.pop_back();
+
+        // Squared distance between the center of the sphere and the box
+        const AABB& aabb = mNodes[node].aabb;
+        Vector3 closestPoint(min(max(sphere.center.x, aabb.min.x), aabb.max.x),
+                             min(max(sphere.center.y, aabb.min.y), aabb.max.y),
+                             min(max(sphere.center.z, aabb.min.z), aabb.max.z));
+        if ((closestPoint - sphere.center).lengthSquared() > radiusSquare) continue;
+
+        if (mNodes[node].isLeaf()) {
+            proxies.push_back(node);
+        }
+        else {
+            stack.push_back(mNodes[node].children[0]);
+            stack.push_back(mNodes[node].children[1]);
+        }
+    }
+}
+
+// Find the objects whose box is inside or intersects a frustum
+void DynamicAABBTree::queryFrustum(const Frustum& frustum, vector<int>& proxies) const {
+
+    if (mRootNode == NULL_NODE) return;
+
+    // The stack contains the nodes and whether they are known to be inside the frustum
+    vector<pair<int, bool> > stack;
+    stack.reserve(64);
+    stack.push_back(make_pair(mRootNode, false));
+
+    while (!stack.empty()) {
+
+        int node = stack.back().first;
+        bool isInside = stack.back().second;
+        stack.pop_back();
+
+        // The subtrees of a node inside the frustum are not tested anymore
+        if (!isInside) {
+            Frustum::TestResult result = frustum.testAABB(mNodes[node].aabb);
+            if (result == Frustum::OUTSIDE) continue;
+            isInside = (result == Frustum::INSIDE);
+        }
+
+        if (mNodes[node].isLeaf()) {
+            proxies.push_back(node);
+        }
+        else {
+            stack.push_back(make_pair(mNodes[node].children[0], isInside));
+            stack.push_back(make_pair(mNodes[node].children[1], isInside));
+        }
+    }
+}
+
+// Find the objects whose box is hit by a ray (the proxies are not sorted)
+void DynamicAABBTree::queryRay(const Ray& ray, vector<int>& proxies) const {
+
+    if (mRootNode == NULL_NODE) return;
+
+    const float infinity = numeric_limits<float>::infinity();
+    const Vector3 invDirection(ray.direction.x != 0.0f ? 1.0f / ray.direction.x : infinity,
+                               ray.direction.y != 0.0f ? 1.0f / ray.direction.y : infinity,
+                               ray.direction.z != 0.0f ? 1.0f / ray.direction.z : infinity);
+
+    vector<int> stack;
+    stack.reserve(64);
+    stack.push_back(mRootNode);
+
+    while (!stack.empty()) {
+
+        int node = stack.back();
+        stack.pop_back();
+
+        // Slab test
+        const AABB& aabb = mNodes[node].aabb;
+        float tx1 = (aabb.min.x - ray.origin.x) * invDirection.x;
+        float tx2 = (aabb.max.x - ray.origin.x) * invDirection.x;
+        float ty1 = (aabb.min.y - ray.origin.y) * invDirection.y;
+        float ty2 = (aabb.max.y - ray.origin.y) * invDirection.y;
+        float tz1 = (aabb.min.z - ray.origin.z) * invDirection.z;
+        float tz2 = (aabb.max.z - ray.origin.z) * invDirection.z;
+        float tMin = max(max(min(tx1, tx2), min(ty1, ty2)), max(min(tz1, tz2), 0.0f));
+        float tMax = min(min(max(tx1, tx2), max(ty1, ty2)), min(max(tz1, tz2), ray.maxDistance));
+        if (tMin > tMax) continue;
+
+        if (mNodes[node].isLeaf()) {
+            proxies.push_back(node);
+        }
+        else {
+            stack.push_back(mNodes[node].children[0]);
+            stack.push_back(mNodes[node].children[1]);
+        }
+    }
+}
+
+// Return the height of a subtree
+int DynamicAABBTree::computeHeight(int node) const {
+    if (mNodes[node].isLeaf()) return 0;
+    return 1 + max(computeHeight(mNodes[node].children[0]),
+                   computeHeight(mNodes[node].children[1]));
+}
+
+// Check the structure of the tree (debugging)
+bool DynamicAABBTree::validate() const {
+
+    if (mRootNode == NULL_NODE) return mNbObjects == 0;
+    if (mNodes[mRootNode].parent != NULL_NODE) return false;
+
+    uint nbLeaves = 0;
+    vector<int> stack;
+    stack.push_back(mRootNode);
+    while (!stack.empty()) {
+
+        int node = stack.back();
+        stack.pop_back();
+
+        if (mNodes[node].isLeaf()) {
+            if (mNodes[node].height != 0) return false;
+            nbLeaves++;
+            continue;
+        }
+
+        int child1 = mNodes[node].children[0];
+        int child2 = mNodes[node].children[1];
+        if (mNodes[child1].parent != node || mNodes[child2].parent != node) return false;
+        if (mNodes[node].height != 1 + max(mNodes[child1].height, mNodes[child2].height)) {
+            return false;
+        }
+        if (!mNodes[node].aabb.contains(mNodes[child1].aabb) ||
+            !mNodes[node].aabb.contains(mNodes[child2].aabb)) return false;
+
+        stack.push_back(child1);
+        stack.push_back(child2);
+    }
+
+    return nbLeaves == mNbObjects && computeHeight(mRootNode) == mNodes[mRootNode].height;
+}
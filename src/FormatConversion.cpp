@@ -0,0 +1,543 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "FormatConversion.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#include <immintrin.h>
+#define FORMAT_CONVERSION_USE_F16C
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FORMAT_CONVERSION_USE_SSE2
+#endif
+
+// Namespaces
+using namespace openglframework;
+
+// Bits of the largest float infinity
+static const uint FLOAT_INFINITY_BITS = 255u << 23;
+
+// Bits of the smallest float that overflows the half floats (2^16)
+static const uint HALF_OVERFLOW_BITS = (127u + 16u) << 23;
+
+// Bits of the smallest normalized half float (2^-14)
+static const uint HALF_NORMAL_MIN_BITS = 113u << 23;
+
+// Bits of the float that aligns the denormal half floats on the last mantissa bit (0.5)
+static const uint HALF_DENORMAL_MAGIC_BITS = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+// Bias added to the bits of a normalized float to obtain the half float bits
+// (exponent rebias and rounding to nearest)
+static const uint HALF_NORMAL_BIAS = ((15u - 127u) << 23) + 0xfffu;
+
+// Bits of the smallest float that is encoded by the sRGB tables (2^-13)
+static const uint SRGB_MIN_BITS = (127u - 13u) << 23;
+
+// Bits of the largest float below 1
+static const uint SRGB_ALMOST_ONE_BITS = 0x3f7fffffu;
+
+// Number of mantissa bits used to index the sRGB encoding buckets
+static const int SRGB_BUCKET_MANTISSA_BITS = 7;
+
+// Shift of the float bits that gives the index of their sRGB encoding bucket
+static const int SRGB_BUCKET_SHIFT = 23 - SRGB_BUCKET_MANTISSA_BITS;
+
+// Mask of the float bits that give the offset of a float inside its sRGB encoding bucket
+static const uint SRGB_BUCKET_OFFSET_MASK = (1u << SRGB_BUCKET_SHIFT) - 1u;
+
+// Number of sRGB encoding buckets
+static const int NB_SRGB_BUCKETS = int((0x3f800000u - SRGB_MIN_BITS) >> SRGB_BUCKET_SHIFT);
+
+// Return the bits of a float
+static inline uint getFloatBits(float value) {
+    uint bits;
+    memcpy(&bits, &value, sizeof(float));
+    return bits;
+}
+
+// Return the float with given bits
+static inline float getFloatFromBits(uint bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(float));
+    return value;
+}
+
+// Clamp a value between a minimum and a maximum (a NaN gives the minimum)
+static inline float clamp(float value, float minValue, float maxValue) {
+    value = (value > minValue) ? value : minValue;
+    return (value < maxValue) ? value : maxValue;
+}
+
+// Convert a sRGB value into a linear value
+static double convertSRGBToLinear(double value) {
+    return (value <= 0.04045) ? value / 12.92 : pow((value + 0.055) / 1.055, 2.4);
+}
+
+// Class SRGBTables
+// Tables used to convert between linear and sRGB8 values. A linear value x is encoded
+// with the number of thresholds below it, where the threshold k is the linear value of
+// the sRGB value (k + 0.5) / 255. The buckets split the floats by their exponent and
+// their first mantissa bits and are small enough to contain at most one threshold, so
+// the code of a value is the code of its bucket plus one if it is above the threshold.
+// Each bucket is a single 32-bit entry with its code in the high bits and a bias in the
+// low bits such that the addition of the offset of a float in its bucket carries into
+// the code exactly when the float reaches the threshold. The encoding is thus one table
+// load, one addition and one shift.
+class SRGBTables {
+
+    public:
+
+        // Linear value of each sRGB8 code
+        float linearValues[256];
+
+        // Smallest float encoded with the code k + 1 (infinity for the last code)
+        float thresholds[256];
+
+        // Entry of each bucket: code of the smallest float of the bucket (shifted by
+        // SRGB_BUCKET_SHIFT + 1) plus 2^(SRGB_BUCKET_SHIFT + 1) minus the offset of the
+        // first float of the bucket encoded with the code + 1 (the offset is
+        // 2^SRGB_BUCKET_SHIFT if there is no such float)
+        uint bucketEntries[NB_SRGB_BUCKETS];
+
+        // Constructor
+        SRGBTables() {
+
+            for (int k=0; k<256; k++) {
+                linearValues[k] = float(convertSRGBToLinear(k / 255.0));
+            }
+
+            // Round the thresholds up to floats so that the comparison with a float is exact
+            for (int k=0; k<255; k++) {
+                double threshold = convertSRGBToLinear((k + 0.5) / 255.0);
+                float floatThreshold = float(threshold);
+                if (double(floatThreshold) < threshold) {
+                    floatThreshold = nextafterf(floatThreshold, 2.0f);
+                }
+                thresholds[k] = floatThreshold;
+            }
+            thresholds[255] = std::numeric_limits<float>::infinity();
+
+            int code = 0;
+            for (int b=0; b<NB_SRGB_BUCKETS; b++) {
+                uint bucketMinBits = SRGB_MIN_BITS + (uint(b) << SRGB_BUCKET_SHIFT);
+                while (code < 255 && thresholds[code] <= getFloatFromBits(bucketMinBits)) code++;
+
+                // The thresholds are positive floats, so they are ordered as their bits
+                uint offset = SRGB_BUCKET_OFFSET_MASK + 1;
+                if (code < 255 && (getFloatBits(thresholds[code]) >> SRGB_BUCKET_SHIFT) ==
+                                  (bucketMinBits >> SRGB_BUCKET_SHIFT)) {
+                    offset = getFloatBits(thresholds[code]) & SRGB_BUCKET_OFFSET_MASK;
+                }
+                bucketEntries[b] = (uint(code) << (SRGB_BUCKET_SHIFT + 1)) +
+                                   (2u << SRGB_BUCKET_SHIFT) - offset;
+            }
+        }
+
+        // Encode a linear value into a sRGB8 code
+        unsigned char encode(float value) const {
+            uint bits = getFloatBits(value);
+            if (!(value > getFloatFromBits(SRGB_MIN_BITS))) bits = SRGB_MIN_BITS;
+            if (bits > SRGB_ALMOST_ONE_BITS) bits = SRGB_ALMOST_ONE_BITS;
+            uint entry = bucketEntries[(bits - SRGB_MIN_BITS) >> SRGB_BUCKET_SHIFT];
+            return (unsigned char)((entry + (bits & SRGB_BUCKET_OFFSET_MASK)) >> (SRGB_BUCKET_SHIFT + 1));
+        }
+};
+
+// Return the sRGB tables (created at the first call)
+static const SRGBTables& getSRGBTables() {
+    static const SRGBTables tables;
+    return tables;
+}
+
+#if defined(FORMAT_CONVERSION_USE_SSE2)
+
+// Select the bits of a where the mask is set and the bits of b elsewhere
+static inline __m128i select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Convert four floats into half floats (in the low 16 bits of each 32-bit lane)
+static inline __m128i convertFloatsToHalfsSSE2(__m128 values) {
+    __m128i f = _mm_castps_si128(values);
+    __m128i sign = _mm_and_si128(f, _mm_set1_epi32(int(0x80000000u)));
+    f = _mm_xor_si128(f, sign);
+
+    // Infinity or NaN
+    __m128i isOverflow = _mm_cmpgt_epi32(f, _mm_set1_epi32(int(HALF_OVERFLOW_BITS - 1)));
+    __m128i isNaN = _mm_cmpgt_epi32(f, _mm_set1_epi32(int(FLOAT_INFINITY_BITS)));
+    __m128i infinityOrNaN = _mm_or_si128(_mm_set1_epi32(0x7c00),
+                                         _mm_and_si128(isNaN, _mm_set1_epi32(0x0200)));
+
+    // Denormal (the addition of the magic number rounds the mantissa)
+    __m128i isDenormal = _mm_cmplt_epi32(f, _mm_set1_epi32(int(HALF_NORMAL_MIN_BITS)));
+    __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(int(HALF_DENORMAL_MAGIC_BITS)));
+    __m128i denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(f), magic)),
+                                     _mm_castps_si128(magic));
+
+    // Normal (rounding to nearest even)
+    __m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(f, 13), _mm_set1_epi32(1));
+    __m128i normal = _mm_add_epi32(_mm_add_epi32(f, _mm_set1_epi32(int(HALF_NORMAL_BIAS))),
+                                   mantissaOdd);
+    normal = _mm_srli_epi32(normal, 13);
+
+    __m128i o = select(isOverflow, infinityOrNaN, select(isDenormal, denormal, normal));
+    return _mm_or_si128(o, _mm_srli_epi32(sign, 16));
+}
+
+// Convert four half floats (in the low 16 bits of each 32-bit lane) into floats
+static inline __m128 convertHalfsToFloatsSSE2(__m128i halfs) {
+    const __m128i shiftedExponent = _mm_set1_epi32(0x7c00 << 13);
+    __m128i o = _mm_slli_epi32(_mm_and_si128(halfs, _mm_set1_epi32(0x7fff)), 13);
+    __m128i exponent = _mm_and_si128(o, shiftedExponent);
+    o = _mm_add_epi32(o, _mm_set1_epi32((127 - 15) << 23));
+
+    // Infinity or NaN
+    __m128i isInfinityOrNaN = _mm_cmpeq_epi32(exponent, shiftedExponent);
+    o = _mm_add_epi32(o, _mm_and_si128(isInfinityOrNaN, _mm_set1_epi32((128 - 16) << 23)));
+
+    // Zero or denormal (renormalized with a float subtraction)
+    __m128i isDenormal = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+    __m128 denormal = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(o, _mm_set1_epi32(1 << 23))),
+                                 _mm_castsi128_ps(_mm_set1_epi32(int(HALF_NORMAL_MIN_BITS))));
+    o = select(isDenormal, _mm_castps_si128(denormal), o);
+
+    o = _mm_or_si128(o, _mm_slli_epi32(_mm_and_si128(halfs, _mm_set1_epi32(0x8000)), 16));
+    return _mm_castsi128_ps(o);
+}
+
+// Encode one channel of four linear colors into sRGB8 codes (one code per 32-bit lane).
+// The clamping and the bucket indices are computed in the registers and only the table
+// loads are scalar (there is no gather instruction in SSE2).
+static inline __m128i convertChannelToSRGB8SSE2(const SRGBTables& tables, __m128 values) {
+
+    // Clamp into the range of the buckets (a NaN gives the smallest value)
+    __m128 clamped = _mm_max_ps(values, _mm_castsi128_ps(_mm_set1_epi32(int(SRGB_MIN_BITS))));
+    clamped = _mm_min_ps(clamped, _mm_castsi128_ps(_mm_set1_epi32(int(SRGB_ALMOST_ONE_BITS))));
+    __m128i bits = _mm_castps_si128(clamped);
+
+    // Load the entries of the buckets
+    alignas(16) uint buckets[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(buckets),
+                    _mm_srli_epi32(_mm_sub_epi32(bits, _mm_set1_epi32(int(SRGB_MIN_BITS))),
+                                   SRGB_BUCKET_SHIFT));
+    __m128i entries = _mm_setr_epi32(int(tables.bucketEntries[buckets[0]]),
+                                     int(tables.bucketEntries[buckets[1]]),
+                                     int(tables.bucketEntries[buckets[2]]),
+                                     int(tables.bucketEntries[buckets[3]]));
+
+    // Add the offsets in the buckets (the sum carries into the code above the threshold)
+    __m128i offsets = _mm_and_si128(bits, _mm_set1_epi32(int(SRGB_BUCKET_OFFSET_MASK)));
+    return _mm_srli_epi32(_mm_add_epi32(entries, offsets), SRGB_BUCKET_SHIFT + 1);
+}
+
+#endif
+
+// Convert a float into a half float
+unsigned short FormatConversion::convertFloatToHalf(float value) {
+    uint f = getFloatBits(value);
+    uint sign = f & 0x80000000u;
+    f ^= sign;
+
+    uint o;
+    if (f >= HALF_OVERFLOW_BITS) {
+        o = (f > FLOAT_INFINITY_BITS) ? 0x7e00u : 0x7c00u;
+    }
+    else if (f < HALF_NORMAL_MIN_BITS) {
+        o = getFloatBits(getFloatFromBits(f) + getFloatFromBits(HALF_DENORMAL_MAGIC_BITS)) -
+            HALF_DENORMAL_MAGIC_BITS;
+    }
+    else {
+        uint mantissaOdd = (f >> 13) & 1u;
+        o = (f + HALF_NORMAL_BIAS + mantissaOdd) >> 13;
+    }
+
+    return (unsigned short)(o | (sign >> 16));
+}
+
+// Convert a half float into a float
+float FormatConversion::convertHalfToFloat(unsigned short half) {
+    const uint shiftedExponent = 0x7c00u << 13;
+    uint o = (uint(half) & 0x7fffu) << 13;
+    uint exponent = o & shiftedExponent;
+    o += (127u - 15u) << 23;
+
+    if (exponent == shiftedExponent) {
+        o += (128u - 16u) << 23;
+    }
+    else if (exponent == 0) {
+        o = getFloatBits(getFloatFromBits(o + (1u << 23)) - getFloatFromBits(HALF_NORMAL_MIN_BITS));
+    }
+
+    return getFloatFromBits(o | ((uint(half) & 0x8000u) << 16));
+}
+
+// Convert an array of floats into half floats
+void FormatConversion::convertFloatsToHalfs(const float* values, unsigned short* halfs,
+                                            uint nbValues) {
+    uint i = 0;
+#if defined(FORMAT_CONVERSION_USE_F16C)
+    for (; i + 8 <= nbValues; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(values + i), 0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(halfs + i), h);
+    }
+#elif defined(FORMAT_CONVERSION_USE_SSE2)
+    for (; i + 8 <= nbValues; i += 8) {
+        __m128i h0 = convertFloatsToHalfsSSE2(_mm_loadu_ps(values + i));
+        __m128i h1 = convertFloatsToHalfsSSE2(_mm_loadu_ps(values + i + 4));
+
+        // Sign-extend the 16-bit values so that the saturating pack keeps their bits
+        h0 = _mm_srai_epi32(_mm_slli_epi32(h0, 16), 16);
+        h1 = _mm_srai_epi32(_mm_slli_epi32(h1, 16), 16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(halfs + i), _mm_packs_epi32(h0, h1));
+    }
+#endif
+    for (; i < nbValues; i++) {
+        halfs[i] = convertFloatToHalf(values[i]);
+    }
+}
+
+// Convert an array of half floats into floats
+void FormatConversion::convertHalfsToFloats(const unsigned short* halfs, float* values,
+                                            uint nbValues) {
+    uint i = 0;
+#if defined(FORMAT_CONVERSION_USE_F16C)
+    for (; i + 8 <= nbValues; i += 8) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(halfs + i));
+        _mm256_storeu_ps(values + i, _mm256_cvtph_ps(h));
+    }
+#elif defined(FORMAT_CONVERSION_USE_SSE2)
+    for (; i + 8 <= nbValues; i += 8) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(halfs + i));
+        _mm_storeu_ps(values + i,
+                      convertHalfsToFloatsSSE2(_mm_unpacklo_epi16(h, _mm_setzero_si128())));
+        _mm_storeu_ps(values + i + 4,
+                      convertHalfsToFloatsSSE2(_mm_unpackhi_epi16(h, _mm_setzero_si128())));
+    }
+#endif
+    for (; i < nbValues; i++) {
+        values[i] = convertHalfToFloat(halfs[i]);
+    }
+}
+
+// Convert an array of colors into RGBA8 pixels (four bytes per color)
+void FormatConversion::convertColorsToRGBA8(const Color* colors, unsigned char* pixels,
+                                            uint nbColors) {
+    uint i = 0;
+#if defined(FORMAT_CONVERSION_USE_SSE2)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (; i + 4 <= nbColors; i += 4) {
+        __m128i c[4];
+        for (int k=0; k<4; k++) {
+            __m128 color = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&colors[i + k].r), zero), one);
+            c[k] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(color, scale), half));
+        }
+        __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(c[0], c[1]), _mm_packs_epi32(c[2], c[3]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + 4 * i), bytes);
+    }
+#endif
+    for (; i < nbColors; i++) {
+        const float* color = &colors[i].r;
+        for (int k=0; k<4; k++) {
+            pixels[4 * i + k] = (unsigned char)(int(clamp(color[k], 0.0f, 1.0f) * 255.0f + 0.5f));
+        }
+    }
+}
+
+// Convert an array of RGBA8 pixels into colors
+void FormatConversion::convertRGBA8ToColors(const unsigned char* pixels, Color* colors,
+                                            uint nbColors) {
+    const float scale = 1.0f / 255.0f;
+    uint i = 0;
+#if defined(FORMAT_CONVERSION_USE_SSE2)
+    const __m128 scales = _mm_set1_ps(scale);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= nbColors; i += 4) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 4 * i));
+        __m128i low = _mm_unpacklo_epi8(bytes, zero);
+        __m128i high = _mm_unpackhi_epi8(bytes, zero);
+        _mm_storeu_ps(&colors[i].r, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), scales));
+        _mm_storeu_ps(&colors[i + 1].r, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), scales));
+        _mm_storeu_ps(&colors[i + 2].r, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), scales));
+        _mm_storeu_ps(&colors[i + 3].r, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), scales));
+    }
+#endif
+    for (; i < nbColors; i++) {
+        const unsigned char* pixel = pixels + 4 * i;
+        colors[i] = Color(pixel[0] * scale, pixel[1] * scale, pixel[2] * scale, pixel[3] * scale);
+    }
+}
+
+// Convert an array of linear colors into sRGB8 pixels with a linear alpha
+void FormatConversion::convertColorsToSRGBA8(const Color* colors, unsigned char* pixels,
+                                             uint nbColors) {
+    const SRGBTables& tables = getSRGBTables();
+    uint i = 0;
+#if defined(FORMAT_CONVERSION_USE_SSE2)
+    for (; i + 4 <= nbColors; i += 4) {
+
+        // Load four colors into one register per channel
+        __m128 r = _mm_loadu_ps(&colors[i].r);
+        __m128 g = _mm_loadu_ps(&colors[i + 1].r);
+        __m128 b = _mm_loadu_ps(&colors[i + 2].r);
+        __m128 a = _mm_loadu_ps(&colors[i + 3].r);
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+
+        a = _mm_min_ps(_mm_max_ps(a, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        __m128i alpha = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(a, _mm_set1_ps(255.0f)),
+                                                    _mm_set1_ps(0.5f)));
+
+        // Pack the four codes of each color into one 32-bit lane
+        __m128i bytes = _mm_or_si128(
+                    _mm_or_si128(convertChannelToSRGB8SSE2(tables, r),
+                                 _mm_slli_epi32(convertChannelToSRGB8SSE2(tables, g), 8)),
+                    _mm_or_si128(_mm_slli_epi32(convertChannelToSRGB8SSE2(tables, b), 16),
+                                 _mm_slli_epi32(alpha, 24)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + 4 * i), bytes);
+    }
+#endif
+    for (; i < nbColors; i++) {
+        const Color& color = colors[i];
+        unsigned char* pixel = pixels + 4 * i;
+        pixel[0] = tables.encode(color.r);
+        pixel[1] = tables.encode(color.g);
+        pixel[2] = tables.encode(color.b);
+        pixel[3] = (unsigned char)(int(clamp(color.a, 0.0f, 1.0f) * 255.0f + 0.5f));
+    }
+}
+
+// Convert an array of sRGB8 pixels with a linear alpha into linear colors
+void FormatConversion::convertSRGBA8ToColors(const unsigned char* pixels, Color* colors,
+                                             uint nbColors) {
+    const SRGBTables& tables = getSRGBTables();
+    for (uint i=0; i<nbColors; i++) {
+        const unsigned char* pixel = pixels + 4 * i;
+        colors[i] = Color(tables.linearValues[pixel[0]], tables.linearValues[pixel[1]],
+                          tables.linearValues[pixel[2]], pixel[3] * (1.0f / 255.0f));
+    }
+}
+
+// Convert an array of vectors into signed normalized 10-10-10-2 values
+void FormatConversion::convertVectorsTo1010102(const Vector3* vectors, uint* packedVectors,
+                                               uint nbVectors) {
+    uint i = 0;
+#if defined(FORMAT_CONVERSION_USE_SSE2)
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(511.0f);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128i mask = _mm_set1_epi32(0x3ff);
+    for (; i + 4 <= nbVectors; i += 4) {
+
+        // Load four vectors (x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3) into one
+        // register per coordinate
+        const float* p = &vectors[i].x;
+        __m128 a = _mm_loadu_ps(p);
+        __m128 b = _mm_loadu_ps(p + 4);
+        __m128 c = _mm_loadu_ps(p + 8);
+        __m128 v[3];
+        v[0] = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)),
+                              _MM_SHUFFLE(2, 0, 3, 0));
+        v[1] = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+                              _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)),
+                              _MM_SHUFFLE(2, 0, 2, 0));
+        v[2] = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c,
+                              _MM_SHUFFLE(3, 0, 2, 0));
+
+        // Round to the nearest integer (half away from zero)
+        __m128i q[3];
+        for (int k=0; k<3; k++) {
+            __m128 value = _mm_min_ps(_mm_max_ps(v[k], minusOne), one);
+            __m128 rounding = _mm_or_ps(_mm_and_ps(value, signMask), half);
+            q[k] = _mm_and_si128(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), rounding)),
+                                 mask);
+        }
+        __m128i packed = _mm_or_si128(_mm_or_si128(q[0], _mm_slli_epi32(q[1], 10)),
+                                      _mm_slli_epi32(q[2], 20));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(packedVectors + i), packed);
+    }
+#endif
+    for (; i < nbVectors; i++) {
+        const float* v = &vectors[i].x;
+        uint packed = 0;
+        for (int k=0; k<3; k++) {
+            float value = clamp(v[k], -1.0f, 1.0f);
+            int q = int(value * 511.0f + (value >= 0.0f ? 0.5f : -0.5f));
+            packed |= (uint(q) & 0x3ffu) << (10 * k);
+        }
+        packedVectors[i] = packed;
+    }
+}
+
+// Convert an array of signed normalized 10-10-10-2 values into vectors
+void FormatConversion::convert1010102ToVectors(const uint* packedVectors, Vector3* vectors,
+                                               uint nbVectors) {
+    const float scale = 1.0f / 511.0f;
+    uint i = 0;
+#if defined(FORMAT_CONVERSION_USE_SSE2)
+    const __m128 scales = _mm_set1_ps(scale);
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+    for (; i + 4 <= nbVectors; i += 4) {
+        __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(packedVectors + i));
+
+        // Sign-extend the 10-bit values
+        __m128i qx = _mm_srai_epi32(_mm_slli_epi32(packed, 22), 22);
+        __m128i qy = _mm_srai_epi32(_mm_slli_epi32(packed, 12), 22);
+        __m128i qz = _mm_srai_epi32(_mm_slli_epi32(packed, 2), 22);
+        __m128 x = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(qx), scales), minusOne);
+        __m128 y = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(qy), scales), minusOne);
+        __m128 z = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(qz), scales), minusOne);
+
+        // Store the vectors (x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3)
+        float* p = &vectors[i].x;
+        _mm_storeu_ps(p, _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)),
+                                        _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)),
+                                        _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(p + 4, _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)),
+                                            _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)),
+                                            _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(p + 8, _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)),
+                                            _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)),
+                                            _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+#endif
+    for (; i < nbVectors; i++) {
+        uint packed = packedVectors[i];
+        float v[3];
+        for (int k=0; k<3; k++) {
+            int q = int(packed << (22 - 10 * k)) >> 22;
+            v[k] = std::max(q * scale, -1.0f);
+        }
+        vectors[i] = Vector3(v[0], v[1], v[2]);
+    }
+}
@@ -0,0 +1,102 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef FORMAT_CONVERSION_H
+#define FORMAT_CONVERSION_H
+
+// Libraries
+#include "definitions.h"
+#include "maths/Vector3.h"
+#include "maths/Color.h"
+
+namespace openglframework {
+
+// Class FormatConversion
+// This class contains bulk converters between floats and the packed formats used to
+// save memory in the vertex, texture and instance buffers:
+//  - 32-bit floats <-> 16-bit half floats (GL_HALF_FLOAT), with rounding to nearest
+//    even, denormals, infinities and NaNs (F16C instructions if available, SSE2 or
+//    scalar code otherwise)
+//  - Colors <-> RGBA8 (GL_RGBA8) and sRGB8 with linear alpha (GL_SRGB8_ALPHA8), the
+//    components are clamped to [0, 1] and rounded to the nearest value
+//  - Vectors <-> signed normalized 10-10-10-2 (GL_INT_2_10_10_10_REV with x in the low
+//    bits and w = 0), the components are clamped to [-1, 1]
+// The sRGB encoding is exact (the rounding is done in the sRGB space). The output
+// arrays must not overlap with the input arrays.
+class FormatConversion {
+
+    private:
+
+        // -------------------- Methods -------------------- //
+
+        // Private constructor (static class)
+        FormatConversion() {}
+
+    public:
+
+        // -------------------- Methods -------------------- //
+
+        // Convert a float into a half float
+        static unsigned short convertFloatToHalf(float value);
+
+        // Convert a half float into a float
+        static float convertHalfToFloat(unsigned short half);
+
+        // Convert an array of floats into half floats
+        static void convertFloatsToHalfs(const float* values, unsigned short* halfs,
+                                         uint nbValues);
+
+        // Convert an array of half floats into floats
+        static void convertHalfsToFloats(const unsigned short* halfs, float* values,
+                                         uint nbValues);
+
+        // Convert an array of colors into RGBA8 pixels (four bytes per color)
+        static void convertColorsToRGBA8(const Color* colors, unsigned char* pixels,
+                                         uint nbColors);
+
+        // Convert an array of RGBA8 pixels into colors
+        static void convertRGBA8ToColors(const unsigned char* pixels, Color* colors,
+                                         uint nbColors);
+
+        // Convert an array of linear colors into sRGB8 pixels with a linear alpha
+        static void convertColorsToSRGBA8(const Color* colors, unsigned char* pixels,
+                                          uint nbColors);
+
+        // Convert an array of sRGB8 pixels with a linear alpha into linear colors
+        static void convertSRGBA8ToColors(const unsigned char* pixels, Color* colors,
+                                          uint nbColors);
+
+        // Convert an array of vectors into signed normalized 10-10-10-2 values
+        static void convertVectorsTo1010102(const Vector3* vectors, uint* packedVectors,
+                                            uint nbVectors);
+
+        // Convert an array of signed normalized 10-10-10-2 values into vectors
+        static void convert1010102ToVectors(const uint* packedVectors, Vector3* vectors,
+                                            uint nbVectors);
+};
+
+}
+
+#endif
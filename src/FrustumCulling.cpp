@@ -0,0 +1,197 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "FrustumCulling.h"
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_CULLING_WIDTH 8
+#elif defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define FRUSTUM_CULLING_WIDTH 4
+#else
+#define FRUSTUM_CULLING_WIDTH 1
+#endif
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Add the indices of the set bits of a visibility mask to the list of visible indices
+static inline void addVisibleIndices(uint firstIndex, int mask, vector<uint>& visibleIndices) {
+    while (mask != 0) {
+        int bit = 0;
+        while (!(mask & (1 << bit))) bit++;
+        visibleIndices.push_back(firstIndex + bit);
+        mask &= ~(1 << bit);
+    }
+}
+
+// Find the spheres that are inside or intersect the frustum
+void FrustumCulling::cullSpheres(const Frustum& frustum, const SphereBatch& spheres,
+                                 vector<uint>& visibleIndices) {
+
+    visibleIndices.clear();
+    const uint nbSpheres = spheres.size();
+    uint i = 0;
+
+#if FRUSTUM_CULLING_WIDTH == 8
+
+    __m256 planeX[Frustum::NB_PLANES], planeY[Frustum::NB_PLANES];
+    __m256 planeZ[Frustum::NB_PLANES], planeW[Frustum::NB_PLANES];
+    for (int p=0; p<Frustum::NB_PLANES; p++) {
+        planeX[p] = _mm256_set1_ps(frustum.planes[p].x);
+        planeY[p] = _mm256_set1_ps(frustum.planes[p].y);
+        planeZ[p] = _mm256_set1_ps(frustum.planes[p].z);
+        planeW[p] = _mm256_set1_ps(frustum.planes[p].w);
+    }
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+    for (; i + 8 <= nbSpheres; i += 8) {
+        __m256 x = _mm256_loadu_ps(&spheres.centerX[i]);
+        __m256 y = _mm256_loadu_ps(&spheres.centerY[i]);
+        __m256 z = _mm256_loadu_ps(&spheres.centerZ[i]);
+        __m256 negativeRadius = _mm256_xor_ps(_mm256_loadu_ps(&spheres.radius[i]), signMask);
+        __m256 isVisible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p=0; p<Frustum::NB_PLANES; p++) {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planeX[p], x),
+                                                          _mm256_mul_ps(planeY[p], y)),
+                                            _mm256_add_ps(_mm256_mul_ps(planeZ[p], z), planeW[p]));
+            isVisible = _mm256_and_ps(isVisible, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+        }
+        addVisibleIndices(i, _mm256_movemask_ps(isVisible), visibleIndices);
+    }
+
+#elif FRUSTUM_CULLING_WIDTH == 4
+
+    __m128 planeX[Frustum::NB_PLANES], planeY[Frustum::NB_PLANES];
+    __m128 planeZ[Frustum::NB_PLANES], planeW[Frustum::NB_PLANES];
+    for (int p=0; p<Frustum::NB_PLANES; p++) {
+        planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+        planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+        planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+        planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+    }
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+
+    for (; i + 4 <= nbSpheres; i += 4) {
+        __m128 x = _mm_loadu_ps(&spheres.centerX[i]);
+        __m128 y = _mm_loadu_ps(&spheres.centerY[i]);
+        __m128 z = _mm_loadu_ps(&spheres.centerZ[i]);
+        __m128 negativeRadius = _mm_xor_ps(_mm_loadu_ps(&spheres.radius[i]), signMask);
+        __m128 isVisible = _mm_cmpeq_ps(x, x);
+        for (int p=0; p<Frustum::NB_PLANES; p++) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], x),
+                                                    _mm_mul_ps(planeY[p], y)),
+                                         _mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+            isVisible = _mm_and_ps(isVisible, _mm_cmpge_ps(distance, negativeRadius));
+        }
+        addVisibleIndices(i, _mm_movemask_ps(isVisible), visibleIndices);
+    }
+
+#endif
+
+    // Test the remaining spheres one by one
+    for (; i<nbSpheres; i++) {
+        bool isVisible = true;
+        for (int p=0; p<Frustum::NB_PLANES && isVisible; p++) {
+            const Vector4& plane = frustum.planes[p];
+            float distance = plane.x * spheres.centerX[i] + plane.y * spheres.centerY[i] +
+                             plane.z * spheres.centerZ[i] + plane.w;
+            isVisible = distance >= -spheres.radius[i];
+        }
+        if (isVisible) visibleIndices.push_back(i);
+    }
+}
+
+// Find the boxes that are inside or intersect the frustum. For each plane, only the
+// corner of the box that is the farthest along the normal of the plane is tested.
+// This corner is selected once per plane for the whole batch.
+void FrustumCulling::cullAABBs(const Frustum& frustum, const AABBBatch& aabbs,
+                               vector<uint>& visibleIndices) {
+
+    visibleIndices.clear();
+    const uint nbAABBs = aabbs.size();
+    if (nbAABBs == 0) return;
+    uint i = 0;
+
+    // Coordinates of the farthest corner along the normal of each plane
+    const float* cornerX[Frustum::NB_PLANES];
+    const float* cornerY[Frustum::NB_PLANES];
+    const float* cornerZ[Frustum::NB_PLANES];
+    for (int p=0; p<Frustum::NB_PLANES; p++) {
+        cornerX[p] = (frustum.planes[p].x >= 0.0f) ? &aabbs.maxX[0] : &aabbs.minX[0];
+        cornerY[p] = (frustum.planes[p].y >= 0.0f) ? &aabbs.maxY[0] : &aabbs.minY[0];
+        cornerZ[p] = (frustum.planes[p].z >= 0.0f) ? &aabbs.maxZ[0] : &aabbs.minZ[0];
+    }
+
+#if FRUSTUM_CULLING_WIDTH == 8
+
+    const __m256 zero = _mm256_setzero_ps();
+    for (; i + 8 <= nbAABBs; i += 8) {
+        __m256 isVisible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p=0; p<Frustum::NB_PLANES; p++) {
+            const Vector4& plane = frustum.planes[p];
+            __m256 distance = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), _mm256_loadu_ps(cornerX[p] + i)),
+                                  _mm256_mul_ps(_mm256_set1_ps(plane.y), _mm256_loadu_ps(cornerY[p] + i))),
+                    _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.z), _mm256_loadu_ps(cornerZ[p] + i)),
+                                  _mm256_set1_ps(plane.w)));
+            isVisible = _mm256_and_ps(isVisible, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+        }
+        addVisibleIndices(i, _mm256_movemask_ps(isVisible), visibleIndices);
+    }
+
+#elif FRUSTUM_CULLING_WIDTH == 4
+
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= nbAABBs; i += 4) {
+        __m128 isVisible = _mm_cmpeq_ps(zero, zero);
+        for (int p=0; p<Frustum::NB_PLANES; p++) {
+            const Vector4& plane = frustum.planes[p];
+            __m128 distance = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), _mm_loadu_ps(cornerX[p] + i)),
+                               _mm_mul_ps(_mm_set1_ps(plane.y), _mm_loadu_ps(cornerY[p] + i))),
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), _mm_loadu_ps(cornerZ[p] + i)),
+                               _mm_set1_ps(plane.w)));
+            isVisible = _mm_and_ps(isVisible, _mm_cmpge_ps(distance, zero));
+        }
+        addVisibleIndices(i, _mm_movemask_ps(isVisible), visibleIndices);
+    }
+
+#endif
+
+    // Test the remaining boxes one by one
+    for (; i<nbAABBs; i++) {
+        bool isVisible = true;
+        for (int p=0; p<Frustum::NB_PLANES && isVisible; p++) {
+            const Vector4& plane = frustum.planes[p];
+            float distance = plane.x * cornerX[p][i] + plane.y * cornerY[p][i] +
+                             plane.z * cornerZ[p][i] + plane.w;
+            isVisible = distance >= 0.0f;
+        }
+        if (isVisible) visibleIndices.push_back(i);
+    }
+}
@@ -0,0 +1,150 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef FRUSTUM_CULLING_H
+#define FRUSTUM_CULLING_H
+
+// Libraries
+#include <vector>
+#include "definitions.h"
+#include "maths/AABB.h"
+#include "maths/BoundingSphere.h"
+#include "maths/Frustum.h"
+
+namespace openglframework {
+
+// Class SphereBatch
+// This class represents an array of bounding spheres stored as structure of arrays
+class SphereBatch {
+
+    public:
+
+        // -------------------- Attributes -------------------- //
+
+        // Centers of the spheres
+        std::vector<float> centerX, centerY, centerZ;
+
+        // Radius of the spheres
+        std::vector<float> radius;
+
+        // -------------------- Methods -------------------- //
+
+        // Add a sphere
+        void add(const BoundingSphere& sphere) {
+            centerX.push_back(sphere.center.x);
+            centerY.push_back(sphere.center.y);
+            centerZ.push_back(sphere.center.z);
+            radius.push_back(sphere.radius);
+        }
+
+        // Set a sphere
+        void set(uint i, const BoundingSphere& sphere) {
+            centerX[i] = sphere.center.x;
+            centerY[i] = sphere.center.y;
+            centerZ[i] = sphere.center.z;
+            radius[i] = sphere.radius;
+        }
+
+        // Remove all the spheres
+        void clear() {
+            centerX.clear(); centerY.clear(); centerZ.clear();
+            radius.clear();
+        }
+
+        // Return the number of spheres
+        uint size() const {
+            return radius.size();
+        }
+};
+
+// Class AABBBatch
+// This class represents an array of axis-aligned boxes stored as structure of arrays
+class AABBBatch {
+
+    public:
+
+        // -------------------- Attributes -------------------- //
+
+        // Minimum coordinates of the boxes
+        std::vector<float> minX, minY, minZ;
+
+        // Maximum coordinates of the boxes
+        std::vector<float> maxX, maxY, maxZ;
+
+        // -------------------- Methods -------------------- //
+
+        // Add a box
+        void add(const AABB& aabb) {
+            minX.push_back(aabb.min.x); minY.push_back(aabb.min.y); minZ.push_back(aabb.min.z);
+            maxX.push_back(aabb.max.x); maxY.push_back(aabb.max.y); maxZ.push_back(aabb.max.z);
+        }
+
+        // Set a box
+        void set(uint i, const AABB& aabb) {
+            minX[i] = aabb.min.x; minY[i] = aabb.min.y; minZ[i] = aabb.min.z;
+            maxX[i] = aabb.max.x; maxY[i] = aabb.max.y; maxZ[i] = aabb.max.z;
+        }
+
+        // Remove all the boxes
+        void clear() {
+            minX.clear(); minY.clear(); minZ.clear();
+            maxX.clear(); maxY.clear(); maxZ.clear();
+        }
+
+        // Return the number of boxes
+        uint size() const {
+            return minX.size();
+        }
+};
+
+// Class FrustumCulling
+// This class tests batches of bounding volumes against a view frustum and outputs
+// the indices of the visible ones. The volumes are tested eight at a time with AVX
+// (if the library is compiled with AVX enabled) or four at a time with SSE.
+class FrustumCulling {
+
+    private :
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor (private because we do not want instances of this class)
+        FrustumCulling();
+
+    public :
+
+        // -------------------- Methods -------------------- //
+
+        // Find the spheres that are inside or intersect the frustum
+        static void cullSpheres(const Frustum& frustum, const SphereBatch& spheres,
+                                std::vector<uint>& visibleIndices);
+
+        // Find the boxes that are inside or intersect the frustum
+        static void cullAABBs(const Frustum& frustum, const AABBBatch& aabbs,
+                              std::vector<uint>& visibleIndices);
+};
+
+}
+
+#endif
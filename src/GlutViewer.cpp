@@ -26,6 +26,7 @@
 // Libraries
 #include "GlutViewer.h"
 #include <string>
+#include <algorithm>
 
 // Namespaces
 using namespace openglframework;
@@ -235,6 +236,97 @@ void GlutViewer::rotate(int xMouse, int yMouse) {
     }
 }
 
+// Add a mesh that can be picked (a BVH of the mesh is built)
+void GlutViewer::addPickableMesh(const Mesh* mesh) {
+    assert(find(mPickableMeshes.begin(), mPickableMeshes.end(), mesh) == mPickableMeshes.end());
+    mPickableMeshes.push_back(mesh);
+    mPickableMeshBVHs.push_back(std::unique_ptr<MeshBVH>(new MeshBVH(*mesh, true)));
+}
+
+// Rebuild the BVH of a pickable mesh after its vertices have changed
+void GlutViewer::updatePickableMesh(const Mesh* mesh) {
+    for (uint i=0; i<mPickableMeshes.size(); i++) {
+        if (mPickableMeshes[i] == mesh) {
+            mPickableMeshBVHs[i]->build(*mesh, true);
+            return;
+        }
+    }
+}
+
+// Remove a pickable mesh
+void GlutViewer::removePickableMesh(const Mesh* mesh) {
+    for (uint i=0; i<mPickableMeshes.size(); i++) {
+        if (mPickableMeshes[i] == mesh) {
+            mPickableMeshes.erase(mPickableMeshes.begin() + i);
+            mPickableMeshBVHs.erase(mPickableMeshBVHs.begin() + i);
+            return;
+        }
+    }
+}
+
+// Return the world-space ray that goes through a pixel of the window
+Ray GlutViewer::computePickingRay(int xMouse, int yMouse) const {
+
+    // Normalized device coordinates of the center of the pixel
+    float x = 2.0f * (xMouse + 0.5f) / float(mCamera.getWidth()) - 1.0f;
+    float y = 1.0f - 2.0f * (yMouse + 0.5f) / float(mCamera.getHeight());
+
+    // Unproject the points on the near and far planes into world-space (the inverse
+    // view-projection matrix is not inverted here but composed from the cached
+    // inverse projection and the camera transform)
+    Matrix4 clipToWorld = mCamera.getInverseViewProjectionMatrix();
+    Vector4 nearPoint = clipToWorld * Vector4(x, y, -1.0f, 1.0f);
+    Vector4 farPoint = clipToWorld * Vector4(x, y, 1.0f, 1.0f);
+    Vector3 nearWorld = Vector3(nearPoint.x, nearPoint.y, nearPoint.z) / nearPoint.w;
+    Vector3 farWorld = Vector3(farPoint.x, farPoint.y, farPoint.z) / farPoint.w;
+
+    Vector3 direction = farWorld - nearWorld;
+    float length = direction.length();
+    return Ray(nearWorld, direction / length, length);
+}
+
+// Pick the closest mesh under a pixel of the window
+bool GlutViewer::pick(int xMouse, int yMouse, PickingHit& hit) const {
+    return pick(computePickingRay(xMouse, yMouse), hit);
+}
+
+// Pick the closest mesh hit by a world-space ray
+bool GlutViewer::pick(const Ray& ray, PickingHit& hit) const {
+
+    bool isHit = false;
+    float closestDistance = ray.maxDistance;
+
+    for (uint i=0; i<mPickableMeshes.size(); i++) {
+
+        const Mesh* mesh = mPickableMeshes[i];
+
+        // Transform the ray into the local-space of the mesh. The local direction is
+        // not normalized so that the distances along the ray stay in world-space.
+        Matrix4 worldToLocal = mesh->getInverseTransformMatrix();
+        Vector3 localOrigin = worldToLocal * ray.origin;
+        Vector3 localDirection = worldToLocal * (ray.origin + ray.direction) - localOrigin;
+        Ray localRay(localOrigin, localDirection, closestDistance);
+
+        RaycastHit meshHit;
+        if (mPickableMeshBVHs[i]->raycast(localRay, meshHit)) {
+            closestDistance = meshHit.distance;
+            hit.mesh = mesh;
+            hit.part = meshHit.part;
+            hit.triangle = meshHit.face;
+            hit.u = meshHit.u;
+            hit.v = meshHit.v;
+            hit.distance = meshHit.distance;
+            isHit = true;
+        }
+    }
+
+    if (isHit) {
+        hit.point = ray.getPoint(hit.distance);
+    }
+
+    return isHit;
+}
+
 // Check the OpenGL errors
 void GlutViewer::checkOpenGLErrors() {
     GLenum glError;
@@ -29,13 +29,42 @@
 // Libraries
 #include "Shader.h"
 #include "Camera.h"
+#include "Mesh.h"
+#include "MeshBVH.h"
 #include "maths/Vector2.h"
+#include "maths/Ray.h"
 #include <string>
+#include <vector>
+#include <memory>
 #include <GL/glew.h>
 #include "GL/freeglut.h"
 
 namespace openglframework {
 
+// Class PickingHit
+// This class contains the result of a picking query in the viewer
+class PickingHit {
+
+    public:
+        PickingHit() : mesh(NULL), part(0), triangle(0), u(0), v(0), distance(0) {}
+
+        // Picked mesh
+        const Mesh* mesh;
+
+        // Part of the mesh and index of the picked triangle in this part
+        uint part;
+        uint triangle;
+
+        // Barycentric coordinates of the hit point in the triangle
+        float u, v;
+
+        // Distance from the camera along the picking ray (world-space)
+        float distance;
+
+        // Hit point (world-space)
+        Vector3 point;
+};
+
 // Class Renderer
 class GlutViewer {
 
@@ -64,6 +93,12 @@ class GlutViewer {
         // GLUT keyboard modifiers
         int mModifiers;
 
+        // Meshes that can be picked
+        std::vector<const Mesh*> mPickableMeshes;
+
+        // BVH of each pickable mesh (local-space of the mesh)
+        std::vector<std::unique_ptr<MeshBVH> > mPickableMeshBVHs;
+
         // -------------------- Methods -------------------- //
 
         // Initialize the GLUT library
@@ -123,6 +158,24 @@ class GlutViewer {
         void keyboard(int key, int x, int y);
         void special(int key, int x, int y);
 
+        // Add a mesh that can be picked (a BVH of the mesh is built)
+        void addPickableMesh(const Mesh* mesh);
+
+        // Rebuild the BVH of a pickable mesh after its vertices have changed
+        void updatePickableMesh(const Mesh* mesh);
+
+        // Remove a pickable mesh
+        void removePickableMesh(const Mesh* mesh);
+
+        // Return the world-space ray that goes through a pixel of the window
+        Ray computePickingRay(int xMouse, int yMouse) const;
+
+        // Pick the closest mesh under a pixel of the window
+        bool pick(int xMouse, int yMouse, PickingHit& hit) const;
+
+        // Pick the closest mesh hit by a world-space ray
+        bool pick(const Ray& ray, PickingHit& hit) const;
+
         // Check the OpenGL errors
         static void checkOpenGLErrors();
 };
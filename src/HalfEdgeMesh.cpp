@@ -0,0 +1,186 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "HalfEdgeMesh.h"
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Constants
+const uint HalfEdgeMesh::INVALID_INDEX;
+
+// Constructor
+HalfEdgeMesh::HalfEdgeMesh() {
+
+}
+
+// Constructor
+HalfEdgeMesh::HalfEdgeMesh(const Mesh& mesh, uint part) {
+    build(mesh, part);
+}
+
+// Destructor
+HalfEdgeMesh::~HalfEdgeMesh() {
+
+}
+
+// Build the half-edge structure from a part of a mesh
+void HalfEdgeMesh::build(const Mesh& mesh, uint part) {
+    assert(part < mesh.getNbParts());
+    build(mesh.getIndices(part), mesh.getNbVertices());
+}
+
+// Build the half-edge structure from an array of triangle indices
+void HalfEdgeMesh::build(const vector<uint>& indices, uint nbVertices) {
+
+    assert(indices.size() % 3 == 0);
+
+    destroy();
+
+    mStartVertices = indices;
+    const uint nbHalfEdges = getNbHalfEdges();
+    mTwins.assign(nbHalfEdges, INVALID_INDEX);
+    mVertexHalfEdges.assign(nbVertices, INVALID_INDEX);
+
+    // ---------- Hash table of the directed edges ---------- //
+
+    // Open addressing table with a load factor of at most 0.5. Each slot contains
+    // the first half-edge that has been inserted for a given directed edge.
+    uint tableSize = 16;
+    while (tableSize < 2 * nbHalfEdges) tableSize *= 2;
+    const uint mask = tableSize - 1;
+    vector<uint> table(tableSize, INVALID_INDEX);
+
+    // True if another half-edge has the same start and end vertices
+    vector<bool> isDuplicated(nbHalfEdges, false);
+
+    // Insert all the half-edges into the table
+    for (uint h=0; h<nbHalfEdges; h++) {
+
+        uint v1 = getStartVertex(h);
+        uint v2 = getEndVertex(h);
+        assert(v1 < nbVertices && v2 < nbVertices);
+
+        uint slot = hashEdge(v1, v2) & mask;
+        while (table[slot] != INVALID_INDEX) {
+            uint other = table[slot];
+            if (getStartVertex(other) == v1 && getEndVertex(other) == v2) {
+
+                // The directed edge is used by more than one face
+                isDuplicated[other] = true;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+        if (table[slot] == INVALID_INDEX) {
+            table[slot] = h;
+        }
+    }
+
+    // ---------- Find the twin of each half-edge ---------- //
+
+    for (uint h=0; h<nbHalfEdges; h++) {
+
+        uint v1 = getStartVertex(h);
+        uint v2 = getEndVertex(h);
+
+        // Find the half-edge stored for the same directed edge and the one
+        // stored for the opposite directed edge
+        uint same = INVALID_INDEX;
+        uint opposite = INVALID_INDEX;
+        for (uint slot = hashEdge(v1, v2) & mask; table[slot] != INVALID_INDEX;
+             slot = (slot + 1) & mask) {
+            uint other = table[slot];
+            if (getStartVertex(other) == v1 && getEndVertex(other) == v2) {
+                same = other;
+                break;
+            }
+        }
+        for (uint slot = hashEdge(v2, v1) & mask; table[slot] != INVALID_INDEX;
+             slot = (slot + 1) & mask) {
+            uint other = table[slot];
+            if (getStartVertex(other) == v2 && getEndVertex(other) == v1) {
+                opposite = other;
+                break;
+            }
+        }
+        assert(same != INVALID_INDEX);
+
+        // If the edge is shared by more than two faces or by two faces with an
+        // inconsistent orientation, the edge is non-manifold
+        bool isNonManifold = isDuplicated[same] ||
+                             (opposite != INVALID_INDEX && isDuplicated[opposite]);
+        if (isNonManifold) {
+
+            // Report each non-manifold edge only once
+            if (h == same && (opposite == INVALID_INDEX || v1 < v2)) {
+                mNonManifoldEdges.push_back(h);
+            }
+        }
+        else {
+            mTwins[h] = opposite;
+        }
+    }
+
+    // ---------- Outgoing half-edge of each vertex ---------- //
+
+    // We prefer a boundary half-edge so that the one-ring iteration
+    // starting at this half-edge visits the whole fan of faces
+    for (uint h=0; h<nbHalfEdges; h++) {
+        uint v = getStartVertex(h);
+        if (mVertexHalfEdges[v] == INVALID_INDEX || mTwins[h] == INVALID_INDEX) {
+            mVertexHalfEdges[v] = h;
+        }
+    }
+}
+
+// Destroy the half-edge structure
+void HalfEdgeMesh::destroy() {
+    mStartVertices.clear();
+    mTwins.clear();
+    mVertexHalfEdges.clear();
+    mNonManifoldEdges.clear();
+}
+
+// Return the number of neighbor vertices of a vertex
+uint HalfEdgeMesh::getVertexValence(uint vertex) const {
+
+    uint start = getVertexHalfEdge(vertex);
+    if (start == INVALID_INDEX) return 0;
+
+    uint valence = 0;
+    uint h = start;
+    do {
+        valence++;
+        h = getNextOutgoingHalfEdge(h);
+    } while (h != INVALID_INDEX && h != start);
+
+    // On the boundary, the last neighbor is only reached by an incoming half-edge
+    if (h == INVALID_INDEX) valence++;
+
+    return valence;
+}
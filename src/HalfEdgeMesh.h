@@ -0,0 +1,247 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef HALF_EDGE_MESH_H
+#define HALF_EDGE_MESH_H
+
+// Libraries
+#include <vector>
+#include <cassert>
+#include "definitions.h"
+#include "Mesh.h"
+
+namespace openglframework {
+
+// Class HalfEdgeMesh
+// This class represents the adjacency information of one part of a triangular
+// Mesh using half-edges. Everything is stored in flat arrays of 32-bit indices.
+// The half-edge 3*f+i of the face f goes from the ith vertex of the face to the
+// next one, so that the next, previous and face of a half-edge are implicit and
+// only the twin half-edges have to be stored. The structure is built in linear
+// time using a hash table on the directed edges. An edge shared by more than two
+// faces (or by two faces with inconsistent orientations) is reported as non-manifold
+// and its half-edges are left without twin (as if they were on the boundary).
+//
+// One-ring iteration around a vertex v :
+//
+//     uint start = halfEdgeMesh.getVertexHalfEdge(v);
+//     uint h = start;
+//     do {
+//         uint neighbor = halfEdgeMesh.getEndVertex(h);
+//         ...
+//         h = halfEdgeMesh.getNextOutgoingHalfEdge(h);
+//     } while (h != HalfEdgeMesh::INVALID_INDEX && h != start);
+class HalfEdgeMesh {
+
+    public:
+
+        // -------------------- Constants -------------------- //
+
+        // Index used for a missing half-edge (boundary) or an isolated vertex
+        static const uint INVALID_INDEX = 0xffffffff;
+
+    private:
+
+        // -------------------- Attributes -------------------- //
+
+        // Vertex index at the start of each half-edge (copy of the part indices)
+        std::vector<uint> mStartVertices;
+
+        // Twin half-edge of each half-edge (INVALID_INDEX on the boundary)
+        std::vector<uint> mTwins;
+
+        // One outgoing half-edge for each vertex (a boundary one if there is one)
+        std::vector<uint> mVertexHalfEdges;
+
+        // One half-edge of each non-manifold edge
+        std::vector<uint> mNonManifoldEdges;
+
+        // -------------------- Methods -------------------- //
+
+        // Return the hash of a directed edge
+        static uint hashEdge(uint v1, uint v2);
+
+    public:
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor
+        HalfEdgeMesh();
+
+        // Constructor
+        HalfEdgeMesh(const Mesh& mesh, uint part = 0);
+
+        // Destructor
+        ~HalfEdgeMesh();
+
+        // Build the half-edge structure from a part of a mesh
+        void build(const Mesh& mesh, uint part = 0);
+
+        // Build the half-edge structure from an array of triangle indices
+        void build(const std::vector<uint>& indices, uint nbVertices);
+
+        // Destroy the half-edge structure
+        void destroy();
+
+        // Return the number of half-edges
+        uint getNbHalfEdges() const;
+
+        // Return the number of faces
+        uint getNbFaces() const;
+
+        // Return the number of vertices
+        uint getNbVertices() const;
+
+        // Return the face of a half-edge
+        uint getFace(uint halfEdge) const;
+
+        // Return the next half-edge in the face
+        uint getNext(uint halfEdge) const;
+
+        // Return the previous half-edge in the face
+        uint getPrevious(uint halfEdge) const;
+
+        // Return the twin half-edge (INVALID_INDEX on the boundary)
+        uint getTwin(uint halfEdge) const;
+
+        // Return the vertex at the start of a half-edge
+        uint getStartVertex(uint halfEdge) const;
+
+        // Return the vertex at the end of a half-edge
+        uint getEndVertex(uint halfEdge) const;
+
+        // Return an outgoing half-edge of a vertex (INVALID_INDEX for an isolated vertex)
+        uint getVertexHalfEdge(uint vertex) const;
+
+        // Return the next outgoing half-edge around the start vertex of a half-edge
+        // (INVALID_INDEX when the boundary is reached)
+        uint getNextOutgoingHalfEdge(uint halfEdge) const;
+
+        // Return true if the half-edge is on the boundary
+        bool isBoundaryHalfEdge(uint halfEdge) const;
+
+        // Return true if the vertex is on the boundary
+        bool isBoundaryVertex(uint vertex) const;
+
+        // Return the number of neighbor vertices of a vertex
+        uint getVertexValence(uint vertex) const;
+
+        // Return one half-edge of each non-manifold edge
+        const std::vector<uint>& getNonManifoldEdges() const;
+
+        // Return true if the mesh part does not contain any non-manifold edge
+        bool isManifold() const;
+};
+
+// Return the hash of a directed edge
+inline uint HalfEdgeMesh::hashEdge(uint v1, uint v2) {
+    return (v1 * 73856093u) ^ (v2 * 19349663u);
+}
+
+// Return the number of half-edges
+inline uint HalfEdgeMesh::getNbHalfEdges() const {
+    return mStartVertices.size();
+}
+
+// Return the number of faces
+inline uint HalfEdgeMesh::getNbFaces() const {
+    return mStartVertices.size() / 3;
+}
+
+// Return the number of vertices
+inline uint HalfEdgeMesh::getNbVertices() const {
+    return mVertexHalfEdges.size();
+}
+
+// Return the face of a half-edge
+inline uint HalfEdgeMesh::getFace(uint halfEdge) const {
+    return halfEdge / 3;
+}
+
+// Return the next half-edge in the face
+inline uint HalfEdgeMesh::getNext(uint halfEdge) const {
+    return (halfEdge % 3 == 2) ? halfEdge - 2 : halfEdge + 1;
+}
+
+// Return the previous half-edge in the face
+inline uint HalfEdgeMesh::getPrevious(uint halfEdge) const {
+    return (halfEdge % 3 == 0) ? halfEdge + 2 : halfEdge - 1;
+}
+
+// Return the twin half-edge (INVALID_INDEX on the boundary)
+inline uint HalfEdgeMesh::getTwin(uint halfEdge) const {
+    assert(halfEdge < getNbHalfEdges());
+    return mTwins[halfEdge];
+}
+
+// Return the vertex at the start of a half-edge
+inline uint HalfEdgeMesh::getStartVertex(uint halfEdge) const {
+    assert(halfEdge < getNbHalfEdges());
+    return mStartVertices[halfEdge];
+}
+
+// Return the vertex at the end of a half-edge
+inline uint HalfEdgeMesh::getEndVertex(uint halfEdge) const {
+    return getStartVertex(getNext(halfEdge));
+}
+
+// Return an outgoing half-edge of a vertex (INVALID_INDEX for an isolated vertex)
+inline uint HalfEdgeMesh::getVertexHalfEdge(uint vertex) const {
+    assert(vertex < getNbVertices());
+    return mVertexHalfEdges[vertex];
+}
+
+// Return the next outgoing half-edge around the start vertex of a half-edge
+// (INVALID_INDEX when the boundary is reached)
+inline uint HalfEdgeMesh::getNextOutgoingHalfEdge(uint halfEdge) const {
+    return getTwin(getPrevious(halfEdge));
+}
+
+// Return true if the half-edge is on the boundary
+inline bool HalfEdgeMesh::isBoundaryHalfEdge(uint halfEdge) const {
+    return getTwin(halfEdge) == INVALID_INDEX;
+}
+
+// Return true if the vertex is on the boundary
+inline bool HalfEdgeMesh::isBoundaryVertex(uint vertex) const {
+
+    // The outgoing half-edge of a boundary vertex is always a boundary one
+    uint halfEdge = getVertexHalfEdge(vertex);
+    return halfEdge == INVALID_INDEX || isBoundaryHalfEdge(halfEdge);
+}
+
+// Return one half-edge of each non-manifold edge
+inline const std::vector<uint>& HalfEdgeMesh::getNonManifoldEdges() const {
+    return mNonManifoldEdges;
+}
+
+// Return true if the mesh part does not contain any non-manifold edge
+inline bool HalfEdgeMesh::isManifold() const {
+    return mNonManifoldEdges.empty();
+}
+
+}
+
+#endif
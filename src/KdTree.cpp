@@ -0,0 +1,296 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "KdTree.h"
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+using namespace openglframework;
+using namespace std;
+
+// Comparison of the points by their coordinate along an axis
+struct PointComparison {
+
+    const vector<Vector3>& points;
+    int axis;
+
+    PointComparison(const vector<Vector3>& points, int axis) : points(points), axis(axis) {}
+
+    bool operator()(uint index1, uint index2) const {
+        return points[index1][axis] < points[index2][axis];
+    }
+};
+
+// Constructor
+KdTree::KdTree() {
+
+}
+
+// Constructor
+KdTree::KdTree(const vector<Vector3>& points) {
+    build(points);
+}
+
+// Destructor
+KdTree::~KdTree() {
+
+}
+
+// Build the tree over a set of points
+void KdTree::build(const vector<Vector3>& points) {
+
+    destroy();
+
+    const uint nbPoints = points.size();
+    if (nbPoints == 0) return;
+
+    // Compute the number of leaves (a power of two) so that each leaf
+    // contains at most MAX_LEAF_SIZE points
+    uint nbLeaves = 1;
+    while (nbPoints > nbLeaves * MAX_LEAF_SIZE) nbLeaves *= 2;
+    mNodes.resize(nbLeaves - 1);
+    mLeafFirstPoints.resize(nbLeaves + 1);
+    mLeafFirstPoints[nbLeaves] = nbPoints;
+
+    // Build the tree
+    vector<uint> indices(nbPoints);
+    for (uint i=0; i<nbPoints; i++) indices[i] = i;
+    #pragma omp parallel
+    {
+        #pragma omp single
+        buildSubtree(0, 0, nbPoints, indices, points);
+    }
+
+    // Copy the points in the leaf order
+    mPoints.resize(nbPoints);
+    #pragma omp parallel for
+    for (int i=0; i<int(nbPoints); i++) {
+        mPoints[i] = points[indices[i]];
+    }
+    mPointIndices.swap(indices);
+}
+
+// Build the subtree of a range of points
+void KdTree::buildSubtree(uint nodeIndex, uint begin, uint end, vector<uint>& indices,
+                          const vector<Vector3>& points) {
+
+    // If the node is a leaf
+    const uint nbInternalNodes = mNodes.size();
+    if (nodeIndex >= nbInternalNodes) {
+        mLeafFirstPoints[nodeIndex - nbInternalNodes] = begin;
+        return;
+    }
+
+    // Compute the bounds of the points
+    Vector3 min = points[indices[begin]];
+    Vector3 max = min;
+    for (uint i=begin + 1; i<end; i++) {
+        const Vector3& point = points[indices[i]];
+        min.x = std::min(min.x, point.x); max.x = std::max(max.x, point.x);
+        min.y = std::min(min.y, point.y); max.y = std::max(max.y, point.y);
+        min.z = std::min(min.z, point.z); max.z = std::max(max.z, point.z);
+    }
+
+    // Split the points at the median along the axis of largest extent
+    Vector3 extent = max - min;
+    int axis = (extent.x > extent.y) ? ((extent.x > extent.z) ? 0 : 2) :
+                                       ((extent.y > extent.z) ? 1 : 2);
+    uint middle = begin + (end - begin) / 2;
+    nth_element(indices.begin() + begin, indices.begin() + middle,
+                indices.begin() + end, PointComparison(points, axis));
+    mNodes[nodeIndex].split = points[indices[middle]][axis];
+    mNodes[nodeIndex].axis = axis;
+
+    // Build the two subtrees (in parallel if they are large enough)
+    if (end - begin >= 4096) {
+        #pragma omp task shared(indices, points)
+        buildSubtree(2 * nodeIndex + 1, begin, middle, indices, points);
+        buildSubtree(2 * nodeIndex + 2, middle, end, indices, points);
+        #pragma omp taskwait
+    }
+    else {
+        buildSubtree(2 * nodeIndex + 1, begin, middle, indices, points);
+        buildSubtree(2 * nodeIndex + 2, middle, end, indices, points);
+    }
+}
+
+// Destroy the tree
+void KdTree::destroy() {
+    mNodes.clear();
+    mLeafFirstPoints.clear();
+    mPoints.clear();
+    mPointIndices.clear();
+}
+
+// Find the k nearest points to a point. The indices and the square distances
+// of the neighbours are sorted by increasing distance. Return the number of
+// neighbours found (less than k if the tree contains less than k points).
+uint KdTree::findKNearestNeighbors(const Vector3& point, uint k, uint* indices,
+                                   float* squareDistances) const {
+
+    if (mPoints.empty() || k == 0) return 0;
+
+    const uint nbInternalNodes = mNodes.size();
+    uint nbFound = 0;
+    float maxSquareDistance = numeric_limits<float>::max();
+
+    // The stack contains the nodes with the square distance to their cell and the
+    // offsets along each axis between the point and the cell (the distance to the
+    // cell of a far child is updated incrementally from the offsets of its parent)
+    uint stackNodes[MAX_DEPTH];
+    float stackDistances[MAX_DEPTH];
+    float stackOffsets[MAX_DEPTH][3];
+    uint stackSize = 0;
+    stackNodes[stackSize] = 0;
+    stackDistances[stackSize] = 0.0f;
+    stackOffsets[stackSize][0] = stackOffsets[stackSize][1] = stackOffsets[stackSize][2] = 0.0f;
+    stackSize++;
+    const float coordinates[3] = {point.x, point.y, point.z};
+
+    while (stackSize > 0) {
+
+        stackSize--;
+        float cellDistance = stackDistances[stackSize];
+        if (cellDistance > maxSquareDistance) continue;
+        uint nodeIndex = stackNodes[stackSize];
+        float offsets[3] = {stackOffsets[stackSize][0], stackOffsets[stackSize][1],
+                            stackOffsets[stackSize][2]};
+
+        // Go down to the leaf containing the point and push the far children
+        while (nodeIndex < nbInternalNodes) {
+            const KdTreeNode& node = mNodes[nodeIndex];
+            float distance = coordinates[node.axis] - node.split;
+            uint nearChild = (distance < 0.0f) ? 2 * nodeIndex + 1 : 2 * nodeIndex + 2;
+            uint farChild = (distance < 0.0f) ? 2 * nodeIndex + 2 : 2 * nodeIndex + 1;
+            float offset = offsets[node.axis];
+            float farCellDistance = cellDistance - offset * offset + distance * distance;
+            if (farCellDistance <= maxSquareDistance) {
+                assert(stackSize < MAX_DEPTH);
+                stackNodes[stackSize] = farChild;
+                stackDistances[stackSize] = farCellDistance;
+                stackOffsets[stackSize][0] = offsets[0];
+                stackOffsets[stackSize][1] = offsets[1];
+                stackOffsets[stackSize][2] = offsets[2];
+                stackOffsets[stackSize++][node.axis] = distance;
+            }
+            nodeIndex = nearChild;
+        }
+
+        // Insert the points of the leaf in the sorted list of neighbours
+        uint leaf = nodeIndex - nbInternalNodes;
+        for (uint i=mLeafFirstPoints[leaf]; i<mLeafFirstPoints[leaf + 1]; i++) {
+            float squareDistance = (mPoints[i] - point).lengthSquared();
+            if (squareDistance >= maxSquareDistance) continue;
+            uint j = (nbFound < k) ? nbFound++ : k - 1;
+            while (j > 0 && squareDistances[j - 1] > squareDistance) {
+                squareDistances[j] = squareDistances[j - 1];
+                indices[j] = indices[j - 1];
+                j--;
+            }
+            squareDistances[j] = squareDistance;
+            indices[j] = mPointIndices[i];
+            if (nbFound == k) maxSquareDistance = squareDistances[k - 1];
+        }
+    }
+
+    return nbFound;
+}
+
+// Find the k nearest points to each point of an array (in parallel). The
+// neighbours of the point i are at the indices [i*k, (i+1)*k) of the output
+// arrays and the missing neighbours have the index INVALID_INDEX.
+void KdTree::findKNearestNeighbors(const vector<Vector3>& points, uint k,
+                                   vector<uint>& indices,
+                                   vector<float>& squareDistances) const {
+
+    indices.resize(size_t(points.size()) * k);
+    squareDistances.resize(size_t(points.size()) * k);
+    const int nbPoints = int(points.size());
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int i=0; i<nbPoints; i++) {
+        size_t offset = size_t(i) * k;
+        uint nbFound = findKNearestNeighbors(points[i], k, &indices[offset],
+                                             &squareDistances[offset]);
+        for (uint j=nbFound; j<k; j++) {
+            indices[offset + j] = INVALID_INDEX;
+            squareDistances[offset + j] = numeric_limits<float>::max();
+        }
+    }
+}
+
+// Find the points inside a sphere (the indices are not sorted)
+void KdTree::findNeighborsInRadius(const Vector3& point, float radius,
+                                   vector<uint>& indices) const {
+
+    indices.clear();
+    if (mPoints.empty()) return;
+
+    const uint nbInternalNodes = mNodes.size();
+    const float squareRadius = radius * radius;
+    const float coordinates[3] = {point.x, point.y, point.z};
+
+    uint stack[MAX_DEPTH];
+    uint stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+
+        uint nodeIndex = stack[--stackSize];
+
+        if (nodeIndex < nbInternalNodes) {
+
+            // Visit the children whose half-space intersects the sphere
+            const KdTreeNode& node = mNodes[nodeIndex];
+            float distance = coordinates[node.axis] - node.split;
+            assert(stackSize + 2 <= MAX_DEPTH);
+            if (distance <= radius) stack[stackSize++] = 2 * nodeIndex + 1;
+            if (distance >= -radius) stack[stackSize++] = 2 * nodeIndex + 2;
+        }
+        else {
+            uint leaf = nodeIndex - nbInternalNodes;
+            for (uint i=mLeafFirstPoints[leaf]; i<mLeafFirstPoints[leaf + 1]; i++) {
+                if ((mPoints[i] - point).lengthSquared() <= squareRadius) {
+                    indices.push_back(mPointIndices[i]);
+                }
+            }
+        }
+    }
+}
+
+// Find the points inside a sphere around each point of an array (in parallel)
+void KdTree::findNeighborsInRadius(const vector<Vector3>& points, float radius,
+                                   vector<vector<uint> >& indices) const {
+
+    indices.resize(points.size());
+    const int nbPoints = int(points.size());
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int i=0; i<nbPoints; i++) {
+        findNeighborsInRadius(points[i], radius, indices[i]);
+    }
+}
@@ -0,0 +1,171 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef KD_TREE_H
+#define KD_TREE_H
+
+// Libraries
+#include <vector>
+#include "definitions.h"
+#include "maths/Vector3.h"
+#include "Mesh.h"
+
+namespace openglframework {
+
+// Class KdTreeNode
+// This class represents an internal node of a kd-tree
+class KdTreeNode {
+
+    public:
+
+        // Position of the splitting plane
+        float split;
+
+        // Axis of the splitting plane
+        uint axis;
+};
+
+// Class KdTree
+// This class represents a kd-tree over a set of points used for k-nearest neighbour
+// and radius queries. The points are split at the median along the axis of largest
+// extent until the leaves contain at most MAX_LEAF_SIZE points. Because of this,
+// the tree is complete and is stored implicitly (the children of the node i are
+// the nodes 2i+1 and 2i+2) so that it only needs eight bytes per internal node.
+// The tree keeps its own copy of the points in the leaf order so that the points
+// of a leaf are contiguous in memory. The subtrees are built in parallel with
+// OpenMP tasks and the batched queries are executed in parallel.
+class KdTree {
+
+    public:
+
+        // -------------------- Constants -------------------- //
+
+        // Maximum number of points in a leaf
+        static const uint MAX_LEAF_SIZE = 16;
+
+        // Maximum depth of the tree (size of the traversal stack)
+        static const uint MAX_DEPTH = 64;
+
+        // Index used for the missing neighbours when less than k points are found
+        static const uint INVALID_INDEX = 0xffffffff;
+
+    private:
+
+        // -------------------- Attributes -------------------- //
+
+        // Internal nodes of the tree (the root is the first node)
+        std::vector<KdTreeNode> mNodes;
+
+        // Index of the first point of each leaf (the last element is the number of points)
+        std::vector<uint> mLeafFirstPoints;
+
+        // Points in the leaf order
+        std::vector<Vector3> mPoints;
+
+        // Index in the input array of each point (in the leaf order)
+        std::vector<uint> mPointIndices;
+
+        // -------------------- Methods -------------------- //
+
+        // Build the subtree of a range of points
+        void buildSubtree(uint nodeIndex, uint begin, uint end, std::vector<uint>& indices,
+                          const std::vector<Vector3>& points);
+
+    public:
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor
+        KdTree();
+
+        // Constructor
+        KdTree(const std::vector<Vector3>& points);
+
+        // Destructor
+        ~KdTree();
+
+        // Build the tree over a set of points
+        void build(const std::vector<Vector3>& points);
+
+        // Build the tree over the vertices of a mesh
+        void build(const Mesh& mesh);
+
+        // Destroy the tree
+        void destroy();
+
+        // Find the k nearest points to a point. The indices and the square distances
+        // of the neighbours are sorted by increasing distance. Return the number of
+        // neighbours found (less than k if the tree contains less than k points).
+        uint findKNearestNeighbors(const Vector3& point, uint k, uint* indices,
+                                   float* squareDistances) const;
+
+        // Find the k nearest points to each point of an array (in parallel). The
+        // neighbours of the point i are at the indices [i*k, (i+1)*k) of the output
+        // arrays and the missing neighbours have the index INVALID_INDEX.
+        void findKNearestNeighbors(const std::vector<Vector3>& points, uint k,
+                                   std::vector<uint>& indices,
+                                   std::vector<float>& squareDistances) const;
+
+        // Find the points inside a sphere (the indices are not sorted)
+        void findNeighborsInRadius(const Vector3& point, float radius,
+                                   std::vector<uint>& indices) const;
+
+        // Find the points inside a sphere around each point of an array (in parallel)
+        void findNeighborsInRadius(const std::vector<Vector3>& points, float radius,
+                                   std::vector<std::vector<uint> >& indices) const;
+
+        // Return the number of points
+        uint getNbPoints() const;
+
+        // Return the number of leaves
+        uint getNbLeaves() const;
+
+        // Return the index in the input array of each point (in the leaf order)
+        const std::vector<uint>& getPointIndices() const;
+};
+
+// Build the tree over the vertices of a mesh
+inline void KdTree::build(const Mesh& mesh) {
+    build(mesh.getVertices());
+}
+
+// Return the number of points
+inline uint KdTree::getNbPoints() const {
+    return mPoints.size();
+}
+
+// Return the number of leaves
+inline uint KdTree::getNbLeaves() const {
+    return mPoints.empty() ? 0 : mNodes.size() + 1;
+}
+
+// Return the index in the input array of each point (in the leaf order)
+inline const std::vector<uint>& KdTree::getPointIndices() const {
+    return mPointIndices;
+}
+
+}
+
+#endif
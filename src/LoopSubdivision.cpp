@@ -0,0 +1,417 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "LoopSubdivision.h"
+#include "maths/Vector4.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Constants
+const float LoopSubdivision::INFINITE_SHARPNESS = 1e30f;
+
+// Class EdgeEntry
+// This class is used to give the same index to all the half-edges of an edge
+class EdgeEntry {
+
+    public:
+        uint vertex1, vertex2;
+        uint halfEdge;
+
+        bool operator<(const EdgeEntry& entry) const {
+            if (vertex1 != entry.vertex1) return vertex1 < entry.vertex1;
+            if (vertex2 != entry.vertex2) return vertex2 < entry.vertex2;
+            return halfEdge < entry.halfEdge;
+        }
+};
+
+// Constructor
+LoopSubdivision::LoopSubdivision() : mNbLevels(0), mNbControlVertices(0) {
+
+}
+
+// Destructor
+LoopSubdivision::~LoopSubdivision() {
+
+}
+
+// Add a crease edge between two vertices of the control mesh. The sharpness is
+// the number of subdivision levels during which the edge stays sharp (a
+// fractional sharpness is rounded up). This has to be called before setup().
+void LoopSubdivision::addCreaseEdge(uint vertex1, uint vertex2, float sharpness) {
+    assert(vertex1 != vertex2);
+    mCreaseEdges.push_back(CreaseEdge(vertex1, vertex2, sharpness));
+}
+
+// Compute the topology tables of the refined mesh for a given control mesh
+void LoopSubdivision::setup(const Mesh& controlMesh, uint nbLevels) {
+
+    mNbLevels = nbLevels;
+    mNbControlVertices = controlMesh.getNbVertices();
+    mStencilOffsets.assign(nbLevels, vector<uint>());
+    mStencilIndices.assign(nbLevels, vector<uint>());
+    mStencilWeights.assign(nbLevels, vector<float>());
+
+    // Put the triangles of all the parts together so that the parts
+    // sharing some vertices are subdivided without cracks
+    vector<uint> indices;
+    vector<uint> nbPartFaces(controlMesh.getNbParts());
+    for (uint p=0; p<controlMesh.getNbParts(); p++) {
+        const vector<uint>& partIndices = controlMesh.getIndices(p);
+        indices.insert(indices.end(), partIndices.begin(), partIndices.end());
+        nbPartFaces[p] = controlMesh.getNbFaces(p);
+    }
+
+    vector<CreaseEdge> creaseEdges = mCreaseEdges;
+    uint nbVertices = mNbControlVertices;
+
+    // For each subdivision level
+    for (uint level=0; level<nbLevels; level++) {
+
+        vector<uint> refinedIndices;
+        vector<CreaseEdge> refinedCreaseEdges;
+        setupLevel(indices, nbVertices, creaseEdges, refinedIndices, refinedCreaseEdges,
+                   mStencilOffsets[level], mStencilIndices[level], mStencilWeights[level]);
+
+        indices.swap(refinedIndices);
+        creaseEdges.swap(refinedCreaseEdges);
+        nbVertices = mStencilOffsets[level].size() - 1;
+
+        // Each face is replaced by four faces
+        for (uint p=0; p<nbPartFaces.size(); p++) {
+            nbPartFaces[p] *= 4;
+        }
+    }
+
+    // Split the refined triangles into the parts of the mesh (the children
+    // of a face directly follow each other so the parts stay contiguous)
+    mRefinedIndices.assign(nbPartFaces.size(), vector<uint>());
+    vector<uint>::const_iterator it = indices.begin();
+    for (uint p=0; p<nbPartFaces.size(); p++) {
+        mRefinedIndices[p].assign(it, it + 3 * nbPartFaces[p]);
+        it += 3 * nbPartFaces[p];
+    }
+}
+
+// Compute the topology and the stencils of one subdivision level
+void LoopSubdivision::setupLevel(const vector<uint>& indices, uint nbVertices,
+                                 const vector<CreaseEdge>& creaseEdges,
+                                 vector<uint>& refinedIndices,
+                                 vector<CreaseEdge>& refinedCreaseEdges,
+                                 vector<uint>& stencilOffsets,
+                                 vector<uint>& stencilIndices,
+                                 vector<float>& stencilWeights) const {
+
+    HalfEdgeMesh halfEdgeMesh;
+    halfEdgeMesh.build(indices, nbVertices);
+    const uint nbHalfEdges = halfEdgeMesh.getNbHalfEdges();
+    const uint nbFaces = halfEdgeMesh.getNbFaces();
+
+    // ---------- Edges ---------- //
+
+    // Give the same index to all the half-edges with the same two vertices
+    // (including the half-edges of the non-manifold edges)
+    vector<EdgeEntry> entries(nbHalfEdges);
+    for (uint h=0; h<nbHalfEdges; h++) {
+        uint v1 = halfEdgeMesh.getStartVertex(h);
+        uint v2 = halfEdgeMesh.getEndVertex(h);
+        entries[h].vertex1 = min(v1, v2);
+        entries[h].vertex2 = max(v1, v2);
+        entries[h].halfEdge = h;
+    }
+    sort(entries.begin(), entries.end());
+
+    vector<uint> halfEdgeToEdge(nbHalfEdges);
+    vector<uint> edgeHalfEdges;
+    vector<uint> edgeNbHalfEdges;
+    for (uint i=0; i<nbHalfEdges; i++) {
+        if (i == 0 || entries[i].vertex1 != entries[i-1].vertex1 ||
+            entries[i].vertex2 != entries[i-1].vertex2) {
+            edgeHalfEdges.push_back(entries[i].halfEdge);
+            edgeNbHalfEdges.push_back(0);
+        }
+        halfEdgeToEdge[entries[i].halfEdge] = edgeHalfEdges.size() - 1;
+        edgeNbHalfEdges.back()++;
+    }
+    const uint nbEdges = edgeHalfEdges.size();
+
+    // Sharpness of each edge
+    vector<float> sharpness(nbEdges, 0.0f);
+    for (uint c=0; c<creaseEdges.size(); c++) {
+        EdgeEntry key;
+        key.vertex1 = min(creaseEdges[c].vertex1, creaseEdges[c].vertex2);
+        key.vertex2 = max(creaseEdges[c].vertex1, creaseEdges[c].vertex2);
+        key.halfEdge = 0;
+        vector<EdgeEntry>::const_iterator it = lower_bound(entries.begin(), entries.end(), key);
+        if (it != entries.end() && it->vertex1 == key.vertex1 && it->vertex2 == key.vertex2) {
+            uint edge = halfEdgeToEdge[it->halfEdge];
+            sharpness[edge] = max(sharpness[edge], creaseEdges[c].sharpness);
+        }
+    }
+
+    // An edge uses the crease rules if it is sharp, on the boundary or non-manifold
+    vector<bool> isCrease(nbEdges);
+    for (uint e=0; e<nbEdges; e++) {
+        isCrease[e] = sharpness[e] > 0.0f || edgeNbHalfEdges[e] != 2 ||
+                      halfEdgeMesh.isBoundaryHalfEdge(edgeHalfEdges[e]);
+    }
+
+    // Number of outgoing half-edges of each vertex
+    vector<uint> nbOutgoingHalfEdges(nbVertices, 0);
+    for (uint h=0; h<nbHalfEdges; h++) {
+        nbOutgoingHalfEdges[halfEdgeMesh.getStartVertex(h)]++;
+    }
+
+    // ---------- Stencils ---------- //
+
+    stencilOffsets.clear();
+    stencilIndices.clear();
+    stencilWeights.clear();
+    stencilOffsets.reserve(nbVertices + nbEdges + 1);
+    stencilOffsets.push_back(0);
+
+    // Stencils of the even vertices (new positions of the existing vertices)
+    vector<uint> neighbors;
+    vector<uint> creaseNeighbors;
+    for (uint v=0; v<nbVertices; v++) {
+
+        neighbors.clear();
+        creaseNeighbors.clear();
+
+        // Visit the one-ring of the vertex
+        uint nbRingFaces = 0;
+        uint start = halfEdgeMesh.getVertexHalfEdge(v);
+        uint h = start;
+        uint last = start;
+        while (h != HalfEdgeMesh::INVALID_INDEX) {
+            uint neighbor = halfEdgeMesh.getEndVertex(h);
+            neighbors.push_back(neighbor);
+            if (isCrease[halfEdgeToEdge[h]]) creaseNeighbors.push_back(neighbor);
+            nbRingFaces++;
+            last = h;
+            h = halfEdgeMesh.getNextOutgoingHalfEdge(h);
+            if (h == start) break;
+        }
+        if (h == HalfEdgeMesh::INVALID_INDEX && start != HalfEdgeMesh::INVALID_INDEX) {
+
+            // On the boundary, the last neighbor is reached by an incoming half-edge
+            uint incoming = halfEdgeMesh.getPrevious(last);
+            uint neighbor = halfEdgeMesh.getStartVertex(incoming);
+            neighbors.push_back(neighbor);
+            if (isCrease[halfEdgeToEdge[incoming]]) creaseNeighbors.push_back(neighbor);
+        }
+
+        // If the one-ring does not contain all the faces of the vertex, the vertex
+        // is non-manifold. Such vertices and the isolated ones are kept as corners.
+        bool isCorner = nbRingFaces == 0 || nbRingFaces != nbOutgoingHalfEdges[v] ||
+                        creaseNeighbors.size() > 2;
+
+        if (isCorner) {
+            stencilIndices.push_back(v);
+            stencilWeights.push_back(1.0f);
+        }
+        else if (creaseNeighbors.size() == 2) {
+
+            // Crease vertex rule
+            stencilIndices.push_back(v);
+            stencilWeights.push_back(0.75f);
+            stencilIndices.push_back(creaseNeighbors[0]);
+            stencilWeights.push_back(0.125f);
+            stencilIndices.push_back(creaseNeighbors[1]);
+            stencilWeights.push_back(0.125f);
+        }
+        else {
+
+            // Smooth vertex rule
+            float n = float(neighbors.size());
+            float c = 0.375f + 0.25f * cos(2.0f * PI / n);
+            float beta = (0.625f - c * c) / n;
+            stencilIndices.push_back(v);
+            stencilWeights.push_back(1.0f - n * beta);
+            for (uint i=0; i<neighbors.size(); i++) {
+                stencilIndices.push_back(neighbors[i]);
+                stencilWeights.push_back(beta);
+            }
+        }
+        stencilOffsets.push_back(stencilIndices.size());
+    }
+
+    // Stencils of the odd vertices (new vertices in the middle of the edges)
+    for (uint e=0; e<nbEdges; e++) {
+
+        uint h = edgeHalfEdges[e];
+        uint v1 = halfEdgeMesh.getStartVertex(h);
+        uint v2 = halfEdgeMesh.getEndVertex(h);
+
+        if (isCrease[e]) {
+
+            // Crease edge rule
+            stencilIndices.push_back(v1);
+            stencilWeights.push_back(0.5f);
+            stencilIndices.push_back(v2);
+            stencilWeights.push_back(0.5f);
+        }
+        else {
+
+            // Smooth edge rule (using the opposite vertices of the two faces)
+            uint v3 = halfEdgeMesh.getStartVertex(halfEdgeMesh.getPrevious(h));
+            uint v4 = halfEdgeMesh.getStartVertex(
+                          halfEdgeMesh.getPrevious(halfEdgeMesh.getTwin(h)));
+            stencilIndices.push_back(v1);
+            stencilWeights.push_back(0.375f);
+            stencilIndices.push_back(v2);
+            stencilWeights.push_back(0.375f);
+            stencilIndices.push_back(v3);
+            stencilWeights.push_back(0.125f);
+            stencilIndices.push_back(v4);
+            stencilWeights.push_back(0.125f);
+        }
+        stencilOffsets.push_back(stencilIndices.size());
+    }
+
+    // ---------- Refined topology ---------- //
+
+    // Each face is split into four faces
+    refinedIndices.resize(12 * nbFaces);
+    for (uint f=0; f<nbFaces; f++) {
+        uint v0 = indices[3*f];
+        uint v1 = indices[3*f + 1];
+        uint v2 = indices[3*f + 2];
+        uint m0 = nbVertices + halfEdgeToEdge[3*f];
+        uint m1 = nbVertices + halfEdgeToEdge[3*f + 1];
+        uint m2 = nbVertices + halfEdgeToEdge[3*f + 2];
+        uint* face = &refinedIndices[12*f];
+        face[0] = v0; face[1] = m0;  face[2] = m2;
+        face[3] = v1; face[4] = m1;  face[5] = m0;
+        face[6] = v2; face[7] = m2;  face[8] = m1;
+        face[9] = m0; face[10] = m1; face[11] = m2;
+    }
+
+    // The two halves of a crease edge stay sharp one level less
+    refinedCreaseEdges.clear();
+    for (uint e=0; e<nbEdges; e++) {
+        if (sharpness[e] > 1.0f) {
+            uint h = edgeHalfEdges[e];
+            uint middle = nbVertices + e;
+            refinedCreaseEdges.push_back(CreaseEdge(halfEdgeMesh.getStartVertex(h), middle,
+                                                    sharpness[e] - 1.0f));
+            refinedCreaseEdges.push_back(CreaseEdge(middle, halfEdgeMesh.getEndVertex(h),
+                                                    sharpness[e] - 1.0f));
+        }
+    }
+}
+
+// Apply the stencils of one level to an attribute array
+template<typename T>
+void LoopSubdivision::applyStencils(uint level, const vector<T>& input,
+                                    vector<T>& output) const {
+
+    const vector<uint>& offsets = mStencilOffsets[level];
+    const vector<uint>& stencilIndices = mStencilIndices[level];
+    const vector<float>& weights = mStencilWeights[level];
+    const int nbOutputs = int(offsets.size()) - 1;
+
+    output.resize(nbOutputs);
+
+    // Each refined value is a weighted sum of values of the previous level
+    #pragma omp parallel for schedule(static, 4096)
+    for (int i=0; i<nbOutputs; i++) {
+        T value = input[stencilIndices[offsets[i]]] * weights[offsets[i]];
+        for (uint k=offsets[i] + 1; k<offsets[i + 1]; k++) {
+            value += input[stencilIndices[k]] * weights[k];
+        }
+        output[i] = value;
+    }
+}
+
+// Compute the refined mesh using the current vertices of the control mesh.
+// The control mesh must have the topology that has been used in setup().
+void LoopSubdivision::refine(const Mesh& controlMesh, Mesh& refinedMesh) const {
+
+    assert(controlMesh.getNbVertices() == mNbControlVertices);
+
+    // Apply the stencils of each level to the vertices, the UVs and the colors (the
+    // colors are interpolated as 4D vectors)
+    vector<Vector3> vertices = controlMesh.getVertices();
+    vector<Vector2> uvs = controlMesh.getUVs();
+    bool hasUVs = controlMesh.hasUVTextureCoordinates();
+    bool hasColors = controlMesh.hasColors();
+    vector<Vector4> colors;
+    if (hasColors) {
+        const vector<Color>& controlColors = controlMesh.getColors();
+        colors.resize(controlColors.size());
+        for (uint i=0; i<controlColors.size(); i++) {
+            const Color& color = controlColors[i];
+            colors[i] = Vector4(color.r, color.g, color.b, color.a);
+        }
+    }
+    vector<Vector3> refinedVertices;
+    vector<Vector2> refinedUVs;
+    vector<Vector4> refinedColors;
+    for (uint level=0; level<mNbLevels; level++) {
+        applyStencils(level, vertices, refinedVertices);
+        vertices.swap(refinedVertices);
+        if (hasUVs) {
+            applyStencils(level, uvs, refinedUVs);
+            uvs.swap(refinedUVs);
+        }
+        if (hasColors) {
+            applyStencils(level, colors, refinedColors);
+            colors.swap(refinedColors);
+        }
+    }
+
+    // Set the refined attributes (the attributes that the control mesh does not
+    // have are cleared so that no stale array of the previous size remains)
+    vector<vector<uint> > indices(mRefinedIndices);
+    refinedMesh.setVertices(std::move(vertices));
+    refinedMesh.setIndices(std::move(indices));
+    if (!hasUVs) uvs.clear();
+    refinedMesh.setUVs(std::move(uvs));
+    vector<Color> refinedMeshColors(colors.size());
+    for (uint i=0; i<colors.size(); i++) {
+        refinedMeshColors[i] = Color(colors[i].x, colors[i].y, colors[i].z, colors[i].w);
+    }
+    refinedMesh.setColors(std::move(refinedMeshColors));
+
+    // Recompute the normals and the tangents of the refined mesh
+    if (controlMesh.hasNormals()) {
+        refinedMesh.calculateNormals();
+    }
+    else {
+        refinedMesh.setNormals(vector<Vector3>());
+    }
+    if (controlMesh.hasTangents() && hasUVs) {
+        refinedMesh.calculateTangents();
+    }
+    else {
+        refinedMesh.setTangents(vector<Vector3>());
+    }
+}
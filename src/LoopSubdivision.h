@@ -0,0 +1,173 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef LOOP_SUBDIVISION_H
+#define LOOP_SUBDIVISION_H
+
+// Libraries
+#include <vector>
+#include "definitions.h"
+#include "Mesh.h"
+#include "HalfEdgeMesh.h"
+
+namespace openglframework {
+
+// Class CreaseEdge
+// This class represents a sharp edge of a mesh to subdivide
+class CreaseEdge {
+
+    public:
+        CreaseEdge() : vertex1(0), vertex2(0), sharpness(0) {}
+        CreaseEdge(uint v1, uint v2, float s) : vertex1(v1), vertex2(v2), sharpness(s) {}
+
+        // Vertices of the edge
+        uint vertex1, vertex2;
+
+        // Number of subdivision levels during which the edge stays sharp
+        float sharpness;
+};
+
+// Class LoopSubdivision
+// This class computes the Loop subdivision of a triangular mesh. The setup() method
+// computes the topology of each subdivision level once and stores, for each refined
+// vertex, the weights of the vertices of the previous level (the stencils). The
+// refine() method only applies those stencils, so that the refined mesh can be
+// cheaply recomputed each time the control vertices of the mesh are moved (as long
+// as the topology does not change). The boundary edges and the crease edges use
+// the crease rules of Hoppe et al. and the vertices with more than two crease
+// edges (or non-manifold vertices) are kept as corners.
+class LoopSubdivision {
+
+    public:
+
+        // -------------------- Constants -------------------- //
+
+        // Sharpness of an edge that stays sharp at all the levels
+        static const float INFINITE_SHARPNESS;
+
+    private:
+
+        // -------------------- Attributes -------------------- //
+
+        // Crease edges of the control mesh
+        std::vector<CreaseEdge> mCreaseEdges;
+
+        // Number of subdivision levels
+        uint mNbLevels;
+
+        // Number of vertices of the control mesh
+        uint mNbControlVertices;
+
+        // For each level, start of the stencil of each refined vertex
+        std::vector<std::vector<uint> > mStencilOffsets;
+
+        // For each level, vertices of the previous level used by the stencils
+        std::vector<std::vector<uint> > mStencilIndices;
+
+        // For each level, weights of the vertices of the previous level in the stencils
+        std::vector<std::vector<float> > mStencilWeights;
+
+        // Indices of the refined mesh (for each part)
+        std::vector<std::vector<uint> > mRefinedIndices;
+
+        // -------------------- Methods -------------------- //
+
+        // Compute the topology and the stencils of one subdivision level
+        void setupLevel(const std::vector<uint>& indices, uint nbVertices,
+                        const std::vector<CreaseEdge>& creaseEdges,
+                        std::vector<uint>& refinedIndices,
+                        std::vector<CreaseEdge>& refinedCreaseEdges,
+                        std::vector<uint>& stencilOffsets,
+                        std::vector<uint>& stencilIndices,
+                        std::vector<float>& stencilWeights) const;
+
+        // Apply the stencils of one level to an attribute array
+        template<typename T>
+        void applyStencils(uint level, const std::vector<T>& input,
+                           std::vector<T>& output) const;
+
+    public:
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor
+        LoopSubdivision();
+
+        // Destructor
+        ~LoopSubdivision();
+
+        // Add a crease edge between two vertices of the control mesh. The sharpness is
+        // the number of subdivision levels during which the edge stays sharp (a
+        // fractional sharpness is rounded up). This has to be called before setup().
+        void addCreaseEdge(uint vertex1, uint vertex2, float sharpness = INFINITE_SHARPNESS);
+
+        // Remove all the crease edges
+        void clearCreaseEdges();
+
+        // Compute the topology tables of the refined mesh for a given control mesh
+        void setup(const Mesh& controlMesh, uint nbLevels);
+
+        // Compute the refined mesh using the current vertices of the control mesh.
+        // The control mesh must have the topology that has been used in setup(). The
+        // UVs and the colors are interpolated, the normals and the tangents are
+        // recomputed (the attributes of the refined mesh that the control mesh does
+        // not have are cleared).
+        void refine(const Mesh& controlMesh, Mesh& refinedMesh) const;
+
+        // Compute the topology tables and the refined mesh
+        void subdivide(const Mesh& controlMesh, Mesh& refinedMesh, uint nbLevels);
+
+        // Return the number of subdivision levels
+        uint getNbLevels() const;
+
+        // Return the number of vertices of the refined mesh
+        uint getNbRefinedVertices() const;
+};
+
+// Remove all the crease edges
+inline void LoopSubdivision::clearCreaseEdges() {
+    mCreaseEdges.clear();
+}
+
+// Compute the topology tables and the refined mesh
+inline void LoopSubdivision::subdivide(const Mesh& controlMesh, Mesh& refinedMesh,
+                                       uint nbLevels) {
+    setup(controlMesh, nbLevels);
+    refine(controlMesh, refinedMesh);
+}
+
+// Return the number of subdivision levels
+inline uint LoopSubdivision::getNbLevels() const {
+    return mNbLevels;
+}
+
+// Return the number of vertices of the refined mesh
+inline uint LoopSubdivision::getNbRefinedVertices() const {
+    return (mNbLevels == 0) ? mNbControlVertices : mStencilOffsets[mNbLevels - 1].size() - 1;
+}
+
+}
+
+#endif
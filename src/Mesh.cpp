@@ -31,7 +31,7 @@ using namespace openglframework;
 using namespace std;
 
 // Constructor
-Mesh::Mesh() {
+Mesh::Mesh() : mGeometry(new MeshGeometry()), mIsGeometryOwned(true) {
 
 }
 
@@ -43,19 +43,17 @@ Mesh::~Mesh() {
 // Destroy the mesh
 void Mesh::destroy() {
 
-    mVertices.clear();
-    mNormals.clear();
-    mTangents.clear();
-    mIndices.clear();
-    mColors.clear();
-    mUVs.clear();
+    // Release the geometry data (it may still be used by other meshes)
+    mGeometry = std::make_shared<MeshGeometry>();
+    mIsGeometryOwned = true;
     mTextures.clear();
 }
 
 // Compute the normals of the mesh
 void Mesh::calculateNormals() {
 
-    mNormals = vector<Vector3>(getNbVertices(), Vector3(0, 0, 0));
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.normals = vector<Vector3>(getNbVertices(), Vector3(0, 0, 0));
 
     // For each triangular face
     for (uint i=0; i<getNbFaces(); i++) {
@@ -77,22 +75,23 @@ void Mesh::calculateNormals() {
 
         // Add the face surface normal to the sum of normals at
         // each vertex of the face
-        mNormals[v1] += normal;
-        mNormals[v2] += normal;
-        mNormals[v3] += normal;
+        geometry.normals[v1] += normal;
+        geometry.normals[v2] += normal;
+        geometry.normals[v3] += normal;
     }
 
     // Normalize the normal at each vertex
     for (uint i=0; i<getNbVertices(); i++) {
-        assert(mNormals[i].length() > 0);
-        mNormals[i] = mNormals[i].normalize();
+        assert(geometry.normals[i].length() > 0);
+        geometry.normals[i] = geometry.normals[i].normalize();
     }
 }
 
 // Compute the tangents of the mesh
 void Mesh::calculateTangents() {
 
-    mTangents = std::vector<Vector3>(getNbVertices(), Vector3(0, 0, 0));
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.tangents = std::vector<Vector3>(getNbVertices(), Vector3(0, 0, 0));
 
     // For each face
     for (uint i=0; i<getNbFaces(); i++) {
@@ -129,9 +128,9 @@ void Mesh::calculateTangents() {
             float factor = 1.0f / cp;
             Vector3 tangent = (edge1 * -edge2UV.y + edge2 * edge1UV.y) * factor;
             tangent.normalize();
-            mTangents[v1] = tangent;
-            mTangents[v2] = tangent;
-            mTangents[v3] = tangent;
+            geometry.tangents[v1] = tangent;
+            geometry.tangents[v2] = tangent;
+            geometry.tangents[v3] = tangent;
         }
     }
 }
@@ -140,25 +139,9 @@ void Mesh::calculateTangents() {
 void Mesh::calculateBoundingBox(Vector3& min, Vector3& max) const {
 
     // If the mesh contains vertices
-    if (!mVertices.empty())  {
-
-        min = mVertices[0];
-        max = mVertices[0];
-
-        std::vector<Vector3>::const_iterator  it(mVertices.begin());
-
-        // For each vertex of the mesh
-        for (; it != mVertices.end(); ++it) {
-
-            if( (*it).x < min.x ) min.x = (*it).x;
-            else if ( (*it).x > max.x ) max.x = (*it).x;
-
-            if( (*it).y < min.y ) min.y = (*it).y;
-            else if ( (*it).y > max.y ) max.y = (*it).y;
-
-            if( (*it).z < min.z ) min.z = (*it).z;
-            else if ( (*it).z > max.z ) max.z = (*it).z;
-        }
+    if (!mGeometry->vertices.empty())  {
+        min = getAABB().min;
+        max = getAABB().max;
     }
     else {
         std::cerr << "Error : Impossible to calculate the bounding box of the mesh because there" <<
@@ -170,8 +153,12 @@ void Mesh::calculateBoundingBox(Vector3& min, Vector3& max) const {
 // Scale of vertices of the mesh using a given factor
 void Mesh::scaleVertices(float factor) {
 
+    MeshGeometry& geometry = getWritableGeometry();
+
     // For each vertex
     for (uint i=0; i<getNbVertices(); i++) {
-        mVertices.at(i) *= factor;
+        geometry.vertices.at(i) *= factor;
     }
+
+    geometry.isBoundingVolumesValid = false;
 }
@@ -30,10 +30,15 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <utility>
 #include "definitions.h"
 #include "maths/Vector2.h"
 #include "maths/Vector3.h"
 #include "maths/Color.h"
+#include "maths/AABB.h"
+#include "maths/BoundingSphere.h"
+#include "MeshGeometry.h"
 #include "Texture2D.h"
 #include "Object3D.h"
 
@@ -42,33 +47,37 @@ namespace openglframework {
 // Class Mesh
 // This class represents a 3D triangular mesh
 // object that can be loaded from an OBJ file for instance.
+// The geometry data is shared between a mesh and its copies (copy-on-write),
+// so that many instances of the same asset can be placed in a scene with
+// their own transform without duplicating the vertices. The meshes sharing a
+// geometry can be read from several threads, but the copy-on-write decides if
+// the geometry is shared with its reference count (use_count), which is not
+// reliable when other threads copy or release the meshes at the same time. The
+// meshes sharing a geometry must therefore be modified, copied and destroyed from
+// a single thread.
 class Mesh : public Object3D {
 
     private:
 
         // -------------------- Attributes -------------------- //
 
-        // A triplet of vertex indices for each triangle
-        std::vector<std::vector<uint> > mIndices;
+        // Geometry data of the mesh (shared with the meshes that have been copied
+        // from this one, and copied only when one of them is modified)
+        std::shared_ptr<const MeshGeometry> mGeometry;
 
-        // Vertices coordinates (local space)
-        std::vector<Vector3> mVertices;
-
-        // Normals coordinates
-        std::vector<Vector3> mNormals;
-
-        // Tangents coordinates
-        std::vector<Vector3> mTangents;
-
-        // Color for each vertex
-        std::vector<Color> mColors;
-
-        // UV texture coordinates
-        std::vector<Vector2> mUVs;
+        // True if the geometry data has been created by a mesh (false if it has been
+        // given with setGeometry(), it is then copied before any modification)
+        bool mIsGeometryOwned;
 
         // Textures of the mesh (one for each part of the mesh)
         std::map<uint, Texture2D> mTextures;
 
+        // -------------------- Methods -------------------- //
+
+        // Return the geometry data for modification (it is copied first if it is
+        // shared with other meshes or if it has been given with setGeometry())
+        MeshGeometry& getWritableGeometry();
+
     public:
 
         // -------------------- Methods -------------------- //
@@ -94,6 +103,39 @@ class Mesh : public Object3D {
         // Scale of vertices of the mesh using a given factor
         void scaleVertices(float factor);
 
+        // Return the bounding box of a part of the mesh (local space)
+        const AABB& getPartAABB(uint part = 0) const;
+
+        // Return the bounding sphere of a part of the mesh (local space)
+        const BoundingSphere& getPartBoundingSphere(uint part = 0) const;
+
+        // Return the bounding box of all the vertices of the mesh (local space)
+        const AABB& getAABB() const;
+
+        // Return the bounding sphere of all the vertices of the mesh (local space)
+        const BoundingSphere& getBoundingSphere() const;
+
+        // Return the bounding box of the mesh in world-space
+        AABB getWorldAABB() const;
+
+        // Return the bounding sphere of the mesh in world-space
+        BoundingSphere getWorldBoundingSphere() const;
+
+        // Share the geometry data of another mesh (until one of the meshes is modified)
+        void shareGeometry(const Mesh& mesh);
+
+        // Set the geometry data of the mesh (the mesh takes a reference to the
+        // geometry block instead of copying it). The mesh never modifies this block
+        // (it is copied before the first modification of the mesh) and the caller
+        // must not modify it anymore either.
+        void setGeometry(const std::shared_ptr<const MeshGeometry>& geometry);
+
+        // Return true if the geometry data is shared with another mesh
+        bool isGeometryShared() const;
+
+        // Return the geometry data of the mesh
+        std::shared_ptr<const MeshGeometry> getGeometry() const;
+
         // Return the number of triangles
         uint getNbFaces(uint part = 0) const;
 
@@ -109,24 +151,54 @@ class Mesh : public Object3D {
         // Set the vertices of the mesh
         void setVertices(std::vector<Vector3>& vertices);
 
+        // Set the vertices of the mesh (the array is moved, not copied)
+        void setVertices(std::vector<Vector3>&& vertices);
+
         // Return a reference to the normals
         const std::vector<Vector3>& getNormals() const;
 
         // set the normals of the mesh
         void setNormals(std::vector<Vector3>& normals);
 
+        // set the normals of the mesh (the array is moved, not copied)
+        void setNormals(std::vector<Vector3>&& normals);
+
         // Return a reference to the UVs
         const std::vector<Vector2>& getUVs() const;
 
         // Set the UV texture coordinates of the mesh
         void setUVs(std::vector<Vector2>& uvs);
 
+        // Set the UV texture coordinates of the mesh (the array is moved, not copied)
+        void setUVs(std::vector<Vector2>&& uvs);
+
+        // Return a reference to the tangents
+        const std::vector<Vector3>& getTangents() const;
+
+        // Set the tangents of the mesh
+        void setTangents(std::vector<Vector3>& tangents);
+
+        // Set the tangents of the mesh (the array is moved, not copied)
+        void setTangents(std::vector<Vector3>&& tangents);
+
+        // Return a reference to the vertex colors
+        const std::vector<Color>& getColors() const;
+
+        // Set the vertex colors of the mesh
+        void setColors(std::vector<Color>& colors);
+
+        // Set the vertex colors of the mesh (the array is moved, not copied)
+        void setColors(std::vector<Color>&& colors);
+
         // Return a reference to the vertex indices
         const std::vector<uint>& getIndices(uint part = 0) const;
 
         // Set the vertices indices of the mesh
         void setIndices(std::vector<std::vector<uint> >& indices);
 
+        // Set the vertices indices of the mesh (the array is moved, not copied)
+        void setIndices(std::vector<std::vector<uint> >&& indices);
+
         // Return the coordinates of a given vertex
         const Vector3& getVertex(uint i) const;
 
@@ -177,23 +249,24 @@ class Mesh : public Object3D {
         // part of the mesh
         bool hasTexture() const;
 
-        // Return a pointer to the vertices data
-        void* getVerticesPointer();
+        // Return a pointer to the vertices data (the data must not be modified
+        // through the pointers because it may be shared with other meshes)
+        const void* getVerticesPointer() const;
 
         // Return a pointer to the normals data
-        void* getNormalsPointer();
+        const void* getNormalsPointer() const;
 
         // Return a pointer to the colors data
-        void* getColorsPointer();
+        const void* getColorsPointer() const;
 
         // Return a pointer to the tangents data
-        void* getTangentsPointer();
+        const void* getTangentsPointer() const;
 
         // Return a pointer to the UV texture coordinates data
-        void* getUVTextureCoordinatesPointer();
+        const void* getUVTextureCoordinatesPointer() const;
 
         // Return a pointer to the vertex indicies data
-        void* getIndicesPointer(uint part = 0);
+        const void* getIndicesPointer(uint part = 0) const;
 
         // Return a reference to a texture of the mesh
         Texture2D &getTexture(uint part = 0);
@@ -204,154 +277,304 @@ class Mesh : public Object3D {
 
 // Return the number of triangles
 inline uint Mesh::getNbFaces(uint part) const {
-    return mIndices[part].size() / 3;
+    return mGeometry->indices[part].size() / 3;
 }
 
 // Return the number of vertices
 inline uint Mesh::getNbVertices() const {
-    return mVertices.size();
+    return mGeometry->vertices.size();
 }
 
 // Return the number of parts in the mesh
 inline uint Mesh::getNbParts() const {
-    return mIndices.size();
+    return mGeometry->indices.size();
 }
 
 // Return a reference to the vertices
 inline const std::vector<Vector3>& Mesh::getVertices() const {
-    return mVertices;
+    return mGeometry->vertices;
 }
 
 // Set the vertices of the mesh
 inline void Mesh::setVertices(std::vector<Vector3>& vertices) {
-    mVertices = vertices;
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.vertices = vertices;
+    geometry.isBoundingVolumesValid = false;
+}
+
+// Set the vertices of the mesh (the array is moved, not copied)
+inline void Mesh::setVertices(std::vector<Vector3>&& vertices) {
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.vertices = std::move(vertices);
+    geometry.isBoundingVolumesValid = false;
 }
 
 // Return a reference to the normals
 inline const std::vector<Vector3>& Mesh::getNormals() const {
-    return mNormals;
+    return mGeometry->normals;
 }
 
 // set the normals of the mesh
 inline void Mesh::setNormals(std::vector<Vector3>& normals) {
-    mNormals = normals;
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.normals = normals;
+}
+
+// set the normals of the mesh (the array is moved, not copied)
+inline void Mesh::setNormals(std::vector<Vector3>&& normals) {
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.normals = std::move(normals);
 }
 
 // Return a reference to the UVs
 inline const std::vector<Vector2>& Mesh::getUVs() const {
-    return mUVs;
+    return mGeometry->uvs;
 }
 
 // Set the UV texture coordinates of the mesh
 inline void Mesh::setUVs(std::vector<Vector2>& uvs) {
-    mUVs = uvs;
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.uvs = uvs;
+}
+
+// Set the UV texture coordinates of the mesh (the array is moved, not copied)
+inline void Mesh::setUVs(std::vector<Vector2>&& uvs) {
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.uvs = std::move(uvs);
+}
+
+// Return a reference to the tangents
+inline const std::vector<Vector3>& Mesh::getTangents() const {
+    return mGeometry->tangents;
+}
+
+// Set the tangents of the mesh
+inline void Mesh::setTangents(std::vector<Vector3>& tangents) {
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.tangents = tangents;
+}
+
+// Set the tangents of the mesh (the array is moved, not copied)
+inline void Mesh::setTangents(std::vector<Vector3>&& tangents) {
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.tangents = std::move(tangents);
+}
+
+// Return a reference to the vertex colors
+inline const std::vector<Color>& Mesh::getColors() const {
+    return mGeometry->colors;
+}
+
+// Set the vertex colors of the mesh
+inline void Mesh::setColors(std::vector<Color>& colors) {
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.colors = colors;
+}
+
+// Set the vertex colors of the mesh (the array is moved, not copied)
+inline void Mesh::setColors(std::vector<Color>&& colors) {
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.colors = std::move(colors);
 }
 
 // Return a reference to the vertex indices
 inline const std::vector<uint>& Mesh::getIndices(uint part) const {
-    return mIndices[part];
+    return mGeometry->indices[part];
 }
 
 // Set the vertices indices of the mesh
 inline void Mesh::setIndices(std::vector<std::vector<uint> >& indices) {
-    mIndices = indices;
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.indices = indices;
+    geometry.isBoundingVolumesValid = false;
+}
+
+// Set the vertices indices of the mesh (the array is moved, not copied)
+inline void Mesh::setIndices(std::vector<std::vector<uint> >&& indices) {
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.indices = std::move(indices);
+    geometry.isBoundingVolumesValid = false;
 }
 
 // Return the coordinates of a given vertex
 inline const Vector3& Mesh::getVertex(uint i) const {
     assert(i < getNbVertices());
-    return mVertices[i];
+    return mGeometry->vertices[i];
 }
 
 // Set the coordinates of a given vertex
 inline void Mesh::setVertex(uint i, const Vector3& vertex) {
     assert(i < getNbVertices());
-    mVertices[i] = vertex;
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.vertices[i] = vertex;
+    geometry.isBoundingVolumesValid = false;
+}
+
+// Return the bounding box of a part of the mesh (local space)
+inline const AABB& Mesh::getPartAABB(uint part) const {
+    assert(part < getNbParts());
+    mGeometry->updateBoundingVolumesIfNeeded();
+    return mGeometry->partAABBs[part];
+}
+
+// Return the bounding sphere of a part of the mesh (local space)
+inline const BoundingSphere& Mesh::getPartBoundingSphere(uint part) const {
+    assert(part < getNbParts());
+    mGeometry->updateBoundingVolumesIfNeeded();
+    return mGeometry->partBoundingSpheres[part];
+}
+
+// Return the bounding box of all the vertices of the mesh (local space)
+inline const AABB& Mesh::getAABB() const {
+    mGeometry->updateBoundingVolumesIfNeeded();
+    return mGeometry->aabb;
+}
+
+// Return the bounding sphere of all the vertices of the mesh (local space)
+inline const BoundingSphere& Mesh::getBoundingSphere() const {
+    mGeometry->updateBoundingVolumesIfNeeded();
+    return mGeometry->boundingSphere;
+}
+
+// Return the bounding box of the mesh in world-space
+inline AABB Mesh::getWorldAABB() const {
+    return getAABB().getTransformed(getTransformMatrix());
+}
+
+// Return the bounding sphere of the mesh in world-space
+inline BoundingSphere Mesh::getWorldBoundingSphere() const {
+    return getBoundingSphere().getTransformed(getTransformMatrix());
+}
+
+// Share the geometry data of another mesh (until one of the meshes is modified)
+inline void Mesh::shareGeometry(const Mesh& mesh) {
+    mGeometry = mesh.mGeometry;
+    mIsGeometryOwned = mesh.mIsGeometryOwned;
+}
+
+// Set the geometry data of the mesh (the mesh takes a reference to the
+// geometry block instead of copying it). The mesh never modifies this block
+// (it is copied before the first modification of the mesh) and the caller
+// must not modify it anymore either.
+inline void Mesh::setGeometry(const std::shared_ptr<const MeshGeometry>& geometry) {
+    assert(geometry);
+    mGeometry = geometry;
+    mIsGeometryOwned = false;
+}
+
+// Return true if the geometry data is shared with another mesh (the result is
+// only reliable if the other meshes are not copied or destroyed concurrently)
+inline bool Mesh::isGeometryShared() const {
+    return mGeometry.use_count() > 1;
+}
+
+// Return the geometry data of the mesh
+inline std::shared_ptr<const MeshGeometry> Mesh::getGeometry() const {
+    return mGeometry;
+}
+
+// Return the geometry data for modification (it is copied first if it is
+// shared with other meshes or if it has been given with setGeometry()). The
+// reference count is not a thread-safe uniqueness
+// test, so this must not run concurrently with copies of the meshes sharing the
+// geometry.
+inline MeshGeometry& Mesh::getWritableGeometry() {
+    if (!mIsGeometryOwned || mGeometry.use_count() > 1) {
+        mGeometry = std::make_shared<MeshGeometry>(*mGeometry);
+        mIsGeometryOwned = true;
+    }
+
+    // The geometry data created by a mesh is never const
+    return const_cast<MeshGeometry&>(*mGeometry);
 }
 
 // Return the coordinates of a given normal
 inline const Vector3& Mesh::getNormal(uint i) const {
     assert(i < getNbVertices());
-    return mNormals[i];
+    return mGeometry->normals[i];
 }
 
 // Set the coordinates of a given normal
 inline void Mesh::setNormal(uint i, const Vector3& normal) {
     assert(i < getNbVertices());
-    mNormals[i] = normal;
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.normals[i] = normal;
 }
 
 // Return the color of a given vertex
 inline const Color& Mesh::getColor(uint i) const {
     assert(i < getNbVertices());
-    return mColors[i];
+    return mGeometry->colors[i];
 }
 
 // Set the color of a given vertex
 inline void Mesh::setColor(uint i, const Color& color) {
+    MeshGeometry& geometry = getWritableGeometry();
 
     // If the color array does not have the same size as
     // the vertices array
-    if (mColors.size() != mVertices.size()) {
+    if (geometry.colors.size() != geometry.vertices.size()) {
 
         // Create the color array with the same size
-        mColors = std::vector<Color>(mVertices.size());
+        geometry.colors = std::vector<Color>(geometry.vertices.size());
     }
 
-    mColors[i] = color;
+    geometry.colors[i] = color;
 }
 
 // Set a color to all the vertices
 inline void Mesh::setColorToAllVertices(const Color& color) {
+    MeshGeometry& geometry = getWritableGeometry();
 
     // If the color array does not have the same size as
     // the vertices array
-    if (mColors.size() != mVertices.size()) {
+    if (geometry.colors.size() != geometry.vertices.size()) {
 
         // Create the color array with the same size
-        mColors = std::vector<Color>(mVertices.size());
+        geometry.colors = std::vector<Color>(geometry.vertices.size());
     }
 
-    for (size_t v=0; v<mVertices.size(); v++) {
-        mColors[v] = color;
+    for (size_t v=0; v<geometry.vertices.size(); v++) {
+        geometry.colors[v] = color;
     }
 }
 
 // Return the UV of a given vertex
 inline const Vector2& Mesh::getUV(uint i) const {
     assert(i < getNbVertices());
-    return mUVs[i];
+    return mGeometry->uvs[i];
 }
 
 // Set the UV of a given vertex
 inline void Mesh::setUV(uint i, const Vector2& uv) {
     assert(i < getNbVertices());
-    mUVs[i] = uv;
+    MeshGeometry& geometry = getWritableGeometry();
+    geometry.uvs[i] = uv;
 }
 
 // Return the vertex index of the ith (i=0,1,2) vertex of a given face
 inline uint Mesh::getVertexIndexInFace(uint faceIndex, uint i, uint part) const {
-    return (mIndices[part])[faceIndex*3 + i];
+    return (mGeometry->indices[part])[faceIndex*3 + i];
 }
 
 // Return true if the mesh has normals
 inline bool Mesh::hasNormals() const {
-    return mNormals.size() == mVertices.size();
+    return mGeometry->normals.size() == mGeometry->vertices.size();
 }
 
 // Return true if the mesh has tangents
 inline bool Mesh::hasTangents() const {
-    return mTangents.size() == mVertices.size();
+    return mGeometry->tangents.size() == mGeometry->vertices.size();
 }
 
 // Return true if the mesh has vertex colors
 inline bool Mesh::hasColors() const {
-    return mColors.size() == mVertices.size();
+    return mGeometry->colors.size() == mGeometry->vertices.size();
 }
 
 // Return true if the mesh has UV texture coordinates
 inline bool Mesh::hasUVTextureCoordinates() const {
-    return mUVs.size() == mVertices.size();
+    return mGeometry->uvs.size() == mGeometry->vertices.size();
 }
 
 // Return true if the mesh has a texture for a given part of the mesh and if it
@@ -367,33 +590,33 @@ inline bool Mesh::hasTexture() const {
 }
 
 // Return a pointer to the vertices data
-inline void* Mesh::getVerticesPointer() {
-    return &(mVertices[0]);
+inline const void* Mesh::getVerticesPointer() const {
+    return &(mGeometry->vertices[0]);
 }
 
 // Return a pointer to the normals data
-inline void* Mesh::getNormalsPointer() {
-    return &(mNormals[0]);
+inline const void* Mesh::getNormalsPointer() const {
+    return &(mGeometry->normals[0]);
 }
 
 // Return a pointer to the colors data
-inline void* Mesh::getColorsPointer() {
-    return &(mColors[0]);
+inline const void* Mesh::getColorsPointer() const {
+    return &(mGeometry->colors[0]);
 }
 
 // Return a pointer to the tangents data
-inline void* Mesh::getTangentsPointer() {
-    return &(mTangents[0]);
+inline const void* Mesh::getTangentsPointer() const {
+    return &(mGeometry->tangents[0]);
 }
 
 // Return a pointer to the UV texture coordinates data
-inline void* Mesh::getUVTextureCoordinatesPointer() {
-    return &(mUVs[0]);
+inline const void* Mesh::getUVTextureCoordinatesPointer() const {
+    return &(mGeometry->uvs[0]);
 }
 
 // Return a pointer to the vertex indicies data
-inline void* Mesh::getIndicesPointer(uint part) {
-    return &(mIndices[part])[0];
+inline const void* Mesh::getIndicesPointer(uint part) const {
+    return &(mGeometry->indices[part])[0];
 }
 
 // Return a reference to a texture of the mesh
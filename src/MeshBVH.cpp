@@ -0,0 +1,994 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "MeshBVH.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define BVH_USE_SSE
+#endif
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Constants
+const uint MeshBVH::MAX_LEAF_SIZE;
+const uint MeshBVH::MAX_DEPTH;
+
+// Number of bins used to evaluate the surface area heuristic
+static const uint NB_BINS = 16;
+
+// Cost of traversing a node relative to the cost of intersecting a triangle
+static const float TRAVERSAL_COST = 1.0f;
+
+// Minimum number of triangles of a subtree to build it in a separate task
+static const uint TASK_MIN_SIZE = 4096;
+
+// Child index of an empty slot of a wide node
+static const uint EMPTY_SLOT = 0xffffffff;
+
+// Return the surface area of a box
+static inline float getSurfaceArea(const AABB& aabb) {
+    if (aabb.isEmpty()) return 0.0f;
+    Vector3 size = aabb.max - aabb.min;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+// Comparison of the triangles by the coordinate of their centroid along an axis
+struct CentroidComparison {
+
+    const vector<Vector3>& centroids;
+    int axis;
+
+    CentroidComparison(const vector<Vector3>& centroids, int axis)
+        : centroids(centroids), axis(axis) {}
+
+    bool operator()(uint triangle1, uint triangle2) const {
+        return centroids[triangle1][axis] < centroids[triangle2][axis];
+    }
+};
+
+// Return the inverse of each component of the direction of a ray
+static inline Vector3 getInverseDirection(const Vector3& direction) {
+    const float infinity = numeric_limits<float>::infinity();
+    return Vector3(direction.x != 0.0f ? 1.0f / direction.x : infinity,
+                   direction.y != 0.0f ? 1.0f / direction.y : infinity,
+                   direction.z != 0.0f ? 1.0f / direction.z : infinity);
+}
+
+// Intersect a ray with the box of a node (slab test)
+static inline bool intersectRayNode(const BVHNode& node, const Vector3& origin,
+                                    const Vector3& invDirection, float maxDistance,
+                                    float& tNear) {
+    float tx1 = (node.min[0] - origin.x) * invDirection.x;
+    float tx2 = (node.max[0] - origin.x) * invDirection.x;
+    float ty1 = (node.min[1] - origin.y) * invDirection.y;
+    float ty2 = (node.max[1] - origin.y) * invDirection.y;
+    float tz1 = (node.min[2] - origin.z) * invDirection.z;
+    float tz2 = (node.max[2] - origin.z) * invDirection.z;
+    float tMin = max(max(min(tx1, tx2), min(ty1, ty2)), max(min(tz1, tz2), 0.0f));
+    float tMax = min(min(max(tx1, tx2), max(ty1, ty2)), min(max(tz1, tz2), maxDistance));
+    tNear = tMin;
+    return tMin <= tMax;
+}
+
+// Intersect a ray with the four child boxes of a wide node and return a bit mask
+// of the intersected children
+static inline int intersectRayWideNode(const BVHWideNode& node, const Vector3& origin,
+                                       const Vector3& invDirection, float maxDistance,
+                                       float tNear[4]) {
+#ifdef BVH_USE_SSE
+    const __m128 ox = _mm_set1_ps(origin.x);
+    const __m128 oy = _mm_set1_ps(origin.y);
+    const __m128 oz = _mm_set1_ps(origin.z);
+    const __m128 ix = _mm_set1_ps(invDirection.x);
+    const __m128 iy = _mm_set1_ps(invDirection.y);
+    const __m128 iz = _mm_set1_ps(invDirection.z);
+    __m128 tx1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minX), ox), ix);
+    __m128 tx2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxX), ox), ix);
+    __m128 ty1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minY), oy), iy);
+    __m128 ty2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxY), oy), iy);
+    __m128 tz1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minZ), oz), iz);
+    __m128 tz2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maxZ), oz), iz);
+    __m128 tMin = _mm_max_ps(_mm_max_ps(_mm_min_ps(tx1, tx2), _mm_min_ps(ty1, ty2)),
+                             _mm_max_ps(_mm_min_ps(tz1, tz2), _mm_setzero_ps()));
+    __m128 tMax = _mm_min_ps(_mm_min_ps(_mm_max_ps(tx1, tx2), _mm_max_ps(ty1, ty2)),
+                             _mm_min_ps(_mm_max_ps(tz1, tz2), _mm_set1_ps(maxDistance)));
+    _mm_storeu_ps(tNear, tMin);
+    return _mm_movemask_ps(_mm_cmple_ps(tMin, tMax));
+#else
+    int mask = 0;
+    for (int i=0; i<4; i++) {
+        float tx1 = (node.minX[i] - origin.x) * invDirection.x;
+        float tx2 = (node.maxX[i] - origin.x) * invDirection.x;
+        float ty1 = (node.minY[i] - origin.y) * invDirection.y;
+        float ty2 = (node.maxY[i] - origin.y) * invDirection.y;
+        float tz1 = (node.minZ[i] - origin.z) * invDirection.z;
+        float tz2 = (node.maxZ[i] - origin.z) * invDirection.z;
+        float tMin = max(max(min(tx1, tx2), min(ty1, ty2)), max(min(tz1, tz2), 0.0f));
+        float tMax = min(min(max(tx1, tx2), max(ty1, ty2)), min(max(tz1, tz2), maxDistance));
+        tNear[i] = tMin;
+        if (tMin <= tMax) mask |= (1 << i);
+    }
+    return mask;
+#endif
+}
+
+// Constructor
+MeshBVH::MeshBVH() {
+
+}
+
+// Constructor
+MeshBVH::MeshBVH(const Mesh& mesh, bool isWideTreeBuilt) {
+    build(mesh, isWideTreeBuilt);
+}
+
+// Destructor
+MeshBVH::~MeshBVH() {
+
+}
+
+// Build the BVH over all the triangles of a mesh
+void MeshBVH::build(const Mesh& mesh, bool isWideTreeBuilt) {
+
+    destroy();
+
+    // Number the triangles of all the parts
+    vector<uint> partFirstTriangles(mesh.getNbParts() + 1, 0);
+    for (uint p=0; p<mesh.getNbParts(); p++) {
+        partFirstTriangles[p + 1] = partFirstTriangles[p] + mesh.getNbFaces(p);
+    }
+    const uint nbTriangles = partFirstTriangles.back();
+    if (nbTriangles == 0) return;
+
+    // Compute the bounding box and the centroid of each triangle
+    vector<AABB> triangleAABBs(nbTriangles);
+    vector<Vector3> centroids(nbTriangles);
+    vector<uint> parts(nbTriangles);
+    vector<uint> faces(nbTriangles);
+    const vector<Vector3>& vertices = mesh.getVertices();
+    for (uint p=0; p<mesh.getNbParts(); p++) {
+        const vector<uint>& indices = mesh.getIndices(p);
+        const int nbFaces = int(mesh.getNbFaces(p));
+        #pragma omp parallel for
+        for (int f=0; f<nbFaces; f++) {
+            uint t = partFirstTriangles[p] + f;
+            const Vector3& v1 = vertices[indices[3*f]];
+            const Vector3& v2 = vertices[indices[3*f + 1]];
+            const Vector3& v3 = vertices[indices[3*f + 2]];
+            triangleAABBs[t].merge(v1);
+            triangleAABBs[t].merge(v2);
+            triangleAABBs[t].merge(v3);
+            centroids[t] = triangleAABBs[t].getCenter();
+            parts[t] = p;
+            faces[t] = f;
+        }
+    }
+
+    // Build the tree in a temporary array where each subtree of n triangles
+    // has room for 2n-1 nodes so that the subtrees can be built in parallel
+    vector<uint> triangles(nbTriangles);
+    for (uint t=0; t<nbTriangles; t++) triangles[t] = t;
+    vector<BVHNode> nodes(2 * nbTriangles - 1);
+    #pragma omp parallel
+    {
+        #pragma omp single
+        buildSubtree(nodes, 0, 0, nbTriangles, triangles, triangleAABBs, centroids, 0);
+    }
+
+    // Copy the used nodes in depth-first order
+    mNodes.reserve(2 * nbTriangles - 1);
+    compactSubtree(nodes, 0);
+
+    // Copy the triangles in the leaf order
+    mTriangleVertices.resize(3 * nbTriangles);
+    mTriangleParts.resize(nbTriangles);
+    mTriangleFaces.resize(nbTriangles);
+    #pragma omp parallel for
+    for (int i=0; i<int(nbTriangles); i++) {
+        uint t = triangles[i];
+        const vector<uint>& indices = mesh.getIndices(parts[t]);
+        mTriangleVertices[3*i] = vertices[indices[3*faces[t]]];
+        mTriangleVertices[3*i + 1] = vertices[indices[3*faces[t] + 1]];
+        mTriangleVertices[3*i + 2] = vertices[indices[3*faces[t] + 2]];
+        mTriangleParts[i] = parts[t];
+        mTriangleFaces[i] = faces[t];
+    }
+
+    if (isWideTreeBuilt) {
+        buildWideTree();
+    }
+}
+
+// Build the subtree of a range of triangles
+void MeshBVH::buildSubtree(vector<BVHNode>& nodes, uint nodeIndex, uint begin, uint end,
+                           vector<uint>& triangles, const vector<AABB>& triangleAABBs,
+                           const vector<Vector3>& centroids, uint depth) {
+
+    const uint nbTriangles = end - begin;
+
+    // Compute the bounds of the triangles and of their centroids
+    AABB bounds;
+    AABB centroidBounds;
+    for (uint i=begin; i<end; i++) {
+        bounds.merge(triangleAABBs[triangles[i]]);
+        centroidBounds.merge(centroids[triangles[i]]);
+    }
+    BVHNode& node = nodes[nodeIndex];
+    node.min[0] = bounds.min.x; node.min[1] = bounds.min.y; node.min[2] = bounds.min.z;
+    node.max[0] = bounds.max.x; node.max[1] = bounds.max.y; node.max[2] = bounds.max.z;
+    node.axis = 0;
+
+    if (nbTriangles == 1) {
+        node.data = begin;
+        node.nbTriangles = 1;
+        return;
+    }
+
+    // ---------- Find the best split with the binned SAH ---------- //
+
+    float bestCost = numeric_limits<float>::max();
+    int bestAxis = -1;
+    uint bestSplit = 0;
+    for (int axis=0; axis<3; axis++) {
+
+        float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+        if (extent <= 0.0f) continue;
+        float scale = float(NB_BINS) / extent;
+
+        // Put the triangles into the bins
+        uint binCounts[NB_BINS] = {0};
+        AABB binBounds[NB_BINS];
+        for (uint i=begin; i<end; i++) {
+            uint t = triangles[i];
+            uint bin = min(NB_BINS - 1, uint((centroids[t][axis] - centroidBounds.min[axis]) * scale));
+            binCounts[bin]++;
+            binBounds[bin].merge(triangleAABBs[t]);
+        }
+
+        // Sweep from the right to compute the cost of the right side of each split
+        float rightAreas[NB_BINS];
+        uint rightCounts[NB_BINS];
+        AABB accumulatedBounds;
+        uint accumulatedCount = 0;
+        for (uint b=NB_BINS-1; b>0; b--) {
+            accumulatedBounds.merge(binBounds[b]);
+            accumulatedCount += binCounts[b];
+            rightAreas[b] = getSurfaceArea(accumulatedBounds);
+            rightCounts[b] = accumulatedCount;
+        }
+
+        // Sweep from the left and evaluate each split
+        accumulatedBounds = AABB();
+        accumulatedCount = 0;
+        for (uint b=0; b<NB_BINS-1; b++) {
+            accumulatedBounds.merge(binBounds[b]);
+            accumulatedCount += binCounts[b];
+            if (accumulatedCount == 0 || rightCounts[b + 1] == 0) continue;
+            float cost = accumulatedCount * getSurfaceArea(accumulatedBounds) +
+                         rightCounts[b + 1] * rightAreas[b + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b + 1;
+            }
+        }
+    }
+
+    // Create a leaf if it is cheaper than splitting
+    float area = getSurfaceArea(bounds);
+    float leafCost = nbTriangles * area;
+    float splitCost = TRAVERSAL_COST * area + bestCost;
+    if (nbTriangles <= MAX_LEAF_SIZE && (bestAxis < 0 || leafCost <= splitCost)) {
+        node.data = begin;
+        node.nbTriangles = nbTriangles;
+        return;
+    }
+
+    // ---------- Partition the triangles ---------- //
+
+    uint middle = begin;
+    if (bestAxis >= 0 && depth < MAX_DEPTH / 2) {
+        float minCentroid = centroidBounds.min[bestAxis];
+        float scale = float(NB_BINS) / (centroidBounds.max[bestAxis] - minCentroid);
+        uint* first = &triangles[0] + begin;
+        uint* last = &triangles[0] + end;
+        uint* split = first;
+        for (uint* it=first; it!=last; ++it) {
+            uint bin = min(NB_BINS - 1, uint((centroids[*it][bestAxis] - minCentroid) * scale));
+            if (bin < bestSplit) swap(*it, *split++);
+        }
+        middle = begin + uint(split - first);
+        node.axis = bestAxis;
+    }
+
+    // If the SAH did not find a split (or if the tree becomes too deep),
+    // split at the median of the largest axis of the centroids
+    if (middle == begin || middle == end) {
+        Vector3 extent = centroidBounds.max - centroidBounds.min;
+        int axis = (extent.x > extent.y) ? ((extent.x > extent.z) ? 0 : 2) :
+                                           ((extent.y > extent.z) ? 1 : 2);
+        middle = begin + nbTriangles / 2;
+        CentroidComparison comparison(centroids, axis);
+        nth_element(triangles.begin() + begin, triangles.begin() + middle,
+                    triangles.begin() + end, comparison);
+        node.axis = axis;
+    }
+
+    // ---------- Build the children ---------- //
+
+    uint leftIndex = nodeIndex + 1;
+    uint rightIndex = nodeIndex + 2 * (middle - begin);
+    node.data = rightIndex;
+    node.nbTriangles = 0;
+
+    if (nbTriangles >= TASK_MIN_SIZE) {
+        #pragma omp task shared(nodes, triangles, triangleAABBs, centroids)
+        buildSubtree(nodes, leftIndex, begin, middle, triangles, triangleAABBs, centroids,
+                     depth + 1);
+        buildSubtree(nodes, rightIndex, middle, end, triangles, triangleAABBs, centroids,
+                     depth + 1);
+        #pragma omp taskwait
+    }
+    else {
+        buildSubtree(nodes, leftIndex, begin, middle, triangles, triangleAABBs, centroids,
+                     depth + 1);
+        buildSubtree(nodes, rightIndex, middle, end, triangles, triangleAABBs, centroids,
+                     depth + 1);
+    }
+}
+
+// Copy a subtree into the final array of nodes in depth-first order
+uint MeshBVH::compactSubtree(const vector<BVHNode>& nodes, uint nodeIndex) {
+
+    uint newIndex = mNodes.size();
+    mNodes.push_back(nodes[nodeIndex]);
+
+    if (!nodes[nodeIndex].isLeaf()) {
+
+        // The first child directly follows its parent
+        compactSubtree(nodes, nodeIndex + 1);
+        uint rightIndex = compactSubtree(nodes, nodes[nodeIndex].data);
+        mNodes[newIndex].data = rightIndex;
+    }
+
+    return newIndex;
+}
+
+// Build the 4-ary tree from the binary tree
+void MeshBVH::buildWideTree() {
+
+    mWideNodes.clear();
+    if (mNodes.empty()) return;
+
+    if (mNodes[0].isLeaf()) {
+
+        // The whole tree is a single leaf
+        BVHWideNode wideNode;
+        for (int i=0; i<4; i++) {
+            wideNode.minX[i] = wideNode.minY[i] = wideNode.minZ[i] = 0.0f;
+            wideNode.maxX[i] = wideNode.maxY[i] = wideNode.maxZ[i] = 0.0f;
+            wideNode.children[i] = EMPTY_SLOT;
+            wideNode.nbTriangles[i] = 0;
+        }
+        const BVHNode& root = mNodes[0];
+        wideNode.minX[0] = root.min[0]; wideNode.minY[0] = root.min[1]; wideNode.minZ[0] = root.min[2];
+        wideNode.maxX[0] = root.max[0]; wideNode.maxY[0] = root.max[1]; wideNode.maxZ[0] = root.max[2];
+        wideNode.children[0] = root.data;
+        wideNode.nbTriangles[0] = root.nbTriangles;
+        mWideNodes.push_back(wideNode);
+    }
+    else {
+        collapseSubtree(0);
+    }
+}
+
+// Collapse a subtree of the binary tree into the 4-ary tree
+uint MeshBVH::collapseSubtree(uint nodeIndex) {
+
+    assert(!mNodes[nodeIndex].isLeaf());
+
+    uint wideIndex = mWideNodes.size();
+    mWideNodes.push_back(BVHWideNode());
+
+    // Start with the two children of the node and replace the internal child
+    // with the largest surface area by its own children until we have four children
+    uint children[4];
+    uint nbChildren = 0;
+    children[nbChildren++] = nodeIndex + 1;
+    children[nbChildren++] = mNodes[nodeIndex].data;
+    while (nbChildren < 4) {
+        int largest = -1;
+        float largestArea = -1.0f;
+        for (uint i=0; i<nbChildren; i++) {
+            const BVHNode& child = mNodes[children[i]];
+            if (child.isLeaf()) continue;
+            float area = getSurfaceArea(AABB(Vector3(child.min[0], child.min[1], child.min[2]),
+                                             Vector3(child.max[0], child.max[1], child.max[2])));
+            if (area > largestArea) {
+                largestArea = area;
+                largest = i;
+            }
+        }
+        if (largest < 0) break;
+        uint expanded = children[largest];
+        children[largest] = expanded + 1;
+        children[nbChildren++] = mNodes[expanded].data;
+    }
+
+    // Fill in the wide node (the recursion can reallocate the array of nodes)
+    BVHWideNode wideNode;
+    for (uint i=0; i<4; i++) {
+        if (i < nbChildren) {
+            const BVHNode& child = mNodes[children[i]];
+            wideNode.minX[i] = child.min[0]; wideNode.minY[i] = child.min[1]; wideNode.minZ[i] = child.min[2];
+            wideNode.maxX[i] = child.max[0]; wideNode.maxY[i] = child.max[1]; wideNode.maxZ[i] = child.max[2];
+            wideNode.nbTriangles[i] = child.nbTriangles;
+            wideNode.children[i] = child.isLeaf() ? child.data : collapseSubtree(children[i]);
+        }
+        else {
+            wideNode.minX[i] = wideNode.minY[i] = wideNode.minZ[i] = 0.0f;
+            wideNode.maxX[i] = wideNode.maxY[i] = wideNode.maxZ[i] = 0.0f;
+            wideNode.nbTriangles[i] = 0;
+            wideNode.children[i] = EMPTY_SLOT;
+        }
+    }
+    wideNode.padding[0] = wideNode.padding[1] = 0;
+    mWideNodes[wideIndex] = wideNode;
+
+    return wideIndex;
+}
+
+// Destroy the BVH
+void MeshBVH::destroy() {
+    mNodes.clear();
+    mWideNodes.clear();
+    mTriangleVertices.clear();
+    mTriangleParts.clear();
+    mTriangleFaces.clear();
+}
+
+// Intersect a ray with a triangle (Moller-Trumbore)
+bool MeshBVH::intersectTriangle(uint triangle, const Ray& ray, float maxDistance,
+                                float& distance, float& u, float& v) const {
+
+    const Vector3& v0 = mTriangleVertices[3 * triangle];
+    Vector3 edge1 = mTriangleVertices[3 * triangle + 1] - v0;
+    Vector3 edge2 = mTriangleVertices[3 * triangle + 2] - v0;
+
+    Vector3 p = ray.direction.cross(edge2);
+    float determinant = edge1.dot(p);
+    if (fabs(determinant) < numeric_limits<float>::min()) return false;
+    float invDeterminant = 1.0f / determinant;
+
+    Vector3 s = ray.origin - v0;
+    u = s.dot(p) * invDeterminant;
+    if (u < 0.0f || u > 1.0f) return false;
+
+    Vector3 q = s.cross(edge1);
+    v = ray.direction.dot(q) * invDeterminant;
+    if (v < 0.0f || u + v > 1.0f) return false;
+
+    distance = edge2.dot(q) * invDeterminant;
+    return distance >= 0.0f && distance <= maxDistance;
+}
+
+// Closest hit traversal of the binary tree
+bool MeshBVH::raycastBinary(const Ray& ray, bool isAnyHit, RaycastHit& hit) const {
+
+    if (mNodes.empty()) return false;
+
+    const Vector3 invDirection = getInverseDirection(ray.direction);
+    const bool isDirectionNegative[3] = {ray.direction.x < 0.0f, ray.direction.y < 0.0f,
+                                         ray.direction.z < 0.0f};
+
+    float closestDistance = ray.maxDistance;
+    bool isHit = false;
+
+    uint stack[MAX_DEPTH];
+    uint stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+
+        const BVHNode& node = mNodes[stack[--stackSize]];
+        uint nodeIndex = uint(&node - &mNodes[0]);
+
+        float tNear;
+        if (!intersectRayNode(node, ray.origin, invDirection, closestDistance, tNear)) continue;
+
+        if (node.isLeaf()) {
+            for (uint t=node.data; t<node.data + node.nbTriangles; t++) {
+                float distance, u, v;
+                if (intersectTriangle(t, ray, closestDistance, distance, u, v)) {
+                    closestDistance = distance;
+                    hit.part = mTriangleParts[t];
+                    hit.face = mTriangleFaces[t];
+                    hit.u = u;
+                    hit.v = v;
+                    hit.distance = distance;
+                    isHit = true;
+                    if (isAnyHit) return true;
+                }
+            }
+        }
+        else {
+
+            // Visit the nearest child first (it is pushed last)
+            assert(stackSize + 2 <= MAX_DEPTH);
+            if (isDirectionNegative[node.axis]) {
+                stack[stackSize++] = nodeIndex + 1;
+                stack[stackSize++] = node.data;
+            }
+            else {
+                stack[stackSize++] = node.data;
+                stack[stackSize++] = nodeIndex + 1;
+            }
+        }
+    }
+
+    return isHit;
+}
+
+// Closest hit traversal of the 4-ary tree
+bool MeshBVH::raycastWide(const Ray& ray, bool isAnyHit, RaycastHit& hit) const {
+
+    const Vector3 invDirection = getInverseDirection(ray.direction);
+
+    float closestDistance = ray.maxDistance;
+    bool isHit = false;
+
+    // The stack contains the nodes and their distance along the ray
+    uint stackNodes[3 * MAX_DEPTH];
+    float stackDistances[3 * MAX_DEPTH];
+    uint stackSize = 0;
+    stackNodes[stackSize] = 0;
+    stackDistances[stackSize++] = 0.0f;
+
+    while (stackSize > 0) {
+
+        stackSize--;
+        if (stackDistances[stackSize] > closestDistance) continue;
+        const BVHWideNode& node = mWideNodes[stackNodes[stackSize]];
+
+        // Test the four children at once
+        float tNear[4];
+        int mask = intersectRayWideNode(node, ray.origin, invDirection, closestDistance, tNear);
+
+        // Sort the intersected children by distance
+        uint order[4];
+        uint nbHitChildren = 0;
+        for (uint i=0; i<4; i++) {
+            if (!(mask & (1 << i)) || node.children[i] == EMPTY_SLOT) continue;
+            uint j = nbHitChildren++;
+            while (j > 0 && tNear[order[j-1]] > tNear[i]) {
+                order[j] = order[j-1];
+                j--;
+            }
+            order[j] = i;
+        }
+
+        // Intersect the leaves from the nearest one
+        for (uint k=0; k<nbHitChildren; k++) {
+            uint i = order[k];
+            if (node.nbTriangles[i] == 0 || tNear[i] > closestDistance) continue;
+            for (uint t=node.children[i]; t<node.children[i] + node.nbTriangles[i]; t++) {
+                float distance, u, v;
+                if (intersectTriangle(t, ray, closestDistance, distance, u, v)) {
+                    closestDistance = distance;
+                    hit.part = mTriangleParts[t];
+                    hit.face = mTriangleFaces[t];
+                    hit.u = u;
+                    hit.v = v;
+                    hit.distance = distance;
+                    isHit = true;
+                    if (isAnyHit) return true;
+                }
+            }
+        }
+
+        // Push the internal children from the farthest one
+        for (int k=int(nbHitChildren)-1; k>=0; k--) {
+            uint i = order[k];
+            if (node.nbTriangles[i] != 0) continue;
+            assert(stackSize < 3 * MAX_DEPTH);
+            stackNodes[stackSize] = node.children[i];
+            stackDistances[stackSize++] = tNear[i];
+        }
+    }
+
+    return isHit;
+}
+
+// Return the closest intersections of a packet of rays with the triangles
+// (local-space). The returned bit mask contains the rays that hit a triangle.
+int MeshBVH::raycastPacket(const RayPacket& packet, RaycastHit hits[RayPacket::SIZE]) const {
+
+    if (mNodes.empty()) return 0;
+
+#ifdef BVH_USE_SSE
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 minDeterminant = _mm_set1_ps(numeric_limits<float>::min());
+
+    const __m128 ox = _mm_loadu_ps(packet.originX);
+    const __m128 oy = _mm_loadu_ps(packet.originY);
+    const __m128 oz = _mm_loadu_ps(packet.originZ);
+    const __m128 dx = _mm_loadu_ps(packet.directionX);
+    const __m128 dy = _mm_loadu_ps(packet.directionY);
+    const __m128 dz = _mm_loadu_ps(packet.directionZ);
+    float invDirections[3][RayPacket::SIZE];
+    for (int i=0; i<RayPacket::SIZE; i++) {
+        Vector3 invDirection = getInverseDirection(Vector3(packet.directionX[i],
+                                                           packet.directionY[i],
+                                                           packet.directionZ[i]));
+        invDirections[0][i] = invDirection.x;
+        invDirections[1][i] = invDirection.y;
+        invDirections[2][i] = invDirection.z;
+    }
+    const __m128 ix = _mm_loadu_ps(invDirections[0]);
+    const __m128 iy = _mm_loadu_ps(invDirections[1]);
+    const __m128 iz = _mm_loadu_ps(invDirections[2]);
+    __m128 closestDistances = _mm_loadu_ps(packet.maxDistance);
+
+    // The children are visited in the order given by the first active ray
+    int firstRay = 0;
+    while (firstRay < RayPacket::SIZE && !packet.isRayActive(firstRay)) firstRay++;
+    if (firstRay == RayPacket::SIZE) return 0;
+    const bool isDirectionNegative[3] = {packet.directionX[firstRay] < 0.0f,
+                                         packet.directionY[firstRay] < 0.0f,
+                                         packet.directionZ[firstRay] < 0.0f};
+
+    int hitMask = 0;
+
+    uint stack[MAX_DEPTH];
+    uint stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+
+        uint nodeIndex = stack[--stackSize];
+        const BVHNode& node = mNodes[nodeIndex];
+
+        // Test the box of the node against the four rays
+        __m128 tx1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.min[0]), ox), ix);
+        __m128 tx2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.max[0]), ox), ix);
+        __m128 ty1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.min[1]), oy), iy);
+        __m128 ty2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.max[1]), oy), iy);
+        __m128 tz1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.min[2]), oz), iz);
+        __m128 tz2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.max[2]), oz), iz);
+        __m128 tMin = _mm_max_ps(_mm_max_ps(_mm_min_ps(tx1, tx2), _mm_min_ps(ty1, ty2)),
+                                 _mm_max_ps(_mm_min_ps(tz1, tz2), zero));
+        __m128 tMax = _mm_min_ps(_mm_min_ps(_mm_max_ps(tx1, tx2), _mm_max_ps(ty1, ty2)),
+                                 _mm_min_ps(_mm_max_ps(tz1, tz2), closestDistances));
+        if (_mm_movemask_ps(_mm_cmple_ps(tMin, tMax)) == 0) continue;
+
+        if (node.isLeaf()) {
+
+            for (uint t=node.data; t<node.data + node.nbTriangles; t++) {
+
+                // Intersect the triangle with the four rays (Moller-Trumbore)
+                const Vector3& v0 = mTriangleVertices[3 * t];
+                Vector3 edge1 = mTriangleVertices[3 * t + 1] - v0;
+                Vector3 edge2 = mTriangleVertices[3 * t + 2] - v0;
+                const __m128 e1x = _mm_set1_ps(edge1.x);
+                const __m128 e1y = _mm_set1_ps(edge1.y);
+                const __m128 e1z = _mm_set1_ps(edge1.z);
+                const __m128 e2x = _mm_set1_ps(edge2.x);
+                const __m128 e2y = _mm_set1_ps(edge2.y);
+                const __m128 e2z = _mm_set1_ps(edge2.z);
+
+                __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+                __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+                __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+                __m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)),
+                                                _mm_mul_ps(e1z, pz));
+                __m128 mask = _mm_cmpge_ps(_mm_andnot_ps(signMask, determinant), minDeterminant);
+                __m128 invDeterminant = _mm_div_ps(one, determinant);
+
+                __m128 sx = _mm_sub_ps(ox, _mm_set1_ps(v0.x));
+                __m128 sy = _mm_sub_ps(oy, _mm_set1_ps(v0.y));
+                __m128 sz = _mm_sub_ps(oz, _mm_set1_ps(v0.z));
+                __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)),
+                                                 _mm_mul_ps(sz, pz)), invDeterminant);
+
+                __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+                __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+                __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+                __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)),
+                                                 _mm_mul_ps(dz, qz)), invDeterminant);
+                __m128 distance = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)),
+                                                        _mm_mul_ps(e2z, qz)), invDeterminant);
+
+                mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+                mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+                mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), one));
+                mask = _mm_and_ps(mask, _mm_cmpge_ps(distance, zero));
+                mask = _mm_and_ps(mask, _mm_cmple_ps(distance, closestDistances));
+                int triangleMask = _mm_movemask_ps(mask);
+                if (triangleMask == 0) continue;
+
+                // Keep the closest hits
+                closestDistances = _mm_or_ps(_mm_and_ps(mask, distance),
+                                             _mm_andnot_ps(mask, closestDistances));
+                float distances[RayPacket::SIZE], us[RayPacket::SIZE], vs[RayPacket::SIZE];
+                _mm_storeu_ps(distances, distance);
+                _mm_storeu_ps(us, u);
+                _mm_storeu_ps(vs, v);
+                for (int i=0; i<RayPacket::SIZE; i++) {
+                    if (triangleMask & (1 << i)) {
+                        hits[i].part = mTriangleParts[t];
+                        hits[i].face = mTriangleFaces[t];
+                        hits[i].u = us[i];
+                        hits[i].v = vs[i];
+                        hits[i].distance = distances[i];
+                    }
+                }
+                hitMask |= triangleMask;
+            }
+        }
+        else {
+
+            // Visit the nearest child first (it is pushed last)
+            assert(stackSize + 2 <= MAX_DEPTH);
+            if (isDirectionNegative[node.axis]) {
+                stack[stackSize++] = nodeIndex + 1;
+                stack[stackSize++] = node.data;
+            }
+            else {
+                stack[stackSize++] = node.data;
+                stack[stackSize++] = nodeIndex + 1;
+            }
+        }
+    }
+
+    return hitMask;
+
+#else
+
+    // Trace the rays one by one
+    int hitMask = 0;
+    for (int i=0; i<RayPacket::SIZE; i++) {
+        if (packet.isRayActive(i) && raycastBinary(packet.getRay(i), false, hits[i])) {
+            hitMask |= (1 << i);
+        }
+    }
+    return hitMask;
+
+#endif
+}
+
+// Return the closest point of a triangle to a point with its barycentric coordinates
+// (see "Real-Time Collision Detection" by Christer Ericson)
+static Vector3 computeClosestPointOnTriangle(const Vector3& point, const Vector3& a,
+                                             const Vector3& b, const Vector3& c,
+                                             float& u, float& v) {
+
+    Vector3 ab = b - a;
+    Vector3 ac = c - a;
+
+    // Vertex region of a
+    Vector3 ap = point - a;
+    float d1 = ab.dot(ap);
+    float d2 = ac.dot(ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        u = 0.0f; v = 0.0f;
+        return a;
+    }
+
+    // Vertex region of b
+    Vector3 bp = point - b;
+    float d3 = ab.dot(bp);
+    float d4 = ac.dot(bp);
+    if (d3 >= 0.0f && d4 <= d3) {
+        u = 1.0f; v = 0.0f;
+        return b;
+    }
+
+    // Edge region of ab
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        u = d1 / (d1 - d3); v = 0.0f;
+        return a + ab * u;
+    }
+
+    // Vertex region of c
+    Vector3 cp = point - c;
+    float d5 = ab.dot(cp);
+    float d6 = ac.dot(cp);
+    if (d6 >= 0.0f && d5 <= d6) {
+        u = 0.0f; v = 1.0f;
+        return c;
+    }
+
+    // Edge region of ac
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        u = 0.0f; v = d2 / (d2 - d6);
+        return a + ac * v;
+    }
+
+    // Edge region of bc
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        u = 1.0f - w; v = w;
+        return b + (c - b) * w;
+    }
+
+    // Face region
+    float denominator = 1.0f / (va + vb + vc);
+    u = vb * denominator;
+    v = vc * denominator;
+    return a + ab * u + ac * v;
+}
+
+// Return the square distance between a point and the box of a node
+static inline float computeSquareDistanceToNode(const BVHNode& node, const Vector3& point) {
+    float dx = max(max(node.min[0] - point.x, point.x - node.max[0]), 0.0f);
+    float dy = max(max(node.min[1] - point.y, point.y - node.max[1]), 0.0f);
+    float dz = max(max(node.min[2] - point.z, point.z - node.max[2]), 0.0f);
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Find the closest point of the triangles to a point (local-space). Return false if
+// no triangle is closer than the maximum distance.
+bool MeshBVH::findClosestPoint(const Vector3& point, ClosestPointHit& hit,
+                               float maxDistance) const {
+
+    hit.isFound = false;
+    hit.distance = numeric_limits<float>::infinity();
+    if (mNodes.empty()) return false;
+
+    float closestSquareDistance = (maxDistance < sqrt(numeric_limits<float>::max())) ?
+                                  maxDistance * maxDistance : numeric_limits<float>::max();
+    bool isFound = false;
+
+    // The stack contains the nodes and their square distance to the point
+    uint stackNodes[MAX_DEPTH];
+    float stackDistances[MAX_DEPTH];
+    uint stackSize = 0;
+    stackNodes[stackSize] = 0;
+    stackDistances[stackSize++] = computeSquareDistanceToNode(mNodes[0], point);
+
+    while (stackSize > 0) {
+
+        stackSize--;
+        if (stackDistances[stackSize] > closestSquareDistance) continue;
+        uint nodeIndex = stackNodes[stackSize];
+        const BVHNode& node = mNodes[nodeIndex];
+
+        if (node.isLeaf()) {
+            for (uint t=node.data; t<node.data + node.nbTriangles; t++) {
+                float u, v;
+                Vector3 closestPoint = computeClosestPointOnTriangle(point, mTriangleVertices[3*t],
+                                                                     mTriangleVertices[3*t + 1],
+                                                                     mTriangleVertices[3*t + 2],
+                                                                     u, v);
+                float squareDistance = (closestPoint - point).lengthSquared();
+                if (squareDistance <= closestSquareDistance) {
+                    closestSquareDistance = squareDistance;
+                    hit.part = mTriangleParts[t];
+                    hit.face = mTriangleFaces[t];
+                    hit.u = u;
+                    hit.v = v;
+                    hit.point = closestPoint;
+                    isFound = true;
+                }
+            }
+        }
+        else {
+
+            // Visit the nearest child first (it is pushed last)
+            uint child1 = nodeIndex + 1;
+            uint child2 = node.data;
+            float distance1 = computeSquareDistanceToNode(mNodes[child1], point);
+            float distance2 = computeSquareDistanceToNode(mNodes[child2], point);
+            if (distance1 < distance2) {
+                swap(child1, child2);
+                swap(distance1, distance2);
+            }
+            assert(stackSize + 2 <= MAX_DEPTH);
+            if (distance1 <= closestSquareDistance) {
+                stackNodes[stackSize] = child1;
+                stackDistances[stackSize++] = distance1;
+            }
+            if (distance2 <= closestSquareDistance) {
+                stackNodes[stackSize] = child2;
+                stackDistances[stackSize++] = distance2;
+            }
+        }
+    }
+
+    if (isFound) {
+        hit.isFound = true;
+        hit.distance = sqrt(closestSquareDistance);
+    }
+
+    return isFound;
+}
+
+// Find the closest points of the triangles to an array of points (in parallel).
+// The hits of the points without a closest point are marked as not found.
+void MeshBVH::findClosestPoints(const vector<Vector3>& points,
+                                vector<ClosestPointHit>& hits) const {
+
+    hits.resize(points.size());
+    const int nbPoints = int(points.size());
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int i=0; i<nbPoints; i++) {
+        findClosestPoint(points[i], hits[i]);
+    }
+}
+
+// Find the triangles whose bounding box overlaps a box (local-space). The
+// triangles are added to the array as indices of the BVH triangles.
+void MeshBVH::queryAABB(const AABB& aabb, vector<uint>& triangles) const {
+
+    if (mNodes.empty()) return;
+
+    uint stack[MAX_DEPTH];
+    uint stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+
+        uint nodeIndex = stack[--stackSize];
+        const BVHNode& node = mNodes[nodeIndex];
+        AABB nodeAABB(Vector3(node.min[0], node.min[1], node.min[2]),
+                      Vector3(node.max[0], node.max[1], node.max[2]));
+        if (!aabb.overlaps(nodeAABB)) continue;
+
+        if (node.isLeaf()) {
+            for (uint t=node.data; t<node.data + node.nbTriangles; t++) {
+                AABB triangleAABB;
+                triangleAABB.merge(mTriangleVertices[3*t]);
+                triangleAABB.merge(mTriangleVertices[3*t + 1]);
+                triangleAABB.merge(mTriangleVertices[3*t + 2]);
+                if (aabb.overlaps(triangleAABB)) triangles.push_back(t);
+            }
+        }
+        else {
+            assert(stackSize + 2 <= MAX_DEPTH);
+            stack[stackSize++] = node.data;
+            stack[stackSize++] = nodeIndex + 1;
+        }
+    }
+}
+
+// Return the bounding box of the whole BVH
+AABB MeshBVH::getAABB() const {
+    if (mNodes.empty()) return AABB();
+    return AABB(Vector3(mNodes[0].min[0], mNodes[0].min[1], mNodes[0].min[2]),
+                Vector3(mNodes[0].max[0], mNodes[0].max[1], mNodes[0].max[2]));
+}
@@ -0,0 +1,323 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef MESH_BVH_H
+#define MESH_BVH_H
+
+// Libraries
+#include <vector>
+#include <limits>
+#include "definitions.h"
+#include "maths/Vector3.h"
+#include "maths/AABB.h"
+#include "maths/Ray.h"
+#include "Mesh.h"
+
+namespace openglframework {
+
+// Class BVHNode
+// This class represents a node of a binary bounding volume hierarchy. A node uses
+// 32 bytes and the bounds can be loaded directly into SIMD registers. The first
+// child of an internal node is always the next node in the array.
+class BVHNode {
+
+    public:
+
+        // Minimum coordinates of the bounding box of the node
+        float min[3];
+
+        // Index of the first triangle (leaf) or of the second child (internal node)
+        uint data;
+
+        // Maximum coordinates of the bounding box of the node
+        float max[3];
+
+        // Number of triangles (zero for an internal node)
+        unsigned short nbTriangles;
+
+        // Split axis of an internal node (used to order the traversal)
+        unsigned short axis;
+
+        // Return true if the node is a leaf
+        bool isLeaf() const {
+            return nbTriangles > 0;
+        }
+};
+
+// Class BVHWideNode
+// This class represents a node of a 4-ary bounding volume hierarchy with the
+// bounds of the four children stored as structure of arrays so that they can
+// be tested against a ray with a single SIMD operation
+class BVHWideNode {
+
+    public:
+
+        // Bounds of the four children
+        float minX[4], minY[4], minZ[4];
+        float maxX[4], maxY[4], maxZ[4];
+
+        // Index of the child node (internal child) or of the first triangle (leaf child)
+        uint children[4];
+
+        // Number of triangles of each leaf child (zero for an internal child)
+        unsigned short nbTriangles[4];
+
+        // Padding to 128 bytes
+        uint padding[2];
+};
+
+// Class RaycastHit
+// This class contains the result of a ray query on a mesh
+class RaycastHit {
+
+    public:
+        RaycastHit() : part(0), face(0), u(0), v(0), distance(0) {}
+
+        // Part of the mesh and index of the hit triangle in this part
+        uint part;
+        uint face;
+
+        // Barycentric coordinates of the hit point (the hit point is
+        // (1-u-v) * v0 + u * v1 + v * v2)
+        float u, v;
+
+        // Distance along the ray
+        float distance;
+};
+
+// Class ClosestPointHit
+// This class contains the result of a closest point query on a mesh. When no
+// triangle has been found (empty tree or maximum distance), isFound is false and
+// the distance is infinite.
+class ClosestPointHit {
+
+    public:
+        ClosestPointHit() : isFound(false), part(0), face(0), u(0), v(0),
+                            distance(std::numeric_limits<float>::infinity()),
+                            point(0, 0, 0) {}
+
+        // True if a closest point has been found
+        bool isFound;
+
+        // Part of the mesh and index of the closest triangle in this part
+        uint part;
+        uint face;
+
+        // Barycentric coordinates of the closest point (the closest point is
+        // (1-u-v) * v0 + u * v1 + v * v2)
+        float u, v;
+
+        // Distance between the query point and the closest point
+        float distance;
+
+        // Closest point on the mesh
+        Vector3 point;
+};
+
+// Class MeshBVH
+// This class represents a bounding volume hierarchy over the triangles of all the
+// parts of a mesh (in local-space of the mesh). It is built with a binned surface
+// area heuristic (the subtrees are built in parallel with OpenMP tasks) and stored
+// as a flat array of 32 bytes nodes. Optionally, the binary tree can be collapsed
+// into a 4-ary tree that is traversed with SSE instructions. The BVH keeps its own
+// copy of the triangle vertices in the leaf order so that the queries do not
+// have to jump between the index and the vertex arrays of the mesh.
+class MeshBVH {
+
+    public:
+
+        // -------------------- Constants -------------------- //
+
+        // Maximum number of triangles in a leaf
+        static const uint MAX_LEAF_SIZE = 8;
+
+        // Maximum depth of the tree (size of the traversal stacks)
+        static const uint MAX_DEPTH = 128;
+
+    private:
+
+        // -------------------- Attributes -------------------- //
+
+        // Nodes of the binary tree (the root is the first node)
+        std::vector<BVHNode> mNodes;
+
+        // Nodes of the 4-ary tree (empty if it has not been built)
+        std::vector<BVHWideNode> mWideNodes;
+
+        // Vertices of the triangles in the leaf order (three for each triangle)
+        std::vector<Vector3> mTriangleVertices;
+
+        // Part of the mesh of each triangle (in the leaf order)
+        std::vector<uint> mTriangleParts;
+
+        // Index of each triangle in its part of the mesh (in the leaf order)
+        std::vector<uint> mTriangleFaces;
+
+        // -------------------- Methods -------------------- //
+
+        // Build the subtree of a range of triangles
+        void buildSubtree(std::vector<BVHNode>& nodes, uint nodeIndex, uint begin, uint end,
+                          std::vector<uint>& triangles, const std::vector<AABB>& triangleAABBs,
+                          const std::vector<Vector3>& centroids, uint depth);
+
+        // Copy a subtree into the final array of nodes in depth-first order
+        uint compactSubtree(const std::vector<BVHNode>& nodes, uint nodeIndex);
+
+        // Collapse a subtree of the binary tree into the 4-ary tree
+        uint collapseSubtree(uint nodeIndex);
+
+        // Intersect a ray with a triangle (Moller-Trumbore)
+        bool intersectTriangle(uint triangle, const Ray& ray, float maxDistance,
+                               float& distance, float& u, float& v) const;
+
+        // Closest hit traversal of the binary tree
+        bool raycastBinary(const Ray& ray, bool isAnyHit, RaycastHit& hit) const;
+
+        // Closest hit traversal of the 4-ary tree
+        bool raycastWide(const Ray& ray, bool isAnyHit, RaycastHit& hit) const;
+
+    public:
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor
+        MeshBVH();
+
+        // Constructor
+        MeshBVH(const Mesh& mesh, bool isWideTreeBuilt = false);
+
+        // Destructor
+        ~MeshBVH();
+
+        // Build the BVH over all the triangles of a mesh
+        void build(const Mesh& mesh, bool isWideTreeBuilt = false);
+
+        // Build the 4-ary tree from the binary tree
+        void buildWideTree();
+
+        // Destroy the BVH
+        void destroy();
+
+        // Return the closest intersection of a ray with the triangles (local-space)
+        bool raycast(const Ray& ray, RaycastHit& hit) const;
+
+        // Return true if a ray hits any triangle (local-space)
+        bool testRayHit(const Ray& ray) const;
+
+        // Return the closest intersections of a packet of rays with the triangles
+        // (local-space). The returned bit mask contains the rays that hit a triangle.
+        int raycastPacket(const RayPacket& packet, RaycastHit hits[RayPacket::SIZE]) const;
+
+        // Find the closest point of the triangles to a point (local-space). Return false if
+        // no triangle is closer than the maximum distance.
+        bool findClosestPoint(const Vector3& point, ClosestPointHit& hit,
+                              float maxDistance = std::numeric_limits<float>::max()) const;
+
+        // Find the closest points of the triangles to an array of points (in parallel).
+        // The hits of the points without a closest point are marked as not found.
+        void findClosestPoints(const std::vector<Vector3>& points,
+                               std::vector<ClosestPointHit>& hits) const;
+
+        // Find the triangles whose bounding box overlaps a box (local-space). The
+        // triangles are added to the array as indices of the BVH triangles.
+        void queryAABB(const AABB& aabb, std::vector<uint>& triangles) const;
+
+        // Return the bounding box of the whole BVH
+        AABB getAABB() const;
+
+        // Return the number of triangles
+        uint getNbTriangles() const;
+
+        // Return the number of nodes of the binary tree
+        uint getNbNodes() const;
+
+        // Return the nodes of the binary tree
+        const std::vector<BVHNode>& getNodes() const;
+
+        // Return true if the 4-ary tree has been built
+        bool hasWideTree() const;
+
+        // Return the part of the mesh of a BVH triangle
+        uint getTrianglePart(uint triangle) const;
+
+        // Return the index of a BVH triangle in its part of the mesh
+        uint getTriangleFace(uint triangle) const;
+
+        // Return a vertex (i=0,1,2) of a BVH triangle
+        const Vector3& getTriangleVertex(uint triangle, uint i) const;
+};
+
+// Return the number of triangles
+inline uint MeshBVH::getNbTriangles() const {
+    return mTriangleParts.size();
+}
+
+// Return the number of nodes of the binary tree
+inline uint MeshBVH::getNbNodes() const {
+    return mNodes.size();
+}
+
+// Return the nodes of the binary tree
+inline const std::vector<BVHNode>& MeshBVH::getNodes() const {
+    return mNodes;
+}
+
+// Return true if the 4-ary tree has been built
+inline bool MeshBVH::hasWideTree() const {
+    return !mWideNodes.empty();
+}
+
+// Return the part of the mesh of a BVH triangle
+inline uint MeshBVH::getTrianglePart(uint triangle) const {
+    assert(triangle < getNbTriangles());
+    return mTriangleParts[triangle];
+}
+
+// Return the index of a BVH triangle in its part of the mesh
+inline uint MeshBVH::getTriangleFace(uint triangle) const {
+    assert(triangle < getNbTriangles());
+    return mTriangleFaces[triangle];
+}
+
+// Return a vertex (i=0,1,2) of a BVH triangle
+inline const Vector3& MeshBVH::getTriangleVertex(uint triangle, uint i) const {
+    assert(triangle < getNbTriangles() && i < 3);
+    return mTriangleVertices[3 * triangle + i];
+}
+
+// Return the closest intersection of a ray with the triangles (local-space)
+inline bool MeshBVH::raycast(const Ray& ray, RaycastHit& hit) const {
+    return hasWideTree() ? raycastWide(ray, false, hit) : raycastBinary(ray, false, hit);
+}
+
+// Return true if a ray hits any triangle (local-space)
+inline bool MeshBVH::testRayHit(const Ray& ray) const {
+    RaycastHit hit;
+    return hasWideTree() ? raycastWide(ray, true, hit) : raycastBinary(ray, true, hit);
+}
+
+}
+
+#endif
@@ -0,0 +1,417 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "MeshCleaner.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Class FaceKey
+// This class is used to sort the triangles in order to find the duplicate ones
+class FaceKey {
+
+    public:
+        uint v[3];
+        uint face;
+
+        bool operator<(const FaceKey& key) const {
+            if (v[0] != key.v[0]) return v[0] < key.v[0];
+            if (v[1] != key.v[1]) return v[1] < key.v[1];
+            if (v[2] != key.v[2]) return v[2] < key.v[2];
+            return face < key.face;
+        }
+
+        bool hasSameVertices(const FaceKey& key) const {
+            return v[0] == key.v[0] && v[1] == key.v[1] && v[2] == key.v[2];
+        }
+};
+
+// New index of a vertex that is removed
+static const uint UNREFERENCED_VERTEX = 0xffffffff;
+
+// Maximum number of cells of the welding grid along each axis
+static const uint MAX_NB_CELLS_PER_AXIS = 1 << 20;
+
+// Return the hash of a cell of the spatial grid
+static inline uint hashCell(int x, int y, int z) {
+    return (uint(x) * 73856093u) ^ (uint(y) * 19349663u) ^ (uint(z) * 83492791u);
+}
+
+// Keep only the elements of an attribute array with a new index and reorder them
+template<typename T>
+static void remapAttributes(vector<T>& attributes, const vector<uint>& oldToNewIndices,
+                            uint nbNewElements) {
+
+    if (attributes.size() != oldToNewIndices.size()) return;
+
+    vector<T> newAttributes(nbNewElements);
+    const int nbElements = int(attributes.size());
+    #pragma omp parallel for
+    for (int i=0; i<nbElements; i++) {
+        if (oldToNewIndices[i] != UNREFERENCED_VERTEX) {
+            newAttributes[oldToNewIndices[i]] = attributes[i];
+        }
+    }
+    attributes.swap(newAttributes);
+}
+
+// Constructor
+MeshCleaner::MeshCleaner() {
+
+}
+
+// Run all the cleaning passes on a mesh
+MeshCleaningStatistics MeshCleaner::cleanMesh(Mesh& mesh, float positionTolerance,
+                                              float attributeTolerance) {
+
+    MeshCleaningStatistics statistics;
+    statistics.nbBytesBefore = getMeshDataSize(mesh);
+
+    statistics.nbWeldedVertices = weldVertices(mesh, positionTolerance, attributeTolerance);
+    statistics.nbDegenerateFaces = removeDegenerateFaces(mesh);
+    statistics.nbDuplicateFaces = removeDuplicateFaces(mesh);
+    statistics.nbUnreferencedVertices = removeUnreferencedVertices(mesh);
+
+    statistics.nbBytesAfter = getMeshDataSize(mesh);
+
+    return statistics;
+}
+
+// Return true if the attributes of two vertices are equal within a tolerance
+bool MeshCleaner::areAttributesEqual(const Mesh& mesh, uint v1, uint v2,
+                                     float attributeTolerance) {
+
+    if (mesh.hasNormals()) {
+        Vector3 difference = mesh.getNormal(v1) - mesh.getNormal(v2);
+        if (fabs(difference.x) > attributeTolerance || fabs(difference.y) > attributeTolerance ||
+            fabs(difference.z) > attributeTolerance) return false;
+    }
+
+    if (mesh.hasUVTextureCoordinates()) {
+        Vector2 difference = mesh.getUV(v1) - mesh.getUV(v2);
+        if (fabs(difference.x) > attributeTolerance ||
+            fabs(difference.y) > attributeTolerance) return false;
+    }
+
+    if (mesh.hasColors()) {
+        const Color& c1 = mesh.getColor(v1);
+        const Color& c2 = mesh.getColor(v2);
+        if (fabs(c1.r - c2.r) > attributeTolerance || fabs(c1.g - c2.g) > attributeTolerance ||
+            fabs(c1.b - c2.b) > attributeTolerance ||
+            fabs(c1.a - c2.a) > attributeTolerance) return false;
+    }
+
+    return true;
+}
+
+// Weld the vertices that are closer than a given tolerance and with the same
+// attributes. The vertices are visited in index order and each one is welded
+// with the first previous unwelded vertex that is within the tolerance, so that
+// a vertex never moves by more than the tolerance. A zero tolerance only welds
+// the vertices with equal positions. The merged vertices are not referenced by
+// the triangles anymore (call removeUnreferencedVertices() to remove them).
+// Return the number of welded vertices.
+uint MeshCleaner::weldVertices(Mesh& mesh, float positionTolerance, float attributeTolerance) {
+
+    const int nbVertices = int(mesh.getNbVertices());
+    if (nbVertices == 0) return 0;
+
+    const vector<Vector3>& vertices = mesh.getVertices();
+
+    // Compute the bounding box of the vertices
+    Vector3 minPoint = vertices[0], maxPoint = vertices[0];
+    for (int i=1; i<nbVertices; i++) {
+        minPoint.x = min(minPoint.x, vertices[i].x); maxPoint.x = max(maxPoint.x, vertices[i].x);
+        minPoint.y = min(minPoint.y, vertices[i].y); maxPoint.y = max(maxPoint.y, vertices[i].y);
+        minPoint.z = min(minPoint.z, vertices[i].z); maxPoint.z = max(maxPoint.z, vertices[i].z);
+    }
+
+    // The size of a cell is at least the tolerance so that two vertices to weld are
+    // always in the same cell or in two neighbor cells. The cells are relative to the
+    // bounding box and there are at most MAX_NB_CELLS_PER_AXIS cells along each axis so
+    // that the cell coordinates do not overflow (with a small or zero tolerance).
+    const float extent = max(max(maxPoint.x - minPoint.x, maxPoint.y - minPoint.y),
+                             maxPoint.z - minPoint.z);
+    float cellSize = max(positionTolerance, extent / float(MAX_NB_CELLS_PER_AXIS));
+    if (!(cellSize > 0.0f)) cellSize = 1.0f;
+    const float invCellSize = 1.0f / cellSize;
+    const float toleranceSquare = positionTolerance * positionTolerance;
+
+    uint tableSize = 16;
+    while (tableSize < uint(nbVertices)) tableSize *= 2;
+    const uint mask = tableSize - 1;
+
+    // ---------- Build the spatial hash grid ---------- //
+
+    // Compute the cell of each vertex
+    vector<int> cells(3 * nbVertices);
+    vector<uint> buckets(nbVertices);
+    #pragma omp parallel for
+    for (int i=0; i<nbVertices; i++) {
+        cells[3*i] = int(floor((vertices[i].x - minPoint.x) * invCellSize));
+        cells[3*i + 1] = int(floor((vertices[i].y - minPoint.y) * invCellSize));
+        cells[3*i + 2] = int(floor((vertices[i].z - minPoint.z) * invCellSize));
+        buckets[i] = hashCell(cells[3*i], cells[3*i + 1], cells[3*i + 2]) & mask;
+    }
+
+    // Sort the vertices by bucket (counting sort)
+    vector<uint> bucketStarts(tableSize + 1, 0);
+    for (int i=0; i<nbVertices; i++) {
+        bucketStarts[buckets[i] + 1]++;
+    }
+    for (uint b=0; b<tableSize; b++) {
+        bucketStarts[b + 1] += bucketStarts[b];
+    }
+    vector<uint> sortedVertices(nbVertices);
+    vector<uint> bucketOffsets(bucketStarts.begin(), bucketStarts.end() - 1);
+    for (int i=0; i<nbVertices; i++) {
+        sortedVertices[bucketOffsets[buckets[i]]++] = i;
+    }
+
+    // ---------- Find the vertex to weld with ---------- //
+
+    // For each vertex (in index order), find the smallest index of a vertex that is
+    // not welded in the 27 neighbor cells, within the tolerance and with the same
+    // attributes. The vertices are only compared with the unwelded vertices so that
+    // a chain of close vertices is not welded into a single one. The vertices of a
+    // bucket are sorted by index.
+    vector<uint> representatives(nbVertices);
+    uint nbWeldedVertices = 0;
+    for (int i=0; i<nbVertices; i++) {
+
+        uint representative = i;
+        for (int dx=-1; dx<=1; dx++) {
+            for (int dy=-1; dy<=1; dy++) {
+                for (int dz=-1; dz<=1; dz++) {
+                    uint bucket = hashCell(cells[3*i] + dx, cells[3*i + 1] + dy,
+                                           cells[3*i + 2] + dz) & mask;
+                    for (uint k=bucketStarts[bucket]; k<bucketStarts[bucket + 1]; k++) {
+                        uint j = sortedVertices[k];
+                        if (j >= representative) break;
+                        if (representatives[j] == j &&
+                            (vertices[j] - vertices[i]).lengthSquared() <= toleranceSquare &&
+                            areAttributesEqual(mesh, i, j, attributeTolerance)) {
+                            representative = j;
+                        }
+                    }
+                }
+            }
+        }
+        representatives[i] = representative;
+        if (representative != uint(i)) nbWeldedVertices++;
+    }
+
+    if (nbWeldedVertices == 0) return 0;
+
+    // ---------- Update the indices ---------- //
+
+    vector<vector<uint> > indices(mesh.getNbParts());
+    for (uint p=0; p<mesh.getNbParts(); p++) {
+        indices[p] = mesh.getIndices(p);
+        const int nbIndices = int(indices[p].size());
+        #pragma omp parallel for
+        for (int i=0; i<nbIndices; i++) {
+            indices[p][i] = representatives[indices[p][i]];
+        }
+    }
+    mesh.setIndices(std::move(indices));
+
+    return nbWeldedVertices;
+}
+
+// Remove the triangles with two identical indices or with a zero area and
+// return the number of removed triangles
+uint MeshCleaner::removeDegenerateFaces(Mesh& mesh) {
+
+    const vector<Vector3>& vertices = mesh.getVertices();
+    uint nbRemovedFaces = 0;
+
+    vector<vector<uint> > indices(mesh.getNbParts());
+    for (uint p=0; p<mesh.getNbParts(); p++) {
+
+        const vector<uint>& partIndices = mesh.getIndices(p);
+        const int nbFaces = int(mesh.getNbFaces(p));
+
+        // Find the degenerate faces
+        vector<char> isDegenerate(nbFaces);
+        #pragma omp parallel for
+        for (int f=0; f<nbFaces; f++) {
+            uint v1 = partIndices[3*f];
+            uint v2 = partIndices[3*f + 1];
+            uint v3 = partIndices[3*f + 2];
+            isDegenerate[f] = (v1 == v2 || v2 == v3 || v1 == v3 ||
+                               (vertices[v2] - vertices[v1]).cross(
+                                vertices[v3] - vertices[v1]).isNull());
+        }
+
+        // Keep the other faces
+        indices[p].reserve(partIndices.size());
+        for (int f=0; f<nbFaces; f++) {
+            if (isDegenerate[f]) {
+                nbRemovedFaces++;
+            }
+            else {
+                indices[p].push_back(partIndices[3*f]);
+                indices[p].push_back(partIndices[3*f + 1]);
+                indices[p].push_back(partIndices[3*f + 2]);
+            }
+        }
+    }
+
+    if (nbRemovedFaces > 0) mesh.setIndices(std::move(indices));
+
+    return nbRemovedFaces;
+}
+
+// Remove the triangles that use the same three vertices with the same
+// orientation as another triangle of the same part and return the number
+// of removed triangles
+uint MeshCleaner::removeDuplicateFaces(Mesh& mesh) {
+
+    uint nbRemovedFaces = 0;
+
+    vector<vector<uint> > indices(mesh.getNbParts());
+    for (uint p=0; p<mesh.getNbParts(); p++) {
+
+        const vector<uint>& partIndices = mesh.getIndices(p);
+        const int nbFaces = int(mesh.getNbFaces(p));
+
+        // Rotate the indices of each face so that the smallest one comes
+        // first (this keeps the orientation of the face)
+        vector<FaceKey> keys(nbFaces);
+        #pragma omp parallel for
+        for (int f=0; f<nbFaces; f++) {
+            const uint* v = &partIndices[3*f];
+            int first = (v[0] < v[1]) ? ((v[0] < v[2]) ? 0 : 2) : ((v[1] < v[2]) ? 1 : 2);
+            keys[f].v[0] = v[first];
+            keys[f].v[1] = v[(first + 1) % 3];
+            keys[f].v[2] = v[(first + 2) % 3];
+            keys[f].face = f;
+        }
+
+        // Sort the faces so that the duplicate ones are next to each other
+        // and keep the first occurence of each face
+        sort(keys.begin(), keys.end());
+        vector<char> isDuplicate(nbFaces, 0);
+        for (int k=1; k<nbFaces; k++) {
+            if (keys[k].hasSameVertices(keys[k-1])) {
+                isDuplicate[keys[k].face] = 1;
+                nbRemovedFaces++;
+            }
+        }
+
+        indices[p].reserve(partIndices.size());
+        for (int f=0; f<nbFaces; f++) {
+            if (!isDuplicate[f]) {
+                indices[p].push_back(partIndices[3*f]);
+                indices[p].push_back(partIndices[3*f + 1]);
+                indices[p].push_back(partIndices[3*f + 2]);
+            }
+        }
+    }
+
+    if (nbRemovedFaces > 0) mesh.setIndices(std::move(indices));
+
+    return nbRemovedFaces;
+}
+
+// Remove the vertices that are not used by any triangle and return the number
+// of removed vertices
+uint MeshCleaner::removeUnreferencedVertices(Mesh& mesh) {
+
+    const uint nbVertices = mesh.getNbVertices();
+
+    // Find the referenced vertices
+    vector<uint> oldToNewIndices(nbVertices, 0);
+    for (uint p=0; p<mesh.getNbParts(); p++) {
+        const vector<uint>& partIndices = mesh.getIndices(p);
+        for (size_t i=0; i<partIndices.size(); i++) {
+            oldToNewIndices[partIndices[i]] = 1;
+        }
+    }
+
+    // Compute the new index of each referenced vertex
+    uint nbNewVertices = 0;
+    for (uint v=0; v<nbVertices; v++) {
+        if (oldToNewIndices[v]) {
+            oldToNewIndices[v] = nbNewVertices++;
+        }
+        else {
+            oldToNewIndices[v] = UNREFERENCED_VERTEX;
+        }
+    }
+
+    if (nbNewVertices == nbVertices) return 0;
+
+    remapVertices(mesh, oldToNewIndices, nbNewVertices);
+
+    return nbVertices - nbNewVertices;
+}
+
+// Keep only the vertices with a given new index and reorder them
+void MeshCleaner::remapVertices(Mesh& mesh, const vector<uint>& oldToNewIndices,
+                                uint nbNewVertices) {
+
+    // Remap the vertex attributes
+    vector<Vector3> vertices = mesh.getVertices();
+    vector<Vector3> normals = mesh.getNormals();
+    vector<Vector3> tangents = mesh.getTangents();
+    vector<Color> colors = mesh.getColors();
+    vector<Vector2> uvs = mesh.getUVs();
+    remapAttributes(vertices, oldToNewIndices, nbNewVertices);
+    remapAttributes(normals, oldToNewIndices, nbNewVertices);
+    remapAttributes(tangents, oldToNewIndices, nbNewVertices);
+    remapAttributes(colors, oldToNewIndices, nbNewVertices);
+    remapAttributes(uvs, oldToNewIndices, nbNewVertices);
+
+    // Remap the indices
+    vector<vector<uint> > indices(mesh.getNbParts());
+    for (uint p=0; p<mesh.getNbParts(); p++) {
+        indices[p] = mesh.getIndices(p);
+        const int nbIndices = int(indices[p].size());
+        #pragma omp parallel for
+        for (int i=0; i<nbIndices; i++) {
+            assert(oldToNewIndices[indices[p][i]] != UNREFERENCED_VERTEX);
+            indices[p][i] = oldToNewIndices[indices[p][i]];
+        }
+    }
+
+    mesh.setVertices(std::move(vertices));
+    mesh.setNormals(std::move(normals));
+    mesh.setTangents(std::move(tangents));
+    mesh.setColors(std::move(colors));
+    mesh.setUVs(std::move(uvs));
+    mesh.setIndices(std::move(indices));
+}
+
+// Return the number of bytes used by the vertex attributes and indices of a mesh
+size_t MeshCleaner::getMeshDataSize(const Mesh& mesh) {
+    return mesh.getGeometry()->getDataSize();
+}
\ No newline at end of file
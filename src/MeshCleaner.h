@@ -0,0 +1,131 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef MESH_CLEANER_H
+#define MESH_CLEANER_H
+
+// Libraries
+#include <vector>
+#include <cstddef>
+#include "definitions.h"
+#include "Mesh.h"
+
+namespace openglframework {
+
+// Class MeshCleaningStatistics
+// This class contains the result of a cleaning pass on a mesh
+class MeshCleaningStatistics {
+
+    public:
+        MeshCleaningStatistics() : nbWeldedVertices(0), nbDegenerateFaces(0),
+                                   nbDuplicateFaces(0), nbUnreferencedVertices(0),
+                                   nbBytesBefore(0), nbBytesAfter(0) {}
+
+        // Number of vertices that have been merged into another vertex
+        uint nbWeldedVertices;
+
+        // Number of removed degenerate triangles
+        uint nbDegenerateFaces;
+
+        // Number of removed duplicate triangles
+        uint nbDuplicateFaces;
+
+        // Number of removed vertices that were not used by any triangle
+        uint nbUnreferencedVertices;
+
+        // Memory used by the vertex attributes and indices before the cleaning
+        size_t nbBytesBefore;
+
+        // Memory used by the vertex attributes and indices after the cleaning
+        size_t nbBytesAfter;
+
+        // Return the number of bytes saved by the cleaning
+        size_t getNbBytesSaved() const {
+            return nbBytesBefore - nbBytesAfter;
+        }
+};
+
+// Class MeshCleaner
+// This class is used to clean a mesh (for instance after loading it from a file).
+// It welds the vertices that are closer than a given tolerance (using a uniform
+// spatial hash grid and also comparing the normals, UVs and colors of the vertices),
+// removes the degenerate and duplicate triangles and removes the vertices that are
+// not referenced by any triangle. The main loops run in parallel when OpenMP is
+// available.
+class MeshCleaner {
+
+    private :
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor (private because we do not want instances of this class)
+        MeshCleaner();
+
+        // Return true if the attributes of two vertices are equal within a tolerance
+        static bool areAttributesEqual(const Mesh& mesh, uint v1, uint v2,
+                                       float attributeTolerance);
+
+        // Keep only the vertices with a given new index and reorder them
+        static void remapVertices(Mesh& mesh, const std::vector<uint>& oldToNewIndices,
+                                  uint nbNewVertices);
+
+    public :
+
+        // -------------------- Methods -------------------- //
+
+        // Run all the cleaning passes on a mesh
+        static MeshCleaningStatistics cleanMesh(Mesh& mesh, float positionTolerance,
+                                                float attributeTolerance = 0.001f);
+
+        // Weld the vertices that are closer than a given tolerance and with the same
+        // attributes. The vertices are visited in index order and each one is welded
+        // with the first previous unwelded vertex that is within the tolerance, so that
+        // a vertex never moves by more than the tolerance. A zero tolerance only welds
+        // the vertices with equal positions. The merged vertices are not referenced by
+        // the triangles anymore (call removeUnreferencedVertices() to remove them).
+        // Return the number of welded vertices.
+        static uint weldVertices(Mesh& mesh, float positionTolerance,
+                                 float attributeTolerance = 0.001f);
+
+        // Remove the triangles with two identical indices or with a zero area and
+        // return the number of removed triangles
+        static uint removeDegenerateFaces(Mesh& mesh);
+
+        // Remove the triangles that use the same three vertices with the same
+        // orientation as another triangle of the same part and return the number
+        // of removed triangles
+        static uint removeDuplicateFaces(Mesh& mesh);
+
+        // Remove the vertices that are not used by any triangle and return the number
+        // of removed vertices
+        static uint removeUnreferencedVertices(Mesh& mesh);
+
+        // Return the number of bytes used by the vertex attributes and indices of a mesh
+        static size_t getMeshDataSize(const Mesh& mesh);
+};
+
+}
+
+#endif
@@ -0,0 +1,502 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "MeshCollision.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define MESH_COLLISION_USE_SSE
+#endif
+
+using namespace openglframework;
+using namespace std;
+
+// Minimum number of pairs of subtrees to create before the parallel traversal
+static const uint NB_PARALLEL_TASKS = 256;
+
+// Distance (relative to the size of the triangles) under which two triangles are coplanar
+static const float COPLANAR_TOLERANCE = 1e-5f;
+
+// Pair of nodes of the two trees
+struct NodePair {
+
+    uint node1, node2;
+
+    NodePair(uint node1, uint node2) : node1(node1), node2(node2) {}
+};
+
+// Box in the local-space of the first mesh
+struct TransformedBox {
+
+    float min[3], max[3];
+};
+
+// Return true if a segment intersects a triangle (Moller-Trumbore)
+static bool testSegmentTriangle(const Vector3& p, const Vector3& q, const Vector3& a,
+                                const Vector3& b, const Vector3& c) {
+    Vector3 direction = q - p;
+    Vector3 edge1 = b - a;
+    Vector3 edge2 = c - a;
+    Vector3 h = direction.cross(edge2);
+    float determinant = edge1.dot(h);
+    if (fabs(determinant) <= numeric_limits<float>::min()) return false;
+    float inverseDeterminant = 1.0f / determinant;
+    Vector3 s = p - a;
+    float u = inverseDeterminant * s.dot(h);
+    if (u < 0.0f || u > 1.0f) return false;
+    Vector3 qv = s.cross(edge1);
+    float v = inverseDeterminant * direction.dot(qv);
+    if (v < 0.0f || u + v > 1.0f) return false;
+    float t = inverseDeterminant * edge2.dot(qv);
+    return t >= 0.0f && t <= 1.0f;
+}
+
+// Return the orientation of three 2D points
+static inline float computeOrientation(const float* a, const float* b, const float* c) {
+    return (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+}
+
+// Return true if a 2D point is inside a 2D triangle (or on its boundary)
+static bool isPointInTriangle2D(const float* p, const float* a, const float* b, const float* c) {
+    float o1 = computeOrientation(a, b, p);
+    float o2 = computeOrientation(b, c, p);
+    float o3 = computeOrientation(c, a, p);
+    return (o1 >= 0.0f && o2 >= 0.0f && o3 >= 0.0f) || (o1 <= 0.0f && o2 <= 0.0f && o3 <= 0.0f);
+}
+
+// Return true if two 2D segments intersect (or touch)
+static bool testSegments2D(const float* a, const float* b, const float* c, const float* d) {
+    float o1 = computeOrientation(a, b, c);
+    float o2 = computeOrientation(a, b, d);
+    float o3 = computeOrientation(c, d, a);
+    float o4 = computeOrientation(c, d, b);
+    if (((o1 > 0.0f && o2 < 0.0f) || (o1 < 0.0f && o2 > 0.0f)) &&
+        ((o3 > 0.0f && o4 < 0.0f) || (o3 < 0.0f && o4 > 0.0f))) return true;
+
+    // Collinear cases
+    if (o1 == 0.0f && min(a[0], b[0]) <= c[0] && c[0] <= max(a[0], b[0]) &&
+        min(a[1], b[1]) <= c[1] && c[1] <= max(a[1], b[1])) return true;
+    if (o2 == 0.0f && min(a[0], b[0]) <= d[0] && d[0] <= max(a[0], b[0]) &&
+        min(a[1], b[1]) <= d[1] && d[1] <= max(a[1], b[1])) return true;
+    if (o3 == 0.0f && min(c[0], d[0]) <= a[0] && a[0] <= max(c[0], d[0]) &&
+        min(c[1], d[1]) <= a[1] && a[1] <= max(c[1], d[1])) return true;
+    if (o4 == 0.0f && min(c[0], d[0]) <= b[0] && b[0] <= max(c[0], d[0]) &&
+        min(c[1], d[1]) <= b[1] && b[1] <= max(c[1], d[1])) return true;
+    return false;
+}
+
+// Return true if two coplanar triangles intersect (they are projected on the
+// plane orthogonal to the largest component of their normal)
+static bool testCoplanarTriangles(const Vector3& normal, const Vector3 triangle1[3],
+                                  const Vector3 triangle2[3]) {
+
+    int axis1 = 1, axis2 = 2;
+    if (fabs(normal.y) >= fabs(normal.x) && fabs(normal.y) >= fabs(normal.z)) axis1 = 0;
+    else if (fabs(normal.z) >= fabs(normal.x) && fabs(normal.z) >= fabs(normal.y)) axis2 = 0;
+
+    float points1[3][2], points2[3][2];
+    for (int i=0; i<3; i++) {
+        points1[i][0] = triangle1[i][axis1]; points1[i][1] = triangle1[i][axis2];
+        points2[i][0] = triangle2[i][axis1]; points2[i][1] = triangle2[i][axis2];
+    }
+
+    for (int i=0; i<3; i++) {
+        for (int j=0; j<3; j++) {
+            if (testSegments2D(points1[i], points1[(i + 1) % 3],
+                               points2[j], points2[(j + 1) % 3])) return true;
+        }
+    }
+
+    // One triangle may contain the other one
+    return isPointInTriangle2D(points1[0], points2[0], points2[1], points2[2]) ||
+           isPointInTriangle2D(points2[0], points1[0], points1[1], points1[2]);
+}
+
+// Return true if two triangles intersect
+bool MeshCollision::testTriangleIntersection(const Vector3& a1, const Vector3& b1,
+                                             const Vector3& c1, const Vector3& a2,
+                                             const Vector3& b2, const Vector3& c2) {
+
+    // Reject the triangles whose vertices are all on the same side of the plane
+    // of the other triangle
+    Vector3 normal1 = (b1 - a1).cross(c1 - a1);
+    float da2 = normal1.dot(a2 - a1);
+    float db2 = normal1.dot(b2 - a1);
+    float dc2 = normal1.dot(c2 - a1);
+    if ((da2 > 0.0f && db2 > 0.0f && dc2 > 0.0f) || (da2 < 0.0f && db2 < 0.0f && dc2 < 0.0f)) {
+        return false;
+    }
+    Vector3 normal2 = (b2 - a2).cross(c2 - a2);
+    float da1 = normal2.dot(a1 - a2);
+    float db1 = normal2.dot(b1 - a2);
+    float dc1 = normal2.dot(c1 - a2);
+    if ((da1 > 0.0f && db1 > 0.0f && dc1 > 0.0f) || (da1 < 0.0f && db1 < 0.0f && dc1 < 0.0f)) {
+        return false;
+    }
+
+    // Ignore the degenerate triangles
+    float length1 = normal1.length();
+    if (length1 <= 0.0f || normal2.lengthSquared() <= 0.0f) return false;
+
+    // If the triangles are coplanar, test them in 2D (the tolerance is relative to
+    // the size of the first triangle, the square root of the length of its normal)
+    float tolerance = COPLANAR_TOLERANCE * length1 * sqrt(length1);
+    if (fabs(da2) <= tolerance && fabs(db2) <= tolerance && fabs(dc2) <= tolerance) {
+        const Vector3 triangle1[3] = {a1, b1, c1};
+        const Vector3 triangle2[3] = {a2, b2, c2};
+        return testCoplanarTriangles(normal1, triangle1, triangle2);
+    }
+
+    // Otherwise, the triangles intersect if and only if an edge of one
+    // triangle intersects the other triangle
+    return testSegmentTriangle(a1, b1, a2, b2, c2) || testSegmentTriangle(b1, c1, a2, b2, c2) ||
+           testSegmentTriangle(c1, a1, a2, b2, c2) || testSegmentTriangle(a2, b2, a1, b1, c1) ||
+           testSegmentTriangle(b2, c2, a1, b1, c1) || testSegmentTriangle(c2, a2, a1, b1, c1);
+}
+
+// Class BVHTraversal
+// Simultaneous traversal of two BVHs in the local-space of the first one
+class BVHTraversal {
+
+    public:
+
+        // BVHs of the two meshes
+        const MeshBVH& bvh1;
+        const MeshBVH& bvh2;
+
+        // Transform from the local-space of the second mesh to the one of the first mesh
+        float rotation[3][3];
+        float translation[3];
+
+        // Absolute values of the rotation (used to transform the boxes)
+        float absoluteRotation[3][3];
+
+        // True if the traversal stops at the first intersection
+        bool isEarlyOut;
+
+        // True if an intersection has been found
+        std::atomic<bool> isIntersectionFound;
+
+        // Constructor
+        BVHTraversal(const MeshBVH& bvh1, const Matrix4& transform1,
+                     const MeshBVH& bvh2, const Matrix4& transform2, bool isEarlyOut)
+            : bvh1(bvh1), bvh2(bvh2), isEarlyOut(isEarlyOut), isIntersectionFound(false) {
+            Matrix4 transform = transform1.getAffineInverse() * transform2;
+            for (int i=0; i<3; i++) {
+                for (int j=0; j<3; j++) {
+                    rotation[i][j] = transform.m[i][j];
+                    absoluteRotation[i][j] = fabs(transform.m[i][j]);
+                }
+                translation[i] = transform.m[i][3];
+            }
+        }
+
+        // Transform a point of the second mesh into the local-space of the first mesh
+        Vector3 transformPoint(const Vector3& p) const {
+            return Vector3(rotation[0][0] * p.x + rotation[0][1] * p.y + rotation[0][2] * p.z + translation[0],
+                           rotation[1][0] * p.x + rotation[1][1] * p.y + rotation[1][2] * p.z + translation[1],
+                           rotation[2][0] * p.x + rotation[2][1] * p.y + rotation[2][2] * p.z + translation[2]);
+        }
+
+        // Compute a box (in the local-space of the first mesh) that contains the
+        // box of a node of the second tree
+        void transformNode(uint nodeIndex, TransformedBox& box) const {
+            const BVHNode& node = bvh2.getNodes()[nodeIndex];
+            float center[3], extent[3];
+            for (int i=0; i<3; i++) {
+                center[i] = 0.5f * (node.min[i] + node.max[i]);
+                extent[i] = 0.5f * (node.max[i] - node.min[i]);
+            }
+            for (int i=0; i<3; i++) {
+                float c = rotation[i][0] * center[0] + rotation[i][1] * center[1] +
+                          rotation[i][2] * center[2] + translation[i];
+                float e = absoluteRotation[i][0] * extent[0] + absoluteRotation[i][1] * extent[1] +
+                          absoluteRotation[i][2] * extent[2];
+                box.min[i] = c - e;
+                box.max[i] = c + e;
+            }
+        }
+
+        // Return true if the box of a node of the first tree overlaps a transformed box
+        bool testOverlap(uint nodeIndex, const TransformedBox& box) const {
+            const BVHNode& node = bvh1.getNodes()[nodeIndex];
+            return node.min[0] <= box.max[0] && node.max[0] >= box.min[0] &&
+                   node.min[1] <= box.max[1] && node.max[1] >= box.min[1] &&
+                   node.min[2] <= box.max[2] && node.max[2] >= box.min[2];
+        }
+
+        // Return true if two nodes overlap
+        bool testOverlap(const NodePair& pair) const {
+            TransformedBox box;
+            transformNode(pair.node2, box);
+            return testOverlap(pair.node1, box);
+        }
+
+        // Return true if both nodes of a pair are leaves
+        bool isLeafPair(const NodePair& pair) const {
+            return bvh1.getNodes()[pair.node1].isLeaf() && bvh2.getNodes()[pair.node2].isLeaf();
+        }
+
+        // Add the overlapping pairs of children of a pair of nodes (the larger node is split)
+        void expandPair(const NodePair& pair, vector<NodePair>& pairs) const {
+
+            const BVHNode& node1 = bvh1.getNodes()[pair.node1];
+            const BVHNode& node2 = bvh2.getNodes()[pair.node2];
+            TransformedBox box2;
+            transformNode(pair.node2, box2);
+
+            bool isFirstNodeSplit = node2.isLeaf();
+            if (!node1.isLeaf() && !node2.isLeaf()) {
+                float size1 = (node1.max[0] - node1.min[0]) + (node1.max[1] - node1.min[1]) +
+                              (node1.max[2] - node1.min[2]);
+                float size2 = (box2.max[0] - box2.min[0]) + (box2.max[1] - box2.min[1]) +
+                              (box2.max[2] - box2.min[2]);
+                isFirstNodeSplit = (size1 >= size2);
+            }
+
+            if (isFirstNodeSplit) {
+                uint children[2] = {pair.node1 + 1, node1.data};
+                for (int i=0; i<2; i++) {
+                    if (testOverlap(children[i], box2)) pairs.push_back(NodePair(children[i], pair.node2));
+                }
+            }
+            else {
+                uint children[2] = {pair.node2 + 1, node2.data};
+                for (int i=0; i<2; i++) {
+                    NodePair childPair(pair.node1, children[i]);
+                    if (testOverlap(childPair)) pairs.push_back(childPair);
+                }
+            }
+        }
+
+        // Test the triangles of two leaves
+        void testLeaves(const NodePair& pair, vector<TrianglePair>& trianglePairs) {
+
+            const BVHNode& leaf1 = bvh1.getNodes()[pair.node1];
+            const BVHNode& leaf2 = bvh2.getNodes()[pair.node2];
+
+            // Transform the triangles of the second leaf (structure of arrays)
+            const uint nbTriangles2 = leaf2.nbTriangles;
+            float coordinates[3][3][MeshBVH::MAX_LEAF_SIZE + 3];
+            for (uint t=0; t<nbTriangles2; t++) {
+                for (uint k=0; k<3; k++) {
+                    Vector3 vertex = transformPoint(bvh2.getTriangleVertex(leaf2.data + t, k));
+                    coordinates[k][0][t] = vertex.x;
+                    coordinates[k][1][t] = vertex.y;
+                    coordinates[k][2][t] = vertex.z;
+                }
+            }
+            for (uint t=nbTriangles2; t<MeshBVH::MAX_LEAF_SIZE + 3; t++) {
+                for (uint k=0; k<3; k++) {
+                    coordinates[k][0][t] = coordinates[k][1][t] = coordinates[k][2][t] = 0.0f;
+                }
+            }
+
+            for (uint t1=leaf1.data; t1<leaf1.data + leaf1.nbTriangles; t1++) {
+
+                const Vector3& a1 = bvh1.getTriangleVertex(t1, 0);
+                const Vector3& b1 = bvh1.getTriangleVertex(t1, 1);
+                const Vector3& c1 = bvh1.getTriangleVertex(t1, 2);
+
+                for (uint first=0; first<nbTriangles2; first+=4) {
+
+                    // Find the triangles of the batch that are not rejected by the planes
+                    int candidates = (1 << min(4u, nbTriangles2 - first)) - 1;
+#ifdef MESH_COLLISION_USE_SSE
+                    candidates &= ~rejectBatch(a1, b1, c1, coordinates, first);
+#endif
+
+                    for (int i=0; candidates != 0; i++, candidates >>= 1) {
+                        if ((candidates & 1) == 0) continue;
+                        uint t = first + i;
+                        Vector3 a2(coordinates[0][0][t], coordinates[0][1][t], coordinates[0][2][t]);
+                        Vector3 b2(coordinates[1][0][t], coordinates[1][1][t], coordinates[1][2][t]);
+                        Vector3 c2(coordinates[2][0][t], coordinates[2][1][t], coordinates[2][2][t]);
+                        if (MeshCollision::testTriangleIntersection(a1, b1, c1, a2, b2, c2)) {
+                            uint t2 = leaf2.data + t;
+                            trianglePairs.push_back(TrianglePair(bvh1.getTrianglePart(t1),
+                                                                 bvh1.getTriangleFace(t1),
+                                                                 bvh2.getTrianglePart(t2),
+                                                                 bvh2.getTriangleFace(t2)));
+                            if (isEarlyOut) {
+                                isIntersectionFound = true;
+                                return;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+#ifdef MESH_COLLISION_USE_SSE
+
+        // Return the bit mask of the four triangles of a batch that are rejected because
+        // all their vertices are on the same side of the plane of the other triangle
+        static int rejectBatch(const Vector3& a1, const Vector3& b1, const Vector3& c1,
+                               const float coordinates[3][3][MeshBVH::MAX_LEAF_SIZE + 3],
+                               uint first) {
+
+            const __m128 zero = _mm_setzero_ps();
+
+            __m128 ax = _mm_loadu_ps(&coordinates[0][0][first]);
+            __m128 ay = _mm_loadu_ps(&coordinates[0][1][first]);
+            __m128 az = _mm_loadu_ps(&coordinates[0][2][first]);
+            __m128 bx = _mm_loadu_ps(&coordinates[1][0][first]);
+            __m128 by = _mm_loadu_ps(&coordinates[1][1][first]);
+            __m128 bz = _mm_loadu_ps(&coordinates[1][2][first]);
+            __m128 cx = _mm_loadu_ps(&coordinates[2][0][first]);
+            __m128 cy = _mm_loadu_ps(&coordinates[2][1][first]);
+            __m128 cz = _mm_loadu_ps(&coordinates[2][2][first]);
+
+            // Distances of the vertices of the batch to the plane of the triangle
+            Vector3 normal1 = (b1 - a1).cross(c1 - a1);
+            __m128 nx = _mm_set1_ps(normal1.x);
+            __m128 ny = _mm_set1_ps(normal1.y);
+            __m128 nz = _mm_set1_ps(normal1.z);
+            __m128 offset = _mm_set1_ps(normal1.dot(a1));
+            __m128 da = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, ax), _mm_mul_ps(ny, ay)),
+                                              _mm_mul_ps(nz, az)), offset);
+            __m128 db = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, bx), _mm_mul_ps(ny, by)),
+                                              _mm_mul_ps(nz, bz)), offset);
+            __m128 dc = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+                                              _mm_mul_ps(nz, cz)), offset);
+            __m128 rejected = _mm_or_ps(
+                _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(da, zero), _mm_cmpgt_ps(db, zero)),
+                           _mm_cmpgt_ps(dc, zero)),
+                _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(da, zero), _mm_cmplt_ps(db, zero)),
+                           _mm_cmplt_ps(dc, zero)));
+
+            // Distances of the vertices of the triangle to the planes of the batch
+            __m128 e1x = _mm_sub_ps(bx, ax), e1y = _mm_sub_ps(by, ay), e1z = _mm_sub_ps(bz, az);
+            __m128 e2x = _mm_sub_ps(cx, ax), e2y = _mm_sub_ps(cy, ay), e2z = _mm_sub_ps(cz, az);
+            __m128 mx = _mm_sub_ps(_mm_mul_ps(e1y, e2z), _mm_mul_ps(e1z, e2y));
+            __m128 my = _mm_sub_ps(_mm_mul_ps(e1z, e2x), _mm_mul_ps(e1x, e2z));
+            __m128 mz = _mm_sub_ps(_mm_mul_ps(e1x, e2y), _mm_mul_ps(e1y, e2x));
+            __m128 offsets = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mx, ax), _mm_mul_ps(my, ay)),
+                                        _mm_mul_ps(mz, az));
+            __m128 ea = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(mx, _mm_set1_ps(a1.x)),
+                                                         _mm_mul_ps(my, _mm_set1_ps(a1.y))),
+                                              _mm_mul_ps(mz, _mm_set1_ps(a1.z))), offsets);
+            __m128 eb = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(mx, _mm_set1_ps(b1.x)),
+                                                         _mm_mul_ps(my, _mm_set1_ps(b1.y))),
+                                              _mm_mul_ps(mz, _mm_set1_ps(b1.z))), offsets);
+            __m128 ec = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(mx, _mm_set1_ps(c1.x)),
+                                                         _mm_mul_ps(my, _mm_set1_ps(c1.y))),
+                                              _mm_mul_ps(mz, _mm_set1_ps(c1.z))), offsets);
+            rejected = _mm_or_ps(rejected, _mm_or_ps(
+                _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(ea, zero), _mm_cmpgt_ps(eb, zero)),
+                           _mm_cmpgt_ps(ec, zero)),
+                _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(ea, zero), _mm_cmplt_ps(eb, zero)),
+                           _mm_cmplt_ps(ec, zero))));
+
+            return _mm_movemask_ps(rejected);
+        }
+
+#endif
+
+        // Traverse the subtrees of a pair of nodes
+        void traverse(const NodePair& root, vector<TrianglePair>& trianglePairs) {
+
+            vector<NodePair> stack;
+            stack.push_back(root);
+
+            while (!stack.empty()) {
+
+                if (isEarlyOut && isIntersectionFound) return;
+
+                NodePair pair = stack.back();
+                stack.pop_back();
+
+                if (isLeafPair(pair)) {
+                    testLeaves(pair, trianglePairs);
+                }
+                else {
+                    expandPair(pair, stack);
+                }
+            }
+        }
+
+        // Find the intersecting triangles (in parallel)
+        void run(vector<TrianglePair>& trianglePairs) {
+
+            trianglePairs.clear();
+            if (bvh1.getNodes().empty() || bvh2.getNodes().empty()) return;
+
+            // Split the traversal into independent pairs of subtrees
+            vector<NodePair> tasks, nextTasks;
+            NodePair root(0, 0);
+            if (testOverlap(root)) tasks.push_back(root);
+            bool isExpanded = true;
+            while (isExpanded && !tasks.empty() && tasks.size() < NB_PARALLEL_TASKS) {
+                isExpanded = false;
+                nextTasks.clear();
+                for (uint i=0; i<tasks.size(); i++) {
+                    if (isLeafPair(tasks[i])) {
+                        nextTasks.push_back(tasks[i]);
+                    }
+                    else {
+                        expandPair(tasks[i], nextTasks);
+                        isExpanded = true;
+                    }
+                }
+                tasks.swap(nextTasks);
+            }
+
+            // Traverse the pairs of subtrees in parallel
+            const int nbTasks = int(tasks.size());
+            vector<vector<TrianglePair> > taskTrianglePairs(nbTasks);
+            #pragma omp parallel for schedule(dynamic, 1)
+            for (int i=0; i<nbTasks; i++) {
+                traverse(tasks[i], taskTrianglePairs[i]);
+            }
+
+            for (int i=0; i<nbTasks; i++) {
+                trianglePairs.insert(trianglePairs.end(), taskTrianglePairs[i].begin(),
+                                     taskTrianglePairs[i].end());
+            }
+        }
+};
+
+// Return true if two meshes (with their BVHs and transforms) intersect
+bool MeshCollision::testIntersection(const MeshBVH& bvh1, const Matrix4& transform1,
+                                     const MeshBVH& bvh2, const Matrix4& transform2) {
+    vector<TrianglePair> trianglePairs;
+    BVHTraversal traversal(bvh1, transform1, bvh2, transform2, true);
+    traversal.run(trianglePairs);
+    return !trianglePairs.empty();
+}
+
+// Find all the pairs of intersecting triangles of two meshes (with their
+// BVHs and transforms)
+void MeshCollision::findIntersectingTriangles(const MeshBVH& bvh1, const Matrix4& transform1,
+                                              const MeshBVH& bvh2, const Matrix4& transform2,
+                                              vector<TrianglePair>& pairs) {
+    BVHTraversal traversal(bvh1, transform1, bvh2, transform2, false);
+    traversal.run(pairs);
+}
@@ -0,0 +1,117 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef MESH_COLLISION_H
+#define MESH_COLLISION_H
+
+// Libraries
+#include <vector>
+#include "definitions.h"
+#include "maths/Matrix4.h"
+#include "Mesh.h"
+#include "MeshBVH.h"
+
+namespace openglframework {
+
+// Class TrianglePair
+// This class represents a pair of intersecting triangles of two meshes
+class TrianglePair {
+
+    public:
+        TrianglePair() : part1(0), face1(0), part2(0), face2(0) {}
+        TrianglePair(uint part1, uint face1, uint part2, uint face2)
+            : part1(part1), face1(face1), part2(part2), face2(face2) {}
+
+        // Part and index of the triangle in this part for the first mesh
+        uint part1, face1;
+
+        // Part and index of the triangle in this part for the second mesh
+        uint part2, face2;
+};
+
+// Class MeshCollision
+// This class contains static methods to find the intersecting triangles of two
+// meshes (for instance for clash detection) with a simultaneous traversal of their
+// BVHs. The traversal is done in the local-space of the first mesh: the boxes of
+// the second BVH are transformed on the fly into boxes that contain them and the
+// triangles of the second mesh are transformed when two leaves overlap. Each
+// triangle of a leaf is tested against four triangles of the other leaf at a time
+// with SSE (rejection by the planes of the triangles) before the exact test. The
+// traversal is split into independent subtrees pairs that run in parallel.
+class MeshCollision {
+
+    private :
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor (private because we do not want instances of this class)
+        MeshCollision();
+
+    public :
+
+        // -------------------- Methods -------------------- //
+
+        // Return true if two meshes (with their BVHs and transforms) intersect
+        static bool testIntersection(const MeshBVH& bvh1, const Matrix4& transform1,
+                                     const MeshBVH& bvh2, const Matrix4& transform2);
+
+        // Find all the pairs of intersecting triangles of two meshes (with their
+        // BVHs and transforms)
+        static void findIntersectingTriangles(const MeshBVH& bvh1, const Matrix4& transform1,
+                                              const MeshBVH& bvh2, const Matrix4& transform2,
+                                              std::vector<TrianglePair>& pairs);
+
+        // Return true if two posed meshes intersect
+        static bool testIntersection(const Mesh& mesh1, const MeshBVH& bvh1,
+                                     const Mesh& mesh2, const MeshBVH& bvh2);
+
+        // Find all the pairs of intersecting triangles of two posed meshes
+        static void findIntersectingTriangles(const Mesh& mesh1, const MeshBVH& bvh1,
+                                              const Mesh& mesh2, const MeshBVH& bvh2,
+                                              std::vector<TrianglePair>& pairs);
+
+        // Return true if two triangles intersect
+        static bool testTriangleIntersection(const Vector3& a1, const Vector3& b1,
+                                             const Vector3& c1, const Vector3& a2,
+                                             const Vector3& b2, const Vector3& c2);
+};
+
+// Return true if two posed meshes intersect
+inline bool MeshCollision::testIntersection(const Mesh& mesh1, const MeshBVH& bvh1,
+                                            const Mesh& mesh2, const MeshBVH& bvh2) {
+    return testIntersection(bvh1, mesh1.getTransformMatrix(), bvh2, mesh2.getTransformMatrix());
+}
+
+// Find all the pairs of intersecting triangles of two posed meshes
+inline void MeshCollision::findIntersectingTriangles(const Mesh& mesh1, const MeshBVH& bvh1,
+                                                     const Mesh& mesh2, const MeshBVH& bvh2,
+                                                     std::vector<TrianglePair>& pairs) {
+    findIntersectingTriangles(bvh1, mesh1.getTransformMatrix(), bvh2,
+                              mesh2.getTransformMatrix(), pairs);
+}
+
+}
+
+#endif
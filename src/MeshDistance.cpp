@@ -0,0 +1,117 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "MeshDistance.h"
+#include <algorithm>
+#include <limits>
+
+using namespace openglframework;
+using namespace std;
+
+// Sample points on the surface of a mesh. With zero subdivisions, only the
+// vertices are sampled. Otherwise, each triangle is sampled on a regular
+// barycentric grid with the given number of subdivisions per edge.
+void MeshDistance::samplePoints(const Mesh& mesh, uint nbSubdivisions, vector<Vector3>& points) {
+
+    points.clear();
+
+    if (nbSubdivisions == 0) {
+        points = mesh.getVertices();
+        return;
+    }
+
+    const float step = 1.0f / float(nbSubdivisions);
+    const uint nbPointsPerTriangle = (nbSubdivisions + 1) * (nbSubdivisions + 2) / 2;
+
+    uint nbTriangles = 0;
+    for (uint p=0; p<mesh.getNbParts(); p++) nbTriangles += mesh.getNbFaces(p);
+    points.reserve(nbTriangles * nbPointsPerTriangle);
+
+    for (uint p=0; p<mesh.getNbParts(); p++) {
+        for (uint f=0; f<mesh.getNbFaces(p); f++) {
+            const Vector3& v0 = mesh.getVertex(mesh.getVertexIndexInFace(f, 0, p));
+            const Vector3& v1 = mesh.getVertex(mesh.getVertexIndexInFace(f, 1, p));
+            const Vector3& v2 = mesh.getVertex(mesh.getVertexIndexInFace(f, 2, p));
+            Vector3 edge1 = v1 - v0;
+            Vector3 edge2 = v2 - v0;
+            for (uint i=0; i<=nbSubdivisions; i++) {
+                for (uint j=0; i+j<=nbSubdivisions; j++) {
+                    points.push_back(v0 + edge1 * (i * step) + edge2 * (j * step));
+                }
+            }
+        }
+    }
+}
+
+// Compute the one-sided Hausdorff distance from a mesh to another mesh (with a BVH)
+float MeshDistance::computeOneSidedHausdorffDistance(const Mesh& mesh, const MeshBVH& otherMeshBVH,
+                                                     uint nbSubdivisions, float* meanDistance) {
+
+    vector<Vector3> points;
+    samplePoints(mesh, nbSubdivisions, points);
+
+    // The distance from a mesh without sample points is zero and the distance to a
+    // mesh without triangles is infinite
+    if (points.empty() || otherMeshBVH.getNbTriangles() == 0) {
+        float distance = points.empty() ? 0.0f : numeric_limits<float>::infinity();
+        if (meanDistance != NULL) *meanDistance = distance;
+        return distance;
+    }
+
+    vector<ClosestPointHit> hits;
+    otherMeshBVH.findClosestPoints(points, hits);
+
+    float maxDistance = 0.0f;
+    double sumDistances = 0.0;
+    for (size_t i=0; i<hits.size(); i++) {
+        maxDistance = max(maxDistance, hits[i].distance);
+        sumDistances += hits[i].distance;
+    }
+
+    if (meanDistance != NULL) {
+        *meanDistance = float(sumDistances / hits.size());
+    }
+
+    return maxDistance;
+}
+
+// Compute the symmetric Hausdorff distance between two meshes
+HausdorffDistance MeshDistance::computeHausdorffDistance(const Mesh& mesh1, const Mesh& mesh2,
+                                                         uint nbSubdivisions) {
+
+    MeshBVH bvh1, bvh2;
+    bvh1.build(mesh1, false);
+    bvh2.build(mesh2, false);
+
+    HausdorffDistance result;
+    result.maxDistance12 = computeOneSidedHausdorffDistance(mesh1, bvh2, nbSubdivisions,
+                                                            &result.meanDistance12);
+    result.maxDistance21 = computeOneSidedHausdorffDistance(mesh2, bvh1, nbSubdivisions,
+                                                            &result.meanDistance21);
+    result.distance = max(result.maxDistance12, result.maxDistance21);
+
+    return result;
+}
@@ -0,0 +1,101 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef MESH_DISTANCE_H
+#define MESH_DISTANCE_H
+
+// Libraries
+#include <vector>
+#include "definitions.h"
+#include "maths/Vector3.h"
+#include "Mesh.h"
+#include "MeshBVH.h"
+
+namespace openglframework {
+
+// Class HausdorffDistance
+// This class contains the result of a Hausdorff distance computation between two meshes.
+// The distances from a mesh without sample points are zero and the distances to a mesh
+// without triangles are infinite. Two empty meshes are thus at distance zero and an
+// empty mesh is at an infinite distance from a non-empty one.
+class HausdorffDistance {
+
+    public:
+        HausdorffDistance() : distance(0), maxDistance12(0), maxDistance21(0),
+                              meanDistance12(0), meanDistance21(0) {}
+
+        // Symmetric Hausdorff distance (maximum of the two one-sided distances)
+        float distance;
+
+        // One-sided distances from the first mesh to the second one and conversely
+        float maxDistance12;
+        float maxDistance21;
+
+        // Mean distances from the first mesh to the second one and conversely
+        float meanDistance12;
+        float meanDistance21;
+};
+
+// Class MeshDistance
+// This class contains static methods to measure the distance between meshes, for
+// instance to compute the error of a simplified mesh (LOD) against the original one.
+// The meshes are compared in their local-space (the transforms are ignored) and
+// the distances are computed between points sampled on the surface of a mesh and
+// the closest points on the other mesh. Since only the sample points are measured,
+// the results are lower bounds of the exact distances that get closer to them as the
+// number of subdivisions increases. The vertices alone (zero subdivisions) miss the
+// points inside the faces and usually underestimate the distance a lot.
+class MeshDistance {
+
+    private :
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor (private because we do not want instances of this class)
+        MeshDistance();
+
+    public :
+
+        // -------------------- Methods -------------------- //
+
+        // Sample points on the surface of a mesh. With zero subdivisions, only the
+        // vertices are sampled. Otherwise, each triangle is sampled on a regular
+        // barycentric grid with the given number of subdivisions per edge.
+        static void samplePoints(const Mesh& mesh, uint nbSubdivisions,
+                                 std::vector<Vector3>& points);
+
+        // Compute the one-sided Hausdorff distance from a mesh to another mesh (with a BVH)
+        static float computeOneSidedHausdorffDistance(const Mesh& mesh, const MeshBVH& otherMeshBVH,
+                                                      uint nbSubdivisions = 4,
+                                                      float* meanDistance = NULL);
+
+        // Compute the symmetric Hausdorff distance between two meshes
+        static HausdorffDistance computeHausdorffDistance(const Mesh& mesh1, const Mesh& mesh2,
+                                                          uint nbSubdivisions = 4);
+};
+
+}
+
+#endif
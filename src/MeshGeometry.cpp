@@ -0,0 +1,84 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "MeshGeometry.h"
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Copy-constructor
+MeshGeometry::MeshGeometry(const MeshGeometry& geometry)
+    : indices(geometry.indices), vertices(geometry.vertices), normals(geometry.normals),
+      tangents(geometry.tangents), colors(geometry.colors), uvs(geometry.uvs),
+      isBoundingVolumesValid(false) {
+
+    // Copy the bounding volumes only if they are up to date (the lock waits for
+    // another thread that may be computing them)
+    std::lock_guard<std::mutex> lock(geometry.mBoundingVolumesMutex);
+    if (geometry.isBoundingVolumesValid.load(std::memory_order_acquire)) {
+        partAABBs = geometry.partAABBs;
+        partBoundingSpheres = geometry.partBoundingSpheres;
+        aabb = geometry.aabb;
+        boundingSphere = geometry.boundingSphere;
+        isBoundingVolumesValid.store(true, std::memory_order_relaxed);
+    }
+}
+
+// Recompute the cached bounding volumes
+void MeshGeometry::updateBoundingVolumes() const {
+
+    // Bounding volumes of each part (using only the vertices of the part)
+    partAABBs.assign(indices.size(), AABB());
+    partBoundingSpheres.assign(indices.size(), BoundingSphere());
+    for (uint p=0; p<indices.size(); p++) {
+        const vector<uint>& partIndices = indices[p];
+        for (size_t i=0; i<partIndices.size(); i++) {
+            partAABBs[p].merge(vertices[partIndices[i]]);
+        }
+        partBoundingSpheres[p] = BoundingSphere::computeRitter(vertices, &partIndices);
+    }
+
+    // Bounding volumes of all the vertices
+    aabb = AABB();
+    for (size_t i=0; i<vertices.size(); i++) {
+        aabb.merge(vertices[i]);
+    }
+    boundingSphere = BoundingSphere::computeRitter(vertices);
+}
+
+// Return the number of bytes used by the vertex attributes and indices
+size_t MeshGeometry::getDataSize() const {
+
+    size_t size = vertices.size() * sizeof(Vector3) + normals.size() * sizeof(Vector3) +
+                  tangents.size() * sizeof(Vector3) + colors.size() * sizeof(Color) +
+                  uvs.size() * sizeof(Vector2);
+    for (size_t p=0; p<indices.size(); p++) {
+        size += indices[p].size() * sizeof(uint);
+    }
+
+    return size;
+}
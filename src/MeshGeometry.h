@@ -0,0 +1,132 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef MESH_GEOMETRY_H
+#define MESH_GEOMETRY_H
+
+// Libraries
+#include <vector>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include "definitions.h"
+#include "maths/Vector2.h"
+#include "maths/Vector3.h"
+#include "maths/Color.h"
+#include "maths/AABB.h"
+#include "maths/BoundingSphere.h"
+
+namespace openglframework {
+
+// Class MeshGeometry
+// This class contains the geometry data of a mesh (the vertex attributes, the
+// indices of the triangles and the cached local-space bounding volumes). A
+// MeshGeometry is reference counted and shared by all the Mesh instances that have
+// been copied from the same mesh. It is only copied when one of those meshes is
+// modified (copy-on-write), so that the memory of a scene with many instances of
+// the same asset only depends on the number of different assets. The bounding
+// volumes are computed at the first query after a modification. This lazy update
+// is protected by a mutex, so the meshes sharing a geometry can be queried from
+// several threads at the same time.
+class MeshGeometry {
+
+    private:
+
+        // -------------------- Attributes -------------------- //
+
+        // Mutex used to compute the cached bounding volumes only once
+        mutable std::mutex mBoundingVolumesMutex;
+
+        // -------------------- Methods -------------------- //
+
+        // Recompute the cached bounding volumes
+        void updateBoundingVolumes() const;
+
+    public:
+
+        // -------------------- Attributes -------------------- //
+
+        // A triplet of vertex indices for each triangle (for each part)
+        std::vector<std::vector<uint> > indices;
+
+        // Vertices coordinates (local space)
+        std::vector<Vector3> vertices;
+
+        // Normals coordinates
+        std::vector<Vector3> normals;
+
+        // Tangents coordinates
+        std::vector<Vector3> tangents;
+
+        // Color for each vertex
+        std::vector<Color> colors;
+
+        // UV texture coordinates
+        std::vector<Vector2> uvs;
+
+        // Cached bounding box of each part of the mesh (local space)
+        mutable std::vector<AABB> partAABBs;
+
+        // Cached bounding sphere of each part of the mesh (local space)
+        mutable std::vector<BoundingSphere> partBoundingSpheres;
+
+        // Cached bounding box of all the vertices of the mesh (local space)
+        mutable AABB aabb;
+
+        // Cached bounding sphere of all the vertices of the mesh (local space)
+        mutable BoundingSphere boundingSphere;
+
+        // True if the cached bounding volumes are up to date
+        mutable std::atomic<bool> isBoundingVolumesValid;
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor
+        MeshGeometry() : isBoundingVolumesValid(false) {}
+
+        // Copy-constructor
+        MeshGeometry(const MeshGeometry& geometry);
+
+        // Recompute the cached bounding volumes if they are not up to date (thread-safe)
+        void updateBoundingVolumesIfNeeded() const;
+
+        // Return the number of bytes used by the vertex attributes and indices
+        size_t getDataSize() const;
+};
+
+// Recompute the cached bounding volumes if they are not up to date (thread-safe)
+inline void MeshGeometry::updateBoundingVolumesIfNeeded() const {
+    if (!isBoundingVolumesValid.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(mBoundingVolumesMutex);
+        if (!isBoundingVolumesValid.load(std::memory_order_relaxed)) {
+            updateBoundingVolumes();
+            isBoundingVolumesValid.store(true, std::memory_order_release);
+        }
+    }
+}
+
+}
+
+#endif
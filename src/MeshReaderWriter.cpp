@@ -31,6 +31,7 @@
 #include <cctype>
 #include <map>
 #include <algorithm>
+#include <utility>
 
 using namespace openglframework;
 using namespace std;
@@ -309,11 +310,11 @@ void MeshReaderWriter::loadOBJFile(const string &filename, Mesh& meshToCreate) {
     assert(meshNormals.empty() || meshNormals.size() == vertices.size());
     assert(meshUVs.empty() || meshUVs.size() == vertices.size());
 
-    // Set the data to the mesh
-    meshToCreate.setIndices(meshIndices);
-    meshToCreate.setVertices(vertices);
-    meshToCreate.setNormals(meshNormals);
-    meshToCreate.setUVs(meshUVs);
+    // Move the data into the mesh (without copying it)
+    meshToCreate.setIndices(std::move(meshIndices));
+    meshToCreate.setVertices(std::move(vertices));
+    meshToCreate.setNormals(std::move(meshNormals));
+    meshToCreate.setUVs(std::move(meshUVs));
 }
 
 // Store a mesh into a OBJ file
@@ -0,0 +1,356 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "NormalEstimation.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using namespace openglframework;
+using namespace std;
+
+// Binary min-heap of the points to visit with their weight (with decrease-key). The
+// position of each point in the heap is stored so that the memory is bounded by the
+// number of points.
+struct PropagationHeap {
+
+    // Points in the heap
+    std::vector<uint> points;
+
+    // Position of each point in the heap (NOT_IN_HEAP if it is not in the heap)
+    std::vector<uint> positions;
+
+    // Smallest weight of an edge to each point
+    std::vector<float> weights;
+
+    static const uint NOT_IN_HEAP = 0xffffffff;
+
+    PropagationHeap(uint nbPoints)
+        : positions(nbPoints, NOT_IN_HEAP),
+          weights(nbPoints, std::numeric_limits<float>::max()) {}
+
+    // Move the point at a position toward the top of the heap
+    void siftUp(uint position) {
+        uint point = points[position];
+        while (position > 0) {
+            uint parent = (position - 1) / 2;
+            if (weights[points[parent]] <= weights[point]) break;
+            points[position] = points[parent];
+            positions[points[position]] = position;
+            position = parent;
+        }
+        points[position] = point;
+        positions[point] = position;
+    }
+
+    // Move the point at a position toward the bottom of the heap
+    void siftDown(uint position) {
+        uint point = points[position];
+        const uint size = points.size();
+        while (true) {
+            uint child = 2 * position + 1;
+            if (child >= size) break;
+            if (child + 1 < size && weights[points[child + 1]] < weights[points[child]]) child++;
+            if (weights[point] <= weights[points[child]]) break;
+            points[position] = points[child];
+            positions[points[position]] = position;
+            position = child;
+        }
+        points[position] = point;
+        positions[point] = position;
+    }
+
+    // Insert a point or decrease its weight if the new weight is smaller
+    void push(uint point, float weight) {
+        if (positions[point] == NOT_IN_HEAP) {
+            weights[point] = weight;
+            points.push_back(point);
+            siftUp(points.size() - 1);
+        }
+        else if (weight < weights[point]) {
+            weights[point] = weight;
+            siftUp(positions[point]);
+        }
+    }
+
+    // Remove and return the point of smallest weight
+    uint pop() {
+        uint top = points[0];
+        positions[top] = NOT_IN_HEAP;
+        uint last = points.back();
+        points.pop_back();
+        if (!points.empty()) {
+            points[0] = last;
+            siftDown(0);
+        }
+        return top;
+    }
+};
+
+const uint PropagationHeap::NOT_IN_HEAP;
+
+// Compute the cross product of two vectors
+static inline void cross(const double* a, const double* b, double* result) {
+    result[0] = a[1] * b[2] - a[2] * b[1];
+    result[1] = a[2] * b[0] - a[0] * b[2];
+    result[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+// Return the square length of a vector
+static inline double lengthSquared(const double* v) {
+    return v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+}
+
+// Return the eigenvector of the smallest eigenvalue of a symmetric 3x3 matrix. The
+// eigenvalues are computed analytically and the eigenvector is the largest cross
+// product of two rows of the matrix minus the smallest eigenvalue.
+static Vector3 computeSmallestEigenvector(double a00, double a01, double a02,
+                                          double a11, double a12, double a22) {
+
+    // Normalize the matrix to avoid overflow and underflow
+    double scale = max(max(max(fabs(a00), fabs(a01)), max(fabs(a02), fabs(a11))),
+                       max(fabs(a12), fabs(a22)));
+    if (scale <= 0.0) return Vector3(0, 0, 1);
+    a00 /= scale; a01 /= scale; a02 /= scale;
+    a11 /= scale; a12 /= scale; a22 /= scale;
+
+    // Compute the smallest eigenvalue
+    double q = (a00 + a11 + a22) / 3.0;
+    double p1 = a01 * a01 + a02 * a02 + a12 * a12;
+    double p2 = (a00 - q) * (a00 - q) + (a11 - q) * (a11 - q) + (a22 - q) * (a22 - q) + 2.0 * p1;
+    double p = sqrt(p2 / 6.0);
+    if (p < 1e-12) return Vector3(0, 0, 1);
+    double b00 = (a00 - q) / p, b11 = (a11 - q) / p, b22 = (a22 - q) / p;
+    double b01 = a01 / p, b02 = a02 / p, b12 = a12 / p;
+    double r = 0.5 * (b00 * (b11 * b22 - b12 * b12) - b01 * (b01 * b22 - b12 * b02) +
+                      b02 * (b01 * b12 - b11 * b02));
+    r = min(max(r, -1.0), 1.0);
+    double phi = acos(r) / 3.0;
+    double eigenvalue = q + 2.0 * p * cos(phi + 2.0 * PI / 3.0);
+
+    // Take the largest cross product of two rows of the matrix minus the eigenvalue
+    double rows[3][3] = {{a00 - eigenvalue, a01, a02},
+                         {a01, a11 - eigenvalue, a12},
+                         {a02, a12, a22 - eigenvalue}};
+    double products[3][3];
+    cross(rows[0], rows[1], products[0]);
+    cross(rows[0], rows[2], products[1]);
+    cross(rows[1], rows[2], products[2]);
+    int best = 0;
+    double bestLengthSquare = lengthSquared(products[0]);
+    for (int i=1; i<3; i++) {
+        double lengthSquare = lengthSquared(products[i]);
+        if (lengthSquare > bestLengthSquare) {
+            best = i;
+            bestLengthSquare = lengthSquare;
+        }
+    }
+
+    if (bestLengthSquare > 1e-20) {
+        double inverseLength = 1.0 / sqrt(bestLengthSquare);
+        return Vector3(float(products[best][0] * inverseLength),
+                       float(products[best][1] * inverseLength),
+                       float(products[best][2] * inverseLength));
+    }
+
+    // If the eigenvalue is double (the points are on a line), return any vector
+    // orthogonal to the largest row
+    best = 0;
+    for (int i=1; i<3; i++) {
+        if (lengthSquared(rows[i]) > lengthSquared(rows[best])) best = i;
+    }
+    double axis[3] = {0.0, 0.0, 0.0};
+    axis[(fabs(rows[best][0]) < fabs(rows[best][1])) ?
+         ((fabs(rows[best][0]) < fabs(rows[best][2])) ? 0 : 2) :
+         ((fabs(rows[best][1]) < fabs(rows[best][2])) ? 1 : 2)] = 1.0;
+    double orthogonal[3];
+    cross(rows[best], axis, orthogonal);
+    double lengthSquare = lengthSquared(orthogonal);
+    if (lengthSquare <= 0.0) return Vector3(0, 0, 1);
+    double inverseLength = 1.0 / sqrt(lengthSquare);
+    return Vector3(float(orthogonal[0] * inverseLength), float(orthogonal[1] * inverseLength),
+                   float(orthogonal[2] * inverseLength));
+}
+
+// Compute the unoriented normals of the points (in parallel)
+void NormalEstimation::computeNormals(const vector<Vector3>& points, const KdTree& kdTree,
+                                      uint nbNeighbors, vector<Vector3>& normals) {
+
+    if (nbNeighbors == 0) {
+        throw std::invalid_argument("Error : The number of neighbors must be positive");
+    }
+    assert(kdTree.getNbPoints() == points.size());
+    normals.resize(points.size());
+    const int nbPoints = int(points.size());
+
+    #pragma omp parallel
+    {
+        vector<uint> neighbors(nbNeighbors);
+        vector<float> squareDistances(nbNeighbors);
+
+        // The points are processed in the leaf order of the tree so that consecutive
+        // queries visit the same nodes
+        const vector<uint>& pointIndices = kdTree.getPointIndices();
+
+        #pragma omp for schedule(dynamic, 1024)
+        for (int p=0; p<nbPoints; p++) {
+
+            uint i = pointIndices[p];
+            uint nbFound = kdTree.findKNearestNeighbors(points[i], nbNeighbors, &neighbors[0],
+                                                        &squareDistances[0]);
+
+            // Compute the covariance matrix of the neighbours around their centroid
+            Vector3 centroid(0, 0, 0);
+            for (uint j=0; j<nbFound; j++) centroid += points[neighbors[j]];
+            centroid /= float(max(nbFound, 1u));
+            double c00 = 0, c01 = 0, c02 = 0, c11 = 0, c12 = 0, c22 = 0;
+            for (uint j=0; j<nbFound; j++) {
+                Vector3 d = points[neighbors[j]] - centroid;
+                c00 += d.x * d.x; c01 += d.x * d.y; c02 += d.x * d.z;
+                c11 += d.y * d.y; c12 += d.y * d.z; c22 += d.z * d.z;
+            }
+
+            normals[i] = computeSmallestEigenvector(c00, c01, c02, c11, c12, c22);
+        }
+    }
+}
+
+// Orient the normals toward a viewpoint (in parallel)
+void NormalEstimation::orientNormalsTowardViewpoint(const vector<Vector3>& points,
+                                                    const Vector3& viewpoint,
+                                                    vector<Vector3>& normals) {
+
+    assert(normals.size() == points.size());
+    const int nbPoints = int(points.size());
+
+    #pragma omp parallel for
+    for (int i=0; i<nbPoints; i++) {
+        if (normals[i].dot(viewpoint - points[i]) < 0.0f) {
+            normals[i] = -normals[i];
+        }
+    }
+}
+
+// Orient the normals consistently by propagation along the neighbourhood graph
+void NormalEstimation::orientNormalsByPropagation(const vector<Vector3>& points,
+                                                  const KdTree& kdTree, uint nbNeighbors,
+                                                  vector<Vector3>& normals) {
+
+    if (nbNeighbors == 0) {
+        throw std::invalid_argument("Error : The number of neighbors must be positive");
+    }
+    assert(normals.size() == points.size());
+    const uint nbPoints = points.size();
+    if (nbPoints == 0) return;
+
+    // Compute the centroid of the points and the point the farthest from it
+    double sum[3] = {0.0, 0.0, 0.0};
+    for (uint i=0; i<nbPoints; i++) {
+        sum[0] += points[i].x; sum[1] += points[i].y; sum[2] += points[i].z;
+    }
+    Vector3 centroid(float(sum[0] / nbPoints), float(sum[1] / nbPoints),
+                     float(sum[2] / nbPoints));
+    uint farthestPoint = 0;
+    float maxSquareDistance = -1.0f;
+    for (uint i=0; i<nbPoints; i++) {
+        float squareDistance = (points[i] - centroid).lengthSquared();
+        if (squareDistance > maxSquareDistance) {
+            maxSquareDistance = squareDistance;
+            farthestPoint = i;
+        }
+    }
+
+    // Compute the neighbourhood graph (in parallel)
+    vector<uint> neighbors;
+    vector<float> squareDistances;
+    kdTree.findKNearestNeighbors(points, nbNeighbors, neighbors, squareDistances);
+    vector<float>().swap(squareDistances);
+
+    vector<bool> isVisited(nbPoints, false);
+    vector<uint> parents(nbPoints);
+    PropagationHeap heap(nbPoints);
+
+    // Each connected component of the graph starts from a seed point whose normal
+    // is oriented away from the centroid (the first seed is the farthest point
+    // from the centroid for which this is always correct)
+    for (uint i=0; i<=nbPoints; i++) {
+
+        uint seed = (i == 0) ? farthestPoint : i - 1;
+        if (isVisited[seed]) continue;
+        if (normals[seed].dot(points[seed] - centroid) < 0.0f) {
+            normals[seed] = -normals[seed];
+        }
+        parents[seed] = seed;
+        heap.push(seed, 0.0f);
+
+        // Visit the points along the minimum spanning tree of the graph (Prim)
+        while (!heap.points.empty()) {
+
+            uint point = heap.pop();
+            isVisited[point] = true;
+
+            Vector3& normal = normals[point];
+            if (normal.dot(normals[parents[point]]) < 0.0f) {
+                normal = -normal;
+            }
+
+            const uint* pointNeighbors = &neighbors[size_t(point) * nbNeighbors];
+            for (uint j=0; j<nbNeighbors; j++) {
+                uint neighbor = pointNeighbors[j];
+                if (neighbor == KdTree::INVALID_INDEX || isVisited[neighbor]) continue;
+                float weight = 1.0f - fabs(normal.dot(normals[neighbor]));
+                if (weight < heap.weights[neighbor]) {
+                    parents[neighbor] = point;
+                    heap.push(neighbor, weight);
+                }
+            }
+        }
+    }
+}
+
+// Estimate the normals of the vertices of a mesh with consistent orientation
+void NormalEstimation::estimateNormals(Mesh& mesh, uint nbNeighbors) {
+
+    const vector<Vector3>& vertices = mesh.getVertices();
+    KdTree kdTree(vertices);
+    vector<Vector3> normals;
+    computeNormals(vertices, kdTree, nbNeighbors, normals);
+    orientNormalsByPropagation(vertices, kdTree, nbNeighbors, normals);
+    mesh.setNormals(std::move(normals));
+}
+
+// Estimate the normals of the vertices of a mesh oriented toward a viewpoint
+void NormalEstimation::estimateNormals(Mesh& mesh, const Vector3& viewpoint, uint nbNeighbors) {
+
+    const vector<Vector3>& vertices = mesh.getVertices();
+    KdTree kdTree(vertices);
+    vector<Vector3> normals;
+    computeNormals(vertices, kdTree, nbNeighbors, normals);
+    orientNormalsTowardViewpoint(vertices, viewpoint, normals);
+    mesh.setNormals(std::move(normals));
+}
@@ -0,0 +1,88 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef NORMAL_ESTIMATION_H
+#define NORMAL_ESTIMATION_H
+
+// Libraries
+#include <vector>
+#include "definitions.h"
+#include "maths/Vector3.h"
+#include "Mesh.h"
+#include "KdTree.h"
+
+namespace openglframework {
+
+// Class NormalEstimation
+// This class contains static methods to estimate the normals of a point cloud (for
+// instance a mesh with vertices but without faces). The normal of each point is the
+// direction of least variance (principal component analysis) of its k nearest
+// neighbours. The sign of the normals is then made consistent either by orienting
+// them toward the viewpoint of the scanner (fast and parallel) or by propagating the
+// orientation along a minimum spanning tree of the neighbourhood graph where the
+// edges between points with parallel normals are visited first (Hoppe et al. 92).
+// The number of neighbours must be positive (an invalid_argument exception is thrown
+// otherwise).
+class NormalEstimation {
+
+    private :
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor (private because we do not want instances of this class)
+        NormalEstimation();
+
+    public :
+
+        // -------------------- Methods -------------------- //
+
+        // Compute the unoriented normals of the points (in parallel). The tree must
+        // have been built over the same array of points.
+        static void computeNormals(const std::vector<Vector3>& points, const KdTree& kdTree,
+                                   uint nbNeighbors, std::vector<Vector3>& normals);
+
+        // Orient the normals toward a viewpoint (in parallel)
+        static void orientNormalsTowardViewpoint(const std::vector<Vector3>& points,
+                                                 const Vector3& viewpoint,
+                                                 std::vector<Vector3>& normals);
+
+        // Orient the normals consistently by propagation along the neighbourhood graph.
+        // The k nearest neighbours of all the points are found in parallel and stored
+        // (N * k indices). The minimum spanning tree is then built serially with Prim's
+        // algorithm and a heap with decrease-key that never holds more than N points.
+        static void orientNormalsByPropagation(const std::vector<Vector3>& points,
+                                               const KdTree& kdTree, uint nbNeighbors,
+                                               std::vector<Vector3>& normals);
+
+        // Estimate the normals of the vertices of a mesh with consistent orientation
+        static void estimateNormals(Mesh& mesh, uint nbNeighbors = 16);
+
+        // Estimate the normals of the vertices of a mesh oriented toward a viewpoint
+        static void estimateNormals(Mesh& mesh, const Vector3& viewpoint, uint nbNeighbors = 16);
+};
+
+}
+
+#endif
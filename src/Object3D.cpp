@@ -25,12 +25,14 @@
 
 // Libraries
 #include "Object3D.h"
+#include <algorithm>
+#include <limits>
 
 // Namespaces
 using namespace openglframework;
 
 // Constructor
-Object3D::Object3D() {
+Object3D::Object3D() : mIsTRSEnabled(false) {
     // Set the transformation matrix to the identity
     setToIdentity();
 }
@@ -39,3 +41,167 @@ Object3D::Object3D() {
 Object3D::~Object3D() {
 
 }
+
+// Represent the transform by its TRS components. The current transform matrix is
+// decomposed and any shear is lost (the rotation is the Gram-Schmidt orthonormalization
+// of the columns in the order x, y, z). An axis with a zero scale (flattened transform)
+// gets a direction orthogonal to the other axes.
+void Object3D::enableTRS() {
+
+    if (mIsTRSEnabled) return;
+
+    // The translation is the last column of the matrix and the scale
+    // factors are the lengths of the three other columns
+    const Matrix4& m = mTransformMatrix;
+    Vector3 axes[3] = {Vector3(m.m[0][0], m.m[1][0], m.m[2][0]),
+                       Vector3(m.m[0][1], m.m[1][1], m.m[2][1]),
+                       Vector3(m.m[0][2], m.m[1][2], m.m[2][2])};
+    mPosition = Vector3(m.m[0][3], m.m[1][3], m.m[2][3]);
+    mScale = Vector3(axes[0].length(), axes[1].length(), axes[2].length());
+
+    // A reflection is represented by a negative scale on the x axis
+    if (axes[0].cross(axes[1]).dot(axes[2]) < 0.f) {
+        mScale.x = -mScale.x;
+    }
+
+    // Orthonormalize the axes that are not degenerate (relative to the largest one)
+    const float minLength = std::numeric_limits<float>::epsilon() *
+                            std::max(std::max(fabs(mScale.x), fabs(mScale.y)), fabs(mScale.z));
+    Vector3 basis[3];
+    bool isDefined[3];
+    uint nbDefinedAxes = 0;
+    for (int i=0; i<3; i++) {
+        isDefined[i] = false;
+        if (!(fabs(mScale[i]) > minLength)) continue;
+        Vector3 axis = axes[i] * (1.f / mScale[i]);
+        for (int j=0; j<i; j++) {
+            if (isDefined[j]) axis -= basis[j] * basis[j].dot(axis);
+        }
+        float length = axis.length();
+        if (length > 1e-3f) {
+            basis[i] = axis / length;
+            isDefined[i] = true;
+            nbDefinedAxes++;
+        }
+    }
+
+    // Complete the basis of the rotation (right-handed)
+    if (nbDefinedAxes == 0) {
+        basis[0] = Vector3(1, 0, 0);
+        basis[1] = Vector3(0, 1, 0);
+        basis[2] = Vector3(0, 0, 1);
+    }
+    else if (nbDefinedAxes == 1) {
+        int i = isDefined[0] ? 0 : (isDefined[1] ? 1 : 2);
+        const Vector3& u = basis[i];
+        Vector3 other = (fabs(u.x) < 0.9f) ? Vector3(1, 0, 0) : Vector3(0, 1, 0);
+        basis[(i + 1) % 3] = u.cross(other).normalize();
+        basis[(i + 2) % 3] = u.cross(basis[(i + 1) % 3]);
+    }
+    else if (nbDefinedAxes == 2) {
+        int k = !isDefined[0] ? 0 : (!isDefined[1] ? 1 : 2);
+        basis[k] = basis[(k + 1) % 3].cross(basis[(k + 2) % 3]);
+    }
+
+    mOrientation = Quaternion(Matrix4(basis[0], basis[1], basis[2]));
+    mOrientation.normalize();
+
+    mIsTRSEnabled = true;
+    setTRSChanged();
+}
+
+// Compose the transform matrix from the TRS components
+void Object3D::updateTransformMatrix() const {
+
+    assert(mIsTRSEnabled);
+
+    // Rotation matrix of the quaternion with its columns multiplied by the scale
+    const Quaternion& q = mOrientation;
+    float xx = q.x*q.x, yy = q.y*q.y, zz = q.z*q.z;
+    float xy = q.x*q.y, xz = q.x*q.z, yz = q.y*q.z;
+    float wx = q.w*q.x, wy = q.w*q.y, wz = q.w*q.z;
+    mTransformMatrix = Matrix4((1.f - 2.f*(yy + zz)) * mScale.x, 2.f*(xy - wz) * mScale.y,
+                               2.f*(xz + wy) * mScale.z, mPosition.x,
+                               2.f*(xy + wz) * mScale.x, (1.f - 2.f*(xx + zz)) * mScale.y,
+                               2.f*(yz - wx) * mScale.z, mPosition.y,
+                               2.f*(xz - wy) * mScale.x, 2.f*(yz + wx) * mScale.y,
+                               (1.f - 2.f*(xx + yy)) * mScale.z, mPosition.z,
+                               0.f, 0.f, 0.f, 1.f);
+    mIsTransformMatrixDirty = false;
+}
+
+// Rotate the object in world-space
+void Object3D::rotateWorld(const Vector3& axis, float angle) {
+    if (mIsTRSEnabled) {
+        Quaternion rotation = Quaternion::rotationQuaternion(axis, angle);
+        mPosition = rotation * mPosition;
+        mOrientation = rotation * mOrientation;
+        mOrientation.normalize();
+        setTRSChanged();
+        return;
+    }
+    mTransformMatrix = Matrix4::rotationMatrix(axis, angle) * mTransformMatrix;
+    mIsInverseTransformMatrixDirty = true;
+}
+
+// Rotate the object in local-space
+void Object3D::rotateLocal(const Vector3& axis, float angle) {
+
+    // A local rotation commutes with the scale only if the scale is uniform,
+    // otherwise the result contains a shear and needs the matrix representation
+    if (mIsTRSEnabled && !hasUniformScale()) {
+        disableTRS();
+    }
+
+    if (mIsTRSEnabled) {
+        mOrientation = mOrientation * Quaternion::rotationQuaternion(axis, angle);
+        mOrientation.normalize();
+        setTRSChanged();
+        return;
+    }
+    mTransformMatrix = mTransformMatrix * Matrix4::rotationMatrix(axis, angle);
+    mIsInverseTransformMatrixDirty = true;
+}
+
+// Rotate the object around a world-space point
+void Object3D::rotateAroundWorldPoint(const Vector3& axis, float angle,
+                                      const Vector3& worldPoint) {
+    if (mIsTRSEnabled) {
+        Quaternion rotation = Quaternion::rotationQuaternion(axis, angle);
+        mPosition = worldPoint + rotation * (mPosition - worldPoint);
+        mOrientation = rotation * mOrientation;
+        mOrientation.normalize();
+        setTRSChanged();
+        return;
+    }
+    mTransformMatrix = Matrix4::translationMatrix(worldPoint) * Matrix4::rotationMatrix(axis, angle)
+                       * Matrix4::translationMatrix(-worldPoint) * mTransformMatrix;
+    mIsInverseTransformMatrixDirty = true;
+}
+
+// Rotate the object around a local-space point
+void Object3D::rotateAroundLocalPoint(const Vector3& axis, float angle,
+                                      const Vector3& worldPoint) {
+
+    // A local rotation commutes with the scale only if the scale is uniform,
+    // otherwise the result contains a shear and needs the matrix representation
+    if (mIsTRSEnabled && !hasUniformScale()) {
+        disableTRS();
+    }
+
+    // Convert the world point into the local coordinate system
+    Vector3 localPoint = getInverseTransformMatrix() * worldPoint;
+
+    if (mIsTRSEnabled) {
+        Quaternion rotation = Quaternion::rotationQuaternion(axis, angle);
+        mPosition += mOrientation * ((localPoint - rotation * localPoint) * mScale.x);
+        mOrientation = mOrientation * rotation;
+        mOrientation.normalize();
+        setTRSChanged();
+        return;
+    }
+    mTransformMatrix = mTransformMatrix * Matrix4::translationMatrix(localPoint)
+                       * Matrix4::rotationMatrix(axis, angle)
+                       * Matrix4::translationMatrix(-localPoint);
+    mIsInverseTransformMatrixDirty = true;
+}
@@ -29,11 +29,19 @@
 // Libraries
 #include "maths/Vector3.h"
 #include "maths/Matrix4.h"
+#include "maths/Quaternion.h"
 
 namespace openglframework {
 
 // Class Object3D
-// This class represent a generic 3D object on the scene.
+// This class represent a generic 3D object on the scene. The inverse of the transform
+// matrix is cached and only recomputed when the transform has changed. As long as the
+// transform is only modified with translations and rotations (around unit axes), it
+// is a rigid transform and its inverse is computed with a transpose.
+// The transform can optionally be represented by a translation, a rotation quaternion
+// and a scale (TRS). In this mode, the rotations update the quaternion instead of
+// multiplying matrices (so the rotation stays orthonormal) and the transform matrix
+// is only composed when it is needed.
 class Object3D {
 
     protected:
@@ -42,7 +50,43 @@ class Object3D {
 
         // Transformation matrix that convert local-space
         // coordinates to world-space coordinates
-        Matrix4 mTransformMatrix;
+        mutable Matrix4 mTransformMatrix;
+
+        // True if the transform matrix has to be composed from the TRS components
+        mutable bool mIsTransformMatrixDirty;
+
+        // True if the transform is represented by the TRS components
+        bool mIsTRSEnabled;
+
+        // Translation of the TRS transform
+        Vector3 mPosition;
+
+        // Rotation of the TRS transform
+        Quaternion mOrientation;
+
+        // Scale of the TRS transform
+        Vector3 mScale;
+
+        // Cached inverse of the transformation matrix (world-space to local-space)
+        mutable Matrix4 mInverseTransformMatrix;
+
+        // True if the cached inverse transformation matrix has to be recomputed
+        mutable bool mIsInverseTransformMatrixDirty;
+
+        // True if the TRS transform is a rigid transform (only used in the TRS mode, the
+        // products of the matrix mode drift away from an orthonormal rotation)
+        bool mIsTransformRigid;
+
+        // -------------------- Methods -------------------- //
+
+        // Called when the TRS components have been modified
+        void setTRSChanged();
+
+        // Compose the transform matrix from the TRS components
+        void updateTransformMatrix() const;
+
+        // Return true if the three components of the TRS scale are equal
+        bool hasUniformScale() const;
 
     public:
 
@@ -57,9 +101,47 @@ class Object3D {
         // Return the transform matrix
         const Matrix4& getTransformMatrix() const;
 
+        // Set the transform matrix (it must be an affine transform)
+        void setTransformMatrix(const Matrix4& matrix);
+
+        // Return the inverse of the transform matrix (world-space to local-space)
+        const Matrix4& getInverseTransformMatrix() const;
+
         // Set to the identity transform
         void setToIdentity();
 
+        // Return true if the transform is represented by its TRS components
+        bool isTRSEnabled() const;
+
+        // Represent the transform by its TRS components. The current transform matrix
+        // is decomposed and any shear is lost. An axis with a zero scale gets a
+        // direction orthogonal to the other axes.
+        void enableTRS();
+
+        // Represent the transform by its matrix only
+        void disableTRS();
+
+        // Set the TRS components of the transform
+        void setTRS(const Vector3& position, const Quaternion& orientation, const Vector3& scale);
+
+        // Return the translation of the TRS transform
+        const Vector3& getPosition() const;
+
+        // Set the translation of the TRS transform
+        void setPosition(const Vector3& position);
+
+        // Return the rotation of the TRS transform
+        const Quaternion& getOrientation() const;
+
+        // Set the rotation of the TRS transform
+        void setOrientation(const Quaternion& orientation);
+
+        // Return the scale of the TRS transform
+        const Vector3& getScale() const;
+
+        // Set the scale of the TRS transform
+        void setScale(const Vector3& scale);
+
         // Return the origin of object in world-space
         Vector3 getOrigin() const;
 
@@ -82,58 +164,145 @@ class Object3D {
         void rotateAroundLocalPoint(const Vector3& axis, float angle, const Vector3& worldPoint);
 };
 
+// Called when the TRS components have been modified
+inline void Object3D::setTRSChanged() {
+    mIsTransformMatrixDirty = true;
+    mIsInverseTransformMatrixDirty = true;
+    mIsTransformRigid = (mScale == Vector3(1, 1, 1));
+}
+
+// Return true if the three components of the TRS scale are equal
+inline bool Object3D::hasUniformScale() const {
+    return mScale.x == mScale.y && mScale.x == mScale.z;
+}
+
 // Return the transform matrix
 inline const Matrix4& Object3D::getTransformMatrix() const {
+    if (mIsTransformMatrixDirty) {
+        updateTransformMatrix();
+    }
     return mTransformMatrix;
 }
 
-// Set to the identity transform
+// Set the transform matrix (it must be an affine transform)
+inline void Object3D::setTransformMatrix(const Matrix4& matrix) {
+    mTransformMatrix = matrix;
+    mIsTransformMatrixDirty = false;
+    mIsTRSEnabled = false;
+    mIsTransformRigid = false;
+    mIsInverseTransformMatrixDirty = true;
+}
+
+// Return the inverse of the transform matrix (world-space to local-space)
+inline const Matrix4& Object3D::getInverseTransformMatrix() const {
+    if (mIsInverseTransformMatrixDirty) {
+        const Matrix4& matrix = getTransformMatrix();
+        mInverseTransformMatrix = (mIsTRSEnabled && mIsTransformRigid) ?
+                                  matrix.getRigidInverse() : matrix.getAffineInverse();
+        mIsInverseTransformMatrixDirty = false;
+    }
+    return mInverseTransformMatrix;
+}
+
+// Set to the identity transform (the TRS mode is kept)
 inline void Object3D::setToIdentity() {
     mTransformMatrix.setToIdentity();
+    mIsTransformMatrixDirty = false;
+    mPosition = Vector3(0, 0, 0);
+    mOrientation = Quaternion::identity();
+    mScale = Vector3(1, 1, 1);
+    mIsTransformRigid = true;
+    mIsInverseTransformMatrixDirty = true;
 }
 
- // Return the origin of object in world-space
-inline Vector3 Object3D::getOrigin() const {
-    return mTransformMatrix * Vector3(0.0, 0.0, 0.0);
+// Return true if the transform is represented by its TRS components
+inline bool Object3D::isTRSEnabled() const {
+    return mIsTRSEnabled;
 }
 
-// Translate the object in world-space
-inline void Object3D::translateWorld(const Vector3& v) {
-    mTransformMatrix = Matrix4::translationMatrix(v) * mTransformMatrix;
+// Represent the transform by its matrix only
+inline void Object3D::disableTRS() {
+    getTransformMatrix();
+    mIsTRSEnabled = false;
 }
 
-// Translate the object in local-space
-inline void Object3D::translateLocal(const Vector3& v) {
-    mTransformMatrix = mTransformMatrix * Matrix4::translationMatrix(v);
+// Set the TRS components of the transform
+inline void Object3D::setTRS(const Vector3& position, const Quaternion& orientation,
+                             const Vector3& scale) {
+    mIsTRSEnabled = true;
+    mPosition = position;
+    mOrientation = orientation.getUnit();
+    mScale = scale;
+    setTRSChanged();
 }
 
-// Rotate the object in world-space
-inline void Object3D::rotateWorld(const Vector3& axis, float angle) {
-    mTransformMatrix = Matrix4::rotationMatrix(axis, angle) * mTransformMatrix;
+// Return the translation of the TRS transform
+inline const Vector3& Object3D::getPosition() const {
+    assert(mIsTRSEnabled);
+    return mPosition;
 }
 
-// Rotate the object in local-space
-inline void Object3D::rotateLocal(const Vector3& axis, float angle) {
-    mTransformMatrix = mTransformMatrix * Matrix4::rotationMatrix(axis, angle);
+// Set the translation of the TRS transform
+inline void Object3D::setPosition(const Vector3& position) {
+    enableTRS();
+    mPosition = position;
+    setTRSChanged();
 }
 
-// Rotate the object around a world-space point
-inline void Object3D::rotateAroundWorldPoint(const Vector3& axis, float angle,
-                                             const Vector3& worldPoint) {
-    mTransformMatrix = Matrix4::translationMatrix(worldPoint) * Matrix4::rotationMatrix(axis, angle)
-                       * Matrix4::translationMatrix(-worldPoint) * mTransformMatrix;
+// Return the rotation of the TRS transform
+inline const Quaternion& Object3D::getOrientation() const {
+    assert(mIsTRSEnabled);
+    return mOrientation;
 }
 
-// Rotate the object around a local-space point
-inline void Object3D::rotateAroundLocalPoint(const Vector3& axis, float angle,
-                                             const Vector3& worldPoint) {
+// Set the rotation of the TRS transform
+inline void Object3D::setOrientation(const Quaternion& orientation) {
+    enableTRS();
+    mOrientation = orientation.getUnit();
+    setTRSChanged();
+}
 
-    // Convert the world point into the local coordinate system
-    Vector3 localPoint = mTransformMatrix.getInverse() * worldPoint;
+// Return the scale of the TRS transform
+inline const Vector3& Object3D::getScale() const {
+    assert(mIsTRSEnabled);
+    return mScale;
+}
 
-    mTransformMatrix = mTransformMatrix * Matrix4::translationMatrix(localPoint)
-                       * Matrix4::rotationMatrix(axis, angle)
-                       * Matrix4::translationMatrix(-localPoint);
+// Set the scale of the TRS transform
+inline void Object3D::setScale(const Vector3& scale) {
+    enableTRS();
+    mScale = scale;
+    setTRSChanged();
+}
+
+ // Return the origin of object in world-space
+inline Vector3 Object3D::getOrigin() const {
+    if (mIsTRSEnabled) {
+        return mPosition;
+    }
+    return mTransformMatrix * Vector3(0.0, 0.0, 0.0);
+}
+
+// Translate the object in world-space
+inline void Object3D::translateWorld(const Vector3& v) {
+    if (mIsTRSEnabled) {
+        mPosition += v;
+        setTRSChanged();
+        return;
+    }
+    mTransformMatrix = Matrix4::translationMatrix(v) * mTransformMatrix;
+    mIsInverseTransformMatrixDirty = true;
+}
+
+// Translate the object in local-space
+inline void Object3D::translateLocal(const Vector3& v) {
+    if (mIsTRSEnabled) {
+        mPosition += mOrientation * Vector3(mScale.x * v.x, mScale.y * v.y, mScale.z * v.z);
+        setTRSChanged();
+        return;
+    }
+    mTransformMatrix = mTransformMatrix * Matrix4::translationMatrix(v);
+    mIsInverseTransformMatrixDirty = true;
 }
 
 }
@@ -0,0 +1,422 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <cmath>
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define OCCLUSION_CULLER_USE_SSE
+#endif
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Constants
+const uint OcclusionCuller::TILE_SIZE;
+const uint OcclusionCuller::BLOCK_SIZE;
+
+// Minimum clip-space w coordinate of a rasterized vertex (near plane test)
+static const float MIN_CLIP_W = 1e-5f;
+
+// Transform a point into clip-space
+static inline void transformToClipSpace(const Matrix4& matrix, const Vector3& point,
+                                        float& x, float& y, float& z, float& w) {
+    const float (*m)[4] = matrix.m;
+    x = m[0][0] * point.x + m[0][1] * point.y + m[0][2] * point.z + m[0][3];
+    y = m[1][0] * point.x + m[1][1] * point.y + m[1][2] * point.z + m[1][3];
+    z = m[2][0] * point.x + m[2][1] * point.y + m[2][2] * point.z + m[2][3];
+    w = m[3][0] * point.x + m[3][1] * point.y + m[3][2] * point.z + m[3][3];
+}
+
+// Constructor
+OcclusionCuller::OcclusionCuller(uint width, uint height) {
+    mViewProjectionMatrix.setToIdentity();
+    setDimensions(width, height);
+}
+
+// Destructor
+OcclusionCuller::~OcclusionCuller() {
+
+}
+
+// Set the dimensions of the depth buffer (multiples of the block size)
+void OcclusionCuller::setDimensions(uint width, uint height) {
+    assert(width > 0 && height > 0 && width % BLOCK_SIZE == 0 && height % BLOCK_SIZE == 0);
+    mWidth = width;
+    mHeight = height;
+    mNbTilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    mNbTilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    mDepthBuffer.assign(width * height, 1.0f);
+
+    // Levels of the hierarchical depth buffer down to a single cell
+    mDepthLevels.clear();
+    mLevelWidths.clear();
+    mLevelHeights.clear();
+    uint levelWidth = width / BLOCK_SIZE, levelHeight = height / BLOCK_SIZE;
+    while (true) {
+        mDepthLevels.push_back(vector<float>(levelWidth * levelHeight, 1.0f));
+        mLevelWidths.push_back(levelWidth);
+        mLevelHeights.push_back(levelHeight);
+        if (levelWidth == 1 && levelHeight == 1) break;
+        levelWidth = (levelWidth + 1) / 2;
+        levelHeight = (levelHeight + 1) / 2;
+    }
+    mTileTriangles.assign(mNbTilesX * mNbTilesY, vector<uint>());
+}
+
+// Start a new frame with a world-space to clip-space matrix. The occluders of
+// the previous frame are removed.
+void OcclusionCuller::beginFrame(const Matrix4& viewProjectionMatrix) {
+    mViewProjectionMatrix = viewProjectionMatrix;
+    mTriangleVertices.clear();
+    for (uint t=0; t<mTileTriangles.size(); t++) {
+        mTileTriangles[t].clear();
+    }
+}
+
+// Add occluder triangles given in the local-space of a transform
+void OcclusionCuller::addOccluder(const vector<Vector3>& vertices, const vector<uint>& indices,
+                                  const Matrix4& modelToWorldMatrix) {
+
+    // Transform the vertices into screen-space
+    const Matrix4 modelToClip = mViewProjectionMatrix * modelToWorldMatrix;
+    const int nbVertices = int(vertices.size());
+    vector<Vector3> screenVertices(nbVertices);
+    vector<char> isBehindNearPlane(nbVertices);
+    #pragma omp parallel for if (nbVertices > 4096)
+    for (int i=0; i<nbVertices; i++) {
+        float x, y, z, w;
+        transformToClipSpace(modelToClip, vertices[i], x, y, z, w);
+        isBehindNearPlane[i] = (w < MIN_CLIP_W || z < -w);
+        float invW = 1.0f / w;
+        screenVertices[i] = Vector3((x * invW * 0.5f + 0.5f) * mWidth,
+                                    (y * invW * 0.5f + 0.5f) * mHeight,
+                                    z * invW * 0.5f + 0.5f);
+    }
+
+    // Bin the triangles into the tiles
+    for (uint f=0; f + 2 < indices.size(); f += 3) {
+
+        uint i1 = indices[f], i2 = indices[f + 1], i3 = indices[f + 2];
+        if (isBehindNearPlane[i1] || isBehindNearPlane[i2] || isBehindNearPlane[i3]) continue;
+        const Vector3& v1 = screenVertices[i1];
+        const Vector3& v2 = screenVertices[i2];
+        const Vector3& v3 = screenVertices[i3];
+
+        // Skip the triangles that are outside of the screen or degenerate
+        float minX = min(v1.x, min(v2.x, v3.x)), maxX = max(v1.x, max(v2.x, v3.x));
+        float minY = min(v1.y, min(v2.y, v3.y)), maxY = max(v1.y, max(v2.y, v3.y));
+        if (maxX < 0.0f || maxY < 0.0f || minX >= mWidth || minY >= mHeight) continue;
+        if (min(v1.z, min(v2.z, v3.z)) > 1.0f) continue;
+        float area = (v2.x - v1.x) * (v3.y - v1.y) - (v2.y - v1.y) * (v3.x - v1.x);
+        if (area == 0.0f) continue;
+
+        uint triangle = mTriangleVertices.size() / 3;
+        mTriangleVertices.push_back(v1);
+        mTriangleVertices.push_back(v2);
+        mTriangleVertices.push_back(v3);
+
+        uint firstTileX = uint(max(minX, 0.0f)) / TILE_SIZE;
+        uint firstTileY = uint(max(minY, 0.0f)) / TILE_SIZE;
+        uint lastTileX = min(uint(maxX), mWidth - 1) / TILE_SIZE;
+        uint lastTileY = min(uint(maxY), mHeight - 1) / TILE_SIZE;
+        for (uint tileY=firstTileY; tileY<=lastTileY; tileY++) {
+            for (uint tileX=firstTileX; tileX<=lastTileX; tileX++) {
+                mTileTriangles[tileY * mNbTilesX + tileX].push_back(triangle);
+            }
+        }
+    }
+}
+
+// Rasterize the occluders added since the beginning of the frame
+void OcclusionCuller::rasterizeOccluders() {
+
+    const int nbTiles = int(mTileTriangles.size());
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int tile=0; tile<nbTiles; tile++) {
+        rasterizeTile(tile);
+    }
+
+    updateDepthLevels();
+}
+
+// Rasterize the triangles that overlap a tile
+void OcclusionCuller::rasterizeTile(uint tile) {
+
+    const uint tileMinX = (tile % mNbTilesX) * TILE_SIZE;
+    const uint tileMinY = (tile / mNbTilesX) * TILE_SIZE;
+    const uint tileMaxX = min(tileMinX + TILE_SIZE, mWidth) - 1;
+    const uint tileMaxY = min(tileMinY + TILE_SIZE, mHeight) - 1;
+
+    // Clear the tile
+    for (uint y=tileMinY; y<=tileMaxY; y++) {
+        fill(mDepthBuffer.begin() + y * mWidth + tileMinX,
+             mDepthBuffer.begin() + y * mWidth + tileMaxX + 1, 1.0f);
+    }
+
+    const vector<uint>& triangles = mTileTriangles[tile];
+    for (uint t=0; t<triangles.size(); t++) {
+
+        Vector3 v0 = mTriangleVertices[3 * triangles[t]];
+        Vector3 v1 = mTriangleVertices[3 * triangles[t] + 1];
+        Vector3 v2 = mTriangleVertices[3 * triangles[t] + 2];
+
+        // Make the triangle counter-clockwise
+        float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+        if (area < 0.0f) {
+            swap(v1, v2);
+            area = -area;
+        }
+
+        // Bounding rectangle of the triangle in the tile (the first column is aligned
+        // on four pixels, the tiles and the width are multiples of four pixels)
+        int minX = max(int(floor(min(v0.x, min(v1.x, v2.x)))), int(tileMinX)) & ~3;
+        int maxX = min(int(floor(max(v0.x, max(v1.x, v2.x)))), int(tileMaxX));
+        int minY = max(int(floor(min(v0.y, min(v1.y, v2.y)))), int(tileMinY));
+        int maxY = min(int(floor(max(v0.y, max(v1.y, v2.y)))), int(tileMaxY));
+        if (minX > maxX || minY > maxY) continue;
+
+        // Edge functions E(x, y) = a * x + b * y + c (positive inside) and depth
+        // plane z(x, y) = z0 + (E20 * (z1 - z0) + E01 * (z2 - z0)) / area
+        const float a12 = v1.y - v2.y, b12 = v2.x - v1.x, c12 = v1.x * v2.y - v1.y * v2.x;
+        const float a20 = v2.y - v0.y, b20 = v0.x - v2.x, c20 = v2.x * v0.y - v2.y * v0.x;
+        const float a01 = v0.y - v1.y, b01 = v1.x - v0.x, c01 = v0.x * v1.y - v0.y * v1.x;
+        const float invArea = 1.0f / area;
+        const float dz1 = (v1.z - v0.z) * invArea;
+        const float dz2 = (v2.z - v0.z) * invArea;
+
+#ifdef OCCLUSION_CULLER_USE_SSE
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+        const __m128 a12s = _mm_set1_ps(a12), a20s = _mm_set1_ps(a20), a01s = _mm_set1_ps(a01);
+        const __m128 z0s = _mm_set1_ps(v0.z), dz1s = _mm_set1_ps(dz1), dz2s = _mm_set1_ps(dz2);
+#endif
+
+        for (int y=minY; y<=maxY; y++) {
+
+            const float py = y + 0.5f;
+            float* row = &mDepthBuffer[y * mWidth];
+
+#ifdef OCCLUSION_CULLER_USE_SSE
+            const __m128 e12Row = _mm_set1_ps(b12 * py + c12);
+            const __m128 e20Row = _mm_set1_ps(b20 * py + c20);
+            const __m128 e01Row = _mm_set1_ps(b01 * py + c01);
+            for (int x=minX; x<=maxX; x+=4) {
+                __m128 px = _mm_add_ps(_mm_set1_ps(float(x)), offsets);
+                __m128 e12 = _mm_add_ps(_mm_mul_ps(a12s, px), e12Row);
+                __m128 e20 = _mm_add_ps(_mm_mul_ps(a20s, px), e20Row);
+                __m128 e01 = _mm_add_ps(_mm_mul_ps(a01s, px), e01Row);
+                __m128 isInside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e12, zero),
+                                                        _mm_cmpge_ps(e20, zero)),
+                                             _mm_cmpge_ps(e01, zero));
+                if (_mm_movemask_ps(isInside) == 0) continue;
+                __m128 depth = _mm_add_ps(z0s, _mm_add_ps(_mm_mul_ps(e20, dz1s),
+                                                          _mm_mul_ps(e01, dz2s)));
+                __m128 oldDepth = _mm_loadu_ps(row + x);
+                __m128 newDepth = _mm_min_ps(oldDepth, depth);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(isInside, newDepth),
+                                                 _mm_andnot_ps(isInside, oldDepth)));
+            }
+#else
+            for (int x=minX; x<=maxX; x++) {
+                const float px = x + 0.5f;
+                float e12 = a12 * px + b12 * py + c12;
+                float e20 = a20 * px + b20 * py + c20;
+                float e01 = a01 * px + b01 * py + c01;
+                if (e12 < 0.0f || e20 < 0.0f || e01 < 0.0f) continue;
+                row[x] = min(row[x], v0.z + e20 * dz1 + e01 * dz2);
+            }
+#endif
+        }
+    }
+}
+
+// Compute the levels of the hierarchical depth buffer
+void OcclusionCuller::updateDepthLevels() {
+
+    // Farthest depth of each block of pixels
+    const int nbBlocksX = int(mLevelWidths[0]);
+    const int nbBlocksY = int(mLevelHeights[0]);
+    vector<float>& blockDepths = mDepthLevels[0];
+    #pragma omp parallel for
+    for (int blockY=0; blockY<nbBlocksY; blockY++) {
+        for (int blockX=0; blockX<nbBlocksX; blockX++) {
+            float maxDepth = 0.0f;
+            for (uint y=0; y<BLOCK_SIZE; y++) {
+                const float* row = &mDepthBuffer[(blockY * BLOCK_SIZE + y) * mWidth +
+                                                 blockX * BLOCK_SIZE];
+                for (uint x=0; x<BLOCK_SIZE; x++) {
+                    maxDepth = max(maxDepth, row[x]);
+                }
+            }
+            blockDepths[blockY * nbBlocksX + blockX] = maxDepth;
+        }
+    }
+
+    // Farthest depth of the 2x2 cells of the previous level (the last row and column
+    // of cells of a level with an odd size have a single child)
+    for (uint level=1; level<mDepthLevels.size(); level++) {
+        const vector<float>& children = mDepthLevels[level - 1];
+        const uint childrenWidth = mLevelWidths[level - 1];
+        const uint childrenHeight = mLevelHeights[level - 1];
+        vector<float>& cells = mDepthLevels[level];
+        for (uint cellY=0; cellY<mLevelHeights[level]; cellY++) {
+            const uint childY = 2 * cellY;
+            const uint nextChildY = min(childY + 1, childrenHeight - 1);
+            for (uint cellX=0; cellX<mLevelWidths[level]; cellX++) {
+                const uint childX = 2 * cellX;
+                const uint nextChildX = min(childX + 1, childrenWidth - 1);
+                cells[cellY * mLevelWidths[level] + cellX] =
+                        max(max(children[childY * childrenWidth + childX],
+                                children[childY * childrenWidth + nextChildX]),
+                            max(children[nextChildY * childrenWidth + childX],
+                                children[nextChildY * childrenWidth + nextChildX]));
+            }
+        }
+    }
+}
+
+// Return true if a pixel of a rectangle (clamped to a cell of a level of the
+// hierarchical depth buffer) is not hidden at a given depth
+bool OcclusionCuller::isRectangleVisible(uint level, int cellX, int cellY, int firstX,
+                                         int lastX, int firstY, int lastY,
+                                         float minDepth) const {
+
+    // The cell hides the rectangle if all its pixels are nearer than the box
+    if (mDepthLevels[level][cellY * mLevelWidths[level] + cellX] < minDepth) return false;
+
+    // Part of the rectangle inside the cell
+    const int cellSize = int(BLOCK_SIZE) << level;
+    const int startX = max(firstX, cellX * cellSize);
+    const int endX = min(lastX, (cellX + 1) * cellSize - 1);
+    const int startY = max(firstY, cellY * cellSize);
+    const int endY = min(lastY, (cellY + 1) * cellSize - 1);
+
+    // Test the pixels of a block
+    if (level == 0) {
+        for (int y=startY; y<=endY; y++) {
+            const float* row = &mDepthBuffer[y * mWidth];
+            for (int x=startX; x<=endX; x++) {
+                if (row[x] >= minDepth) return true;
+            }
+        }
+        return false;
+    }
+
+    // Test the children cells that overlap the rectangle
+    const int childSize = cellSize / 2;
+    for (int childY=startY/childSize; childY<=endY/childSize; childY++) {
+        for (int childX=startX/childSize; childX<=endX/childSize; childX++) {
+            if (isRectangleVisible(level - 1, childX, childY, startX, endX, startY, endY,
+                                   minDepth)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Return true if a world-space box is not hidden by the occluders
+bool OcclusionCuller::isVisible(const AABB& aabb) const {
+
+    // Project the corners of the box
+    float minX = numeric_limits<float>::max(), maxX = -numeric_limits<float>::max();
+    float minY = numeric_limits<float>::max(), maxY = -numeric_limits<float>::max();
+    float minDepth = numeric_limits<float>::max();
+    for (int i=0; i<8; i++) {
+        Vector3 corner((i & 1) ? aabb.max.x : aabb.min.x, (i & 2) ? aabb.max.y : aabb.min.y,
+                       (i & 4) ? aabb.max.z : aabb.min.z);
+        float x, y, z, w;
+        transformToClipSpace(mViewProjectionMatrix, corner, x, y, z, w);
+
+        // A box that crosses the near plane is considered visible
+        if (w < MIN_CLIP_W || z < -w) return true;
+
+        float invW = 1.0f / w;
+        float screenX = (x * invW * 0.5f + 0.5f) * mWidth;
+        float screenY = (y * invW * 0.5f + 0.5f) * mHeight;
+        minX = min(minX, screenX); maxX = max(maxX, screenX);
+        minY = min(minY, screenY); maxY = max(maxY, screenY);
+        minDepth = min(minDepth, z * invW * 0.5f + 0.5f);
+    }
+
+    // The boxes outside of the screen or beyond the far plane are not visible
+    if (maxX < 0.0f || maxY < 0.0f || minX >= mWidth || minY >= mHeight || minDepth > 1.0f) {
+        return false;
+    }
+
+    // Pixels covered by the box
+    const int firstX = max(int(floor(minX)), 0);
+    const int lastX = min(int(floor(maxX)), int(mWidth) - 1);
+    const int firstY = max(int(floor(minY)), 0);
+    const int lastY = min(int(floor(maxY)), int(mHeight) - 1);
+
+    // Finest level where the rectangle overlaps at most 2x2 cells
+    uint level = 0;
+    while (level + 1 < mDepthLevels.size()) {
+        const int cellSize = int(BLOCK_SIZE) << level;
+        if (lastX / cellSize - firstX / cellSize <= 1 &&
+            lastY / cellSize - firstY / cellSize <= 1) {
+            break;
+        }
+        level++;
+    }
+
+    // Test the cells of this level and descend into the cells that may not hide the box
+    const int cellSize = int(BLOCK_SIZE) << level;
+    for (int cellY=firstY/cellSize; cellY<=lastY/cellSize; cellY++) {
+        for (int cellX=firstX/cellSize; cellX<=lastX/cellSize; cellX++) {
+            if (isRectangleVisible(level, cellX, cellY, firstX, lastX, firstY, lastY,
+                                   minDepth)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Find the boxes that are not hidden by the occluders
+void OcclusionCuller::cullAABBs(const AABBBatch& aabbs, vector<uint>& visibleIndices) const {
+
+    const int nbAABBs = int(aabbs.size());
+    vector<char> isVisibleAABB(nbAABBs);
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int i=0; i<nbAABBs; i++) {
+        AABB aabb(Vector3(aabbs.minX[i], aabbs.minY[i], aabbs.minZ[i]),
+                  Vector3(aabbs.maxX[i], aabbs.maxY[i], aabbs.maxZ[i]));
+        isVisibleAABB[i] = isVisible(aabb);
+    }
+
+    visibleIndices.clear();
+    for (int i=0; i<nbAABBs; i++) {
+        if (isVisibleAABB[i]) visibleIndices.push_back(i);
+    }
+}
@@ -0,0 +1,199 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef OCCLUSION_CULLER_H
+#define OCCLUSION_CULLER_H
+
+// Libraries
+#include <vector>
+#include <cassert>
+#include "definitions.h"
+#include "Mesh.h"
+#include "Camera.h"
+#include "FrustumCulling.h"
+#include "maths/Matrix4.h"
+#include "maths/AABB.h"
+
+namespace openglframework {
+
+// Class OcclusionCuller
+// This class performs software occlusion culling on the CPU. A set of simplified
+// occluder meshes is rasterized into a low-resolution depth buffer. The screen is
+// split into tiles that are rasterized in parallel (OpenMP) with SSE, four pixels at a
+// time. A hierarchical depth buffer then stores the farthest depth of each block of
+// 8x8 pixels (level 0) and each coarser level the farthest depth of 2x2 cells of the
+// previous level, up to a single cell. The screen-space rectangle and nearest depth
+// of the box of an object are compared with the cells of the finest level where
+// the rectangle overlaps at most 2x2 cells, and the test only descends into the cells
+// that do not hide the object, down to the pixels. The depth values are the window
+// depths in [0, 1]. The triangles that cross the near plane are not rasterized, which
+// is conservative.
+class OcclusionCuller {
+
+    public:
+
+        // -------------------- Constants -------------------- //
+
+        // Size of the tiles rasterized in parallel (in pixels)
+        static const uint TILE_SIZE = 32;
+
+        // Size of the blocks of the finest level of the hierarchical depth buffer (in pixels)
+        static const uint BLOCK_SIZE = 8;
+
+    private:
+
+        // -------------------- Attributes -------------------- //
+
+        // Dimensions of the depth buffer (multiples of the block size)
+        uint mWidth, mHeight;
+
+        // World-space to clip-space matrix of the current frame
+        Matrix4 mViewProjectionMatrix;
+
+        // Depth buffer (the rows from the bottom to the top)
+        std::vector<float> mDepthBuffer;
+
+        // Levels of the hierarchical depth buffer (farthest depth of each cell). A cell
+        // of the level l covers (BLOCK_SIZE << l) x (BLOCK_SIZE << l) pixels.
+        std::vector<std::vector<float> > mDepthLevels;
+
+        // Number of cells of each level of the hierarchical depth buffer
+        std::vector<uint> mLevelWidths, mLevelHeights;
+
+        // Screen-space vertices (x and y in pixels and z the window depth) of the
+        // triangles of the occluders (three for each triangle)
+        std::vector<Vector3> mTriangleVertices;
+
+        // Triangles that overlap each tile
+        std::vector<std::vector<uint> > mTileTriangles;
+
+        // Number of tiles
+        uint mNbTilesX, mNbTilesY;
+
+        // -------------------- Methods -------------------- //
+
+        // Rasterize the triangles that overlap a tile
+        void rasterizeTile(uint tile);
+
+        // Compute the levels of the hierarchical depth buffer
+        void updateDepthLevels();
+
+        // Return true if a pixel of a rectangle (clamped to a cell of a level of the
+        // hierarchical depth buffer) is not hidden at a given depth
+        bool isRectangleVisible(uint level, int cellX, int cellY, int firstX, int lastX,
+                                int firstY, int lastY, float minDepth) const;
+
+    public:
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor
+        OcclusionCuller(uint width = 256, uint height = 128);
+
+        // Destructor
+        ~OcclusionCuller();
+
+        // Set the dimensions of the depth buffer (multiples of the block size)
+        void setDimensions(uint width, uint height);
+
+        // Start a new frame with a world-space to clip-space matrix. The occluders of
+        // the previous frame are removed.
+        void beginFrame(const Matrix4& viewProjectionMatrix);
+
+        // Start a new frame seen by a camera
+        void beginFrame(const Camera& camera);
+
+        // Add the triangles of an occluder mesh (in its world transform)
+        void addOccluder(const Mesh& mesh);
+
+        // Add occluder triangles given in the local-space of a transform
+        void addOccluder(const std::vector<Vector3>& vertices, const std::vector<uint>& indices,
+                         const Matrix4& modelToWorldMatrix);
+
+        // Rasterize the occluders added since the beginning of the frame
+        void rasterizeOccluders();
+
+        // Return true if a world-space box is not hidden by the occluders
+        bool isVisible(const AABB& aabb) const;
+
+        // Find the boxes that are not hidden by the occluders
+        void cullAABBs(const AABBBatch& aabbs, std::vector<uint>& visibleIndices) const;
+
+        // Return the width of the depth buffer
+        uint getWidth() const;
+
+        // Return the height of the depth buffer
+        uint getHeight() const;
+
+        // Return the depth buffer
+        const std::vector<float>& getDepthBuffer() const;
+
+        // Return the number of levels of the hierarchical depth buffer
+        uint getNbDepthLevels() const;
+
+        // Return the number of occluder triangles of the current frame
+        uint getNbOccluderTriangles() const;
+};
+
+// Start a new frame seen by a camera
+inline void OcclusionCuller::beginFrame(const Camera& camera) {
+    beginFrame(camera.getViewProjectionMatrix());
+}
+
+// Add the triangles of an occluder mesh (in its world transform)
+inline void OcclusionCuller::addOccluder(const Mesh& mesh) {
+    for (uint p=0; p<mesh.getNbParts(); p++) {
+        addOccluder(mesh.getVertices(), mesh.getIndices(p), mesh.getTransformMatrix());
+    }
+}
+
+// Return the width of the depth buffer
+inline uint OcclusionCuller::getWidth() const {
+    return mWidth;
+}
+
+// Return the height of the depth buffer
+inline uint OcclusionCuller::getHeight() const {
+    return mHeight;
+}
+
+// Return the depth buffer
+inline const std::vector<float>& OcclusionCuller::getDepthBuffer() const {
+    return mDepthBuffer;
+}
+
+// Return the number of levels of the hierarchical depth buffer
+inline uint OcclusionCuller::getNbDepthLevels() const {
+    return mDepthLevels.size();
+}
+
+// Return the number of occluder triangles of the current frame
+inline uint OcclusionCuller::getNbOccluderTriangles() const {
+    return mTriangleVertices.size() / 3;
+}
+
+}
+
+#endif
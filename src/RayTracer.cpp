@@ -0,0 +1,241 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include "RayTracer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <chrono>
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Constants
+const uint RayTracer::TILE_SIZE = 16;
+
+// Constructor
+RayTracer::RayTracer()
+          : mLightPosition(0, 0, 0), mLightDiffuseColor(Color::white()),
+            mLightSpecularColor(Color::white()), mAmbientColor(0.3f, 0.3f, 0.3f, 1.0f),
+            mShininess(60.0f), mBackgroundColor(Color::black()), mLastRenderingTime(0.0),
+            mLastNbRays(0) {
+
+}
+
+// Destructor
+RayTracer::~RayTracer() {
+
+    // Delete the BVHs of the meshes
+    for (uint i=0; i<mMeshBVHs.size(); i++) {
+        delete mMeshBVHs[i];
+    }
+}
+
+// Add a mesh to the scene (a BVH of the mesh is built)
+void RayTracer::addMesh(const Mesh* mesh) {
+    assert(find(mMeshes.begin(), mMeshes.end(), mesh) == mMeshes.end());
+    mMeshes.push_back(mesh);
+    mMeshBVHs.push_back(new MeshBVH(*mesh));
+}
+
+// Rebuild the BVH of a mesh after its vertices have changed
+void RayTracer::updateMesh(const Mesh* mesh) {
+    for (uint i=0; i<mMeshes.size(); i++) {
+        if (mMeshes[i] == mesh) {
+            mMeshBVHs[i]->build(*mesh);
+            return;
+        }
+    }
+}
+
+// Remove a mesh from the scene
+void RayTracer::removeMesh(const Mesh* mesh) {
+    for (uint i=0; i<mMeshes.size(); i++) {
+        if (mMeshes[i] == mesh) {
+            delete mMeshBVHs[i];
+            mMeshes.erase(mMeshes.begin() + i);
+            mMeshBVHs.erase(mMeshBVHs.begin() + i);
+            return;
+        }
+    }
+}
+
+// Render the scene seen by a camera. The pixel buffer is resized to the dimensions
+// of the camera (three bytes per pixel and the rows from the bottom to the top).
+void RayTracer::render(const Camera& camera, vector<unsigned char>& pixels) {
+
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+
+    const uint width = camera.getWidth();
+    const uint height = camera.getHeight();
+    pixels.resize(width * height * 3);
+
+    // The points of the far plane are a linear function of the normalized device
+    // coordinates. We compute the world-space point at the center of the screen and
+    // its variation along the x and y axis of the screen.
+    const Matrix4& cameraToWorld = camera.getTransformMatrix();
+    Matrix4 inverseProjection = camera.getProjectionMatrix().getInverse();
+    Vector4 farCenter = inverseProjection * Vector4(0.0f, 0.0f, 1.0f, 1.0f);
+    Vector4 farRight = inverseProjection * Vector4(1.0f, 0.0f, 1.0f, 1.0f);
+    Vector4 farTop = inverseProjection * Vector4(0.0f, 1.0f, 1.0f, 1.0f);
+    const Vector3 cameraPosition = camera.getOrigin();
+    const Vector3 center = cameraToWorld * Vector3(farCenter.x, farCenter.y, farCenter.z);
+    const Vector3 right = cameraToWorld * Vector3(farRight.x, farRight.y, farRight.z) - center;
+    const Vector3 up = cameraToWorld * Vector3(farTop.x, farTop.y, farTop.z) - center;
+
+    // Compute the world to local-space transform of each mesh
+    vector<Matrix4> worldToLocalMatrices(mMeshes.size());
+    for (uint m=0; m<mMeshes.size(); m++) {
+        worldToLocalMatrices[m] = mMeshes[m]->getInverseTransformMatrix();
+    }
+
+    const uint nbTilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    const uint nbTilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    const int nbTiles = int(nbTilesX * nbTilesY);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int tile=0; tile<nbTiles; tile++) {
+
+        const uint startX = (tile % nbTilesX) * TILE_SIZE;
+        const uint startY = (tile / nbTilesX) * TILE_SIZE;
+        const uint endX = min(startX + TILE_SIZE, width);
+        const uint endY = min(startY + TILE_SIZE, height);
+
+        // For each block of 2x2 pixels of the tile
+        for (uint y=startY; y<endY; y+=2) {
+            for (uint x=startX; x<endX; x+=2) {
+
+                // Create the packet of world-space rays
+                Ray rays[RayPacket::SIZE];
+                bool isActive[RayPacket::SIZE];
+                for (int i=0; i<RayPacket::SIZE; i++) {
+                    uint pixelX = x + (i & 1);
+                    uint pixelY = y + (i >> 1);
+                    isActive[i] = pixelX < endX && pixelY < endY;
+                    float ndcX = 2.0f * (pixelX + 0.5f) / float(width) - 1.0f;
+                    float ndcY = 2.0f * (pixelY + 0.5f) / float(height) - 1.0f;
+                    Vector3 farPoint = center + right * ndcX + up * ndcY;
+                    rays[i] = Ray(cameraPosition, (farPoint - cameraPosition).normalize());
+                }
+
+                // Find the closest hit of each ray among the meshes
+                RaycastHit closestHits[RayPacket::SIZE];
+                int closestMeshes[RayPacket::SIZE] = {-1, -1, -1, -1};
+                for (uint m=0; m<mMeshes.size(); m++) {
+
+                    // Transform the rays into the local-space of the mesh (the local
+                    // directions are not normalized so that distances stay in world-space)
+                    const Matrix4& worldToLocal = worldToLocalMatrices[m];
+                    RayPacket packet;
+                    for (int i=0; i<RayPacket::SIZE; i++) {
+                        if (!isActive[i]) {
+                            packet.disableRay(i);
+                            continue;
+                        }
+                        Vector3 localOrigin = worldToLocal * rays[i].origin;
+                        Vector3 localDirection = worldToLocal * (rays[i].origin + rays[i].direction)
+                                                 - localOrigin;
+                        float maxDistance = (closestMeshes[i] >= 0) ? closestHits[i].distance :
+                                                                      rays[i].maxDistance;
+                        packet.setRay(i, Ray(localOrigin, localDirection, maxDistance));
+                    }
+
+                    RaycastHit hits[RayPacket::SIZE];
+                    int hitMask = mMeshBVHs[m]->raycastPacket(packet, hits);
+                    for (int i=0; i<RayPacket::SIZE; i++) {
+                        if (hitMask & (1 << i)) {
+                            closestHits[i] = hits[i];
+                            closestMeshes[i] = int(m);
+                        }
+                    }
+                }
+
+                // Shade the pixels
+                for (int i=0; i<RayPacket::SIZE; i++) {
+                    if (!isActive[i]) continue;
+                    Color color = (closestMeshes[i] >= 0) ?
+                                  shade(closestMeshes[i], closestHits[i], rays[i]) :
+                                  mBackgroundColor;
+                    uint pixel = 3 * ((y + (i >> 1)) * width + x + (i & 1));
+                    pixels[pixel] = (unsigned char)(min(max(color.r, 0.0f), 1.0f) * 255.0f + 0.5f);
+                    pixels[pixel + 1] = (unsigned char)(min(max(color.g, 0.0f), 1.0f) * 255.0f + 0.5f);
+                    pixels[pixel + 2] = (unsigned char)(min(max(color.b, 0.0f), 1.0f) * 255.0f + 0.5f);
+                }
+            }
+        }
+    }
+
+    mLastRenderingTime = chrono::duration<double>(chrono::high_resolution_clock::now() -
+                                                  start).count();
+    mLastNbRays = width * height;
+}
+
+// Compute the Phong shading of a hit point of a mesh
+Color RayTracer::shade(uint meshIndex, const RaycastHit& hit, const Ray& ray) const {
+
+    const Mesh* mesh = mMeshes[meshIndex];
+    const Matrix4& modelToWorld = mesh->getTransformMatrix();
+    const vector<uint>& indices = mesh->getIndices(hit.part);
+    uint i1 = indices[3 * hit.face];
+    uint i2 = indices[3 * hit.face + 1];
+    uint i3 = indices[3 * hit.face + 2];
+
+    // Compute the local-space surface normal (interpolated if the mesh has normals)
+    Vector3 normal;
+    if (mesh->hasNormals()) {
+        normal = mesh->getNormal(i1) * (1.0f - hit.u - hit.v) + mesh->getNormal(i2) * hit.u +
+                 mesh->getNormal(i3) * hit.v;
+    }
+    else {
+        const Vector3& v1 = mesh->getVertex(i1);
+        normal = (mesh->getVertex(i2) - v1).cross(mesh->getVertex(i3) - v1);
+    }
+
+    // Transform the normal into world-space as in the vertex shader
+    Vector4 worldNormal4 = modelToWorld * Vector4(normal.x, normal.y, normal.z, 0.0f);
+    Vector3 N(worldNormal4.x, worldNormal4.y, worldNormal4.z);
+    N.normalize();
+
+    Vector3 worldPosition = ray.getPoint(hit.distance);
+
+    // Compute the diffuse term
+    Vector3 L = (mLightPosition - worldPosition).normalize();
+    float diffuseFactor = max(N.dot(L), 0.0f);
+
+    // Compute the specular term
+    Vector3 V = -ray.direction;
+    Vector3 H = (V + L).normalize();
+    float specularFactor = pow(max(N.dot(H), 0.0f), mShininess);
+
+    // Compute the final color
+    return Color(mAmbientColor.r + mLightDiffuseColor.r * diffuseFactor +
+                 mLightSpecularColor.r * specularFactor,
+                 mAmbientColor.g + mLightDiffuseColor.g * diffuseFactor +
+                 mLightSpecularColor.g * specularFactor,
+                 mAmbientColor.b + mLightDiffuseColor.b * diffuseFactor +
+                 mLightSpecularColor.b * specularFactor, 1.0f);
+}
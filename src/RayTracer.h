@@ -0,0 +1,183 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef RAY_TRACER_H
+#define RAY_TRACER_H
+
+// Libraries
+#include <vector>
+#include "definitions.h"
+#include "Mesh.h"
+#include "MeshBVH.h"
+#include "Camera.h"
+#include "Light.h"
+#include "maths/Color.h"
+#include "maths/Ray.h"
+
+namespace openglframework {
+
+// Class RayTracer
+// This class renders meshes on the CPU without any OpenGL context. It computes the
+// same Phong shading as the "phong.frag" shader (without texture) for the primary
+// rays of a camera. The image is split into tiles that are rendered in parallel
+// (OpenMP) and the rays of each tile are traced by packets of four rays against
+// the BVH of each mesh. The result is a RGB pixel buffer with the same layout as
+// an OpenGL texture that can be written with the TextureReaderWriter class.
+class RayTracer {
+
+    private:
+
+        // -------------------- Constants -------------------- //
+
+        // Size of the tiles (in pixels)
+        static const uint TILE_SIZE;
+
+        // -------------------- Attributes -------------------- //
+
+        // Meshes of the scene
+        std::vector<const Mesh*> mMeshes;
+
+        // BVH of each mesh (local-space of the mesh)
+        std::vector<MeshBVH*> mMeshBVHs;
+
+        // World position of the light
+        Vector3 mLightPosition;
+
+        // Diffuse color of the light
+        Color mLightDiffuseColor;
+
+        // Specular color of the light
+        Color mLightSpecularColor;
+
+        // Ambient color of the light
+        Color mAmbientColor;
+
+        // Shininess of the surfaces
+        float mShininess;
+
+        // Color of the pixels that do not see any mesh
+        Color mBackgroundColor;
+
+        // Duration of the last rendering (in seconds)
+        double mLastRenderingTime;
+
+        // Number of rays traced during the last rendering
+        uint mLastNbRays;
+
+        // -------------------- Methods -------------------- //
+
+        // Private copy-constructor and assignment operator (the BVHs are owned)
+        RayTracer(const RayTracer& rayTracer);
+        RayTracer& operator=(const RayTracer& rayTracer);
+
+        // Compute the Phong shading of a hit point of a mesh
+        Color shade(uint meshIndex, const RaycastHit& hit, const Ray& ray) const;
+
+    public:
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor
+        RayTracer();
+
+        // Destructor
+        ~RayTracer();
+
+        // Add a mesh to the scene (a BVH of the mesh is built)
+        void addMesh(const Mesh* mesh);
+
+        // Rebuild the BVH of a mesh after its vertices have changed
+        void updateMesh(const Mesh* mesh);
+
+        // Remove a mesh from the scene
+        void removeMesh(const Mesh* mesh);
+
+        // Set the position and colors of the light
+        void setLight(const Light& light);
+
+        // Set the ambient color
+        void setAmbientColor(const Color& color);
+
+        // Set the shininess of the surfaces
+        void setShininess(float shininess);
+
+        // Set the background color
+        void setBackgroundColor(const Color& color);
+
+        // Render the scene seen by a camera. The pixel buffer is resized to the dimensions
+        // of the camera (three bytes per pixel and the rows from the bottom to the top).
+        void render(const Camera& camera, std::vector<unsigned char>& pixels);
+
+        // Return the duration of the last rendering (in seconds)
+        double getLastRenderingTime() const;
+
+        // Return the number of rays traced during the last rendering
+        uint getLastNbRays() const;
+
+        // Return the number of millions of rays traced per second during the last rendering
+        double getLastMraysPerSecond() const;
+};
+
+// Set the position and colors of the light
+inline void RayTracer::setLight(const Light& light) {
+    mLightPosition = light.getOrigin();
+    mLightDiffuseColor = light.getDiffuseColor();
+    mLightSpecularColor = light.getSpecularColor();
+}
+
+// Set the ambient color
+inline void RayTracer::setAmbientColor(const Color& color) {
+    mAmbientColor = color;
+}
+
+// Set the shininess of the surfaces
+inline void RayTracer::setShininess(float shininess) {
+    mShininess = shininess;
+}
+
+// Set the background color
+inline void RayTracer::setBackgroundColor(const Color& color) {
+    mBackgroundColor = color;
+}
+
+// Return the duration of the last rendering (in seconds)
+inline double RayTracer::getLastRenderingTime() const {
+    return mLastRenderingTime;
+}
+
+// Return the number of rays traced during the last rendering
+inline uint RayTracer::getLastNbRays() const {
+    return mLastNbRays;
+}
+
+// Return the number of millions of rays traced per second during the last rendering
+inline double RayTracer::getLastMraysPerSecond() const {
+    if (mLastRenderingTime <= 0.0) return 0.0;
+    return mLastNbRays / mLastRenderingTime * 1e-6;
+}
+
+}
+
+#endif
@@ -29,6 +29,7 @@
 // Libraries
 #include "definitions.h"
 #include "maths/Matrix4.h"
+#include "maths/ColumnMajorMatrix4.h"
 #include "maths/Vector2.h"
 #include "maths/Vector3.h"
 #include "maths/Vector4.h"
@@ -122,6 +123,15 @@ class Shader {
         // to set it, an assert will occur)
         void setMatrix4x4Uniform(const std::string& variableName, const Matrix4& matrix) const;
 
+        // Set a 4x4 matrix uniform value stored in the OpenGL layout to this shader
+        // (the matrix is passed by pointer without any copy or transposition)
+        void setMatrix4x4Uniform(const std::string& variableName,
+                                 const ColumnMajorMatrix4& matrix) const;
+
+        // Set an array of 4x4 matrix uniform values stored in the OpenGL layout to this shader
+        void setMatrix4x4ArrayUniform(const std::string& variableName,
+                                      const ColumnMajorMatrix4* matrices, uint nbMatrices) const;
+
         // Return true if the needed OpenGL extensions are available
         static bool checkOpenGLExtensions();
 };
@@ -222,13 +232,26 @@ inline void Shader::setMatrix4x4Uniform(const std::string& variableName, const f
 // to set it, an assert will occur)
 inline void Shader::setMatrix4x4Uniform(const std::string& variableName, const Matrix4& matrix) const {
     assert(mProgramObjectID != 0);
-    GLfloat mat[16];
-    for (int i=0; i<4; i++) {
-        for (int j=0; j<4; j++) {
-            mat[i*4 + j] = matrix.m[i][j];
-        }
-    }
-    glUniformMatrix4fv(getUniformLocation(variableName), 1, true, mat);
+
+    // The rows of the matrix are contiguous, so OpenGL can read it directly as a transposed matrix
+    glUniformMatrix4fv(getUniformLocation(variableName), 1, true, matrix.dataBlock());
+}
+
+// Set a 4x4 matrix uniform value stored in the OpenGL layout to this shader
+// (the matrix is passed by pointer without any copy or transposition)
+inline void Shader::setMatrix4x4Uniform(const std::string& variableName,
+                                        const ColumnMajorMatrix4& matrix) const {
+    assert(mProgramObjectID != 0);
+    glUniformMatrix4fv(getUniformLocation(variableName), 1, false, matrix.dataBlock());
+}
+
+// Set an array of 4x4 matrix uniform values stored in the OpenGL layout to this shader
+inline void Shader::setMatrix4x4ArrayUniform(const std::string& variableName,
+                                             const ColumnMajorMatrix4* matrices,
+                                             uint nbMatrices) const {
+    assert(mProgramObjectID != 0);
+    glUniformMatrix4fv(getUniformLocation(variableName), nbMatrices, false,
+                       matrices[0].dataBlock());
 }
 
 // Return true if the needed OpenGL extensions are available for shaders
@@ -26,6 +26,7 @@
 // Librairies
 #include "TextureReaderWriter.h"
 #include <string>
+#include <vector>
 #include <jpeglib.h>
 #include <jerror.h>
 
@@ -87,6 +88,28 @@ void TextureReaderWriter::loadTextureFromFile(const std::string& filename,
 void TextureReaderWriter::writeTextureToFile(const std::string& filename,
                                              const Texture2D& texture)
                                              throw(runtime_error, invalid_argument){
+    assert(texture.getID() != 0);
+
+    // Get the bytes from the OpenGL texture (without padding at the end of the rows)
+    vector<unsigned char> pixels(texture.getWidth() * texture.getHeight() * 3);
+    GLint packAlignment;
+    glGetIntegerv(GL_PACK_ALIGNMENT, &packAlignment);
+    glBindTexture(GL_TEXTURE_2D, texture.getID());
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, &pixels[0]);
+    glPixelStorei(GL_PACK_ALIGNMENT, packAlignment);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    writePixelsToFile(filename, texture.getWidth(), texture.getHeight(), &pixels[0]);
+}
+
+// Write a RGB pixel buffer to a file (three bytes per pixel). The rows are written
+// in the order of the buffer as for the textures (or in the reverse order if
+// the picture is flipped vertically)
+void TextureReaderWriter::writePixelsToFile(const std::string& filename, uint width,
+                                            uint height, const unsigned char* pixels,
+                                            bool isFlippedVertically)
+                                            throw(runtime_error, invalid_argument){
 
     // Get the extension of the file
     uint startPosExtension = filename.find_last_of(".");
@@ -94,10 +117,10 @@ void TextureReaderWriter::writeTextureToFile(const std::string& filename,
 
     // Write the file using the correct method
     if (extension == "tga") {
-        writeTGAPicture(filename, texture);
+        writeTGAPicture(filename, width, height, pixels, isFlippedVertically);
     }
     else if (extension == "jpg" || extension == "jpeg"){
-        writeJPEGPicture(filename, texture);
+        writeJPEGPicture(filename, width, height, pixels, isFlippedVertically);
     }
     else {
 
@@ -156,18 +179,11 @@ void TextureReaderWriter::readTGAPicture(const std::string &filename,
 
 
 // Write a TGA picture
-void TextureReaderWriter::writeTGAPicture(const std::string& filename,
-                                          const Texture2D& texture) throw(runtime_error) {
-    assert(texture.getID() != 0);
-
-    // Bind the corresponding texture
-    glBindTexture(GL_TEXTURE_2D, texture.getID());
-
-    uint sizeImg = texture.getWidth() * texture.getHeight();
+void TextureReaderWriter::writeTGAPicture(const std::string& filename, uint width, uint height,
+                                          const unsigned char* pixels,
+                                          bool isFlippedVertically) throw(runtime_error) {
 
-    // Get the bytes form the OpenGL texture
-    char* data = new char[sizeImg * 3];
-    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+    uint sizeImg = width * height;
 
     // Open the file
     std::ofstream stream(filename.c_str(), std::ios::binary);
@@ -178,7 +194,6 @@ void TextureReaderWriter::writeTGAPicture(const std::string& filename,
         // Throw an exception and display an error message
         string errorMessage("Error : Cannot create/access the file " + filename);
         std::cerr << errorMessage << std::endl;
-        delete[] data;
         throw std::runtime_error(errorMessage);
     }
 
@@ -192,20 +207,23 @@ void TextureReaderWriter::writeTGAPicture(const std::string& filename,
     header.colourmapbits=0;                     // number of bits per palette entry 15,16,24,32
     header.xstart = 0;                          // image x origin
     header.ystart = 0;                          // image y origin
-    header.width = (short)texture.getWidth();   // image width in pixels
-    header.height = (short)texture.getHeight(); // image height in pixels
+    header.width = (short)width;                // image width in pixels
+    header.height = (short)height;              // image height in pixels
     header.bits = 24;                           // image bits per pixel 8,16,24,32
     header.descriptor = 0;                      // image descriptor bits (vh flip bits)
 
     // Write the header to the file
     stream.write((char*)(&header), sizeof(TGA_HEADER));
 
-    // Write the bytes to the file
+    // Write the bytes to the file (in BGR order)
+    char* data = new char[sizeImg * 3];
     for(uint i = 0; i < sizeImg; i++) {
         unsigned pos = i*3;
-        unsigned char red = data[pos];
-        data[pos] = data[pos + 2];
-        data[pos + 2] = red;
+        uint row = isFlippedVertically ? height - 1 - i / width : i / width;
+        unsigned sourcePos = (row * width + i % width) * 3;
+        data[pos] = pixels[sourcePos + 2];
+        data[pos + 1] = pixels[sourcePos + 1];
+        data[pos + 2] = pixels[sourcePos];
     }
     stream.write(data, sizeImg*3);
 
@@ -214,9 +232,6 @@ void TextureReaderWriter::writeTGAPicture(const std::string& filename,
 
     // Delete the data
     delete[] data;
-
-    // Unbind the corresponding texture
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 // Read a JPEG picture
@@ -276,8 +291,9 @@ void TextureReaderWriter::readJPEGPicture(const std::string& filename,
 }
 
 // Write a JPEG picture
-void TextureReaderWriter::writeJPEGPicture(const std::string& filename,
-                                           const Texture2D& texture) throw(std::runtime_error) {
+void TextureReaderWriter::writeJPEGPicture(const std::string& filename, uint width, uint height,
+                                           const unsigned char* pixels,
+                                           bool isFlippedVertically) throw(std::runtime_error) {
 
     struct jpeg_compress_struct info;
     struct jpeg_error_mgr error;
@@ -295,14 +311,10 @@ void TextureReaderWriter::writeJPEGPicture(const std::string& filename,
         throw std::runtime_error(errorMessage);
     }
 
-    // Get the bytes form the OpenGL texture
-    char* data = new char[texture.getWidth() * texture.getHeight() * 3];
-    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-
     jpeg_stdio_dest(&info, file);
 
-    info.image_width = texture.getWidth();
-    info.image_height = texture.getHeight();
+    info.image_width = width;
+    info.image_height = height;
     info.input_components = 3;
     info.in_color_space = JCS_RGB;
     jpeg_set_defaults(&info);
@@ -312,9 +324,10 @@ void TextureReaderWriter::writeJPEGPicture(const std::string& filename,
 
     // Write the data into the file
     JSAMPROW rowPointer;
-    int rowStride = texture.getWidth() * 3;
+    int rowStride = width * 3;
     while (info.next_scanline < info.image_height) {
-        rowPointer = (JSAMPROW) &data[info.next_scanline * rowStride];
+        uint row = isFlippedVertically ? height - 1 - info.next_scanline : info.next_scanline;
+        rowPointer = (JSAMPROW) &pixels[row * rowStride];
         jpeg_write_scanlines(&info, &rowPointer, 1);
     }
 
@@ -323,7 +336,4 @@ void TextureReaderWriter::writeJPEGPicture(const std::string& filename,
 
     // Close the file
     fclose(file);
-
-    // Free allocated memory
-    delete[] data;
 }
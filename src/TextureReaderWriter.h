@@ -56,16 +56,18 @@ class TextureReaderWriter {
                                    Texture2D& textureToCreate) throw(std::runtime_error);
 
         // Write a TGA picture
-        static void writeTGAPicture(const std::string& filename,
-                                    const Texture2D& texture) throw(std::runtime_error);
+        static void writeTGAPicture(const std::string& filename, uint width, uint height,
+                                    const unsigned char* pixels,
+                                    bool isFlippedVertically) throw(std::runtime_error);
 
         // Read a JPEG picture
         static void readJPEGPicture(const std::string& filename,
                                     Texture2D& textureToCreate) throw(std::runtime_error);
 
         // Write a JPEG picture
-        static void writeJPEGPicture(const std::string& filename,
-                                     const Texture2D& texture) throw(std::runtime_error);
+        static void writeJPEGPicture(const std::string& filename, uint width, uint height,
+                                     const unsigned char* pixels,
+                                     bool isFlippedVertically) throw(std::runtime_error);
 
     public :
 
@@ -80,6 +82,15 @@ class TextureReaderWriter {
         static void writeTextureToFile(const std::string& filename,
                                        const Texture2D& texture)
                                        throw(std::runtime_error, std::invalid_argument);
+
+        // Write a RGB pixel buffer to a file (three bytes per pixel). The rows are written
+        // in the order of the buffer as for the textures (the first row is the bottom
+        // one in a TGA file and the top one in a JPEG file) or in the reverse order if
+        // the picture is flipped vertically.
+        static void writePixelsToFile(const std::string& filename, uint width, uint height,
+                                      const unsigned char* pixels,
+                                      bool isFlippedVertically = false)
+                                      throw(std::runtime_error, std::invalid_argument);
 };
 
 }
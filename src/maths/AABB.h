@@ -0,0 +1,138 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef AABB_H
+#define AABB_H
+
+// Libraries
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "Vector3.h"
+#include "Matrix4.h"
+
+namespace openglframework {
+
+// Class AABB
+// This class represents an axis-aligned bounding box
+class AABB {
+
+    public:
+
+        // -------------------- Attributes -------------------- //
+
+        // Minimum coordinates of the box
+        Vector3 min;
+
+        // Maximum coordinates of the box
+        Vector3 max;
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor of an empty box
+        constexpr AABB() : min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                               std::numeric_limits<float>::max()),
+                           max(-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(),
+                               -std::numeric_limits<float>::max()) {}
+
+        // Constructor
+        constexpr AABB(const Vector3& min, const Vector3& max) : min(min), max(max) {}
+
+        // Return true if the box does not contain any point
+        bool isEmpty() const {
+            return min.x > max.x || min.y > max.y || min.z > max.z;
+        }
+
+        // Enlarge the box so that it contains a point
+        void merge(const Vector3& point) {
+            min.x = std::min(min.x, point.x); max.x = std::max(max.x, point.x);
+            min.y = std::min(min.y, point.y); max.y = std::max(max.y, point.y);
+            min.z = std::min(min.z, point.z); max.z = std::max(max.z, point.z);
+        }
+
+        // Enlarge the box so that it contains another box
+        void merge(const AABB& aabb) {
+            min.x = std::min(min.x, aabb.min.x); max.x = std::max(max.x, aabb.max.x);
+            min.y = std::min(min.y, aabb.min.y); max.y = std::max(max.y, aabb.max.y);
+            min.z = std::min(min.z, aabb.min.z); max.z = std::max(max.z, aabb.max.z);
+        }
+
+        // Return the center of the box
+        Vector3 getCenter() const {
+            return (min + max) * 0.5f;
+        }
+
+        // Return the half-size of the box along each axis
+        Vector3 getExtent() const {
+            return (max - min) * 0.5f;
+        }
+
+        // Return true if the box contains a point
+        bool contains(const Vector3& point) const {
+            return point.x >= min.x && point.x <= max.x && point.y >= min.y &&
+                   point.y <= max.y && point.z >= min.z && point.z <= max.z;
+        }
+
+        // Return true if the box contains another box
+        bool contains(const AABB& aabb) const {
+            return aabb.min.x >= min.x && aabb.max.x <= max.x && aabb.min.y >= min.y &&
+                   aabb.max.y <= max.y && aabb.min.z >= min.z && aabb.max.z <= max.z;
+        }
+
+        // Return the surface area of the box
+        float getSurfaceArea() const {
+            if (isEmpty()) return 0.0f;
+            Vector3 size = max - min;
+            return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+
+        // Return true if the box overlaps another box
+        bool overlaps(const AABB& aabb) const {
+            return min.x <= aabb.max.x && max.x >= aabb.min.x &&
+                   min.y <= aabb.max.y && max.y >= aabb.min.y &&
+                   min.z <= aabb.max.z && max.z >= aabb.min.z;
+        }
+
+        // Return the box that contains this box transformed by an affine transform.
+        // Only the center and the extent are transformed (Arvo's method) which
+        // is much cheaper than transforming the eight corners.
+        AABB getTransformed(const Matrix4& transform) const {
+            if (isEmpty()) return *this;
+            const float (*m)[4] = transform.m;
+            Vector3 c = getCenter();
+            Vector3 e = getExtent();
+            Vector3 center(m[0][0]*c.x + m[0][1]*c.y + m[0][2]*c.z + m[0][3],
+                           m[1][0]*c.x + m[1][1]*c.y + m[1][2]*c.z + m[1][3],
+                           m[2][0]*c.x + m[2][1]*c.y + m[2][2]*c.z + m[2][3]);
+            Vector3 extent(std::fabs(m[0][0])*e.x + std::fabs(m[0][1])*e.y + std::fabs(m[0][2])*e.z,
+                           std::fabs(m[1][0])*e.x + std::fabs(m[1][1])*e.y + std::fabs(m[1][2])*e.z,
+                           std::fabs(m[2][0])*e.x + std::fabs(m[2][1])*e.y + std::fabs(m[2][2])*e.z);
+            return AABB(center - extent, center + extent);
+        }
+};
+
+}
+
+#endif
@@ -0,0 +1,155 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef BOUNDING_SPHERE_H
+#define BOUNDING_SPHERE_H
+
+// Libraries
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "Vector3.h"
+#include "Matrix4.h"
+#include "../definitions.h"
+
+namespace openglframework {
+
+// Class BoundingSphere
+// This class represents a bounding sphere
+class BoundingSphere {
+
+    public:
+
+        // -------------------- Attributes -------------------- //
+
+        // Center of the sphere
+        Vector3 center;
+
+        // Radius of the sphere (negative for an empty sphere)
+        float radius;
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor of an empty sphere
+        constexpr BoundingSphere() : center(0, 0, 0), radius(-1.0f) {}
+
+        // Constructor
+        constexpr BoundingSphere(const Vector3& center, float radius) : center(center), radius(radius) {}
+
+        // Return true if the sphere does not contain any point
+        bool isEmpty() const {
+            return radius < 0.0f;
+        }
+
+        // Enlarge the sphere so that it contains a point
+        void merge(const Vector3& point) {
+            if (isEmpty()) {
+                center = point;
+                radius = 0.0f;
+                return;
+            }
+            Vector3 d = point - center;
+            float distanceSquare = d.lengthSquared();
+            if (distanceSquare > radius * radius) {
+
+                // Move the center toward the point and grow the radius just enough
+                float distance = std::sqrt(distanceSquare);
+                float newRadius = 0.5f * (radius + distance);
+                center += d * ((newRadius - radius) / distance);
+                radius = newRadius;
+            }
+        }
+
+        // Return true if the sphere contains a point
+        bool contains(const Vector3& point) const {
+            return (point - center).lengthSquared() <= radius * radius;
+        }
+
+        // Return the sphere that contains this sphere transformed by an affine transform
+        // (the radius is scaled by the largest scaling factor of the transform)
+        BoundingSphere getTransformed(const Matrix4& transform) const {
+            if (isEmpty()) return *this;
+            const float (*m)[4] = transform.m;
+            Vector3 newCenter(m[0][0]*center.x + m[0][1]*center.y + m[0][2]*center.z + m[0][3],
+                              m[1][0]*center.x + m[1][1]*center.y + m[1][2]*center.z + m[1][3],
+                              m[2][0]*center.x + m[2][1]*center.y + m[2][2]*center.z + m[2][3]);
+            float scaleX = m[0][0]*m[0][0] + m[1][0]*m[1][0] + m[2][0]*m[2][0];
+            float scaleY = m[0][1]*m[0][1] + m[1][1]*m[1][1] + m[2][1]*m[2][1];
+            float scaleZ = m[0][2]*m[0][2] + m[1][2]*m[1][2] + m[2][2]*m[2][2];
+            float scale = std::sqrt(std::max(scaleX, std::max(scaleY, scaleZ)));
+            return BoundingSphere(newCenter, radius * scale);
+        }
+
+        // Compute a bounding sphere of a set of points with Ritter's algorithm.
+        // If an array of indices is given, only the indexed points are used.
+        static BoundingSphere computeRitter(const std::vector<Vector3>& points,
+                                            const std::vector<uint>* indices = NULL);
+
+    private:
+
+        // Return the ith point of a set of points (optionally indexed)
+        static const Vector3& getPoint(const std::vector<Vector3>& points,
+                                       const std::vector<uint>* indices, size_t i) {
+            return points[(indices != NULL) ? (*indices)[i] : i];
+        }
+};
+
+// Compute a bounding sphere of a set of points with Ritter's algorithm.
+// If an array of indices is given, only the indexed points are used.
+inline BoundingSphere BoundingSphere::computeRitter(const std::vector<Vector3>& points,
+                                                    const std::vector<uint>* indices) {
+
+    size_t nbPoints = (indices != NULL) ? indices->size() : points.size();
+    if (nbPoints == 0) return BoundingSphere();
+
+    // Find the point that is the farthest from the first point and then
+    // the point that is the farthest from this one
+    Vector3 a = getPoint(points, indices, 0);
+    Vector3 b = a;
+    float maxDistance = 0.0f;
+    for (size_t i=0; i<nbPoints; i++) {
+        float distance = (getPoint(points, indices, i) - a).lengthSquared();
+        if (distance > maxDistance) { maxDistance = distance; b = getPoint(points, indices, i); }
+    }
+    Vector3 c = b;
+    maxDistance = 0.0f;
+    for (size_t i=0; i<nbPoints; i++) {
+        float distance = (getPoint(points, indices, i) - b).lengthSquared();
+        if (distance > maxDistance) { maxDistance = distance; c = getPoint(points, indices, i); }
+    }
+
+    // Initial sphere with the two farthest points as diameter and
+    // grow it to contain all the points
+    BoundingSphere sphere((b + c) * 0.5f, 0.5f * std::sqrt(maxDistance));
+    for (size_t i=0; i<nbPoints; i++) {
+        sphere.merge(getPoint(points, indices, i));
+    }
+
+    return sphere;
+}
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef COLUMN_MAJOR_MATRIX4_H
+#define COLUMN_MAJOR_MATRIX4_H
+
+// Libraries
+#include <assert.h>
+#include "Matrix4.h"
+
+namespace openglframework {
+
+// Class ColumnMajorMatrix4
+// This class stores a 4x4 matrix with the column-major layout of OpenGL. It is used to
+// upload matrices to OpenGL (uniforms, uniform buffers or instance buffers) directly
+// by pointer without any temporary copy or transposition by the driver. An array of
+// these matrices can be uploaded as a whole. The matrix is converted from a Matrix4
+// (that keeps the row-major layout used by the rest of the library) with a SIMD
+// transposition.
+class alignas(16) ColumnMajorMatrix4 {
+
+    public:
+
+        // -------------------- Attributes -------------------- //
+
+        // Elements of the matrix (the element (i, j) is at the index j*4 + i)
+        float data[16];
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor (identity matrix)
+        ColumnMajorMatrix4() {
+            for (int i = 0; i < 16; i++) {
+                data[i] = (i % 5 == 0) ? 1.f : 0.f;
+            }
+        }
+
+        // Constructor
+        explicit ColumnMajorMatrix4(const Matrix4& matrix) {
+            set(matrix);
+        }
+
+        // = operator
+        ColumnMajorMatrix4& operator=(const Matrix4& matrix) {
+            set(matrix);
+            return *this;
+        }
+
+        // Set the values from a row-major matrix
+        void set(const Matrix4& matrix) {
+#if defined(MATRIX4_USE_SSE)
+            __m128 r0 = _mm_loadu_ps(matrix.m[0]);
+            __m128 r1 = _mm_loadu_ps(matrix.m[1]);
+            __m128 r2 = _mm_loadu_ps(matrix.m[2]);
+            __m128 r3 = _mm_loadu_ps(matrix.m[3]);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(data, r0);
+            _mm_storeu_ps(data + 4, r1);
+            _mm_storeu_ps(data + 8, r2);
+            _mm_storeu_ps(data + 12, r3);
+#elif defined(MATRIX4_USE_NEON)
+            float32x4x4_t columns = vld4q_f32(matrix.m[0]);
+            vst1q_f32(data, columns.val[0]);
+            vst1q_f32(data + 4, columns.val[1]);
+            vst1q_f32(data + 8, columns.val[2]);
+            vst1q_f32(data + 12, columns.val[3]);
+#else
+            for (int i = 0; i < 4; i++) {
+                for (int j = 0; j < 4; j++) {
+                    data[j*4 + i] = matrix.m[i][j];
+                }
+            }
+#endif
+        }
+
+        // Return the row-major matrix
+        Matrix4 getMatrix4() const {
+            return Matrix4(data[0], data[4], data[8],  data[12],
+                           data[1], data[5], data[9],  data[13],
+                           data[2], data[6], data[10], data[14],
+                           data[3], data[7], data[11], data[15]);
+        }
+
+        // Return a given value from the matrix
+        float getValue(int i, int j) const {
+            assert(i >= 0 && i<4 && j >= 0 && j<4);
+            return data[j*4 + i];
+        }
+
+        // Return the constant pointer to the data array of the matrix
+        const float* dataBlock() const {
+            return data;
+        }
+};
+
+}
+
+#endif
@@ -0,0 +1,163 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef FAST_MATH_H
+#define FAST_MATH_H
+
+// Libraries
+#include <math.h>
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define FAST_MATH_USE_SSE
+#endif
+
+namespace openglframework {
+
+// Precision of the inverse square root and sine/cosine methods of the FastMath class
+enum MathPrecision {
+
+    // Full precision with the standard library functions
+    PRECISION_ACCURATE,
+
+    // Approximations with the error bounds of the FastMath class
+    PRECISION_FAST
+};
+
+// Default precision of the FastMath::inverseSqrt() and FastMath::sinCos() methods. The
+// fast approximations can be selected globally by defining OPENGLFRAMEWORK_FAST_MATH
+// (option ENABLE_FAST_MATH of CMake) or for each call with the precision argument. The
+// maths types always use the standard library functions because the approximations
+// were not measured faster there (bench_maths).
+#if defined(OPENGLFRAMEWORK_FAST_MATH)
+const MathPrecision DEFAULT_MATH_PRECISION = PRECISION_FAST;
+#else
+const MathPrecision DEFAULT_MATH_PRECISION = PRECISION_ACCURATE;
+#endif
+
+// Maximum relative error of FastMath::fastInverseSqrt()
+const float FAST_RSQRT_MAX_RELATIVE_ERROR = 5e-7f;
+
+// Maximum absolute error of FastMath::fastSinCos()
+const float FAST_SINCOS_MAX_ABSOLUTE_ERROR = 2e-7f;
+
+// Largest angle magnitude handled by the polynomials of FastMath::fastSinCos()
+// (larger angles use the standard library functions)
+const float FAST_SINCOS_MAX_ANGLE = 8192.0f;
+
+// Class FastMath
+// This class contains fast approximations of the inverse square root and of the sine
+// and cosine functions with bounded errors. The inverse square root is computed with
+// the SSE approximation refined by a Newton-Raphson iteration (relative error below
+// FAST_RSQRT_MAX_RELATIVE_ERROR). The sine and cosine are computed together with a
+// range reduction to [-PI/4, PI/4] and minimax polynomials (absolute error below
+// FAST_SINCOS_MAX_ABSOLUTE_ERROR). These bounds are verified by the test_fast_math test.
+class FastMath {
+
+    private:
+
+        // -------------------- Methods -------------------- //
+
+        // Private constructor (static class)
+        FastMath() {}
+
+    public:
+
+        // -------------------- Methods -------------------- //
+
+        // Return an approximation of 1 / sqrt(x) (x must be positive)
+        static float fastInverseSqrt(float x);
+
+        // Compute approximations of the sine and the cosine of an angle
+        static void fastSinCos(float angle, float& sine, float& cosine);
+
+        // Return 1 / sqrt(x) with a given precision
+        static float inverseSqrt(float x, MathPrecision precision = DEFAULT_MATH_PRECISION);
+
+        // Compute the sine and the cosine of an angle with a given precision
+        static void sinCos(float angle, float& sine, float& cosine,
+                           MathPrecision precision = DEFAULT_MATH_PRECISION);
+};
+
+// Return an approximation of 1 / sqrt(x) (x must be positive)
+inline float FastMath::fastInverseSqrt(float x) {
+#if defined(FAST_MATH_USE_SSE)
+    // 12-bit hardware approximation refined by one Newton-Raphson iteration
+    float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+    return y * (1.5f - 0.5f * x * y * y);
+#else
+    return 1.0f / sqrtf(x);
+#endif
+}
+
+// Compute approximations of the sine and the cosine of an angle
+inline void FastMath::fastSinCos(float angle, float& sine, float& cosine) {
+
+    if (!(fabsf(angle) <= FAST_SINCOS_MAX_ANGLE)) {
+        sine = sinf(angle);
+        cosine = cosf(angle);
+        return;
+    }
+
+    // Reduce the angle to [-PI/4, PI/4] (the multiple of PI/2 is subtracted
+    // in three parts to keep the precision of the reduced angle)
+    int q = int(angle * 0.63661977236f + (angle >= 0.0f ? 0.5f : -0.5f));
+    float quadrant = float(q);
+    float x = ((angle - quadrant * 1.5703125f) - quadrant * 4.837512969970703125e-4f)
+              - quadrant * 7.54978995489188216e-8f;
+
+    // Minimax polynomials of the sine and the cosine on [-PI/4, PI/4]
+    float x2 = x * x;
+    float s = x + x * x2 * (-1.6666654611e-1f + x2 * (8.3321608736e-3f + x2 * -1.9515295891e-4f));
+    float c = 1.0f - 0.5f * x2 + x2 * x2 * (4.166664568298827e-2f + x2 * (-1.388731625493765e-3f +
+                                                                        x2 * 2.443315711809948e-5f));
+
+    // Rotate the result according to the quadrant
+    switch (q & 3) {
+        case 0: sine = s;  cosine = c;  break;
+        case 1: sine = c;  cosine = -s; break;
+        case 2: sine = -s; cosine = -c; break;
+        default: sine = -c; cosine = s; break;
+    }
+}
+
+// Return 1 / sqrt(x) with a given precision
+inline float FastMath::inverseSqrt(float x, MathPrecision precision) {
+    return (precision == PRECISION_FAST) ? fastInverseSqrt(x) : 1.0f / sqrtf(x);
+}
+
+// Compute the sine and the cosine of an angle with a given precision
+inline void FastMath::sinCos(float angle, float& sine, float& cosine, MathPrecision precision) {
+    if (precision == PRECISION_FAST) {
+        fastSinCos(angle, sine, cosine);
+    }
+    else {
+        sine = sinf(angle);
+        cosine = cosf(angle);
+    }
+}
+
+}
+
+#endif
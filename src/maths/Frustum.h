@@ -0,0 +1,118 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+// Libraries
+#include <cmath>
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4.h"
+#include "AABB.h"
+#include "BoundingSphere.h"
+
+namespace openglframework {
+
+// Class Frustum
+// This class represents a view frustum as six planes. Each plane is stored as a
+// Vector4 (a, b, c, d) with a normalized normal (a, b, c) that points toward the
+// inside of the frustum, so that a point p is inside the plane if a*px + b*py + c*pz + d >= 0.
+class Frustum {
+
+    public:
+
+        // -------------------- Constants -------------------- //
+
+        // Indices of the planes
+        enum Plane {LEFT = 0, RIGHT, BOTTOM, TOP, NEAR_PLANE, FAR_PLANE, NB_PLANES};
+
+        // Result of a visibility test
+        enum TestResult {OUTSIDE = 0, INTERSECT, INSIDE};
+
+        // -------------------- Attributes -------------------- //
+
+        // Planes of the frustum
+        Vector4 planes[NB_PLANES];
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor
+        Frustum() {}
+
+        // Constructor with the planes extracted from a projection * view matrix
+        // (the planes are in the space the view matrix transforms from)
+        explicit Frustum(const Matrix4& matrix) {
+            const float (*m)[4] = matrix.m;
+            for (int i=0; i<3; i++) {
+                planes[2*i] = Vector4(m[3][0] + m[i][0], m[3][1] + m[i][1],
+                                      m[3][2] + m[i][2], m[3][3] + m[i][3]);
+                planes[2*i + 1] = Vector4(m[3][0] - m[i][0], m[3][1] - m[i][1],
+                                          m[3][2] - m[i][2], m[3][3] - m[i][3]);
+            }
+            for (int i=0; i<NB_PLANES; i++) {
+                float length = std::sqrt(planes[i].x * planes[i].x + planes[i].y * planes[i].y +
+                                         planes[i].z * planes[i].z);
+                planes[i] = Vector4(planes[i].x / length, planes[i].y / length,
+                                    planes[i].z / length, planes[i].w / length);
+            }
+        }
+
+        // Return the signed distance from a plane to a point
+        float getDistance(int plane, const Vector3& point) const {
+            return planes[plane].x * point.x + planes[plane].y * point.y +
+                   planes[plane].z * point.z + planes[plane].w;
+        }
+
+        // Test a box against the frustum
+        TestResult testAABB(const AABB& aabb) const {
+            Vector3 center = aabb.getCenter();
+            Vector3 extent = aabb.getExtent();
+            TestResult result = INSIDE;
+            for (int i=0; i<NB_PLANES; i++) {
+                float distance = getDistance(i, center);
+                float radius = std::fabs(planes[i].x) * extent.x + std::fabs(planes[i].y) * extent.y +
+                               std::fabs(planes[i].z) * extent.z;
+                if (distance < -radius) return OUTSIDE;
+                if (distance < radius) result = INTERSECT;
+            }
+            return result;
+        }
+
+        // Test a sphere against the frustum
+        TestResult testSphere(const BoundingSphere& sphere) const {
+            TestResult result = INSIDE;
+            for (int i=0; i<NB_PLANES; i++) {
+                float distance = getDistance(i, sphere.center);
+                if (distance < -sphere.radius) return OUTSIDE;
+                if (distance < sphere.radius) result = INTERSECT;
+            }
+            return result;
+        }
+};
+
+}
+
+#endif
@@ -47,16 +47,13 @@ class Matrix3 {
     public :
 
         // Constructor
-        Matrix3() {
-            setToNull();
-        }
+        constexpr Matrix3() : m{{0, 0, 0}, {0, 0, 0}, {0, 0, 0}} {}
 
         // Constructor
-        Matrix3(float a1, float a2,
-                float a3, float b1, float b2, float b3,
-                float c1, float c2, float c3) {
-            setAllValues(a1, a2, a3, b1, b2, b3, c1, c2, c3);
-        }
+        constexpr Matrix3(float a1, float a2,
+                          float a3, float b1, float b2, float b3,
+                          float c1, float c2, float c3)
+            : m{{a1, a2, a3}, {b1, b2, b3}, {c1, c2, c3}} {}
 
         // Constructor
         Matrix3(float n[3][3]) {
@@ -66,17 +63,17 @@ class Matrix3 {
         }
 
         // Constructor
-        Matrix3(const Vector3& a1, const Vector3& a2, const Vector3& a3) {
-            m[0][0] = a1.x; m[0][1] = a2.x; m[0][2] = a3.x;
-            m[1][0] = a1.y; m[1][1] = a2.y; m[1][2] = a3.y;
-            m[2][0] = a1.z; m[2][1] = a2.z; m[2][2] = a3.z;
+        constexpr Matrix3(const Vector3& a1, const Vector3& a2, const Vector3& a3)
+            : m{{a1.x, a2.x, a3.x}, {a1.y, a2.y, a3.y}, {a1.z, a2.z, a3.z}} {}
+
+        // Return the identity matrix
+        static constexpr Matrix3 identity() {
+            return Matrix3(1, 0, 0, 0, 1, 0, 0, 0, 1);
         }
 
-        // Constructor
-        Matrix3(const Matrix3& matrix) {
-            setAllValues(matrix.m[0][0], matrix.m[0][1], matrix.m[0][2],
-                         matrix.m[1][0], matrix.m[1][1], matrix.m[1][2],
-                         matrix.m[2][0], matrix.m[2][1], matrix.m[2][2]);
+        // Return a 3x3 scaling matrix
+        static constexpr Matrix3 scaleMatrix(const Vector3& s) {
+            return Matrix3(s.x, 0, 0, 0, s.y, 0, 0, 0, s.z);
         }
 
         // Method to get a value in the matrix
@@ -178,16 +175,6 @@ class Matrix3 {
             }
         }
 
-        // Overloaded operator =
-        Matrix3& operator=(const Matrix3& matrix) {
-            if (&matrix != this) {
-                setAllValues(matrix.m[0][0], matrix.m[0][1], matrix.m[0][2],
-                             matrix.m[1][0], matrix.m[1][1], matrix.m[1][2],
-                             matrix.m[2][0], matrix.m[2][1], matrix.m[2][2]);
-            }
-            return *this;
-        }
-
 
         // Overloaded operator for addition
         Matrix3 operator+(const Matrix3& matrix2) {
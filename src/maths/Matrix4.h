@@ -32,12 +32,26 @@
 #include <iostream>
 #include "Vector3.h"
 #include "Vector4.h"
+#if defined(__AVX__)
+#include <immintrin.h>
+#define MATRIX4_USE_AVX
+#define MATRIX4_USE_SSE
+#elif defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define MATRIX4_USE_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MATRIX4_USE_NEON
+#endif
 
 namespace openglframework {
 
 // Class Matrix4
-// This class represents a 4x4 matrix
-class Matrix4 {
+// This class represents a 4x4 matrix. The rows are stored contiguously and aligned on
+// 16 bytes so that they can be loaded into SIMD registers. The matrix products use SSE
+// (AVX or NEON if available) and accumulate the terms in the same order as the scalar
+// code so that the results are the same.
+class alignas(16) Matrix4 {
 
     public:
 
@@ -49,15 +63,12 @@ class Matrix4 {
         // -------------------- Methods -------------------- //
 
         // Constructor
-        Matrix4(float m_00=0, float m_01=0, float m_02=0, float m_03=0,
-                float m_10=0, float m_11=0, float m_12=0, float m_13=0,
-                float m_20=0, float m_21=0, float m_22=0, float m_23=0,
-                float m_30=0, float m_31=0, float m_32=0, float m_33=0) {
-            m[0][0] = m_00; m[0][1] = m_01; m[0][2] = m_02;  m[0][3] = m_03;
-            m[1][0] = m_10; m[1][1] = m_11; m[1][2] = m_12;  m[1][3] = m_13;
-            m[2][0] = m_20; m[2][1] = m_21; m[2][2] = m_22;  m[2][3] = m_23;
-            m[3][0] = m_30; m[3][1] = m_31; m[3][2] = m_32;  m[3][3] = m_33;
-        }
+        constexpr Matrix4(float m_00=0, float m_01=0, float m_02=0, float m_03=0,
+                          float m_10=0, float m_11=0, float m_12=0, float m_13=0,
+                          float m_20=0, float m_21=0, float m_22=0, float m_23=0,
+                          float m_30=0, float m_31=0, float m_32=0, float m_33=0)
+            : m{{m_00, m_01, m_02, m_03}, {m_10, m_11, m_12, m_13},
+                {m_20, m_21, m_22, m_23}, {m_30, m_31, m_32, m_33}} {}
 
         // Constructor
         Matrix4(float n[4][4]) {
@@ -68,29 +79,14 @@ class Matrix4 {
         }
 
         // Constructor
-        Matrix4(const Vector3& a1, const Vector3& a2, const Vector3& a3) {
-            m[0][0] = a1.x; m[0][1] = a2.x; m[0][2] = a3.x;  m[0][3] = 0.f;
-            m[1][0] = a1.y; m[1][1] = a2.y; m[1][2] = a3.y;  m[1][3] = 0.f;
-            m[2][0] = a1.z; m[2][1] = a2.z; m[2][2] = a3.z;  m[2][3] = 0.f;
-            m[3][0] = 0.f;  m[3][1] = 0.f;  m[3][2] = 0.f;   m[3][3] = 1.f;
-        }
-
-        // Constructor
-        Matrix4(const Vector4& a1, const Vector4& a2, const Vector4& a3) {
-            m[0][0] = a1.x; m[0][1] = a2.x; m[0][2] = a3.x;  m[0][3] = 0.f;
-            m[1][0] = a1.y; m[1][1] = a2.y; m[1][2] = a3.y;  m[1][3] = 0.f;
-            m[2][0] = a1.z; m[2][1] = a2.z; m[2][2] = a3.z;  m[2][3] = 0.f;
-            m[3][0] = a1.w; m[3][1] = a2.w; m[3][2] = a3.w;  m[3][3] = 1.f;
-        }
+        constexpr Matrix4(const Vector3& a1, const Vector3& a2, const Vector3& a3)
+            : m{{a1.x, a2.x, a3.x, 0.f}, {a1.y, a2.y, a3.y, 0.f},
+                {a1.z, a2.z, a3.z, 0.f}, {0.f, 0.f, 0.f, 1.f}} {}
 
         // Constructor
-        Matrix4(const Matrix4& matrix) {
-
-            setAllValues(matrix.m[0][0], matrix.m[0][1], matrix.m[0][2], matrix.m[0][3],
-                         matrix.m[1][0], matrix.m[1][1], matrix.m[1][2], matrix.m[1][3],
-                         matrix.m[2][0], matrix.m[2][1], matrix.m[2][2], matrix.m[2][3],
-                         matrix.m[3][0], matrix.m[3][1], matrix.m[3][2], matrix.m[3][3]);
-        }
+        constexpr Matrix4(const Vector4& a1, const Vector4& a2, const Vector4& a3)
+            : m{{a1.x, a2.x, a3.x, 0.f}, {a1.y, a2.y, a3.y, 0.f},
+                {a1.z, a2.z, a3.z, 0.f}, {a1.w, a2.w, a3.w, 1.f}} {}
 
         // + operator
         Matrix4 operator+(const Matrix4 &n) const {
@@ -126,17 +122,6 @@ class Matrix4 {
             return *this;
         }
 
-        // = operator
-        Matrix4& operator=(const Matrix4& matrix) {
-            if (&matrix != this) {
-                setAllValues(matrix.m[0][0], matrix.m[0][1], matrix.m[0][2], matrix.m[0][3],
-                             matrix.m[1][0], matrix.m[1][1], matrix.m[1][2], matrix.m[1][3],
-                             matrix.m[2][0], matrix.m[2][1], matrix.m[2][2], matrix.m[2][3],
-                             matrix.m[3][0], matrix.m[3][1], matrix.m[3][2], matrix.m[3][3]);
-            }
-            return *this;
-        }
-
         // == operator
         bool operator==(const Matrix4 &n) const {
             return m[0][0]==n.m[0][0] && m[0][1]==n.m[0][1] && m[0][2]==n.m[0][2] && m[0][3]==n.m[0][3] &&
@@ -148,6 +133,45 @@ class Matrix4 {
         // * operator
         Matrix4 operator*(const Matrix4 &n) const {
             Matrix4 o;
+#if defined(MATRIX4_USE_AVX)
+            // Compute two rows of the result at a time
+            const __m256 n0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(n.m[0]));
+            const __m256 n1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(n.m[1]));
+            const __m256 n2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(n.m[2]));
+            const __m256 n3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(n.m[3]));
+            for (int i = 0; i < 4; i += 2) {
+                __m256 a = _mm256_loadu_ps(m[i]);
+                __m256 v = _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0x00), n0);
+                v = _mm256_add_ps(v, _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0x55), n1));
+                v = _mm256_add_ps(v, _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0xAA), n2));
+                v = _mm256_add_ps(v, _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0xFF), n3));
+                _mm256_storeu_ps(o.m[i], v);
+            }
+#elif defined(MATRIX4_USE_SSE)
+            const __m128 n0 = _mm_loadu_ps(n.m[0]);
+            const __m128 n1 = _mm_loadu_ps(n.m[1]);
+            const __m128 n2 = _mm_loadu_ps(n.m[2]);
+            const __m128 n3 = _mm_loadu_ps(n.m[3]);
+            for (int i = 0; i < 4; i++) {
+                __m128 v = _mm_mul_ps(_mm_set1_ps(m[i][0]), n0);
+                v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(m[i][1]), n1));
+                v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(m[i][2]), n2));
+                v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(m[i][3]), n3));
+                _mm_storeu_ps(o.m[i], v);
+            }
+#elif defined(MATRIX4_USE_NEON)
+            const float32x4_t n0 = vld1q_f32(n.m[0]);
+            const float32x4_t n1 = vld1q_f32(n.m[1]);
+            const float32x4_t n2 = vld1q_f32(n.m[2]);
+            const float32x4_t n3 = vld1q_f32(n.m[3]);
+            for (int i = 0; i < 4; i++) {
+                float32x4_t v = vmulq_n_f32(n0, m[i][0]);
+                v = vaddq_f32(v, vmulq_n_f32(n1, m[i][1]));
+                v = vaddq_f32(v, vmulq_n_f32(n2, m[i][2]));
+                v = vaddq_f32(v, vmulq_n_f32(n3, m[i][3]));
+                vst1q_f32(o.m[i], v);
+            }
+#else
             for(int i = 0; i  < 4; i++) {
                 for(int j = 0; j < 4; j++) {
                     float v = 0;
@@ -157,30 +181,56 @@ class Matrix4 {
                     o.m[i][j] = v;
                 }
             }
+#endif
             return o;
         }
 
         // * operator
         Vector3 operator*(const Vector3 &v) const {
-            Vector3 u =Vector3(m[0][0]*v.x + m[0][1]*v.y + m[0][2]*v.z + m[0][3],
-                               m[1][0]*v.x + m[1][1]*v.y + m[1][2]*v.z + m[1][3],
-                               m[2][0]*v.x + m[2][1]*v.y + m[2][2]*v.z + m[2][3]);
-            float w = m[3][0]*v.x + m[3][1]*v.y + m[3][2]*v.z + m[3][3];
-            return u/w;
+            Vector4 u = transform(Vector4(v.x, v.y, v.z, 1.f));
+            return Vector3(u.x, u.y, u.z) / u.w;
         }
 
         // * operator
         Vector4 operator*(const Vector4 &v) const {
-            Vector4 u = Vector4(m[0][0]*v.x + m[0][1]*v.y + m[0][2]*v.z + v.w*m[0][3],
-                                m[1][0]*v.x + m[1][1]*v.y + m[1][2]*v.z + v.w*m[1][3],
-                                m[2][0]*v.x + m[2][1]*v.y + m[2][2]*v.z + v.w*m[2][3],
-                                m[3][0]*v.x + m[3][1]*v.y + m[3][2]*v.z + v.w*m[3][3]);
+            Vector4 u = transform(v);
             if(u.w != 0)
                 return u/u.w;
             else
                 return u;
         }
 
+        // Return the product of the matrix with a 4D vector (without the division by w)
+        Vector4 transform(const Vector4 &v) const {
+            Vector4 u;
+#if defined(MATRIX4_USE_SSE)
+            // Multiply the columns of the matrix by the components of the vector
+            __m128 c0 = _mm_loadu_ps(m[0]);
+            __m128 c1 = _mm_loadu_ps(m[1]);
+            __m128 c2 = _mm_loadu_ps(m[2]);
+            __m128 c3 = _mm_loadu_ps(m[3]);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            __m128 r = _mm_mul_ps(c0, _mm_set1_ps(v.x));
+            r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(v.y)));
+            r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(v.z)));
+            r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_set1_ps(v.w)));
+            _mm_storeu_ps(&u.x, r);
+#elif defined(MATRIX4_USE_NEON)
+            float32x4x4_t c = vld4q_f32(m[0]);
+            float32x4_t r = vmulq_n_f32(c.val[0], v.x);
+            r = vaddq_f32(r, vmulq_n_f32(c.val[1], v.y));
+            r = vaddq_f32(r, vmulq_n_f32(c.val[2], v.z));
+            r = vaddq_f32(r, vmulq_n_f32(c.val[3], v.w));
+            vst1q_f32(&u.x, r);
+#else
+            u = Vector4(m[0][0]*v.x + m[0][1]*v.y + m[0][2]*v.z + v.w*m[0][3],
+                        m[1][0]*v.x + m[1][1]*v.y + m[1][2]*v.z + v.w*m[1][3],
+                        m[2][0]*v.x + m[2][1]*v.y + m[2][2]*v.z + v.w*m[2][3],
+                        m[3][0]*v.x + m[3][1]*v.y + m[3][2]*v.z + v.w*m[3][3]);
+#endif
+            return u;
+        }
+
         // * operator
         Matrix4 operator*(float f) const {
             return Matrix4(m[0][0]*f, m[0][1]*f, m[0][2]*f,  m[0][3]*f,
@@ -311,6 +361,60 @@ class Matrix4 {
             return Matrix4(minv);
         }
 
+        // Return the inverse of an affine matrix (the last row must be [0 0 0 1])
+        Matrix4 getAffineInverse() const {
+            assert(m[3][0] == 0.f && m[3][1] == 0.f && m[3][2] == 0.f && m[3][3] == 1.f);
+
+            // Inverse of the upper 3x3 matrix with the cofactors
+            float c00 = m[1][1]*m[2][2] - m[1][2]*m[2][1];
+            float c01 = m[1][2]*m[2][0] - m[1][0]*m[2][2];
+            float c02 = m[1][0]*m[2][1] - m[1][1]*m[2][0];
+            float determinant = m[0][0]*c00 + m[0][1]*c01 + m[0][2]*c02;
+            assert(determinant != 0.f);
+            float inv = 1.f / determinant;
+            Matrix4 o(c00 * inv, (m[0][2]*m[2][1] - m[0][1]*m[2][2]) * inv,
+                      (m[0][1]*m[1][2] - m[0][2]*m[1][1]) * inv, 0.f,
+                      c01 * inv, (m[0][0]*m[2][2] - m[0][2]*m[2][0]) * inv,
+                      (m[0][2]*m[1][0] - m[0][0]*m[1][2]) * inv, 0.f,
+                      c02 * inv, (m[0][1]*m[2][0] - m[0][0]*m[2][1]) * inv,
+                      (m[0][0]*m[1][1] - m[0][1]*m[1][0]) * inv, 0.f,
+                      0.f, 0.f, 0.f, 1.f);
+
+            // Inverse translation
+            for (int i = 0; i < 3; i++) {
+                o.m[i][3] = -(o.m[i][0]*m[0][3] + o.m[i][1]*m[1][3] + o.m[i][2]*m[2][3]);
+            }
+            return o;
+        }
+
+        // Return true if the upper-left 3x3 matrix is orthonormal (up to a tolerance)
+        bool isOrthonormal3x3(float tolerance = 1e-4f) const {
+            for (int i=0; i<3; i++) {
+                for (int j=i; j<3; j++) {
+                    float dot = m[i][0]*m[j][0] + m[i][1]*m[j][1] + m[i][2]*m[j][2];
+                    if (fabs(dot - (i == j ? 1.f : 0.f)) > tolerance) return false;
+                }
+            }
+            return true;
+        }
+
+        // Return the inverse of a rigid transform matrix (a rotation and a translation).
+        // The upper-left 3x3 matrix must be orthonormal.
+        Matrix4 getRigidInverse() const {
+            assert(m[3][0] == 0.f && m[3][1] == 0.f && m[3][2] == 0.f && m[3][3] == 1.f);
+            assert(isOrthonormal3x3());
+
+            // The inverse rotation is the transpose and the inverse translation is the
+            // opposite of the translation rotated by the inverse rotation
+            return Matrix4(m[0][0], m[1][0], m[2][0],
+                           -(m[0][0]*m[0][3] + m[1][0]*m[1][3] + m[2][0]*m[2][3]),
+                           m[0][1], m[1][1], m[2][1],
+                           -(m[0][1]*m[0][3] + m[1][1]*m[1][3] + m[2][1]*m[2][3]),
+                           m[0][2], m[1][2], m[2][2],
+                           -(m[0][2]*m[0][3] + m[1][2]*m[1][3] + m[2][2]*m[2][3]),
+                           0.f, 0.f, 0.f, 1.f);
+        }
+
         // Method to set all the values in the matrix
         void setAllValues(float a1, float a2, float a3, float a4,
                           float b1, float b2, float b3, float b4,
@@ -363,10 +467,16 @@ class Matrix4 {
             return (m[0][0] + m[1][1] + m[2][2] + m[3][3]);
         }
 
+        // Return the identity matrix
+        static constexpr Matrix4 identity();
+
         // Return a 4x4 translation matrix
-        static Matrix4 translationMatrix(const Vector3& v);
+        static constexpr Matrix4 translationMatrix(const Vector3& v);
+
+        // Return a 4x4 scaling matrix
+        static constexpr Matrix4 scaleMatrix(const Vector3& s);
 
-        // Return a 4x4 rotation matrix
+        // Return a 4x4 rotation matrix (the axis does not need to be normalized)
         static Matrix4 rotationMatrix(const Vector3& axis, float angle);
 };
 
@@ -375,14 +485,30 @@ inline Matrix4 operator*(float f, const Matrix4 & m) {
 	return (m * f);
 }
 
+// Return the identity matrix
+inline constexpr Matrix4 Matrix4::identity() {
+    return Matrix4(1, 0, 0, 0,
+                   0, 1, 0, 0,
+                   0, 0, 1, 0,
+                   0, 0, 0, 1);
+}
+
 // Return a 4x4 translation matrix
-inline Matrix4 Matrix4::translationMatrix(const Vector3& v) {
+inline constexpr Matrix4 Matrix4::translationMatrix(const Vector3& v) {
     return Matrix4(1, 0, 0, v.x,
                    0, 1, 0, v.y,
                    0, 0, 1, v.z,
                    0, 0, 0, 1);
 }
 
+// Return a 4x4 scaling matrix
+inline constexpr Matrix4 Matrix4::scaleMatrix(const Vector3& s) {
+    return Matrix4(s.x, 0, 0, 0,
+                   0, s.y, 0, 0,
+                   0, 0, s.z, 0,
+                   0, 0, 0, 1);
+}
+
 // Return a 4x4 rotation matrix
 inline Matrix4 Matrix4::rotationMatrix(const Vector3& axis, float angle) {
 
@@ -391,19 +517,22 @@ inline Matrix4 Matrix4::rotationMatrix(const Vector3& axis, float angle) {
     Matrix4 rotationMatrix;
     rotationMatrix.setToIdentity();
 
-    rotationMatrix.m[0][0] = cosA + (1-cosA) * axis.x * axis.x;
-    rotationMatrix.m[0][1] = (1-cosA) * axis.x * axis.y - axis.z * sinA;
-    rotationMatrix.m[0][2] = (1-cosA) * axis.x * axis.z + axis.y * sinA;
+    // Unit axis (the matrix is orthonormal only if the axis is normalized)
+    const Vector3 u = Vector3(axis).normalize();
+
+    rotationMatrix.m[0][0] = cosA + (1-cosA) * u.x * u.x;
+    rotationMatrix.m[0][1] = (1-cosA) * u.x * u.y - u.z * sinA;
+    rotationMatrix.m[0][2] = (1-cosA) * u.x * u.z + u.y * sinA;
     rotationMatrix.m[0][3] = 0.f;
 
-    rotationMatrix.m[1][0] = (1-cosA) * axis.x * axis.y + axis.z * sinA;
-    rotationMatrix.m[1][1] = cosA + (1-cosA) * axis.y * axis.y;
-    rotationMatrix.m[1][2] = (1-cosA) * axis.y * axis.z - axis.x * sinA;
+    rotationMatrix.m[1][0] = (1-cosA) * u.x * u.y + u.z * sinA;
+    rotationMatrix.m[1][1] = cosA + (1-cosA) * u.y * u.y;
+    rotationMatrix.m[1][2] = (1-cosA) * u.y * u.z - u.x * sinA;
     rotationMatrix.m[1][3] = 0.f;
 
-    rotationMatrix.m[2][0] = (1-cosA) * axis.x * axis.z - axis.y * sinA;
-    rotationMatrix.m[2][1] = (1-cosA) * axis.y * axis.z + axis.x * sinA;
-    rotationMatrix.m[2][2] = cosA + (1-cosA) * axis.z * axis.z;
+    rotationMatrix.m[2][0] = (1-cosA) * u.x * u.z - u.y * sinA;
+    rotationMatrix.m[2][1] = (1-cosA) * u.y * u.z + u.x * sinA;
+    rotationMatrix.m[2][2] = cosA + (1-cosA) * u.z * u.z;
     rotationMatrix.m[2][3] = 0.f;
 
     rotationMatrix.m[3][0] = 0.f;
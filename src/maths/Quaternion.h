@@ -0,0 +1,364 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef QUATERNION_H
+#define QUATERNION_H
+
+// Libraries
+#include <math.h>
+#include <assert.h>
+#include "Vector3.h"
+#include "Matrix4.h"
+
+namespace openglframework {
+
+// Class Quaternion
+// This class represents a quaternion (x, y, z, w) where (x, y, z) is the vector part
+// and w is the scalar part. A unit quaternion represents a rotation. It is aligned on
+// 16 bytes so that it can be loaded into a SIMD register, and arrays of quaternions
+// can be multiplied or normalized four at a time with SSE.
+class alignas(16) Quaternion {
+
+    public:
+
+        // -------------------- Attributes -------------------- //
+
+        // Components of the quaternion
+        float x, y, z, w;
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor (identity rotation)
+        constexpr Quaternion(float x=0, float y=0, float z=0, float w=1) : x(x), y(y), z(z), w(w) {}
+
+        // Constructor from a vector part and a scalar part
+        constexpr Quaternion(const Vector3& v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
+
+        // Constructor from a rotation matrix (the upper-left 3x3 part of the matrix
+        // must be a rotation)
+        explicit Quaternion(const Matrix4& matrix);
+
+        // + operator
+        Quaternion operator+(const Quaternion& q) const {
+            return Quaternion(x + q.x, y + q.y, z + q.z, w + q.w);
+        }
+
+        // - operator
+        Quaternion operator-(const Quaternion& q) const {
+            return Quaternion(x - q.x, y - q.y, z - q.z, w - q.w);
+        }
+
+        // - operator
+        Quaternion operator-() const {
+            return Quaternion(-x, -y, -z, -w);
+        }
+
+        // * operator
+        Quaternion operator*(float f) const {
+            return Quaternion(f*x, f*y, f*z, f*w);
+        }
+
+        // * operator (composition of the rotations, q is applied first)
+        Quaternion operator*(const Quaternion& q) const {
+            return Quaternion(w*q.x + x*q.w + y*q.z - z*q.y,
+                              w*q.y - x*q.z + y*q.w + z*q.x,
+                              w*q.z + x*q.y - y*q.x + z*q.w,
+                              w*q.w - x*q.x - y*q.y - z*q.z);
+        }
+
+        // *= operator
+        Quaternion& operator*=(const Quaternion& q) {
+            *this = *this * q;
+            return *this;
+        }
+
+        // * operator (rotation of a vector by a unit quaternion)
+        Vector3 operator*(const Vector3& v) const {
+            Vector3 u(x, y, z);
+            Vector3 t = u.cross(v) * 2.f;
+            return v + t * w + u.cross(t);
+        }
+
+        // == operator
+        bool operator==(const Quaternion& q) const {
+            return x == q.x && y == q.y && z == q.z && w == q.w;
+        }
+
+        // != operator
+        bool operator!=(const Quaternion& q) const {
+            return !(*this == q);
+        }
+
+        // Return the vector part of the quaternion
+        Vector3 getVectorPart() const {
+            return Vector3(x, y, z);
+        }
+
+        // Dot product operator
+        float dot(const Quaternion& q) const {
+            return x*q.x + y*q.y + z*q.z + w*q.w;
+        }
+
+        // Return the squared length of the quaternion
+        float lengthSquared() const { return x*x + y*y + z*z + w*w; }
+
+        // Return the length of the quaternion
+        float length() const { return sqrt(lengthSquared()); }
+
+        // Normalize the quaternion
+        void normalize() {
+            float l = length();
+            assert(l > std::numeric_limits<float>::epsilon());
+            float inv = 1.f / l;
+            x *= inv; y *= inv; z *= inv; w *= inv;
+        }
+
+        // Return the corresponding unit quaternion
+        Quaternion getUnit() const {
+            Quaternion q(*this);
+            q.normalize();
+            return q;
+        }
+
+        // Return the conjugate of the quaternion
+        Quaternion getConjugate() const {
+            return Quaternion(-x, -y, -z, w);
+        }
+
+        // Return the inverse of the quaternion
+        Quaternion getInverse() const {
+            float l2 = lengthSquared();
+            assert(l2 > std::numeric_limits<float>::epsilon());
+            return getConjugate() * (1.f / l2);
+        }
+
+        // Return the 4x4 rotation matrix of a unit quaternion
+        Matrix4 getMatrix4() const;
+
+        // Return the rotation axis and the rotation angle of a unit quaternion
+        void getRotationAngleAxis(float& angle, Vector3& axis) const;
+
+        // Return a unit quaternion that represents a rotation around a unit axis
+        static Quaternion rotationQuaternion(const Vector3& axis, float angle);
+
+        // Return the identity quaternion
+        static constexpr Quaternion identity();
+
+        // Return the normalized linear interpolation between two unit quaternions
+        static Quaternion nlerp(const Quaternion& q1, const Quaternion& q2, float t);
+
+        // Return the spherical linear interpolation between two unit quaternions
+        static Quaternion slerp(const Quaternion& q1, const Quaternion& q2, float t);
+
+        // Compute the products q1[i] * q2[i] of two arrays of quaternions
+        static void multiply(const Quaternion* q1, const Quaternion* q2,
+                             Quaternion* results, int nbQuaternions);
+
+        // Normalize an array of quaternions
+        static void normalize(Quaternion* quaternions, int nbQuaternions);
+};
+
+// * operator
+inline Quaternion operator*(float f, const Quaternion& q) {
+    return q * f;
+}
+
+// Constructor from a rotation matrix (the upper-left 3x3 part of the matrix
+// must be a rotation)
+inline Quaternion::Quaternion(const Matrix4& matrix) {
+
+    // Use the largest of the diagonal terms to avoid a division by a small number
+    float trace = matrix.m[0][0] + matrix.m[1][1] + matrix.m[2][2];
+    if (trace > 0.f) {
+        float s = 0.5f / sqrt(trace + 1.f);
+        w = 0.25f / s;
+        x = (matrix.m[2][1] - matrix.m[1][2]) * s;
+        y = (matrix.m[0][2] - matrix.m[2][0]) * s;
+        z = (matrix.m[1][0] - matrix.m[0][1]) * s;
+    }
+    else if (matrix.m[0][0] > matrix.m[1][1] && matrix.m[0][0] > matrix.m[2][2]) {
+        float s = 0.5f / sqrt(1.f + matrix.m[0][0] - matrix.m[1][1] - matrix.m[2][2]);
+        w = (matrix.m[2][1] - matrix.m[1][2]) * s;
+        x = 0.25f / s;
+        y = (matrix.m[0][1] + matrix.m[1][0]) * s;
+        z = (matrix.m[0][2] + matrix.m[2][0]) * s;
+    }
+    else if (matrix.m[1][1] > matrix.m[2][2]) {
+        float s = 0.5f / sqrt(1.f + matrix.m[1][1] - matrix.m[0][0] - matrix.m[2][2]);
+        w = (matrix.m[0][2] - matrix.m[2][0]) * s;
+        x = (matrix.m[0][1] + matrix.m[1][0]) * s;
+        y = 0.25f / s;
+        z = (matrix.m[1][2] + matrix.m[2][1]) * s;
+    }
+    else {
+        float s = 0.5f / sqrt(1.f + matrix.m[2][2] - matrix.m[0][0] - matrix.m[1][1]);
+        w = (matrix.m[1][0] - matrix.m[0][1]) * s;
+        x = (matrix.m[0][2] + matrix.m[2][0]) * s;
+        y = (matrix.m[1][2] + matrix.m[2][1]) * s;
+        z = 0.25f / s;
+    }
+}
+
+// Return the 4x4 rotation matrix of a unit quaternion
+inline Matrix4 Quaternion::getMatrix4() const {
+    float xx = x*x, yy = y*y, zz = z*z;
+    float xy = x*y, xz = x*z, yz = y*z;
+    float wx = w*x, wy = w*y, wz = w*z;
+    return Matrix4(1.f - 2.f*(yy + zz), 2.f*(xy - wz), 2.f*(xz + wy), 0.f,
+                   2.f*(xy + wz), 1.f - 2.f*(xx + zz), 2.f*(yz - wx), 0.f,
+                   2.f*(xz - wy), 2.f*(yz + wx), 1.f - 2.f*(xx + yy), 0.f,
+                   0.f, 0.f, 0.f, 1.f);
+}
+
+// Return the rotation axis and the rotation angle of a unit quaternion
+inline void Quaternion::getRotationAngleAxis(float& angle, Vector3& axis) const {
+    float cosHalfAngle = w > 1.f ? 1.f : (w < -1.f ? -1.f : w);
+    angle = 2.f * acos(cosHalfAngle);
+    float sinHalfAngle = sqrt(1.f - cosHalfAngle * cosHalfAngle);
+    if (sinHalfAngle < std::numeric_limits<float>::epsilon()) {
+        axis = Vector3(1, 0, 0);
+    }
+    else {
+        axis = Vector3(x, y, z) / sinHalfAngle;
+    }
+}
+
+// Return a unit quaternion that represents a rotation around a unit axis
+inline Quaternion Quaternion::rotationQuaternion(const Vector3& axis, float angle) {
+    float halfAngle = 0.5f * angle;
+    return Quaternion(axis * sin(halfAngle), cos(halfAngle));
+}
+
+// Return the identity quaternion
+inline constexpr Quaternion Quaternion::identity() {
+    return Quaternion(0, 0, 0, 1);
+}
+
+// Return the normalized linear interpolation between two unit quaternions
+inline Quaternion Quaternion::nlerp(const Quaternion& q1, const Quaternion& q2, float t) {
+
+    // Interpolate along the shortest path
+    float s = q1.dot(q2) < 0.f ? -t : t;
+    Quaternion q = q1 * (1.f - t) + q2 * s;
+    q.normalize();
+    return q;
+}
+
+// Return the spherical linear interpolation between two unit quaternions
+inline Quaternion Quaternion::slerp(const Quaternion& q1, const Quaternion& q2, float t) {
+
+    // Interpolate along the shortest path
+    float cosTheta = q1.dot(q2);
+    float sign = 1.f;
+    if (cosTheta < 0.f) {
+        cosTheta = -cosTheta;
+        sign = -1.f;
+    }
+
+    // If the quaternions are very close, use a linear interpolation to
+    // avoid the division by a small sine
+    if (cosTheta > 0.9995f) {
+        return nlerp(q1, q2, t);
+    }
+
+    float theta = acos(cosTheta);
+    float invSinTheta = 1.f / sin(theta);
+    float coeff1 = sin((1.f - t) * theta) * invSinTheta;
+    float coeff2 = sign * sin(t * theta) * invSinTheta;
+    return q1 * coeff1 + q2 * coeff2;
+}
+
+// Compute the products q1[i] * q2[i] of two arrays of quaternions
+inline void Quaternion::multiply(const Quaternion* q1, const Quaternion* q2,
+                                 Quaternion* results, int nbQuaternions) {
+    int i = 0;
+#if defined(MATRIX4_USE_SSE)
+    // Transpose four quaternions at a time so that each register contains
+    // the same component of the four quaternions
+    for (; i + 4 <= nbQuaternions; i += 4) {
+        __m128 x1 = _mm_loadu_ps(&q1[i].x);
+        __m128 y1 = _mm_loadu_ps(&q1[i+1].x);
+        __m128 z1 = _mm_loadu_ps(&q1[i+2].x);
+        __m128 w1 = _mm_loadu_ps(&q1[i+3].x);
+        _MM_TRANSPOSE4_PS(x1, y1, z1, w1);
+        __m128 x2 = _mm_loadu_ps(&q2[i].x);
+        __m128 y2 = _mm_loadu_ps(&q2[i+1].x);
+        __m128 z2 = _mm_loadu_ps(&q2[i+2].x);
+        __m128 w2 = _mm_loadu_ps(&q2[i+3].x);
+        _MM_TRANSPOSE4_PS(x2, y2, z2, w2);
+
+        // The terms are accumulated in the same order as the scalar product
+        __m128 x = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(w1, x2), _mm_mul_ps(x1, w2)),
+                                         _mm_mul_ps(y1, z2)), _mm_mul_ps(z1, y2));
+        __m128 y = _mm_add_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(w1, y2), _mm_mul_ps(x1, z2)),
+                                         _mm_mul_ps(y1, w2)), _mm_mul_ps(z1, x2));
+        __m128 z = _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(w1, z2), _mm_mul_ps(x1, y2)),
+                                         _mm_mul_ps(y1, x2)), _mm_mul_ps(z1, w2));
+        __m128 w = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(w1, w2), _mm_mul_ps(x1, x2)),
+                                         _mm_mul_ps(y1, y2)), _mm_mul_ps(z1, z2));
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(&results[i].x, x);
+        _mm_storeu_ps(&results[i+1].x, y);
+        _mm_storeu_ps(&results[i+2].x, z);
+        _mm_storeu_ps(&results[i+3].x, w);
+    }
+#endif
+    for (; i < nbQuaternions; i++) {
+        results[i] = q1[i] * q2[i];
+    }
+}
+
+// Normalize an array of quaternions
+inline void Quaternion::normalize(Quaternion* quaternions, int nbQuaternions) {
+    int i = 0;
+#if defined(MATRIX4_USE_SSE)
+    for (; i + 4 <= nbQuaternions; i += 4) {
+        __m128 x = _mm_loadu_ps(&quaternions[i].x);
+        __m128 y = _mm_loadu_ps(&quaternions[i+1].x);
+        __m128 z = _mm_loadu_ps(&quaternions[i+2].x);
+        __m128 w = _mm_loadu_ps(&quaternions[i+3].x);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        __m128 l2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                               _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w)));
+        __m128 inv = _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(l2));
+        x = _mm_mul_ps(x, inv);
+        y = _mm_mul_ps(y, inv);
+        z = _mm_mul_ps(z, inv);
+        w = _mm_mul_ps(w, inv);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(&quaternions[i].x, x);
+        _mm_storeu_ps(&quaternions[i+1].x, y);
+        _mm_storeu_ps(&quaternions[i+2].x, z);
+        _mm_storeu_ps(&quaternions[i+3].x, w);
+    }
+#endif
+    for (; i < nbQuaternions; i++) {
+        quaternions[i].normalize();
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,123 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+#ifndef RAY_H
+#define RAY_H
+
+// Libraries
+#include <limits>
+#include "Vector3.h"
+
+namespace openglframework {
+
+// Class Ray
+// This class represents a ray (or a segment if the maximum distance is finite)
+class Ray {
+
+    public:
+
+        // -------------------- Attributes -------------------- //
+
+        // Origin of the ray
+        Vector3 origin;
+
+        // Direction of the ray (does not need to be normalized, the distances
+        // along the ray are expressed in multiples of its length)
+        Vector3 direction;
+
+        // Maximum distance along the ray
+        float maxDistance;
+
+        // -------------------- Methods -------------------- //
+
+        // Constructor
+        Ray(const Vector3& origin = Vector3(0, 0, 0), const Vector3& direction = Vector3(0, 0, 1),
+            float maxDistance = std::numeric_limits<float>::max())
+            : origin(origin), direction(direction), maxDistance(maxDistance) {}
+
+        // Return the point at a given distance along the ray
+        Vector3 getPoint(float distance) const {
+            return origin + direction * distance;
+        }
+};
+
+// Class RayPacket
+// This class represents a packet of four rays stored as structure of arrays so
+// that they can be traversed together with SIMD instructions. A ray with a
+// negative maximum distance is inactive.
+class RayPacket {
+
+    public:
+
+        // -------------------- Constants -------------------- //
+
+        // Number of rays in a packet
+        static const int SIZE = 4;
+
+        // -------------------- Attributes -------------------- //
+
+        // Origins of the rays
+        float originX[SIZE], originY[SIZE], originZ[SIZE];
+
+        // Directions of the rays
+        float directionX[SIZE], directionY[SIZE], directionZ[SIZE];
+
+        // Maximum distances along the rays
+        float maxDistance[SIZE];
+
+        // -------------------- Methods -------------------- //
+
+        // Set a ray of the packet
+        void setRay(int i, const Ray& ray) {
+            originX[i] = ray.origin.x;
+            originY[i] = ray.origin.y;
+            originZ[i] = ray.origin.z;
+            directionX[i] = ray.direction.x;
+            directionY[i] = ray.direction.y;
+            directionZ[i] = ray.direction.z;
+            maxDistance[i] = ray.maxDistance;
+        }
+
+        // Disable a ray of the packet
+        void disableRay(int i) {
+            setRay(i, Ray());
+            maxDistance[i] = -1.0f;
+        }
+
+        // Return a ray of the packet
+        Ray getRay(int i) const {
+            return Ray(Vector3(originX[i], originY[i], originZ[i]),
+                       Vector3(directionX[i], directionY[i], directionZ[i]), maxDistance[i]);
+        }
+
+        // Return true if a ray of the packet is active
+        bool isRayActive(int i) const {
+            return maxDistance[i] >= 0.0f;
+        }
+};
+
+}
+
+#endif
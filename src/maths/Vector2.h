@@ -47,10 +47,7 @@ class Vector2 {
         // -------------------- Methods -------------------- //
 
         // Constructor
-        Vector2(float x=0, float y=0) : x(x), y(y) {}
-
-        // Constructor
-        Vector2(const Vector2& vector) : x(vector.x), y(vector.y) {}
+        constexpr Vector2(float x=0, float y=0) : x(x), y(y) {}
 
         // + operator
         Vector2 operator+(const Vector2 &v) const {
@@ -74,15 +71,6 @@ class Vector2 {
             return *this;
         }
 
-        // = operator
-        Vector2& operator=(const Vector2& vector) {
-            if (&vector != this) {
-                x = vector.x;
-                y = vector.y;
-            }
-            return *this;
-        }
-
         // == operator
         bool operator==(const Vector2 &v) const {
             return x == v.x && y == v.y;
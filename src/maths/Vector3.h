@@ -30,6 +30,7 @@
 #include <cmath>
 #include <cassert>
 #include <limits>
+#include "FastMath.h"
 
 namespace openglframework {
 
@@ -47,23 +48,7 @@ class Vector3 {
         // -------------------- Methods -------------------- //
 
         // Constructor
-        Vector3(float x=0, float y=0, float z=0) : x(x), y(y), z(z) {}
-
-        // Constructor
-        Vector3(const Vector3& vector) : x(vector.x), y(vector.y), z(vector.z) {}
-
-        // Constructor
-        ~Vector3() {}
-
-        // = operator
-        Vector3& operator=(const Vector3& vector) {
-            if (&vector != this) {
-                x = vector.x;
-                y = vector.y;
-                z = vector.z;
-            }
-            return *this;
-        }
+        constexpr Vector3(float x=0, float y=0, float z=0) : x(x), y(y), z(z) {}
 
         // + operator
         Vector3 operator+(const Vector3 &v) const {
@@ -172,6 +157,10 @@ class Vector3 {
             return *this;
         }
 
+        // Normalize an array of vectors (they must not be null). The groups of four
+        // vectors are normalized with SSE.
+        static void normalize(Vector3* vectors, int nbVectors);
+
         bool isNull() const {
           return( x == 0. && y == 0. && z == 0. );
         }
@@ -198,6 +187,46 @@ inline Vector3 operator*(float f, const Vector3 & o) {
   return o*f;
 }
 
+// Normalize an array of vectors (they must not be null)
+inline void Vector3::normalize(Vector3* vectors, int nbVectors) {
+
+    int i = 0;
+#if defined(FAST_MATH_USE_SSE)
+    // Four vectors at a time (x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3)
+    for (; i + 4 <= nbVectors; i += 4) {
+        float* p = &vectors[i].x;
+        __m128 a = _mm_loadu_ps(p);
+        __m128 b = _mm_loadu_ps(p + 4);
+        __m128 c = _mm_loadu_ps(p + 8);
+        __m128 vx = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)),
+                                   _MM_SHUFFLE(2, 0, 3, 0));
+        __m128 vy = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+                                   _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)),
+                                   _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 vz = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c,
+                                   _MM_SHUFFLE(3, 0, 2, 0));
+        __m128 l2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)),
+                               _mm_mul_ps(vz, vz));
+        __m128 l = _mm_sqrt_ps(l2);
+        vx = _mm_div_ps(vx, l);
+        vy = _mm_div_ps(vy, l);
+        vz = _mm_div_ps(vz, l);
+        _mm_storeu_ps(p, _mm_shuffle_ps(_mm_shuffle_ps(vx, vy, _MM_SHUFFLE(0, 0, 0, 0)),
+                                        _mm_shuffle_ps(vz, vx, _MM_SHUFFLE(1, 1, 0, 0)),
+                                        _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(p + 4, _mm_shuffle_ps(_mm_shuffle_ps(vy, vz, _MM_SHUFFLE(1, 1, 1, 1)),
+                                            _mm_shuffle_ps(vx, vy, _MM_SHUFFLE(2, 2, 2, 2)),
+                                            _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(p + 8, _mm_shuffle_ps(_mm_shuffle_ps(vz, vx, _MM_SHUFFLE(3, 3, 2, 2)),
+                                            _mm_shuffle_ps(vy, vz, _MM_SHUFFLE(3, 3, 3, 3)),
+                                            _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+#endif
+    for (; i < nbVectors; i++) {
+        vectors[i].normalize();
+    }
+}
+
 }
 
 #endif
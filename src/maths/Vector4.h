@@ -33,8 +33,9 @@
 namespace openglframework {
 
 // Class Vector4
-// This class represents a 4D vector.
-class Vector4 {
+// This class represents a 4D vector. It is aligned on 16 bytes so that it can be
+// loaded into a SIMD register.
+class alignas(16) Vector4 {
 
     public:
 
@@ -46,10 +47,7 @@ class Vector4 {
         // -------------------- Methods -------------------- //
 
         // Constructor
-        Vector4(float x=0, float y=0, float z=0, float w=0) : x(x), y(y), z(z), w(w) {}
-
-        // Constructor
-        Vector4(const Vector4& vector) : x(vector.x), y(vector.y), z(vector.z), w(vector.w) {}
+        constexpr Vector4(float x=0, float y=0, float z=0, float w=0) : x(x), y(y), z(z), w(w) {}
 
         // + operator
         Vector4 operator+(const Vector4 &v) const {
@@ -73,17 +71,6 @@ class Vector4 {
             return *this;
         }
 
-        // = operator
-        Vector4& operator=(const Vector4& vector) {
-            if (&vector != this) {
-                x = vector.x;
-                y = vector.y;
-                z = vector.z;
-                w = vector.w;
-            }
-            return *this;
-        }
-
         // == operator
         bool operator==(const Vector4 &v) const {
             return x == v.x && y == v.y && z == v.z && w == v.w;
@@ -33,16 +33,39 @@
 #include "Camera.h"
 #include "Light.h"
 #include "Mesh.h"
+#include "MeshGeometry.h"
+#include "HalfEdgeMesh.h"
+#include "MeshCleaner.h"
+#include "LoopSubdivision.h"
+#include "MeshBVH.h"
+#include "MeshDistance.h"
+#include "KdTree.h"
+#include "NormalEstimation.h"
+#include "ConvexHull.h"
+#include "MeshCollision.h"
+#include "BatchTransform.h"
+#include "FormatConversion.h"
+#include "RayTracer.h"
+#include "DynamicAABBTree.h"
+#include "FrustumCulling.h"
+#include "OcclusionCuller.h"
 #include "Shader.h"
 #include "Texture2D.h"
 #include "FrameBufferObject.h"
 #include "Shader.h"
+#include "maths/FastMath.h"
 #include "maths/Color.h"
 #include "maths/Vector2.h"
 #include "maths/Vector3.h"
 #include "maths/Vector4.h"
 #include "maths/Matrix4.h"
+#include "maths/ColumnMajorMatrix4.h"
 #include "maths/Matrix3.h"
+#include "maths/Quaternion.h"
+#include "maths/AABB.h"
+#include "maths/BoundingSphere.h"
+#include "maths/Ray.h"
+#include "maths/Frustum.h"
 #include "definitions.h"
 
 #endif
@@ -0,0 +1,217 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <cfloat>
+#include <vector>
+#include <map>
+#include "openglframework.h"
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Return a random number between -1 and 1
+float getRandomNumber() {
+    return rand() / float(RAND_MAX) * 2.0f - 1.0f;
+}
+
+// Return a random point on a sphere
+Vector3 getRandomPointOnSphere(float radius) {
+    Vector3 point;
+    do {
+        point = Vector3(getRandomNumber(), getRandomNumber(), getRandomNumber());
+    } while (point.lengthSquared() > 1.0f || point.lengthSquared() < 0.01f);
+    point.normalize();
+    return point * radius;
+}
+
+// Return the tolerance of the hull of a set of points (as used by the convex hull)
+double computeTolerance(const vector<Vector3>& points) {
+    Vector3 maxCoordinates(0, 0, 0);
+    for (uint i=0; i<points.size(); i++) {
+        for (int axis=0; axis<3; axis++) {
+            maxCoordinates[axis] = std::max(maxCoordinates[axis], std::fabs(points[i][axis]));
+        }
+    }
+    return 3.0 * FLT_EPSILON * (double(maxCoordinates.x) + maxCoordinates.y + maxCoordinates.z);
+}
+
+// Return the signed distance between a point and the plane of a face of a mesh
+double computeDistance(const Mesh& mesh, uint face, const Vector3& point) {
+    const vector<Vector3>& vertices = mesh.getVertices();
+    const vector<uint>& indices = mesh.getIndices(0);
+    const Vector3& a = vertices[indices[3 * face]];
+    const Vector3& b = vertices[indices[3 * face + 1]];
+    const Vector3& c = vertices[indices[3 * face + 2]];
+    double ab[3] = {double(b.x) - a.x, double(b.y) - a.y, double(b.z) - a.z};
+    double ac[3] = {double(c.x) - a.x, double(c.y) - a.y, double(c.z) - a.z};
+    double normal[3] = {ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2],
+                        ab[0] * ac[1] - ab[1] * ac[0]};
+    double length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    return (normal[0] * (point.x - a.x) + normal[1] * (point.y - a.y) +
+            normal[2] * (point.z - a.z)) / length;
+}
+
+// Check that a hull is a closed convex polyhedron (each edge is shared by two faces
+// in opposite directions, the Euler characteristic is 2 and no vertex of a face is
+// above a neighbour face) and return the number of errors
+int checkClosedAndLocallyConvex(const Mesh& hull, double epsilon) {
+
+    const vector<uint>& indices = hull.getIndices(0);
+    const uint nbFaces = indices.size() / 3;
+    map<pair<uint, uint>, uint> edgeFaces;
+    int nbErrors = 0;
+    for (uint f=0; f<nbFaces; f++) {
+        for (uint e=0; e<3; e++) {
+            pair<uint, uint> edge(indices[3 * f + e], indices[3 * f + (e + 1) % 3]);
+            if (edgeFaces.count(edge) != 0) nbErrors++;
+            edgeFaces[edge] = f;
+        }
+    }
+
+    for (uint f=0; f<nbFaces; f++) {
+        for (uint e=0; e<3; e++) {
+            map<pair<uint, uint>, uint>::const_iterator it =
+                    edgeFaces.find(make_pair(indices[3 * f + (e + 1) % 3], indices[3 * f + e]));
+            if (it == edgeFaces.end()) {
+                nbErrors++;
+                continue;
+            }
+            for (uint i=0; i<3; i++) {
+                const Vector3& vertex = hull.getVertices()[indices[3 * it->second + i]];
+                if (computeDistance(hull, f, vertex) > epsilon) nbErrors++;
+            }
+        }
+    }
+
+    int eulerCharacteristic = int(hull.getNbVertices()) - int(edgeFaces.size() / 2) + int(nbFaces);
+    if (eulerCharacteristic != 2) nbErrors++;
+
+    return nbErrors;
+}
+
+// Return the number of points outside of the faces of a hull (every faceStep faces)
+int countOutsidePoints(const Mesh& hull, const vector<Vector3>& points, double epsilon,
+                       uint faceStep) {
+    int nbOutsidePoints = 0;
+    for (uint f=0; f<hull.getNbFaces(); f+=faceStep) {
+        for (uint i=0; i<points.size(); i++) {
+            if (computeDistance(hull, f, points[i]) > epsilon) nbOutsidePoints++;
+        }
+    }
+    return nbOutsidePoints;
+}
+
+// Report the result of a test and return its number of errors
+int report(const char* name, int nbErrors) {
+    cout << name << " : " << (nbErrors == 0 ? "passed" : "FAILED") << " (" << nbErrors
+         << " errors)" << endl;
+    return nbErrors;
+}
+
+// Main function
+int main(int argc, char** argv) {
+
+    srand(0);
+    int nbErrors = 0;
+
+    // Dense points on a sphere (every point is almost coplanar with its neighbours)
+    const uint nbPointsOnSphere[2] = {100000, 200000};
+    for (int s=0; s<2; s++) {
+        vector<Vector3> points(nbPointsOnSphere[s]);
+        for (uint i=0; i<points.size(); i++) points[i] = getRandomPointOnSphere(5.0f);
+        const double epsilon = computeTolerance(points);
+        Mesh hull;
+        ConvexHull::computeConvexHull(points, hull);
+        int nbSphereErrors = checkClosedAndLocallyConvex(hull, epsilon) +
+                             countOutsidePoints(hull, points, epsilon, 997);
+        nbErrors += report(s == 0 ? "sphere (100k points)" : "sphere (200k points)",
+                           nbSphereErrors);
+    }
+
+    // Points in a cube with coplanar points on its faces
+    vector<Vector3> cubePoints;
+    for (int x=0; x<10; x++) {
+        for (int y=0; y<10; y++) {
+            for (int z=0; z<10; z++) cubePoints.push_back(Vector3(x, y, z));
+        }
+    }
+    for (int i=0; i<20000; i++) {
+        cubePoints.push_back(Vector3(getRandomNumber(), getRandomNumber(), getRandomNumber()) * 4.5f +
+                             Vector3(4.5f, 4.5f, 4.5f));
+    }
+    {
+        const double epsilon = computeTolerance(cubePoints);
+        Mesh hull;
+        ConvexHull::computeConvexHull(cubePoints, hull);
+        int nbCubeErrors = checkClosedAndLocallyConvex(hull, epsilon) +
+                           countOutsidePoints(hull, cubePoints, epsilon, 1);
+        if (hull.getNbVertices() != 8) nbCubeErrors++;
+        nbErrors += report("cube", nbCubeErrors);
+    }
+
+    // The simplified hulls contain all the points
+    vector<Vector3> spherePoints(20000);
+    for (uint i=0; i<spherePoints.size(); i++) spherePoints[i] = getRandomPointOnSphere(5.0f);
+    {
+        const double epsilon = computeTolerance(spherePoints);
+        Mesh hull;
+        ConvexHull::computeConvexHull(spherePoints, hull, 64);
+        int nbSimplifiedErrors = checkClosedAndLocallyConvex(hull, epsilon) +
+                                 countOutsidePoints(hull, spherePoints, epsilon, 1);
+        if (hull.getNbFaces() > 64) nbSimplifiedErrors++;
+        nbErrors += report("simplified sphere", nbSimplifiedErrors);
+    }
+
+    // The simplified planar hulls contain all the points
+    vector<Vector3> planarPoints(5000);
+    for (uint i=0; i<planarPoints.size(); i++) {
+        Vector3 point = getRandomPointOnSphere(1.0f);
+        planarPoints[i] = Vector3(point.x + point.y, point.y, 2.0f * point.x + 1.0f);
+    }
+    {
+        const double epsilon = computeTolerance(planarPoints);
+        Mesh hull;
+        ConvexHull::computeConvexHull(planarPoints, hull, 10);
+        const vector<Vector3>& vertices = hull.getVertices();
+        const uint nbVertices = vertices.size();
+        Vector3 normal = (vertices[1] - vertices[0]).cross(vertices[2] - vertices[0]);
+        int nbPlanarErrors = (hull.getNbFaces() > 10) ? 1 : 0;
+        for (uint v=0; v<nbVertices; v++) {
+            Vector3 outside = (vertices[(v + 1) % nbVertices] - vertices[v]).cross(normal);
+            outside.normalize();
+            for (uint i=0; i<planarPoints.size(); i++) {
+                if (outside.dot(planarPoints[i] - vertices[v]) > epsilon) nbPlanarErrors++;
+            }
+        }
+        nbErrors += report("simplified polygon", nbPlanarErrors);
+    }
+
+    return (nbErrors == 0) ? 0 : 1;
+}
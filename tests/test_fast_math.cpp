@@ -0,0 +1,126 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "openglframework.h"
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Return a random number between -1 and 1
+float getRandomNumber() {
+    return rand() / float(RAND_MAX) * 2.0f - 1.0f;
+}
+
+// Return the maximum relative error of FastMath::fastInverseSqrt() over the positive
+// normalized floats (one every 97 representable values)
+double computeInverseSqrtError() {
+    double maxError = 0.0;
+    for (uint bits = 0x00800000u; bits < 0x7f000000u; bits += 97) {
+        float x;
+        memcpy(&x, &bits, sizeof(float));
+        double error = fabs(double(FastMath::fastInverseSqrt(x)) * sqrt(double(x)) - 1.0);
+        maxError = max(maxError, error);
+    }
+    return maxError;
+}
+
+// Return the maximum absolute error of FastMath::fastSinCos() over
+// [-FAST_SINCOS_MAX_ANGLE, FAST_SINCOS_MAX_ANGLE]
+double computeSinCosError() {
+    double maxError = 0.0;
+    for (double a = -FAST_SINCOS_MAX_ANGLE; a <= FAST_SINCOS_MAX_ANGLE; a += 0.000731) {
+        float angle = float(a);
+        float sine, cosine;
+        FastMath::fastSinCos(angle, sine, cosine);
+        maxError = max(maxError, fabs(sine - sin(double(angle))));
+        maxError = max(maxError, fabs(cosine - cos(double(angle))));
+    }
+    return maxError;
+}
+
+// Return the maximum error of the components of the vectors normalized by batches
+// against the vectors divided by their length in double precision
+double computeBatchNormalizeError() {
+    vector<Vector3> vectors(4099);
+    for (uint i=0; i<vectors.size(); i++) {
+        float scale = powf(10.0f, 4.0f * getRandomNumber());
+        vectors[i] = Vector3(getRandomNumber(), getRandomNumber(), getRandomNumber() + 2.0f) * scale;
+    }
+    vector<Vector3> normalizedVectors(vectors);
+    Vector3::normalize(&normalizedVectors[0], int(normalizedVectors.size()));
+    double maxError = 0.0;
+    for (uint i=0; i<vectors.size(); i++) {
+        const Vector3& v = vectors[i];
+        double length = sqrt(double(v.x) * v.x + double(v.y) * v.y + double(v.z) * v.z);
+        for (int axis=0; axis<3; axis++) {
+            double error = fabs(normalizedVectors[i][axis] - v[axis] / length);
+            maxError = max(maxError, error);
+        }
+    }
+    return maxError;
+}
+
+// Report the result of a test and return its number of errors
+int report(const char* name, double error, double bound) {
+    int nbErrors = (error <= bound) ? 0 : 1;
+    cout << name << " : " << (nbErrors == 0 ? "passed" : "FAILED") << " (error " << error
+         << ", bound " << bound << ")" << endl;
+    return nbErrors;
+}
+
+// Main function
+int main(int argc, char** argv) {
+
+    srand(0);
+    int nbErrors = 0;
+
+    nbErrors += report("fast inverse square root", computeInverseSqrtError(),
+                       FAST_RSQRT_MAX_RELATIVE_ERROR);
+    nbErrors += report("fast sine and cosine", computeSinCosError(),
+                       FAST_SINCOS_MAX_ABSOLUTE_ERROR);
+
+    // The large angles use the standard library functions
+    float sine, cosine;
+    FastMath::fastSinCos(3.0f * FAST_SINCOS_MAX_ANGLE, sine, cosine);
+    nbErrors += report("fast sine and cosine (large angle)",
+                       max(fabs(sine - sinf(3.0f * FAST_SINCOS_MAX_ANGLE)),
+                           fabs(cosine - cosf(3.0f * FAST_SINCOS_MAX_ANGLE))), 0.0);
+
+    // The components of the normalized vectors contain the rounding errors of the
+    // square root and of the division
+    nbErrors += report("batch normalize", computeBatchNormalizeError(),
+                       4.0 * numeric_limits<float>::epsilon());
+
+    return (nbErrors == 0) ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+/********************************************************************************
+* OpenGL-Framework                                                              *
+* Copyright (c) 2013 Daniel Chappuis                                            *
+*********************************************************************************
+*                                                                               *
+* This software is provided 'as-is', without any express or implied warranty.   *
+* In no event will the authors be held liable for any damages arising from the  *
+* use of this software.                                                         *
+*                                                                               *
+* Permission is granted to anyone to use this software for any purpose,         *
+* including commercial applications, and to alter it and redistribute it        *
+* freely, subject to the following restrictions:                                *
+*                                                                               *
+* 1. The origin of this software must not be misrepresented; you must not claim *
+*    that you wrote the original software. If you use this software in a        *
+*    product, an acknowledgment in the product documentation would be           *
+*    appreciated but is not required.                                           *
+*                                                                               *
+* 2. Altered source versions must be plainly marked as such, and must not be    *
+*    misrepresented as being the original software.                             *
+*                                                                               *
+* 3. This notice may not be removed or altered from any source distribution.    *
+*                                                                               *
+********************************************************************************/
+
+// Libraries
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include "openglframework.h"
+
+// Namespaces
+using namespace openglframework;
+using namespace std;
+
+// Create a mesh with one part whose indices reference each vertex once
+void createMesh(Mesh& mesh, vector<Vector3>& vertices) {
+    vector<vector<uint> > indices(1);
+    for (uint i=0; i<vertices.size(); i++) indices[0].push_back(i);
+    mesh.setVertices(vertices);
+    mesh.setIndices(std::move(indices));
+}
+
+// Weld the vertices of a mesh and return the number of errors between the new and
+// the expected indices and of vertices moved by more than the tolerance
+int checkWelding(vector<Vector3>& vertices, float tolerance,
+                 const vector<uint>& expectedIndices) {
+    Mesh mesh;
+    createMesh(mesh, vertices);
+    MeshCleaner::weldVertices(mesh, tolerance, 0.001f);
+    const vector<uint>& indices = mesh.getIndices(0);
+    int nbErrors = 0;
+    for (uint i=0; i<indices.size(); i++) {
+        if (indices[i] != expectedIndices[i]) nbErrors++;
+        if ((vertices[indices[i]] - vertices[i]).length() > tolerance) nbErrors++;
+    }
+    return nbErrors;
+}
+
+// Report the result of a test and return its number of errors
+int report(const char* name, int nbErrors) {
+    cout << name << " : " << (nbErrors == 0 ? "passed" : "FAILED") << " (" << nbErrors
+         << " errors)" << endl;
+    return nbErrors;
+}
+
+// Main function
+int main(int argc, char** argv) {
+
+    int nbErrors = 0;
+
+    // A chain of vertices spaced just under the tolerance is not welded into a
+    // single vertex
+    {
+        vector<Vector3> vertices;
+        for (uint i=0; i<4; i++) vertices.push_back(Vector3(0.9f * i, 0.0f, 0.0f));
+        uint expectedIndices[4] = {0, 0, 2, 2};
+        nbErrors += report("chain of close vertices",
+                           checkWelding(vertices, 1.0f, vector<uint>(expectedIndices,
+                                                                     expectedIndices + 4)));
+    }
+
+    // A zero tolerance only welds the equal vertices (even with large coordinates)
+    {
+        vector<Vector3> vertices;
+        vertices.push_back(Vector3(1e6f, -2e6f, 3e6f));
+        vertices.push_back(Vector3(1e6f + 0.125f, -2e6f, 3e6f));
+        vertices.push_back(Vector3(-1e6f, 5.0f, 0.0f));
+        vertices.push_back(Vector3(1e6f, -2e6f, 3e6f));
+        vertices.push_back(Vector3(-1e6f, 5.0f, 0.0f));
+        uint expectedIndices[5] = {0, 1, 2, 0, 2};
+        nbErrors += report("zero tolerance with large coordinates",
+                           checkWelding(vertices, 0.0f, vector<uint>(expectedIndices,
+                                                                     expectedIndices + 5)));
+    }
+
+    // The attributes are compared with the vertex that is kept
+    {
+        vector<Vector3> vertices(4, Vector3(1, 2, 3));
+        vector<Vector3> normals;
+        for (uint i=0; i<4; i++) normals.push_back(Vector3(0.0f, 0.0008f * i, 1.0f));
+        Mesh mesh;
+        createMesh(mesh, vertices);
+        mesh.setNormals(normals);
+        MeshCleaner::weldVertices(mesh, 0.0f, 0.001f);
+        const vector<uint>& indices = mesh.getIndices(0);
+        int nbAttributeErrors = 0;
+        for (uint i=0; i<indices.size(); i++) {
+            if (fabs(normals[indices[i]].y - normals[i].y) > 0.001f) nbAttributeErrors++;
+        }
+        nbErrors += report("chain of close attributes", nbAttributeErrors);
+    }
+
+    return (nbErrors == 0) ? 0 : 1;
+}